@@ -88,10 +88,16 @@ extern uint32_t SystemCoreClock;
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS           0
+#define configGENERATE_RUN_TIME_STATS           1
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
+/* Run time stats are clocked from the DWT cycle counter, see timer.h */
+extern void timer_cycles_init(void);
+extern uint32_t timer_run_time_get(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()  timer_cycles_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()          timer_run_time_get()
+
 /* Co-routine related definitions. */
 #define configUSE_CO_ROUTINES                   0
 #define configMAX_CO_ROUTINE_PRIORITIES         1
@@ -14,6 +14,7 @@
 
 /* Clock support */
 #include "cyhal_clock.h"
+#include <string.h>
 
 /* Static PWM object used by the buzzer driver */
 static cyhal_pwm_t buzzer_pwm;
@@ -29,6 +30,49 @@ static uint32_t buzzer_freq = 3500; // default
 static cyhal_clock_t buzzer_clock;
 static bool buzzer_clock_reserved = false;
 
+/* A queued sequence of notes */
+typedef struct
+{
+	const buzzer_note_t *notes;
+	uint8_t count;
+	uint8_t priority;
+} buzzer_sequence_t;
+
+/* Sequencer state, shared with the timer interrupt */
+static cyhal_timer_t buzzer_timer;
+static cyhal_timer_cfg_t buzzer_timer_cfg;
+static volatile bool buzzer_playing = false;
+static buzzer_sequence_t buzzer_current;
+static uint8_t buzzer_note_index;
+static uint16_t buzzer_remaining_ms;
+static buzzer_sequence_t buzzer_queue[BUZZER_QUEUE_LENGTH]; // Highest priority first
+static uint8_t buzzer_queue_count = 0;
+
+static const buzzer_note_t buzzer_effect_hit[] = {
+	{1500, 60, 50}, {0, 20, 0}, {2500, 90, 50},
+};
+static const buzzer_note_t buzzer_effect_sunk[] = {
+	{2500, 80, 50}, {2000, 80, 50}, {1500, 80, 50}, {1000, 250, 50},
+};
+static const buzzer_note_t buzzer_effect_win[] = {
+	{1047, 120, 50}, {1319, 120, 50}, {1568, 120, 50}, {2093, 400, 50},
+};
+static const buzzer_note_t buzzer_effect_lose[] = {
+	{784, 200, 50}, {659, 200, 50}, {523, 500, 50},
+};
+static const buzzer_note_t buzzer_effect_alarm[] = {
+	{3500, 150, 50}, {0, 50, 0}, {3500, 150, 50}, {0, 50, 0}, {3500, 150, 50}, {0, 300, 0},
+};
+
+/* Effects indexed by buzzer_effect_t, with their priorities */
+static const buzzer_sequence_t buzzer_effects[BUZZER_EFFECT_COUNT] = {
+	[BUZZER_EFFECT_HIT] = {buzzer_effect_hit, sizeof(buzzer_effect_hit) / sizeof(buzzer_note_t), 1},
+	[BUZZER_EFFECT_SUNK] = {buzzer_effect_sunk, sizeof(buzzer_effect_sunk) / sizeof(buzzer_note_t), 2},
+	[BUZZER_EFFECT_WIN] = {buzzer_effect_win, sizeof(buzzer_effect_win) / sizeof(buzzer_note_t), 3},
+	[BUZZER_EFFECT_LOSE] = {buzzer_effect_lose, sizeof(buzzer_effect_lose) / sizeof(buzzer_note_t), 3},
+	[BUZZER_EFFECT_ALARM] = {buzzer_effect_alarm, sizeof(buzzer_effect_alarm) / sizeof(buzzer_note_t), 4},
+};
+
 cy_rslt_t buzzer_init(float duty, uint32_t frequency)
 {
 	cy_rslt_t rslt;
@@ -99,3 +143,165 @@ void buzzer_free(void)
 		buzzer_clock_reserved = false;
 	}
 }
+
+/**
+ * @brief
+ * Programs the PWM for the current note.  Called with the sequencer
+ * state protected.
+ */
+static void buzzer_note_start(void)
+{
+	const buzzer_note_t *note = &buzzer_current.notes[buzzer_note_index];
+
+	buzzer_remaining_ms = (note->duration_ms == 0) ? 1 : note->duration_ms;
+	if (note->frequency == 0)
+	{
+		cyhal_pwm_stop(&buzzer_pwm);
+	}
+	else
+	{
+		cyhal_pwm_set_duty_cycle(&buzzer_pwm, note->duty, note->frequency);
+		cyhal_pwm_start(&buzzer_pwm);
+	}
+}
+
+/**
+ * @brief
+ * Starts sequence from its first note
+ */
+static void buzzer_sequence_start(const buzzer_sequence_t *sequence)
+{
+	buzzer_current = *sequence;
+	buzzer_note_index = 0;
+	buzzer_note_start();
+
+	if (!buzzer_playing)
+	{
+		buzzer_playing = true;
+		cyhal_timer_reset(&buzzer_timer);
+		cyhal_timer_start(&buzzer_timer);
+	}
+}
+
+/**
+ * @brief
+ * Moves to the next note, the next queued sequence, or silence
+ */
+static void buzzer_note_next(void)
+{
+	if (++buzzer_note_index < buzzer_current.count)
+	{
+		buzzer_note_start();
+	}
+	else if (buzzer_queue_count > 0)
+	{
+		buzzer_sequence_start(&buzzer_queue[0]);
+		buzzer_queue_count--;
+		memmove(&buzzer_queue[0], &buzzer_queue[1], buzzer_queue_count * sizeof(buzzer_sequence_t));
+	}
+	else
+	{
+		cyhal_pwm_stop(&buzzer_pwm);
+		cyhal_timer_stop(&buzzer_timer);
+		buzzer_playing = false;
+	}
+}
+
+/**
+ * @brief
+ * Sequencer tick, every 1 ms while a sequence plays
+ */
+static void buzzer_timer_handler(void *handler_arg, cyhal_timer_event_t event)
+{
+	(void)handler_arg;
+	(void)event;
+
+	if (buzzer_playing && --buzzer_remaining_ms == 0)
+	{
+		buzzer_note_next();
+	}
+}
+
+cy_rslt_t buzzer_sequencer_init(void)
+{
+	cy_rslt_t rslt;
+
+	if (!buzzer_initialized)
+	{
+		return CYHAL_PWM_RSLT_BAD_ARGUMENT;
+	}
+
+	rslt = timer_init(&buzzer_timer, &buzzer_timer_cfg, 100000000 / BUZZER_TICK_HZ, buzzer_timer_handler);
+	if (rslt == CY_RSLT_SUCCESS)
+	{
+		cyhal_timer_stop(&buzzer_timer);
+	}
+	return rslt;
+}
+
+bool buzzer_play(const buzzer_note_t *notes, uint8_t count, uint8_t priority)
+{
+	buzzer_sequence_t sequence = {notes, count, priority};
+	bool status = true;
+	uint8_t i;
+	uint32_t state;
+
+	if (!buzzer_initialized || notes == NULL || count == 0)
+	{
+		return false;
+	}
+
+	state = cyhal_system_critical_section_enter();
+	if (!buzzer_playing || priority > buzzer_current.priority)
+	{
+		buzzer_sequence_start(&sequence);
+	}
+	else if (buzzer_queue_count < BUZZER_QUEUE_LENGTH || priority > buzzer_queue[BUZZER_QUEUE_LENGTH - 1].priority)
+	{
+		// Insert behind sequences of equal or higher priority, dropping the
+		// lowest priority one when the queue is full
+		if (buzzer_queue_count < BUZZER_QUEUE_LENGTH)
+		{
+			buzzer_queue_count++;
+		}
+		for (i = buzzer_queue_count - 1; i > 0 && buzzer_queue[i - 1].priority < priority; i--)
+		{
+			buzzer_queue[i] = buzzer_queue[i - 1];
+		}
+		buzzer_queue[i] = sequence;
+	}
+	else
+	{
+		status = false;
+	}
+	cyhal_system_critical_section_exit(state);
+
+	return status;
+}
+
+bool buzzer_play_effect(buzzer_effect_t effect)
+{
+	if (effect >= BUZZER_EFFECT_COUNT)
+	{
+		return false;
+	}
+	return buzzer_play(buzzer_effects[effect].notes, buzzer_effects[effect].count, buzzer_effects[effect].priority);
+}
+
+void buzzer_stop_all(void)
+{
+	uint32_t state = cyhal_system_critical_section_enter();
+
+	buzzer_queue_count = 0;
+	if (buzzer_playing)
+	{
+		buzzer_note_index = buzzer_current.count;
+		buzzer_note_next();
+	}
+	cyhal_system_critical_section_exit(state);
+}
+
+bool buzzer_is_playing(void)
+{
+	return buzzer_playing;
+}
@@ -16,9 +16,71 @@
 #include "cyhal.h"
 #include "cybsp.h"
 #include "ece353-pins.h"
+#include "timer.h"
+
+#define BUZZER_TICK_HZ 1000      // Sequencer timer rate, 1 ms note resolution
+#define BUZZER_QUEUE_LENGTH 4    // Sequences waiting behind the one playing
+
+/* One step of a sequence.  A frequency of 0 is a rest. */
+typedef struct
+{
+	uint16_t frequency;
+	uint16_t duration_ms;
+	uint8_t duty;              // Percent
+} buzzer_note_t;
+
+/* Built in sound effects */
+typedef enum
+{
+	BUZZER_EFFECT_HIT,
+	BUZZER_EFFECT_SUNK,
+	BUZZER_EFFECT_WIN,
+	BUZZER_EFFECT_LOSE,
+	BUZZER_EFFECT_ALARM,
+	BUZZER_EFFECT_COUNT
+} buzzer_effect_t;
 
 cy_rslt_t buzzer_init(float duty, uint32_t frequency);
 void buzzer_on(void);
 void buzzer_off(void);
 
+/**
+ * @brief
+ * Starts the hardware timer that steps through queued sequences.  Must be
+ * called after buzzer_init.  The timer only runs while a sequence plays.
+ * @return cy_rslt_t
+ */
+cy_rslt_t buzzer_sequencer_init(void);
+
+/**
+ * @brief
+ * Queues a sequence and returns immediately.  The notes are played from
+ * the timer interrupt, so the array must stay valid until it finishes.
+ * A higher priority sequence cuts off the one playing.  Otherwise it waits
+ * behind queued sequences of equal or higher priority.
+ * @param notes
+ * @param count
+ * @param priority
+ * @return true
+ * @return false if the queue is full of sequences of at least priority
+ */
+bool buzzer_play(const buzzer_note_t *notes, uint8_t count, uint8_t priority);
+
+/**
+ * @brief
+ * Queues one of the built in sound effects
+ * @param effect
+ * @return true
+ * @return false
+ */
+bool buzzer_play_effect(buzzer_effect_t effect);
+
+/**
+ * @brief
+ * Silences the buzzer and discards every queued sequence
+ */
+void buzzer_stop_all(void);
+
+bool buzzer_is_playing(void);
+
 #endif
\ No newline at end of file
@@ -20,30 +20,38 @@
  */
 void eeprom_wait_for_write(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin)
 {
-	uint8_t status = 0;
 	do
 	{
-		uint8_t tx_buffer[2];
-		uint8_t rx_buffer[2];
-		tx_buffer[0] = EEPROM_CMD_RDSR; // Read Status Register command
-		tx_buffer[1] = 0xFF;			// Dummy
+		// Small delay between status checks
+		cyhal_system_delay_ms(1);
 
-		// Assert CS pin
-		cyhal_gpio_write(cs_pin, 0);
+	} while (eeprom_write_in_progress(spi_obj, cs_pin));
+}
 
-		// Send SPI transaction to read status register
-		cyhal_spi_transfer(spi_obj, tx_buffer, 2, rx_buffer, 2, 0xFF);
+/** Reads the status register once and returns true if the EEPROM
+ *  is still busy with an internal write cycle
+ *
+ * @param
+ *
+ */
+bool eeprom_write_in_progress(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin)
+{
+	uint8_t tx_buffer[2];
+	uint8_t rx_buffer[2];
+	tx_buffer[0] = EEPROM_CMD_RDSR; // Read Status Register command
+	tx_buffer[1] = 0xFF;			// Dummy
 
-		// De-assert CS pin
-		cyhal_gpio_write(cs_pin, 1);
+	// Assert CS pin
+	cyhal_gpio_write(cs_pin, 0);
 
-		// Extract status from received data
-		status = rx_buffer[1];
+	// Send SPI transaction to read status register
+	cyhal_spi_transfer(spi_obj, tx_buffer, 2, rx_buffer, 2, 0xFF);
 
-		// Small delay between status checks
-		cyhal_system_delay_ms(1);
+	// De-assert CS pin
+	cyhal_gpio_write(cs_pin, 1);
 
-	} while (status & 0x01); // Continue while Write In Progress bit is set
+	// Write In Progress bit
+	return (rx_buffer[1] & 0x01) != 0;
 }
 /** Enables Writes to the EEPROM
  *
@@ -141,4 +149,74 @@ uint8_t eeprom_read_byte(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin, uint16_t add
 	cyhal_gpio_write(cs_pin, 1);
 
 	return rx_buffer[3]; // Return the received data byte
+}
+
+/** Writes up to one page of data starting at the specified address
+ *  using a single write cycle.  The data must not cross a page
+ *  boundary (EEPROM_PAGE_SIZE); the device wraps within the page.
+ *
+ * @param address -- 16 bit address in the EEPROM
+ * @param data    -- bytes to write into memory
+ * @param length  -- number of bytes to write
+ *
+ */
+void eeprom_write_page(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin, uint16_t address, const uint8_t *data, uint16_t length)
+{
+	if (length == 0)
+	{
+		return;
+	}
+
+	// Enable writes first
+	eeprom_write_enable(spi_obj, cs_pin);
+
+	uint8_t tx_buffer[3];
+	tx_buffer[0] = EEPROM_CMD_WRITE;	  // Write command
+	tx_buffer[1] = (address >> 8) & 0xFF; // High byte of address
+	tx_buffer[2] = address & 0xFF;		  // Low byte of address
+
+	// Assert CS pin
+	cyhal_gpio_write(cs_pin, 0);
+
+	// Transmit the command/address followed by the page data
+	cyhal_spi_transfer(spi_obj, tx_buffer, 3, NULL, 0, 0xFF);
+	cyhal_spi_transfer(spi_obj, data, length, NULL, 0, 0xFF);
+
+	// De-assert CS pin
+	cyhal_gpio_write(cs_pin, 1);
+
+	// Wait for write to complete
+	eeprom_wait_for_write(spi_obj, cs_pin);
+}
+
+/** Reads a block of data starting at the specified address using
+ *  a single sequential read transaction.
+ *
+ * @param address -- 16 bit address in the EEPROM
+ * @param data    -- buffer to store the bytes read
+ * @param length  -- number of bytes to read
+ *
+ */
+void eeprom_read_seq(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin, uint16_t address, uint8_t *data, uint16_t length)
+{
+	if (length == 0)
+	{
+		return;
+	}
+
+	uint8_t tx_buffer[3];
+	tx_buffer[0] = EEPROM_CMD_READ;		  // Read command
+	tx_buffer[1] = (address >> 8) & 0xFF; // High byte of address
+	tx_buffer[2] = address & 0xFF;		  // Low byte of address
+
+	// Assert CS pin
+	cyhal_gpio_write(cs_pin, 0);
+
+	// Send the command/address, then clock out the data with dummy bytes.
+	// The EEPROM auto-increments the address for as long as CS is held low.
+	cyhal_spi_transfer(spi_obj, tx_buffer, 3, NULL, 0, 0xFF);
+	cyhal_spi_transfer(spi_obj, NULL, 0, data, length, 0xFF);
+
+	// De-assert CS pin
+	cyhal_gpio_write(cs_pin, 1);
 }
\ No newline at end of file
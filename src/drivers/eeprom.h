@@ -29,6 +29,8 @@
 #define EEPROM_CMD_RDLS					0x83
 #define EEPROM_CMD_LID 					0x82
 
+#define EEPROM_PAGE_SIZE				64       // Bytes per write page
+
 /** Determine if the EEPROM is busy writing the last
  *  transaction to non-volatile storage
  *
@@ -37,6 +39,14 @@
  */
 void eeprom_wait_for_write(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin);
 
+/** Reads the status register once and returns true if the EEPROM
+ *  is still busy with an internal write cycle
+ *
+ * @param
+ *
+ */
+bool eeprom_write_in_progress(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin);
+
 /** Enables Writes to the EEPROM
  *
  * @param
@@ -67,4 +77,25 @@ void eeprom_write_byte(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin, uint16_t addre
  */
 uint8_t eeprom_read_byte(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin, uint16_t address);
 
+/** Writes up to one page of data starting at the specified address
+ *  using a single write cycle.  The data must not cross a page
+ *  boundary (EEPROM_PAGE_SIZE); the device wraps within the page.
+ *
+ * @param address -- 16 bit address in the EEPROM
+ * @param data    -- bytes to write into memory
+ * @param length  -- number of bytes to write
+ *
+ */
+void eeprom_write_page(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin, uint16_t address, const uint8_t *data, uint16_t length);
+
+/** Reads a block of data starting at the specified address using
+ *  a single sequential read transaction.
+ *
+ * @param address -- 16 bit address in the EEPROM
+ * @param data    -- buffer to store the bytes read
+ * @param length  -- number of bytes to read
+ *
+ */
+void eeprom_read_seq(cyhal_spi_t *spi_obj, cyhal_gpio_t cs_pin, uint16_t address, uint8_t *data, uint16_t length);
+
 #endif /* EEPROM_H_ */
@@ -145,5 +145,94 @@ cy_rslt_t i2c_read_u16(cyhal_i2c_t *obj, uint8_t subordinate_address, uint8_t re
 
 	*value = (uint16)rx_data[0] << 8 | rx_data[1];
 
+	return rslt;
+}
+
+/**
+ * @brief
+ * Reads consecutive registers starting at reg using a repeated start
+ * @param obj
+ * @param subordinate_address
+ * @param reg
+ * @param data
+ * @param length
+ * @return cy_rslt_t
+ */
+cy_rslt_t i2c_read_burst(cyhal_i2c_t *obj, uint8_t subordinate_address, uint8_t reg, uint8_t *data, uint16_t length)
+{
+	cy_rslt_t rslt;
+
+	if (data == NULL || length == 0)
+	{
+		return CYHAL_I2C_RSLT_ERR_BAD_ARGUMENT;
+	}
+
+	// Register address, repeated start, then length bytes with auto-increment
+	rslt = cyhal_i2c_master_mem_read(obj, subordinate_address, reg, 1, data, length, I2C_BURST_TIMEOUT_MS);
+	if (rslt != CY_RSLT_SUCCESS)
+	{
+		printf("I2C burst read failed!\n\r");
+	}
+
+	return rslt;
+}
+
+/**
+ * @brief
+ * Writes consecutive registers starting at reg
+ * @param obj
+ * @param subordinate_address
+ * @param reg
+ * @param data
+ * @param length
+ * @return cy_rslt_t
+ */
+cy_rslt_t i2c_write_burst(cyhal_i2c_t *obj, uint8_t subordinate_address, uint8_t reg, const uint8_t *data, uint16_t length)
+{
+	cy_rslt_t rslt;
+
+	if (data == NULL || length == 0)
+	{
+		return CYHAL_I2C_RSLT_ERR_BAD_ARGUMENT;
+	}
+
+	rslt = cyhal_i2c_master_mem_write(obj, subordinate_address, reg, 1, data, length, I2C_BURST_TIMEOUT_MS);
+	if (rslt != CY_RSLT_SUCCESS)
+	{
+		printf("I2C burst write failed!\n\r");
+	}
+
+	return rslt;
+}
+
+/**
+ * @brief
+ * Runs each burst in list in order
+ * @param obj
+ * @param list
+ * @param count
+ * @return cy_rslt_t
+ */
+cy_rslt_t i2c_burst_list(cyhal_i2c_t *obj, const i2c_burst_t *list, uint8_t count)
+{
+	cy_rslt_t rslt = CY_RSLT_SUCCESS;
+
+	if (list == NULL)
+	{
+		return CYHAL_I2C_RSLT_ERR_BAD_ARGUMENT;
+	}
+
+	for (uint8_t i = 0; i < count && rslt == CY_RSLT_SUCCESS; i++)
+	{
+		if (list[i].write)
+		{
+			rslt = i2c_write_burst(obj, list[i].subordinate_address, list[i].reg, list[i].data, list[i].length);
+		}
+		else
+		{
+			rslt = i2c_read_burst(obj, list[i].subordinate_address, list[i].reg, list[i].data, list[i].length);
+		}
+	}
+
 	return rslt;
 }
\ No newline at end of file
@@ -21,6 +21,17 @@
 
 /* Macros */
 #define I2C_MASTER_FREQUENCY 100000u
+#define I2C_BURST_TIMEOUT_MS 10u
+
+/* One register burst in a scatter list passed to i2c_burst_list() */
+typedef struct
+{
+	uint8_t subordinate_address;
+	uint8_t reg;      // First register, the device auto-increments from here
+	uint8_t *data;
+	uint16_t length;
+	bool write;
+} i2c_burst_t;
 
 /* Public API */
 
@@ -63,6 +74,44 @@ cy_rslt_t i2c_read_u8(cyhal_i2c_t *obj, uint8_t subordinate_address, uint8_t reg
  */
 cy_rslt_t i2c_read_u16(cyhal_i2c_t *obj, uint8_t subordinate_address, uint8_t reg, uint16_t *value);
 
+/**
+ * @brief 
+ * Reads length consecutive registers starting at reg in one transaction.
+ * The register address is written, then a repeated start reads the data,
+ * so the address phase is paid once for the whole block.
+ * @param obj 
+ * @param subordinate_address 
+ * @param reg 
+ * @param data 
+ * @param length 
+ * @return cy_rslt_t 
+ */
+cy_rslt_t i2c_read_burst(cyhal_i2c_t *obj, uint8_t subordinate_address, uint8_t reg, uint8_t *data, uint16_t length);
+
+/**
+ * @brief 
+ * Writes length consecutive registers starting at reg in one transaction
+ * @param obj 
+ * @param subordinate_address 
+ * @param reg 
+ * @param data 
+ * @param length 
+ * @return cy_rslt_t 
+ */
+cy_rslt_t i2c_write_burst(cyhal_i2c_t *obj, uint8_t subordinate_address, uint8_t reg, const uint8_t *data, uint16_t length);
+
+/**
+ * @brief 
+ * Runs a list of bursts back to back, possibly to different devices.  The
+ * caller holds the I2C semaphore once around the whole list.  Stops at
+ * the first burst that fails.
+ * @param obj 
+ * @param list 
+ * @param count 
+ * @return cy_rslt_t 
+ */
+cy_rslt_t i2c_burst_list(cyhal_i2c_t *obj, const i2c_burst_t *list, uint8_t count);
+
 #endif /* ECE353_FREERTOS */
 
 #endif /* I2C_H_ */
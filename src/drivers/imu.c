@@ -101,6 +101,133 @@ void imu_read_registers(
    memcpy(buffer, &rx_buffer[1], length);
 }
 
+/**
+ * @brief
+ * Returns the output data rate in Hz for an ODR_xxx code
+ * @param odr
+ * @return uint16_t
+ */
+uint16_t imu_odr_to_hz(uint8_t odr)
+{
+    switch (odr)
+    {
+        case ODR_104HZ:  return 104;
+        case ODR_208HZ:  return 208;
+        case ODR_416HZ:  return 416;
+        case ODR_833HZ:  return 833;
+        case ODR_1660HZ: return 1660;
+        default:         return 0;
+    }
+}
+
+/**
+ * @brief
+ * Puts the accelerometer into FIFO continuous mode at the requested ODR
+ * with a watermark of watermark samples.
+ * @param spi_obj
+ * @param cs_pin
+ * @param odr
+ * @param watermark
+ * @return true
+ * @return false
+ */
+bool imu_fifo_enable(
+    cyhal_spi_t *spi_obj,
+    cyhal_gpio_t cs_pin,
+    uint8_t odr,
+    uint16_t watermark)
+{
+    uint16_t words = watermark * FIFO_WORDS_PER_SAMPLE;
+
+    if (imu_odr_to_hz(odr) == 0 || watermark == 0 || words >= FIFO_MAX_WORDS)
+    {
+        return false;
+    }
+
+    // Switching to bypass mode empties the FIFO
+    imu_write_reg(spi_obj, cs_pin, IMU_REG_FIFO_CTRL5, FIFO_MODE_BYPASS);
+
+    imu_write_reg(spi_obj, cs_pin, IMU_REG_CTRL1_XL, odr | FS_XL_2G);
+    imu_write_reg(spi_obj, cs_pin, IMU_REG_CTRL2_G, odr | FS_G_250DPS);
+
+    imu_write_reg(spi_obj, cs_pin, IMU_REG_FIFO_CTRL1, words & 0xFF);
+    imu_write_reg(spi_obj, cs_pin, IMU_REG_FIFO_CTRL2, (words >> 8) & 0x07);
+    imu_write_reg(spi_obj, cs_pin, IMU_REG_FIFO_CTRL3, FIFO_DEC_GYRO_NONE | FIFO_DEC_XL_NONE);
+
+    // ODR_FIFO uses the same encoding as ODR_XL, one bit lower
+    imu_write_reg(spi_obj, cs_pin, IMU_REG_FIFO_CTRL5, (odr >> 1) | FIFO_MODE_CONTINUOUS);
+
+    return true;
+}
+
+/**
+ * @brief
+ * Returns the FIFO to bypass mode and powers down the gyroscope
+ * @param spi_obj
+ * @param cs_pin
+ */
+void imu_fifo_disable(
+    cyhal_spi_t *spi_obj,
+    cyhal_gpio_t cs_pin)
+{
+    imu_write_reg(spi_obj, cs_pin, IMU_REG_FIFO_CTRL5, FIFO_MODE_BYPASS);
+    imu_write_reg(spi_obj, cs_pin, IMU_REG_CTRL2_G, 0x00);
+}
+
+/**
+ * @brief
+ * Reads the FIFO level, pattern and flags
+ * @param spi_obj
+ * @param cs_pin
+ * @param words
+ * @param pattern
+ * @return uint8_t
+ */
+uint8_t imu_fifo_status(
+    cyhal_spi_t *spi_obj,
+    cyhal_gpio_t cs_pin,
+    uint16_t *words,
+    uint16_t *pattern)
+{
+    uint8_t status[4];
+
+    imu_read_registers(spi_obj, cs_pin, IMU_REG_FIFO_STATUS1, status, 4);
+
+    *words = ((uint16_t)(status[1] & 0x07) << 8) | status[0];
+    *pattern = ((uint16_t)(status[3] & 0x03) << 8) | status[2];
+
+    return status[1] & (FIFO_STATUS2_WATERMARK | FIFO_STATUS2_OVER_RUN);
+}
+
+/**
+ * @brief
+ * Reads words 16-bit words from the FIFO.  The FIFO output register does
+ * not auto-increment past FIFO_DATA_OUT_H, so a single burst drains as
+ * many words as requested.
+ * @param spi_obj
+ * @param cs_pin
+ * @param buffer
+ * @param words
+ */
+void imu_fifo_read(
+    cyhal_spi_t *spi_obj,
+    cyhal_gpio_t cs_pin,
+    int16_t *buffer,
+    uint16_t words)
+{
+    uint8_t reg = IMU_REG_FIFO_DATA_OUT_L | 0x80; // Set MSB for read operation
+
+    // Assert CS pin
+    cyhal_gpio_write(cs_pin, 0);
+
+    // Send the register address, then clock in the FIFO data
+    cyhal_spi_transfer(spi_obj, &reg, 1, NULL, 0, 0xFF);
+    cyhal_spi_transfer(spi_obj, NULL, 0, (uint8_t *)buffer, words * 2, 0xFF);
+
+    // De-assert CS pin
+    cyhal_gpio_write(cs_pin, 1);
+}
+
 /**
  * @brief
  * This function verifys the WHO_AM_I register and configures the IMU
@@ -36,16 +36,50 @@
 #define IMU_REG_OUTZ_H_XL    0x2D  // Accel Z output high byte
 #define IMU_REG_WHO_AM_I     0x0F  // Device ID
 #define IMU_REG_CTRL3_C      0x12  // Control register 3
+#define IMU_REG_FIFO_CTRL1   0x06  // FIFO watermark [7:0]
+#define IMU_REG_FIFO_CTRL2   0x07  // FIFO watermark [10:8]
+#define IMU_REG_FIFO_CTRL3   0x08  // FIFO gyro/accel decimation
+#define IMU_REG_FIFO_CTRL5   0x0A  // FIFO ODR and mode
+#define IMU_REG_FIFO_STATUS1 0x3A  // Unread FIFO words [7:0]
+#define IMU_REG_FIFO_STATUS2 0x3B  // FIFO flags, unread FIFO words [10:8]
+#define IMU_REG_FIFO_STATUS3 0x3C  // FIFO pattern [7:0]
+#define IMU_REG_FIFO_STATUS4 0x3D  // FIFO pattern [9:8]
+#define IMU_REG_FIFO_DATA_OUT_L 0x3E  // FIFO output, rolls over to itself on burst reads
 
 // Configuration values
 #define ODR_104HZ    0x40  // Output data rate = 104 Hz
+#define ODR_208HZ    0x50  // Output data rate = 208 Hz
+#define ODR_416HZ    0x60  // Output data rate = 416 Hz
+#define ODR_833HZ    0x70  // Output data rate = 833 Hz
+#define ODR_1660HZ   0x80  // Output data rate = 1.66 kHz
 #define FS_XL_2G     0x00  // ±2g
 #define FS_G_250DPS  0x00  // ±250 dps
 
+// FIFO configuration values
+#define FIFO_DEC_XL_NONE        0x01  // Accelerometer in FIFO, no decimation
+#define FIFO_DEC_GYRO_NONE      0x08  // Gyroscope in FIFO, no decimation
+#define FIFO_MODE_BYPASS        0x00  // FIFO disabled (also clears it)
+#define FIFO_MODE_CONTINUOUS    0x06  // Oldest samples overwritten when full
+#define FIFO_STATUS2_WATERMARK  0x80
+#define FIFO_STATUS2_OVER_RUN   0x40
+#define FIFO_WORDS_PER_SAMPLE   6     // Gyro X, Y, Z then accel X, Y, Z words
+#define FIFO_MAX_WORDS          2048  // 4 KB FIFO
+
 // Conversion factors
 #define ACCEL_SENS_2G   (2.0f / 32768.0f)   // g/LSB
 #define GYRO_SENS_250DPS (250.0f / 32768.0f) // dps/LSB
 
+// One accelerometer + gyroscope sample read from the FIFO
+typedef struct
+{
+    int16_t x;   // Accelerometer
+    int16_t y;
+    int16_t z;
+    int16_t gx;  // Gyroscope
+    int16_t gy;
+    int16_t gz;
+} imu_sample_t;
+
 /**
  * @brief 
  *  This function initializes the IMU (LSM6DSMTR) sensor.
@@ -107,4 +141,80 @@ void imu_read_registers(
     uint8_t length
 );
 
+/**
+ * @brief 
+ *  Returns the output data rate in Hz for one of the ODR_xxx codes, or 0
+ *  if the code is not supported.
+ * @param odr 
+ * @return uint16_t 
+ */
+uint16_t imu_odr_to_hz(uint8_t odr);
+
+/**
+ * @brief 
+ *  This function puts the IMU into FIFO continuous mode.  The gyroscope and
+ *  accelerometer run at the same ODR and both are stored, so every sample
+ *  is FIFO_WORDS_PER_SAMPLE words (gyro X, Y, Z then accel X, Y, Z).
+ * @param spi_obj 
+ * @param cs_pin 
+ * @param odr 
+ *  Sensor and FIFO output data rate.  Must be ODR_104HZ or faster.
+ * @param watermark 
+ *  Number of samples that sets the FIFO watermark flag
+ * @return true 
+ * @return false 
+ */
+bool imu_fifo_enable(
+    cyhal_spi_t *spi_obj, 
+    cyhal_gpio_t cs_pin, 
+    uint8_t odr, 
+    uint16_t watermark
+);
+
+/**
+ * @brief 
+ *  This function returns the FIFO to bypass mode, discarding its contents.
+ * @param spi_obj 
+ * @param cs_pin 
+ */
+void imu_fifo_disable(
+    cyhal_spi_t *spi_obj, 
+    cyhal_gpio_t cs_pin
+);
+
+/**
+ * @brief 
+ *  This function reads FIFO_STATUS1..4 in a single transaction.
+ * @param spi_obj 
+ * @param cs_pin 
+ * @param words 
+ *  Number of unread 16-bit words in the FIFO
+ * @param pattern 
+ *  Index (0..FIFO_WORDS_PER_SAMPLE-1) of the next FIFO word in the sample
+ * @return uint8_t 
+ *  FIFO_STATUS2 flags (FIFO_STATUS2_WATERMARK, FIFO_STATUS2_OVER_RUN)
+ */
+uint8_t imu_fifo_status(
+    cyhal_spi_t *spi_obj, 
+    cyhal_gpio_t cs_pin, 
+    uint16_t *words, 
+    uint16_t *pattern
+);
+
+/**
+ * @brief 
+ *  This function reads words 16-bit words from the FIFO in a single
+ *  burst transaction.
+ * @param spi_obj 
+ * @param cs_pin 
+ * @param buffer 
+ * @param words 
+ */
+void imu_fifo_read(
+    cyhal_spi_t *spi_obj, 
+    cyhal_gpio_t cs_pin, 
+    int16_t *buffer, 
+    uint16_t words
+);
+
 #endif
\ No newline at end of file
@@ -1,11 +1,18 @@
 #include "joystick.h"
+#include "timer.h"
 #include "cy_result.h"
 #include "cyhal_adc.h"
 
+#define JOYSTICK_TIMER_HZ 100000000 /* Count rate set by timer_init() */
+
 /* Static Global Variables */
 static cyhal_adc_t joystick_adc_obj;
 static cyhal_adc_channel_t joystick_adc_chan_x_obj;
 static cyhal_adc_channel_t joystick_adc_chan_y_obj;
+static cyhal_timer_t joystick_scan_timer_obj;
+static cyhal_timer_cfg_t joystick_scan_timer_cfg;
+static int32_t joystick_scan_results[2]; /* X then Y, written by the ADC interrupt */
+static joystick_scan_handler_t joystick_scan_handler = NULL;
 const cyhal_adc_channel_config_t channel_config = { .enable_averaging = false, .min_acquisition_ns = 220, .enabled = true };
 
 const cyhal_adc_config_t joystick_config = {
@@ -106,13 +113,19 @@ uint16_t  joystick_read_y(void)
  */
 joystick_position_t joystick_get_pos(void)
 {
-    uint16_t x_val;
-    uint16_t y_val;
+    return joystick_pos_from_values(joystick_read_x(), joystick_read_y());
+}
+
+/**
+ * @brief 
+ * Returns the position for a pair of X/Y readings 
+ * @param x_val 
+ * @param y_val 
+ * @return joystick_position_t 
+ */
+joystick_position_t joystick_pos_from_values(uint16_t x_val, uint16_t y_val)
+{
     joystick_position_t position = JOYSTICK_POS_CENTER;
-    
-    /* ADD CODE */
-    x_val = joystick_read_x();
-    y_val = joystick_read_y();
 
     // Determine X direction: < 0.825V means moved, > 2.475V means moved
     bool x_left = (x_val > JOYSTICK_THRESH_X_LEFT_2P475V);
@@ -154,3 +167,79 @@ joystick_position_t joystick_get_pos(void)
 
     return position;
 }
+
+/**
+ * @brief 
+ * Converts a signed differential result to the scale of cyhal_adc_read_u16
+ */
+static uint16_t joystick_scan_to_u16(int32_t result)
+{
+    return (uint16_t)((result * (1 << (16 - joystick_config.resolution))) + 0x8000);
+}
+
+/**
+ * @brief 
+ * Timer interrupt, starts one scan of both channels 
+ */
+static void joystick_scan_timer_handler(void *callback_arg, cyhal_timer_event_t event)
+{
+    (void)callback_arg;
+    (void)event;
+
+    /* Fails if the previous scan has not finished, that period is skipped */
+    cyhal_adc_read_async(&joystick_adc_obj, 1, joystick_scan_results);
+}
+
+/**
+ * @brief 
+ * ADC interrupt, the scan started by the timer is complete 
+ */
+static void joystick_scan_adc_handler(void *callback_arg, cyhal_adc_event_t event)
+{
+    (void)callback_arg;
+
+    if ((event & CYHAL_ADC_ASYNC_READ_COMPLETE) != 0 && joystick_scan_handler != NULL)
+    {
+        joystick_scan_handler(joystick_scan_to_u16(joystick_scan_results[0]),
+                              joystick_scan_to_u16(joystick_scan_results[1]));
+    }
+}
+
+/**
+ * @brief 
+ * Starts timer paced scans of both joystick channels 
+ * @param rate_hz 
+ * @param intr_priority 
+ * @param handler 
+ * @return cy_rslt_t 
+ */
+cy_rslt_t joystick_scan_start(uint32_t rate_hz, uint8_t intr_priority, joystick_scan_handler_t handler)
+{
+    cyhal_adc_config_t scan_config = joystick_config;
+    cy_rslt_t rslt;
+
+    if (rate_hz == 0 || handler == NULL)
+    {
+        return CYHAL_ADC_RSLT_BAD_ARGUMENT;
+    }
+
+    /* Scans are started by the timer instead of running back to back */
+    scan_config.continuous_scanning = false;
+    rslt = cyhal_adc_configure(&joystick_adc_obj, &scan_config);
+    if(rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+
+    rslt = cyhal_adc_set_async_mode(&joystick_adc_obj, CYHAL_ASYNC_SW, CYHAL_DMA_PRIORITY_DEFAULT);
+    if(rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+
+    joystick_scan_handler = handler;
+    cyhal_adc_register_callback(&joystick_adc_obj, joystick_scan_adc_handler, NULL);
+    cyhal_adc_enable_event(&joystick_adc_obj, CYHAL_ADC_ASYNC_READ_COMPLETE, intr_priority, true);
+
+    return timer_init(&joystick_scan_timer_obj, &joystick_scan_timer_cfg, JOYSTICK_TIMER_HZ / rate_hz, joystick_scan_timer_handler);
+}
@@ -43,6 +43,9 @@ typedef enum {
     JOYSTICK_POS_LOWER_RIGHT
 }joystick_position_t;
 
+/* Called from the ADC interrupt with the result of each paced scan */
+typedef void (*joystick_scan_handler_t)(uint16_t x, uint16_t y);
+
 /* Public Global Variables */
 // #define JOYSTICK_THRESH_X_LEFT_2P475V   0xC000
 // #define JOYSTICK_THRESH_X_RIGHT_0P825V  0x4000
@@ -75,6 +78,28 @@ uint16_t  joystick_read_y(void);
  */
 joystick_position_t joystick_get_pos(void);
 
+/**
+ * @brief 
+ * Returns the position for a pair of X/Y readings 
+ * @param x_val 
+ * @param y_val 
+ * @return joystick_position_t 
+ */
+joystick_position_t joystick_pos_from_values(uint16_t x_val, uint16_t y_val);
+
+/**
+ * @brief 
+ * Starts a hardware timer that triggers a scan of both channels rate_hz
+ * times a second.  Results are delivered to handler from the ADC interrupt,
+ * so the CPU is idle between scans.  joystick_read_x/y still work.
+ * @param rate_hz 
+ * @param intr_priority 
+ * Priority of the ADC interrupt
+ * @param handler 
+ * @return cy_rslt_t 
+ */
+cy_rslt_t joystick_scan_start(uint32_t rate_hz, uint8_t intr_priority, joystick_scan_handler_t handler);
+
 /**
  * @brief 
  * Prints out a string to the console based on parameter passed 
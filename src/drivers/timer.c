@@ -41,4 +41,26 @@ cy_rslt_t timer_init(cyhal_timer_t *timer_obj, cyhal_timer_cfg_t *timer_cfg, uin
         return rslt;
     }
     return rslt; // Return the result of the initialization
+}
+
+void timer_cycles_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t timer_cycles_to_us(uint32_t cycles)
+{
+    return cycles / (SystemCoreClock / 1000000);
+}
+
+uint32_t timer_run_time_get(void)
+{
+    static uint64_t total = 0;
+    static uint32_t last = 0;
+    uint32_t now = timer_cycles_get();
+
+    total += now - last;
+    last = now;
+    return (uint32_t)(total >> 8);
 }
\ No newline at end of file
@@ -32,4 +32,39 @@
  */
 cy_rslt_t timer_init(cyhal_timer_t *timer_obj, cyhal_timer_cfg_t *timer_cfg, uint32_t ticks, void *Handler);
 
+/**
+ * @brief 
+ * Enables the Cortex-M DWT cycle counter so code sections can be timed with
+ * CPU clock resolution.  Safe to call more than once.
+ */
+void timer_cycles_init(void);
+
+/**
+ * @brief 
+ * Returns the current value of the DWT cycle counter.  The counter wraps, so
+ * only the difference between two readings is meaningful.
+ * @return uint32_t 
+ */
+__STATIC_INLINE uint32_t timer_cycles_get(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief 
+ * Converts a number of CPU cycles into microseconds
+ * @param cycles 
+ * @return uint32_t 
+ */
+uint32_t timer_cycles_to_us(uint32_t cycles);
+
+/**
+ * @brief 
+ * Run time stats clock for FreeRTOS.  Counts CPU cycles / 256, extended
+ * past the 32 bit cycle counter so it only wraps after about 3 hours at
+ * 100MHz.  Must be read at least once per cycle counter wrap (~40s).
+ * @return uint32_t 
+ */
+uint32_t timer_run_time_get(void);
+
 #endif
\ No newline at end of file
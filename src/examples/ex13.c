@@ -15,6 +15,7 @@
 #include "drivers.h"
 #include "task_console.h"
 #include "task_temp_sensor.h"
+#include "task_i2c.h"
 
 char APP_DESCRIPTION[] = "ECE353: Ex 13 - FreeRTOS Temp Sensor";
 
@@ -40,7 +41,7 @@ void task_system_control(void *arg);
 void task_system_control(void *arg)
 {
     (void)arg; // Unused parameter
-    temp_sensor_packet_t temp_packet;
+    float temperature;
     
     task_console_printf("Starting System Control Task\r\n");
 
@@ -48,19 +49,10 @@ void task_system_control(void *arg)
     {
         vTaskDelay(pdMS_TO_TICKS(500));
         
-        /* Read the temp sensor */
-        temp_packet.operation = TEMP_SENSOR_READ;
-        temp_packet.return_queue = Queue_Temp_Sensor_Responses;
-
-        xQueueSend(Queue_Temp_Sensor_Requests, &temp_packet, portMAX_DELAY);
-
-        /* Wait for the response from the temp sensor task */
-        if(xQueueReceive(Queue_Temp_Sensor_Responses, &temp_packet, portMAX_DELAY) == pdTRUE)
+        /* Read the temp sensor, answered from its newest sample */
+        if(system_sensors_get_temp(Queue_Temp_Sensor_Responses, &temperature))
         {
-            if(temp_packet.operation == TEMP_SENSOR_RESPONSE)
-            {
-                task_console_printf("Temperature: %.2f C\r\n", temp_packet.value);
-            }
+            task_console_printf("Temperature: %.2f C\r\n", temperature);
         }
     }
 }
@@ -100,7 +92,7 @@ void app_init_hw(void)
 void app_main(void)
 {
     /* Create a Queue for the temp sensor task */
-    Queue_Temp_Sensor_Responses = xQueueCreate(1, sizeof(temp_sensor_packet_t));
+    Queue_Temp_Sensor_Responses = xQueueCreate(1, sizeof(device_response_msg_t));
     
     /* Create the I2C Semaphore */
     I2C_Semaphore = xSemaphoreCreateBinary();
@@ -122,6 +114,13 @@ void app_main(void)
         CY_ASSERT(0);
     }
 
+    if(!task_i2c_resources_init(I2C_Obj, &I2C_Semaphore))
+    {
+        printf("I2C Task initialization failed!\n\r");
+        for(int i = 0; i < 10000; i++);
+        CY_ASSERT(0);
+    }
+
     if(!task_temp_sensor_resources_init(I2C_Obj, &I2C_Semaphore))
     {
         printf("Temp Sensor Task initialization failed!\n\r");
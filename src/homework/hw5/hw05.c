@@ -14,17 +14,27 @@
 #if defined(HW05)
 #include "drivers.h"
 #include "devices.h"
+#include "device_manager.h"
 #include "task_console.h"
+#include "task_i2c.h"
+#include "spi_bus.h"
 #include "task_io_expander.h"
 #include "task_light_sensor.h"
 #include "task_temp_sensor.h"
 #include "task_eeprom.h"
+#include "kv_store.h"
+#include "game_state.h"
 #include "task_imu.h"
+#include "imu_tilt.h"
+#include "task_sensor_hub.h"
 #include "task_lcd.h"
 #include "task_buttons.h"
+#include "led_anim.h"
 #include "task_joystick.h"
 #include "task_buzzer.h"
 #include "battleship.h"
+#include "battleship_engine.h"
+#include "battleship_ai.h"
 #include "task_ipc.h"
 #include "rtos_events.h"
 
@@ -33,7 +43,7 @@ char APP_DESCRIPTION[] = "ECE353: HW05 - FreeRTOS CLI";
 /*****************************************************************************/
 /* Macros                                                                    */
 /*****************************************************************************/
-#define EEPROM_SHIPS_ADDR 0x0000 /* EEPROM address to store opponent ships count */
+#define IMU_SAMPLES_PER_PASS 8  /* IMU samples copied out of the stream at a time */
 
 /*****************************************************************************/
 /* Function Prototypes                                                       */
@@ -50,51 +60,25 @@ SemaphoreHandle_t Semaphore_I2C = NULL;
 SemaphoreHandle_t Semaphore_SPI = NULL;
 
 QueueHandle_t Queue_System_Control_Responses = NULL;
-QueueHandle_t Queue_Sensor_Responses;
 QueueHandle_t xQueue_LCD_response = NULL;
 /* xQueue_LCD is defined in task_lcd.c */
 extern QueueHandle_t xQueue_LCD;
-extern QueueHandle_t Queue_position;
 
-/* Game state variables */
+/* Game start handshake */
 uint8_t player_id = 255;       /* 0=Player1, 1=Player2, 255=unassigned */
 bool opponent_ready = false;   /* Flag set when opponent sends NEW_GAME */
 bool ack_received = false;     /* Flag set when opponent sends ACK */
 uint8_t next_first_player = 0; /* 0 = I go first next game, 1 = opponent goes first */
-bool game_over = false;        /* Flag set when game ends (someone won) */
-bool i_won = false;            /* Flag set if I won the game */
-uint8_t current_turn = 0;      /* 0 = Player 0's turn, 1 = Player 1's turn (alternates during gameplay) */
 EventGroupHandle_t ECE353_RTOS_Events = NULL;
 
+/* The game itself - boards, turn, counters and result.  The rules live in
+ * battleship_engine.c, the functions below only connect it to the LCD,
+ * buttons and IPC link. */
+static battleship_game_t Game;
+
 /* Board border color - determined by player ID (Blue for Player 1, Red for Player 2) */
 uint16_t board_border_color = LCD_COLOR_BLUE; /* Will be set in initialize_game_players() */
-/* Hit and Miss counters for game play */
-uint16_t my_hits = 0;                 /* Number of times I hit opponent's ships */
-uint16_t my_misses = 0;               /* Number of times I missed */
-uint16_t opponent_hits = 0;           /* Number of times opponent hit my ships */
-uint16_t opponent_misses = 0;         /* Number of times opponent missed */
-uint8_t opponent_ships_remaining = 5; /* Number of opponent's ships still alive (tracked in EEPROM) */
-
-/* Ship placement board - tracks where your ships are located */
-/* 0 = empty, 1-5 = ship ID placed here */
-/* This is used by task_ipc_rx.c to check opponent's fire commands */
-uint8_t occupied_board[10][10] = {0};
-
-/* Track which tiles have been hit (turned red) - 0 = not hit, 1 = hit */
-uint8_t hit_tiles[10][10] = {0};
-
-/* Track opponent's board - tiles you've fired at and the results */
-/* 0 = unknown/never fired, 1 = hit, 2 = miss */
-uint8_t opponent_board[10][10] = {0};
-
-/* Track last fire coordinates so RESULT handler knows which tile to update */
-uint8_t last_fire_row = 0;
-uint8_t last_fire_col = 0;
-
-/* Track hits on each ship - ship_hit_count[ship_id-1] = number of hits */
-uint8_t ship_hit_count[5] = {0};           /* 5 ships, 0 hits initially */
-uint8_t ship_lengths[5] = {2, 3, 3, 4, 5}; /* Destroyer, Submarine, Cruiser, Battleship, Carrier (matches placement order) */
-bool light_mode;                           // checking if light mode or dark mode
+bool light_mode; // checking if light mode or dark mode
 #define LIGHT_THRESHOLD 200
 
 /* Board tile color - determined at game start and stays consistent */
@@ -112,6 +96,7 @@ void initialize_game_players(void);
 void draw_battleship_board(void);
 void task_ship_placement(void);
 bool battleship_check_light_threshold(void);
+bool battleship_light_init(void);
 
 /*****************************************************************************/
 /* Function Definitions                                                      */
@@ -168,31 +153,24 @@ void draw_initial_board(void)
  */
 void handle_incoming_fire(uint8_t fire_row, uint8_t fire_col)
 {
-    /* Check if this position has a ship */
-    uint8_t ship_id = occupied_board[fire_row][fire_col];
+    /* The engine records the shot and tells hit, sunk and repeat apart */
+    uint8_t ship_id = 0;
+    bitboard_shot_t shot;
+    battleship_status_t fire_status = battleship_game_receive_fire(&Game, fire_col, fire_row, &shot, &ship_id);
 
-    if (ship_id > 0) /* Hit! (ship_id is 1-5) */
+    if (fire_status != BATTLESHIP_OK)
     {
-        /* Check if this tile was already hit */
-        if (hit_tiles[fire_row][fire_col] == 1)
-        {
-            printf("ERROR: Redundant fire at (%d,%d) - already hit!\r\n", fire_row, fire_col);
-            ipc_send_error(IPC_ERROR_COORD_OCCUPIED); /* Send error, don't count as hit */
-            return;                                   /* Exit early */
-        }
+        printf("ERROR: Fire at (%d,%d) refused (status %d)\r\n", fire_row, fire_col, fire_status);
+        ipc_send_error((fire_status == BATTLESHIP_ERR_REPEAT) ? IPC_ERROR_COORD_OCCUPIED : (fire_status == BATTLESHIP_ERR_INVALID) ? IPC_ERROR_COORD_INVALID
+                                                                                                                                   : IPC_ERROR_SYSTEM_FAILURE);
+        return; /* Exit early, don't count as hit */
+    }
 
+    if (ship_id > 0) /* Hit! (ship_id is 1-5) */
+    {
         printf("HIT on ship %d at (%d,%d)!\r\n", ship_id, fire_row, fire_col);
 
-        /* Mark this tile as hit BEFORE incrementing count */
-        hit_tiles[fire_row][fire_col] = 1;
-
-        /* Increment opponent's hit counter */
-        extern uint16_t opponent_hits;
-        opponent_hits++;
-        printf("Opponent hits: %d\r\n", opponent_hits);
-
-        /* Increment hit count for this ship */
-        ship_hit_count[ship_id - 1]++;
+        printf("Opponent hits: %d\r\n", Game.opponent_hits);
 
         /* Draw red tile on MY board to show hit */
         lcd_msg_t lcd_msg;
@@ -207,33 +185,20 @@ void handle_incoming_fire(uint8_t fire_row, uint8_t fire_col)
         xQueueReceive(xQueue_LCD_response, &status, pdMS_TO_TICKS(100));
 
         /* Check if ship is sunk */
-        if (ship_hit_count[ship_id - 1] == ship_lengths[ship_id - 1])
+        if (shot == BITBOARD_SHOT_SUNK)
         {
             printf("  ⚓⚓⚓ SHIP %d IS SUNK! (hits: %d == length: %d) ⚓⚓⚓\r\n",
-                   ship_id, ship_hit_count[ship_id - 1], ship_lengths[ship_id - 1]);
+                   ship_id, Game.ship_hit_count[ship_id - 1], battleship_game_ship_length(ship_id));
             printf("  Sending IPC_RESULT_SUNK...\r\n");
             ipc_send_result(IPC_RESULT_SUNK);
 
-            /* Check if this was my last ship - count how many ships are fully sunk */
-            uint8_t ships_sunk = 0;
-            for (uint8_t i = 0; i < 5; i++)
-            {
-                if (ship_hit_count[i] >= ship_lengths[i])
-                {
-                    ships_sunk++;
-                }
-            }
-
-            if (ships_sunk == 5) /* All my ships are destroyed */
+            /* Check if this was my last ship */
+            if (Game.phase == BATTLESHIP_PHASE_OVER) /* All my ships are destroyed */
             {
-                extern bool game_over;
-                extern bool i_won;
                 printf("  ╔═══════════════════════════════════════════╗\r\n");
                 printf("  ║ ALL MY SHIPS DESTROYED - I LOST!          ║\r\n");
                 printf("  ╚═══════════════════════════════════════════╝\r\n");
                 printf("  Sending IPC_GAME_CONTROL_END_GAME...\r\n");
-                game_over = true;
-                i_won = false;
                 ipc_send_game_control(IPC_GAME_CONTROL_END_GAME);
                 printf("  END_GAME signal sent!\r\n");
             }
@@ -244,25 +209,11 @@ void handle_incoming_fire(uint8_t fire_row, uint8_t fire_col)
             ipc_send_result(IPC_RESULT_HIT);
         }
     }
-    else /* Miss or already-hit empty tile */
+    else /* Miss */
     {
-        /* Check if this empty tile was already fired upon */
-        if (hit_tiles[fire_row][fire_col] == 1)
-        {
-            printf("ERROR: Redundant fire at empty tile (%d,%d) - already fired!\r\n", fire_row, fire_col);
-            ipc_send_error(IPC_ERROR_COORD_OCCUPIED);
-            return;
-        }
-
         printf("MISS at (%d,%d)\r\n", fire_row, fire_col);
 
-        /* Mark this tile as fired upon */
-        hit_tiles[fire_row][fire_col] = 1;
-
-        /* Increment opponent's miss counter */
-        extern uint16_t opponent_misses;
-        opponent_misses++;
-        printf("Opponent misses: %d\r\n", opponent_misses);
+        printf("Opponent misses: %d\r\n", Game.opponent_misses);
 
         /* Don't draw anything for misses - keep the board as is */
 
@@ -270,6 +221,86 @@ void handle_incoming_fire(uint8_t fire_row, uint8_t fire_col)
     }
 }
 
+/**
+ * @brief Handle the opponent's RESULT for my last shot
+ * @param result
+ *
+ * Updates the opponent board and counters, and the ship LEDs on a sink
+ */
+void handle_fire_result(ipc_result_t result)
+{
+    bitboard_shot_t shot = (result == IPC_RESULT_SUNK) ? BITBOARD_SHOT_SUNK : (result == IPC_RESULT_HIT) ? BITBOARD_SHOT_HIT
+                                                                                                         : BITBOARD_SHOT_MISS;
+    uint8_t ships_before = Game.opponent_ships_remaining;
+
+    if (battleship_game_apply_result(&Game, shot) != BATTLESHIP_OK)
+    {
+        printf("Result with no shot waiting for it - ignored\r\n");
+        return;
+    }
+
+    if (shot == BITBOARD_SHOT_MISS)
+    {
+        printf("My misses: %d\r\n", Game.my_misses);
+        return;
+    }
+
+    printf("My hits: %d\r\n", Game.my_hits);
+    buzzer_play_effect((shot == BITBOARD_SHOT_SUNK) ? BUZZER_EFFECT_SUNK : BUZZER_EFFECT_HIT);
+
+    /* If opponent's ship was sunk, update LED counter */
+    if (shot == BITBOARD_SHOT_SUNK)
+    {
+        printf("╔═══════════════════════════════════════════════════════════╗\r\n");
+        printf("║ RECEIVED: IPC_RESULT_SUNK - OPPONENT SHIP SUNK!           ║\r\n");
+        printf("╚═══════════════════════════════════════════════════════════╝\r\n");
+        printf("  Ships remaining BEFORE: %d\r\n", ships_before);
+        printf("  Ships remaining AFTER:  %d\r\n", Game.opponent_ships_remaining);
+        update_opponent_ships_leds(Game.opponent_ships_remaining);
+        printf("  LEDs/EEPROM updated!\r\n");
+    }
+}
+
+/**
+ * @brief Handle a GAME_CONTROL command from the opponent
+ * @param control
+ */
+void handle_game_control(ipc_game_control_t control)
+{
+    switch (control)
+    {
+    case IPC_GAME_CONTROL_NEW_GAME:
+        /* Player 2 receives this */
+        opponent_ready = true; /* Signal that opponent pressed SW1 */
+        player_id = 1;         /* I am Player 2 */
+        printf("Received NEW_GAME - I am Player 2\r\n");
+        /* Send ACK back to Player 1 */
+        ipc_send_game_control(IPC_GAME_CONTROL_ACK);
+        break;
+    case IPC_GAME_CONTROL_ACK:
+        /* Player 1 receives this */
+        ack_received = true;
+        printf("Received ACK from Player 2\r\n");
+        break;
+    case IPC_GAME_CONTROL_PLAYER_READY:
+        opponent_ready = true;
+        printf("Received PLAYER_READY from opponent - opponent has placed all ships!\r\n");
+        break;
+    case IPC_GAME_CONTROL_PASS_TURN:
+        /* Opponent passed their turn to me */
+        battleship_game_pass_turn(&Game, 1 - Game.player_id);
+        printf("Received PASS_TURN - now it's MY turn! (current_turn=%d)\r\n", Game.current_turn);
+        break;
+    case IPC_GAME_CONTROL_END_GAME:
+        /* Opponent lost, so I won */
+        printf("Received END_GAME from opponent - I WON!\r\n");
+        battleship_game_end(&Game, true);
+        break;
+    default:
+        break;
+    }
+}
+
 /**
  * @brief
  * Initialize game players - wait for SW1 press, determine player roles, handle ACK
@@ -420,7 +451,7 @@ void draw_battleship_board(void)
  * 1 ship:  LED 0 on    (0b00000001 = 0x01)
  * 0 ships: All off     (0b00000000 = 0x00)
  *
- * Also stores the count in EEPROM at address EEPROM_SHIPS_ADDR
+ * Also saves the game state to the EEPROM key/value store
  */
 void update_opponent_ships_leds(uint8_t ships_remaining)
 {
@@ -440,11 +471,23 @@ void update_opponent_ships_leds(uint8_t ships_remaining)
     else
         led_pattern = 0x00; /* All LEDs off */
 
-    /* Write to IO Expander LEDs */
-    system_sensors_io_expander_write(NULL, IOXP_ADDR_OUTPUT_PORT, led_pattern);
+    /* The LED of the ship just sunk blinks out, the animation turns it off */
+    uint8_t sunk_led = 0x00;
+    if (ships_remaining < 5 && led_anim_play(LED_ANIM_CH_IOXP0 + ships_remaining, &led_anim_blink_out, false))
+    {
+        sunk_led = 1 << ships_remaining;
+    }
 
-    /* Write count to EEPROM */
-    system_sensors_eeprom_write(NULL, EEPROM_SHIPS_ADDR, ships_remaining);
+    /* Only the five ship LEDs change.  Both calls go out as one I2C write,
+     * and none at all if the LEDs already show the pattern. */
+    system_sensors_io_expander_clear_bits(~led_pattern & ~sunk_led & 0x1F);
+    system_sensors_io_expander_set_bits(led_pattern);
+
+    /* Save the boards and counters, only the parts that changed are written */
+    if (!game_state_save(&Game))
+    {
+        printf("Game state save failed\r\n");
+    }
 
     printf("Updated LEDs and EEPROM: %d opponent ships remaining (pattern: 0x%02X)\r\n",
            ships_remaining, led_pattern);
@@ -454,7 +497,7 @@ void light_mode_sensor(void)
 {
     uint16_t ambient_light = 0;
 
-    system_sensors_get_light(Queue_Sensor_Responses, &ambient_light);
+    system_sensors_get_light(device_mailbox(), &ambient_light);
     printf("Ambient light reading: %d (threshold: %d)\r\n", ambient_light, LIGHT_THRESHOLD);
 
     if ((LIGHT_THRESHOLD) < ambient_light)
@@ -492,9 +535,8 @@ void task_gameplay(void)
     /* Target coordinates for attack */
     uint8_t target_row = 0, target_col = 0;
     uint8_t prev_target_row = 0, prev_target_col = 0;
-    uint32_t last_joystick_move = 0;
-    const uint32_t JOYSTICK_DEBOUNCE = 300;
     bool cursor_needs_redraw = true; /* Flag to redraw cursor on movement */
+    uint8_t shown_turn = 0xFF;       /* Turn shown on the RGB LED */
 
     /* Draw YOUR board with your ships */
     lcd_msg.command = LCD_CMD_DRAW_BOARD;
@@ -507,7 +549,7 @@ void task_gameplay(void)
     {
         for (uint8_t col = 0; col < 10; col++)
         {
-            if (occupied_board[row][col] > 0) /* Ship present */
+            if (battleship_game_ship_at(&Game, col, row) > 0) /* Ship present */
             {
                 lcd_msg.command = LCD_CMD_DRAW_TILE;
                 lcd_msg.response_queue = xQueue_LCD_response;
@@ -518,7 +560,7 @@ void task_gameplay(void)
                 xQueueSend(xQueue_LCD, &lcd_msg, 0);
                 xQueueReceive(xQueue_LCD_response, &status, pdMS_TO_TICKS(50));
             }
-            else if (hit_tiles[row][col] == 1) /* Hit on your board */
+            else if (battleship_game_shot_at(&Game, col, row)) /* Hit on your board */
             {
                 lcd_msg.command = LCD_CMD_DRAW_TILE;
                 lcd_msg.response_queue = xQueue_LCD_response;
@@ -539,11 +581,11 @@ void task_gameplay(void)
     lcd_msg.payload.battleship.col = target_col;
 
     /* Determine fill color at cursor start position */
-    if (hit_tiles[target_row][target_col] == 1)
+    if (battleship_game_shot_at(&Game, target_col, target_row))
     {
         lcd_msg.payload.battleship.fill_color = LCD_COLOR_RED;
     }
-    else if (occupied_board[target_row][target_col] > 0)
+    else if (battleship_game_ship_at(&Game, target_col, target_row) > 0)
     {
         lcd_msg.payload.battleship.fill_color = LCD_COLOR_YELLOW;
     }
@@ -555,7 +597,7 @@ void task_gameplay(void)
     xQueueSend(xQueue_LCD, &lcd_msg, 0);
     xQueueReceive(xQueue_LCD_response, &status, pdMS_TO_TICKS(100));
 
-    while (!game_over && game_elapsed < game_timeout)
+    while (Game.phase != BATTLESHIP_PHASE_OVER && game_elapsed < game_timeout)
     {
 
         if (battleship_check_light_threshold())
@@ -565,7 +607,7 @@ void task_gameplay(void)
             {
                 for (uint8_t col = 0; col < 10; col++)
                 {
-                    if (occupied_board[row][col] == 0) /* Only redraw empty tiles */
+                    if (battleship_game_ship_at(&Game, col, row) == 0) /* Only redraw empty tiles */
                     {
                         lcd_msg.command = LCD_CMD_DRAW_TILE;
                         lcd_msg.response_queue = xQueue_LCD_response;
@@ -588,7 +630,7 @@ void task_gameplay(void)
         console_payload = &lcd_msg.payload.console;
         console_payload->x_offset = 210;
         console_payload->y_offset = 50;
-        sprintf(hits_buffer, "Hits: %d", my_hits);
+        sprintf(hits_buffer, "Hits: %d", Game.my_hits);
         console_payload->message = hits_buffer;
         console_payload->length = strlen(console_payload->message);
         xQueueSend(xQueue_LCD, &lcd_msg, 0);
@@ -600,7 +642,7 @@ void task_gameplay(void)
         console_payload = &lcd_msg.payload.console;
         console_payload->x_offset = 210;
         console_payload->y_offset = 100;
-        sprintf(misses_buffer, "Miss: %d", my_misses);
+        sprintf(misses_buffer, "Miss: %d", Game.my_misses);
         console_payload->message = misses_buffer;
         console_payload->length = strlen(console_payload->message);
         xQueueSend(xQueue_LCD, &lcd_msg, 0);
@@ -612,7 +654,7 @@ void task_gameplay(void)
         console_payload = &lcd_msg.payload.console;
         console_payload->x_offset = 210;
         console_payload->y_offset = 150;
-        if (current_turn == player_id)
+        if (battleship_game_is_my_turn(&Game))
         {
             console_payload->message = "YOURS";
         }
@@ -624,51 +666,53 @@ void task_gameplay(void)
         xQueueSend(xQueue_LCD, &lcd_msg, 0);
         xQueueReceive(xQueue_LCD_response, &status, pdMS_TO_TICKS(100));
 
+        /* Green LED pulses while it is my turn */
+        if (Game.current_turn != shown_turn)
+        {
+            shown_turn = Game.current_turn;
+            led_anim_play(LED_ANIM_CH_GREEN, battleship_game_is_my_turn(&Game) ? &led_anim_pulse : &led_anim_fade_out, battleship_game_is_my_turn(&Game));
+        }
+
         /* If it's my turn, use joystick to aim and SW1 to fire */
-        if (current_turn == player_id)
+        if (battleship_game_is_my_turn(&Game))
         {
-            /* Check joystick for target movement */
-            joystick_position_t joystick_pos;
-            uint32_t current_time = xTaskGetTickCount();
+            /* Apply every joystick step since the last pass.  A press wraps
+             * around the board, a held stick stops at the edge. */
+            joystick_event_t joystick_event;
+            TickType_t joystick_wait = pdMS_TO_TICKS(10);
 
-            if (xQueueReceive(Queue_position, &joystick_pos, pdMS_TO_TICKS(10)) == pdTRUE)
+            while (xQueueReceive(Queue_Joystick, &joystick_event, joystick_wait) == pdTRUE)
             {
-                if ((current_time - last_joystick_move) >= pdMS_TO_TICKS(JOYSTICK_DEBOUNCE))
+                joystick_wait = 0;
+                if (joystick_event.type == JOYSTICK_EVENT_RELEASE)
+                {
+                    continue;
+                }
+
+                if (!cursor_needs_redraw)
                 {
                     /* Save previous position for clearing */
                     prev_target_row = target_row;
                     prev_target_col = target_col;
+                }
 
-                    switch (joystick_pos)
+                if (joystick_event.type == JOYSTICK_EVENT_PRESS)
+                {
+                    target_col = (target_col + 10 + joystick_event.dx) % 10;
+                    target_row = (target_row + 10 + joystick_event.dy) % 10;
+                }
+                else
+                {
+                    if ((joystick_event.dx < 0 && target_col > 0) || (joystick_event.dx > 0 && target_col < 9))
+                    {
+                        target_col += joystick_event.dx;
+                    }
+                    if ((joystick_event.dy < 0 && target_row > 0) || (joystick_event.dy > 0 && target_row < 9))
                     {
-                    case JOYSTICK_POS_LEFT:
-                    case JOYSTICK_POS_UPPER_LEFT:
-                    case JOYSTICK_POS_LOWER_LEFT:
-                        target_col = (target_col > 0) ? target_col - 1 : 9;
-                        cursor_needs_redraw = true;
-                        last_joystick_move = current_time;
-                        break;
-                    case JOYSTICK_POS_RIGHT:
-                    case JOYSTICK_POS_UPPER_RIGHT:
-                    case JOYSTICK_POS_LOWER_RIGHT:
-                        target_col = (target_col < 9) ? target_col + 1 : 0;
-                        cursor_needs_redraw = true;
-                        last_joystick_move = current_time;
-                        break;
-                    case JOYSTICK_POS_UP:
-                        target_row = (target_row > 0) ? target_row - 1 : 9;
-                        cursor_needs_redraw = true;
-                        last_joystick_move = current_time;
-                        break;
-                    case JOYSTICK_POS_DOWN:
-                        target_row = (target_row < 9) ? target_row + 1 : 0;
-                        cursor_needs_redraw = true;
-                        last_joystick_move = current_time;
-                        break;
-                    default:
-                        break;
+                        target_row += joystick_event.dy;
                     }
                 }
+                cursor_needs_redraw = true;
             }
 
             /* Redraw cursor if it moved */
@@ -681,13 +725,13 @@ void task_gameplay(void)
                 lcd_msg.payload.battleship.col = prev_target_col;
 
                 /* Restore original colors based on board state */
-                if (hit_tiles[prev_target_row][prev_target_col] == 1 && occupied_board[prev_target_row][prev_target_col] > 0)
+                if (battleship_game_shot_at(&Game, prev_target_col, prev_target_row) && battleship_game_ship_at(&Game, prev_target_col, prev_target_row) > 0)
                 {
                     /* Hit on your SHIP - keep red fill AND red border */
                     lcd_msg.payload.battleship.fill_color = LCD_COLOR_RED;
                     lcd_msg.payload.battleship.border_color = LCD_COLOR_RED;
                 }
-                else if (occupied_board[prev_target_row][prev_target_col] > 0)
+                else if (battleship_game_ship_at(&Game, prev_target_col, prev_target_row) > 0)
                 {
                     /* Your own ship (not hit yet) - keep yellow */
                     lcd_msg.payload.battleship.fill_color = LCD_COLOR_YELLOW;
@@ -710,12 +754,12 @@ void task_gameplay(void)
                 lcd_msg.payload.battleship.col = target_col;
 
                 /* Keep the fill color as-is, only change border to yellow */
-                if (hit_tiles[target_row][target_col] == 1 && occupied_board[target_row][target_col] > 0)
+                if (battleship_game_shot_at(&Game, target_col, target_row) && battleship_game_ship_at(&Game, target_col, target_row) > 0)
                 {
                     /* Hit on your SHIP - keep red fill */
                     lcd_msg.payload.battleship.fill_color = LCD_COLOR_RED;
                 }
-                else if (occupied_board[target_row][target_col] > 0)
+                else if (battleship_game_ship_at(&Game, target_col, target_row) > 0)
                 {
                     /* Your own ship (not hit yet) - keep yellow fill */
                     lcd_msg.payload.battleship.fill_color = LCD_COLOR_YELLOW;
@@ -744,93 +788,76 @@ void task_gameplay(void)
             if (button_event & ECE353_RTOS_EVENTS_SW1)
             {
                 static uint32_t fire_count = 0;
-                fire_count++;
 
-                /* Save fire coordinates for RESULT handler */
-                last_fire_row = target_row;
-                last_fire_col = target_col;
-
-                /* Send fire command with target coordinates */
-                printf(">>> FIRE #%lu at row=%d, col=%d <<<\r\n", fire_count, target_row, target_col);
-
-                if (!ipc_send_fire(target_row, target_col))
-                {
-                    printf("ERROR: Failed to send fire command!\r\n");
-                }
-                else
-                {
-                    printf("Fire command #%lu sent successfully!\r\n", fire_count);
-                }
-
-                /* Pass turn to opponent */
-                if (!ipc_send_game_control(IPC_GAME_CONTROL_PASS_TURN))
+                /* The engine refuses a cell that was already fired on */
+                battleship_status_t fire_status = battleship_game_fire(&Game, target_col, target_row);
+                if (fire_status != BATTLESHIP_OK)
                 {
-                    printf("ERROR: Failed to send PASS_TURN!\r\n");
+                    printf("Can't fire at row=%d, col=%d (status %d)\r\n", target_row, target_col, fire_status);
                 }
                 else
                 {
-                    printf("PASS_TURN sent successfully!\r\n");
-                }
-                current_turn = 1 - current_turn;
-                printf("Current turn updated to: %d\r\n", current_turn);
+                    fire_count++;
 
-                vTaskDelay(pdMS_TO_TICKS(500));
-            }
-        }
+                    /* Send fire command with target coordinates */
+                    printf(">>> FIRE #%lu at row=%d, col=%d <<<\r\n", fire_count, target_row, target_col);
 
-        vTaskDelay(pdMS_TO_TICKS(100));
-        game_elapsed += 100;
-
-        /* Check win condition - if opponent has no ships left, I won */
-        if (opponent_ships_remaining == 0)
-        {
-            printf("All opponent ships sunk! I WON!\r\n");
-            game_over = true;
-            i_won = true;
-        }
+                    if (!ipc_send_fire(target_row, target_col))
+                    {
+                        printf("ERROR: Failed to send fire command!\r\n");
+                    }
+                    else
+                    {
+                        printf("Fire command #%lu sent successfully!\r\n", fire_count);
+                    }
 
-        /* Check lose condition - if I have no ships left, I lost */
-        extern uint8_t player_id;
-        uint8_t my_ships_remaining = 0;
-        for (uint8_t row = 0; row < 10; row++)
-        {
-            for (uint8_t col = 0; col < 10; col++)
-            {
-                if (occupied_board[row][col] > 0) /* Found a ship tile */
-                {
-                    if (hit_tiles[row][col] == 0) /* Not hit yet */
+                    /* Pass turn to opponent */
+                    battleship_game_pass_turn(&Game, Game.player_id);
+                    if (!ipc_send_game_control(IPC_GAME_CONTROL_PASS_TURN))
                     {
-                        my_ships_remaining++;
+                        printf("ERROR: Failed to send PASS_TURN!\r\n");
                     }
+                    else
+                    {
+                        printf("PASS_TURN sent successfully!\r\n");
+                    }
+                    printf("Current turn updated to: %d\r\n", Game.current_turn);
+
+                    vTaskDelay(pdMS_TO_TICKS(500));
                 }
             }
         }
-
-        if (my_ships_remaining == 0 && (occupied_board[0][0] > 0 || occupied_board[1][0] > 0)) /* All my ships are sunk */
+        else
         {
-            printf("  Unhit ship tiles remaining: %d\r\n", my_ships_remaining);
-            printf("  Sending IPC_GAME_CONTROL_END_GAME...\r\n");
-            game_over = true;
-            i_won = false;
-            ipc_send_game_control(IPC_GAME_CONTROL_END_GAME);
-            printf("  END_GAME signal sent!\r\n");
+            /* Discard stick movement made during the opponent's turn */
+            xQueueReset(Queue_Joystick);
         }
-        /* game_over will be set by IPC RX task when opponent wins */
+
+        vTaskDelay(pdMS_TO_TICKS(100));
+        game_elapsed += 100;
+
+        /* The engine ends the game when either fleet is sunk - the IPC
+         * handlers apply the last result or shot */
     }
 
     /* Display game end message */
+    led_anim_set(LED_ANIM_CH_GREEN, 0);
+    led_anim_play(Game.i_won ? LED_ANIM_CH_GREEN : LED_ANIM_CH_RED, &led_anim_heartbeat, true);
+
     lcd_msg.command = LCD_CMD_CLEAR_SCREEN;
     lcd_msg.response_queue = xQueue_LCD_response;
     xQueueSend(xQueue_LCD, &lcd_msg, 0);
     xQueueReceive(xQueue_LCD_response, &status, pdMS_TO_TICKS(100));
 
-    if (i_won)
+    if (Game.i_won)
     {
         printf("YOU WIN!\r\n");
+        buzzer_play_effect(BUZZER_EFFECT_WIN);
     }
     else
     {
         printf("YOU LOSE!\r\n");
+        buzzer_play_effect(BUZZER_EFFECT_LOSE);
         /* END_GAME already sent when ships were destroyed - don't send again */
     }
 
@@ -840,7 +867,7 @@ void task_gameplay(void)
     console_payload = &lcd_msg.payload.console; /* Reassign pointer */
     console_payload->x_offset = 100;
     console_payload->y_offset = 100;
-    if (i_won)
+    if (Game.i_won)
     {
         console_payload->message = "YOU WIN!";
     }
@@ -859,40 +886,18 @@ void task_gameplay(void)
 
     /* Reset game state for next game */
     printf("═══════════════════════════════════════════════\r\n");
-    printf("RESETTING GAME STATE - my_hits=%d, my_misses=%d\r\n", my_hits, my_misses);
+    printf("RESETTING GAME STATE - my_hits=%d, my_misses=%d\r\n", Game.my_hits, Game.my_misses);
     printf("═══════════════════════════════════════════════\r\n");
-    game_over = false;
-    i_won = false;
     opponent_ready = false;
     ack_received = false;
-    my_hits = 0;
-    my_misses = 0;
-    opponent_hits = 0;
-    opponent_misses = 0;
-    opponent_ships_remaining = 5;
-    update_opponent_ships_leds(5); /* Reset IO expander to show 5 opponent ships */
-    current_turn = 0;
-
-    /* Clear all game boards */
-    for (uint8_t i = 0; i < 10; i++)
-    {
-        for (uint8_t j = 0; j < 10; j++)
-        {
-            occupied_board[i][j] = 0;
-            hit_tiles[i][j] = 0;
-            opponent_board[i][j] = 0;
-        }
-    }
-
-    /* Clear ship hit counts */
-    for (uint8_t i = 0; i < 5; i++)
-    {
-        ship_hit_count[i] = 0;
-    }
 
     /* Set who goes first next game based on next_first_player */
     player_id = next_first_player;
 
+    /* Fresh boards and counters for the next game */
+    battleship_game_init(&Game, player_id);
+    update_opponent_ships_leds(Game.opponent_ships_remaining); /* Reset IO expander to show 5 opponent ships */
+
     /* Update border color based on new player ID */
     if (player_id == 0)
     {
@@ -941,21 +946,24 @@ void task_ship_placement(void)
     uint8_t ships_placed = 0;
     uint8_t cursor_col = 0, cursor_row = 0;
     bool ship_orientation = true; /* true = horizontal */
-    uint16_t imu_data[3];
-    int16_t accel_x, accel_y;
-    uint32_t last_move_time = 0;
-    QueueHandle_t imu_response_queue;
+    imu_sample_t imu_samples[IMU_SAMPLES_PER_PASS];
+    uint32_t imu_cursor = 0;
+    QueueHandle_t imu_response_queue = device_mailbox(); /* Same pooled mailbox every game */
 
-    const int16_t IMU_THRESHOLD = 2500; /* Threshold for IMU movement */
-    const uint32_t MOVE_INTERVAL = 300; /* 0.3 seconds */
+    /* Tilt filter that turns IMU samples into cursor moves */
+    const imu_tilt_config_t tilt_config = IMU_TILT_CONFIG_DEFAULT;
+    imu_tilt_t tilt;
 
     /* Track cursor tile positions to know what to clear */
     uint8_t cursor_tiles[5][2]; /* Store col,row of cursor tiles */
     uint8_t cursor_tile_count = 0;
 
-    /* Clear battleship board and create IMU queue */
-    battleship_board_clear();
-    imu_response_queue = xQueueCreate(1, sizeof(device_response_msg_t));
+    /* Start a new game with empty boards */
+    battleship_game_init(&Game, player_id);
+
+    /* Stream the accelerometer so each pass reads the newest sample from memory */
+    system_sensors_imu_stream_start(imu_response_queue, ODR_104HZ, 4);
+    imu_tilt_init(&tilt, &tilt_config, imu_odr_to_hz(ODR_104HZ));
 
     /* Draw the board once before ship placement */
     lcd_msg.command = LCD_CMD_DRAW_BOARD;
@@ -976,7 +984,7 @@ void task_ship_placement(void)
             {
                 for (uint8_t col = 0; col < 10; col++)
                 {
-                    if (occupied_board[row][col] == 0) /* Only redraw empty tiles */
+                    if (battleship_game_ship_at(&Game, col, row) == 0) /* Only redraw empty tiles */
                     {
                         lcd_msg.command = LCD_CMD_DRAW_TILE;
                         lcd_msg.response_queue = xQueue_LCD_response;
@@ -993,72 +1001,40 @@ void task_ship_placement(void)
 
         bool ship_moved = false;
 
-        /* Read IMU data - continuous movement based on tilt */
-        if (system_sensors_imu_read(imu_response_queue, imu_data))
+        /* Feed every new IMU sample through the tilt filter */
+        int8_t move_x = 0, move_y = 0;
+        uint16_t sample_count;
+        while ((sample_count = imu_stream_read(&imu_cursor, imu_samples, IMU_SAMPLES_PER_PASS)) > 0)
         {
-            accel_x = (int16_t)imu_data[0];
-            accel_y = (int16_t)imu_data[1];
-
-            /* Check timing for movement - only allow movement after MOVE_INTERVAL */
-            uint32_t current_time = xTaskGetTickCount();
-            if (current_time - last_move_time >= MOVE_INTERVAL)
+            for (uint16_t i = 0; i < sample_count; i++)
             {
-                /* Check X-axis movement - inverted for intuitive control */
-                if (accel_x > IMU_THRESHOLD)
-                {
-                    /* Save previous position before moving */
-                    if (!first_draw)
-                    {
-                        prev_cursor_col = cursor_col;
-                        prev_cursor_row = cursor_row;
-                    }
-                    cursor_col = (cursor_col == 0) ? 9 : cursor_col - 1;
-                    last_move_time = current_time;
-                    // printf("Ship moved LEFT to col %d\r\n", cursor_col);
-                    ship_moved = true;
-                }
-                else if (accel_x < -IMU_THRESHOLD)
-                {
-                    /* Save previous position before moving */
-                    if (!first_draw)
-                    {
-                        prev_cursor_col = cursor_col;
-                        prev_cursor_row = cursor_row;
-                    }
-                    cursor_col = (cursor_col + 1) % 10;
-                    last_move_time = current_time;
-                    printf("Ship moved RIGHT to col %d\r\n", cursor_col);
-                    ship_moved = true;
-                }
-                else if (accel_y > IMU_THRESHOLD)
-                {
-                    /* Save previous position before moving */
-                    if (!first_draw)
-                    {
-                        prev_cursor_col = cursor_col;
-                        prev_cursor_row = cursor_row;
-                    }
-                    cursor_row = (cursor_row + 1) % 10;
-                    last_move_time = current_time;
-                    printf("Ship moved DOWN to row %d\r\n", cursor_row);
-                    ship_moved = true;
-                }
-                else if (accel_y < -IMU_THRESHOLD)
+                int8_t dx, dy;
+                imu_tilt_sample_t sample = {imu_samples[i].x, imu_samples[i].y, imu_samples[i].z,
+                                            imu_samples[i].gx, imu_samples[i].gy, imu_samples[i].gz};
+                if (imu_tilt_update(&tilt, &sample, &dx, &dy))
                 {
-                    /* Save previous position before moving */
-                    if (!first_draw)
-                    {
-                        prev_cursor_col = cursor_col;
-                        prev_cursor_row = cursor_row;
-                    }
-                    cursor_row = (cursor_row == 0) ? 9 : cursor_row - 1;
-                    last_move_time = current_time;
-                    printf("Ship moved UP to row %d\r\n", cursor_row);
-                    ship_moved = true;
+                    move_x += dx;
+                    move_y += dy;
                 }
             }
         }
 
+        if (move_x != 0 || move_y != 0)
+        {
+            /* Save previous position before moving */
+            if (!first_draw)
+            {
+                prev_cursor_col = cursor_col;
+                prev_cursor_row = cursor_row;
+            }
+
+            /* Tilting toward +X moves left, tilting toward +Y moves down */
+            cursor_col = (uint8_t)((cursor_col + 100 - move_x) % 10);
+            cursor_row = (uint8_t)((cursor_row + 100 + move_y) % 10);
+            printf("Ship moved to (%d, %d)\r\n", cursor_col, cursor_row);
+            ship_moved = true;
+        }
+
         /* If ship moved, clear only the previous yellow cursor ship tiles */
         if (ship_moved && !first_draw)
         {
@@ -1070,7 +1046,7 @@ void task_ship_placement(void)
                 uint8_t clear_row = ship_orientation ? prev_cursor_row : (prev_cursor_row + i);
 
                 /* Only clear if this tile doesn't have a placed ship */
-                if (occupied_board[clear_row][clear_col] == 0)
+                if (battleship_game_ship_at(&Game, clear_col, clear_row) == 0)
                 {
                     /* Draw blue board tile to cover the yellow cursor ship */
                     lcd_msg.command = LCD_CMD_DRAW_TILE;
@@ -1133,7 +1109,7 @@ void task_ship_placement(void)
                     uint8_t clear_row = ship_orientation ? cursor_row : (cursor_row + i);
 
                     /* Only clear if this tile doesn't have a placed ship */
-                    if (occupied_board[clear_row][clear_col] == 0)
+                    if (battleship_game_ship_at(&Game, clear_col, clear_row) == 0)
                     {
                         lcd_msg.command = LCD_CMD_DRAW_TILE;
                         lcd_msg.response_queue = xQueue_LCD_response;
@@ -1172,6 +1148,7 @@ void task_ship_placement(void)
             if (current_ship >= 5)
             {
                 printf("ERROR: current_ship out of bounds (%d)\r\n", current_ship);
+                system_sensors_imu_stream_stop(imu_response_queue);
                 return;
             }
 
@@ -1179,25 +1156,10 @@ void task_ship_placement(void)
             printf("Attempting to place ship %d (type=%d, length=%d) at (%d,%d)\r\n",
                    current_ship, ship_types[current_ship], ship_length, cursor_col, cursor_row);
 
-            /* Check if ship will fit within board */
-            bool fits_in_board = true;
-            if (ship_orientation) /* horizontal */
-            {
-                if ((cursor_col + ship_length) > 10)
-                    fits_in_board = false;
-            }
-            else /* vertical */
-            {
-                if ((cursor_row + ship_length) > 10)
-                    fits_in_board = false;
-            }
-
-            /* Try to place the ship - battleship_place_ship handles overlap checking internally */
-            bool placement_success = false;
-            if (fits_in_board)
-            {
-                placement_success = battleship_place_ship(cursor_col, cursor_row, ship_types[current_ship], ship_orientation, player_id);
-            }
+            /* The engine checks the board edges and overlap with placed ships */
+            uint8_t ship_id = current_ship + 1; /* Ship IDs are 1-5 */
+            battleship_status_t place_status = battleship_game_place(&Game, ship_id, cursor_col, cursor_row, ship_orientation);
+            bool placement_success = (place_status == BATTLESHIP_OK);
 
             if (placement_success)
             {
@@ -1220,17 +1182,6 @@ void task_ship_placement(void)
 
                 vTaskDelay(pdMS_TO_TICKS(50));
 
-                /* Mark all tiles this ship occupies with ship ID (1-5) */
-                uint8_t ship_length = battleship_get_ship_length(ship_types[current_ship]);
-                uint8_t ship_id = current_ship + 1; /* Ship IDs are 1-5 */
-                for (uint8_t i = 0; i < ship_length; i++)
-                {
-                    uint8_t mark_col = ship_orientation ? (cursor_col + i) : cursor_col;
-                    uint8_t mark_row = ship_orientation ? cursor_row : (cursor_row + i);
-                    occupied_board[mark_row][mark_col] = ship_id; /* Update both local and global */
-                    printf("Marked occupied_board[%d][%d] = %d\r\n", mark_row, mark_col, ship_id);
-                }
-
                 ships_placed++;
                 current_ship++; /* Move to next ship */
 
@@ -1246,16 +1197,21 @@ void task_ship_placement(void)
             }
             else
             {
-                printf("Placement failed for ship %d at (%d,%d). fits_in_board=%d\r\n",
-                       current_ship, cursor_col, cursor_row, fits_in_board);
+                printf("Placement failed for ship %d at (%d,%d). status=%d\r\n",
+                       current_ship, cursor_col, cursor_row, place_status);
                 ipc_send_error(IPC_ERROR_COORD_OCCUPIED);
             }
         }
 
-        vTaskDelay(pdMS_TO_TICKS(50));
-        vTaskDelay(pdMS_TO_TICKS(50));
+        /* Short pass so cursor repeats are not quantized to the loop period */
+        vTaskDelay(pdMS_TO_TICKS(20));
     }
 
+    system_sensors_imu_stream_stop(imu_response_queue);
+    printf("Tilt: %lu moves, %lu reversals, %lu ms avg first-move latency\r\n",
+           tilt.stats.moves, tilt.stats.reversals,
+           (tilt.stats.starts > 0) ? (tilt.stats.latency_ms / tilt.stats.starts) : 0);
+
     printf("All ships placed! Sending PLAYER_READY...\r\n");
     ipc_send_game_control(IPC_GAME_CONTROL_PLAYER_READY);
 
@@ -1320,9 +1276,21 @@ void task_system_control(void *arg)
     /* Configure the IO Expander*/
     system_sensors_io_expander_write(NULL, IOXP_ADDR_CONFIG, 0x80); // Set P7 as input, all others as outputs
 
+    /* Index the key/value store, then report the game saved before the last reset */
+    game_state_record_t saved_game;
+    if (!kv_store_mount())
+    {
+        task_console_printf("Key/value store mount failed\r\n");
+    }
+    else if (game_state_load(&saved_game))
+    {
+        task_console_printf("Saved game: %d opponent ships left, %d hits, %d misses\r\n",
+                            saved_game.opponent_ships_remaining, saved_game.my_hits, saved_game.my_misses);
+    }
+
     /* Initialize opponent ships count - 5 ships at start */
-    opponent_ships_remaining = 5;
-    update_opponent_ships_leds(opponent_ships_remaining);
+    battleship_game_init(&Game, 0);
+    update_opponent_ships_leds(Game.opponent_ships_remaining);
 
     /* Wait for LCD queue to be initialized */
     while (xQueue_LCD_response == NULL || xQueue_LCD == NULL)
@@ -1390,8 +1358,8 @@ void app_init_hw(void)
         CY_ASSERT(0);
     }
 
-    // LEDS
-    rslt = leds_init();
+    // LEDS, the RGB LED is driven by PWM for animations
+    rslt = led_anim_init();
     if (rslt != CY_RSLT_SUCCESS)
     {
         printf("LEDs initialization failed!\n\r");
@@ -1403,6 +1371,20 @@ void app_init_hw(void)
     // buttons
     rslt = buttons_init_gpio();
     if (rslt != CY_RSLT_SUCCESS)
+    {
+        printf("Buttons initialization failed!\n\r");
+        for (int i = 0; i < 10000; i++)
+            ;
+        CY_ASSERT(0);
+    }
+
+    // buzzer, sound effects are played by the sequencer's timer interrupt
+    rslt = buzzer_init(50, 2000);
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = buzzer_sequencer_init();
+    }
+    if (rslt != CY_RSLT_SUCCESS)
     {
         printf("Buzzer initialization failed!\n\r");
         for (int i = 0; i < 10000; i++)
@@ -1477,6 +1459,17 @@ void app_main(void)
         CY_ASSERT(0);
     }
 
+    if (!device_manager_init())
+    {
+        printf("Device Manager initialization failed!\n\r");
+        for (int i = 0; i < 10000; i++)
+            ;
+        CY_ASSERT(0);
+    }
+
+    /* Ship masks used by the bitboards */
+    bitboard_init();
+
     if (!task_console_init())
     {
         printf("Console initialization failed!\n\r");
@@ -1509,6 +1502,14 @@ void app_main(void)
         CY_ASSERT(0);
     }
 
+    if (!task_i2c_resources_init(I2C_Obj, &Semaphore_I2C))
+    {
+        printf("I2C Task initialization failed!\n\r");
+        for (int i = 0; i < 10000; i++)
+            ;
+        CY_ASSERT(0);
+    }
+
     if (!task_io_expander_resources_init(I2C_Obj, &Semaphore_I2C))
     {
         printf("IO Expander Task initialization failed!\n\r");
@@ -1525,7 +1526,15 @@ void app_main(void)
         CY_ASSERT(0);
     }
 
-    if (!task_eeprom_resources_init(SPI_Obj, &Semaphore_SPI, PIN_EEPROM_CS))
+    if (!spi_bus_init(SPI_Obj, &Semaphore_SPI))
+    {
+        printf("SPI Bus initialization failed!\n\r");
+        for (int i = 0; i < 10000; i++)
+            ;
+        CY_ASSERT(0);
+    }
+
+    if (!task_eeprom_resources_init(SPI_Obj, &Semaphore_SPI, PIN_EEPROM_CS) || !kv_store_init() || !game_state_init())
     {
         printf("EEPROM Task initialization failed!\n\r");
         for (int i = 0; i < 10000; i++)
@@ -1541,6 +1550,32 @@ void app_main(void)
         CY_ASSERT(0);
     }
 
+    if (!task_temp_sensor_resources_init(I2C_Obj, &Semaphore_I2C))
+    {
+        printf("Temp Sensor Task initialization failed!\n\r");
+        for (int i = 0; i < 10000; i++)
+            ;
+        CY_ASSERT(0);
+    }
+
+    /* Light, temperature and IMU are cached by the sensor hub.  The LM75
+     * task publishes a new temperature every second. */
+    sensor_hub_config_t sensor_hub_config = {
+        .period_ms = {
+            [SENSOR_HUB_LIGHT] = 250,
+            [SENSOR_HUB_TEMP] = 1000,
+            [SENSOR_HUB_IMU] = 50,
+        },
+    };
+
+    if (!task_sensor_hub_resources_init(&sensor_hub_config) || !battleship_light_init())
+    {
+        printf("Sensor Hub initialization failed!\n\r");
+        for (int i = 0; i < 10000; i++)
+            ;
+        CY_ASSERT(0);
+    }
+
     if (!task_ipc_init())
     {
         printf("IPC Task initialization failed!\n\r");
@@ -1549,6 +1584,15 @@ void app_main(void)
         CY_ASSERT(0);
     }
 
+    /* Local opponent for single board play, enabled from the console */
+    if (!battleship_ai_init())
+    {
+        printf("Battleship AI initialization failed!\n\r");
+        for (int i = 0; i < 10000; i++)
+            ;
+        CY_ASSERT(0);
+    }
+
     /* Start the scheduler*/
     vTaskStartScheduler();
 
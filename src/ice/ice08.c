@@ -148,16 +148,6 @@ void app_main(void)
         CY_ASSERT(0); // If the task initialization fails, assert
     }
 
-    /* Start the buttons task*/
-    xTaskCreate(
-        task_buttons, 
-        "Task Buttons", 
-        configMINIMAL_STACK_SIZE, 
-        NULL, 
-        tskIDLE_PRIORITY + 1, 
-        NULL
-    );
-
     xTaskCreate(
         task_system_control, 
         "Task System Control", 
@@ -63,6 +63,14 @@ leds_init();
         for(int i = 0; i < 100000; i++) {}
         CY_ASSERT(0);
     }
+
+    rslt = buttons_init_gpio();
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        printf("Button initialization failed!\n\r");
+        for(int i = 0; i < 100000; i++) {}
+        CY_ASSERT(0);
+    }
 }
 
 
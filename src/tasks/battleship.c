@@ -12,17 +12,17 @@
 #include "battleship.h"
 #include "task_lcd.h"
 #include "task_console.h"
+#include "task_sensor_hub.h"
+#include "bitboard.h"
 
 #ifdef ECE353_FREERTOS
 
-// Game board to track ship positions (0 = empty, 1 = occupied)
-// [row][col]
-static uint8_t game_board[10][10] = {0};
+// Cells covered by the ships placed so far, bit row * 10 + col
+static bitboard_t game_board = {0, 0};
 extern bool light_mode;                // checking if light mode or dark mode
 extern uint8_t player_id;              // 0=Player1, 1=Player2, 255=unassigned
 extern uint16_t board_tile_fill_color; // Board tile color (white or black)
 extern uint16_t board_border_color;    // Board border color (blue for Player 1, red for Player 2)
-extern QueueHandle_t Queue_Sensor_Responses; // Light sensor response queue
 uint16_t tile_color;
 
 // length of ship based on type
@@ -83,34 +83,47 @@ bool battleship_get_box_coordinates(lcd_coord_t *coord, uint8_t col, uint8_t row
     }
 }
 
+#define LIGHT_THRESHOLD 200  /* Must match hw05.c threshold */
+#define LIGHT_HYSTERESIS 20  /* Counts below the threshold before dark mode returns */
+
+static uint8_t light_subscription;
+
 /**
  * @brief
- * Check light threshold every 0.5 seconds and update tile color if crossed
+ * Subscribes to light threshold crossings from the sensor hub.  Must be
+ * called before the scheduler starts.
+ * @return true
+ * @return false
+ */
+bool battleship_light_init(void)
+{
+    return sensor_hub_subscribe(
+        SENSOR_HUB_LIGHT,
+        0,
+        LIGHT_THRESHOLD,
+        LIGHT_HYSTERESIS,
+        ECE353_RTOS_Events,
+        ECE353_RTOS_EVENTS_LIGHT,
+        &light_subscription);
+}
+
+/**
+ * @brief
+ * Update tile color if the sensor hub reported a light threshold crossing.
+ * Only reads the event group and the hub cache, so it never blocks.
  * Returns true if threshold was crossed and color changed, false otherwise
  */
 bool battleship_check_light_threshold(void)
 {
-    static uint32_t last_check_time = 0;
     static bool last_light_mode = false;
-    const uint16_t LIGHT_THRESHOLD = 200; /* Must match hw05.c threshold */
-    
-    uint32_t current_time = xTaskGetTickCount();
-    
-    /* Only check every 0.5 seconds */
-    if (current_time - last_check_time < pdMS_TO_TICKS(500))
+
+    if ((xEventGroupClearBits(ECE353_RTOS_Events, ECE353_RTOS_EVENTS_LIGHT) & ECE353_RTOS_EVENTS_LIGHT) == 0)
     {
         return false;
     }
-    
-    last_check_time = current_time;
-    
-    /* Read current light level */
-    uint16_t ambient_light = 0;
-    system_sensors_get_light(Queue_Sensor_Responses, &ambient_light);
-   // printf("Light check: ambient=%d, threshold=%d\r\n", ambient_light, LIGHT_THRESHOLD);
-    
+
     /* Determine new light mode */
-    bool new_light_mode = (LIGHT_THRESHOLD) < ambient_light;
+    bool new_light_mode = sensor_hub_is_above(light_subscription);
     
     /* If threshold was crossed, update tile color */
     if (new_light_mode != last_light_mode)
@@ -258,28 +271,9 @@ bool battleship_place_ship(uint8_t col, uint8_t row, battleship_type_t type, boo
         return false; // Ship would overlap with existing ship
     }
 
-    // If all checks pass, place the ship and update the game board
-    for (uint8_t i = 0; i < ship_length; i++)
-    {
-        uint8_t place_col, place_row;
-        // Determine the position to mark based on orientation
-        if (horizontal)
-        {
-            place_col = col + i;
-            place_row = row;
-        }
-        else
-        {
-            place_col = col;
-            place_row = row + i;
-        }
-
-        // Mark this space as occupied in the game board
-        game_board[place_row][place_col] = 1;
-
-        // Don't draw grey - let the hw05 task handle all drawing
-        // battleship_draw_cursor(place_col, place_row, LCD_COLOR_BLUE, LCD_COLOR_GRAY);
-    }
+    // If all checks pass, mark the cells the ship covers as occupied.
+    // Don't draw grey - let the hw05 task handle all drawing
+    game_board = bitboard_or(game_board, bitboard_ship_mask(ship_length, horizontal, col, row));
 
     return true;
 }
@@ -297,40 +291,16 @@ bool battleship_place_ship(uint8_t col, uint8_t row, battleship_type_t type, boo
  */
 bool battleship_check_overlap(uint8_t col, uint8_t row, battleship_type_t type, bool horizontal, uint8_t player_id)
 {
-    // Get ship length
-    uint8_t ship_length = battleship_get_ship_length(type);
+    // Cells the ship would cover, empty if any of them is off the board
+    bitboard_t mask = bitboard_ship_mask(battleship_get_ship_length(type), horizontal, col, row);
 
-    // Check each space the ship would occupy
-    for (uint8_t i = 0; i < ship_length; i++)
+    // Treat OOB as overlap/invalid
+    if (bitboard_is_empty(mask))
     {
-        uint8_t check_col, check_row;
-
-        // Determine the position to check based on orientation
-        if (horizontal)
-        {
-            check_col = col + i;
-            check_row = row;
-        }
-        else
-        {
-            check_col = col;
-            check_row = row + i;
-        }
-
-        // Guard against out-of-bounds access - treat OOB as conflict
-        if (check_row >= 10 || check_col >= 10)
-        {
-            return true; // Treat OOB as overlap/invalid
-        }
-
-        // Check if this space is already occupied
-        if (game_board[check_row][check_col] != 0)
-        {
-            return true; // Overlap detected
-        }
+        return true;
     }
 
-    return false; // No overlap
+    return !bitboard_is_empty(bitboard_and(mask, game_board));
 }
 
 /**
@@ -339,15 +309,8 @@ bool battleship_check_overlap(uint8_t col, uint8_t row, battleship_type_t type,
  */
 void battleship_board_clear(void)
 {
-    // Clear the internal game board array
-    for (uint8_t r = 0; r < 10; r++)
-    {
-        // Iterate through each column
-        for (uint8_t c = 0; c < 10; c++)
-        {
-            game_board[r][c] = 0;
-        }
-    }
+    // Clear the internal game board
+    game_board = (bitboard_t){0, 0};
 }
 
 #endif
\ No newline at end of file
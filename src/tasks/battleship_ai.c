@@ -0,0 +1,340 @@
+/**
+ * @file battleship_ai.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Probability density battleship opponent that stands in for the IPC peer
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "battleship_ai.h"
+#include <string.h>
+
+/**
+ * @brief
+ * The targeting is in battleship_ai_target.c; this file plays it as the
+ * opponent.  battleship_ai_enable() installs the AI as the IPC local peer.
+ * The packets hw05 sends are queued to the AI task, which answers through
+ * ipc_rx_inject() with the same packets a second board would send: ACK
+ * for NEW_GAME, PLAYER_READY once the player has placed their ships, a
+ * RESULT (and END_GAME for the last ship) for each FIRE, and a FIRE
+ * followed by PASS_TURN when the turn is passed to it.  Its side of the
+ * game is a battleship_game_t, so the AI follows the same rules as the
+ * player's board.  The AI is Player 2 in the first game and alternates
+ * with the player after that, as hw05 does.
+ */
+
+typedef struct
+{
+    bool in_game;
+    uint8_t player_id;          // 0 fires first
+    uint32_t shots;             // Shots fired this game
+    battleship_game_t game;     // The AI's fleet, its shots and the turn
+    battleship_ai_t ai;
+} battleship_ai_peer_t;
+
+/* Global Variables */
+static QueueHandle_t Queue_Battleship_AI;
+static battleship_ai_peer_t Battleship_AI_Peer;
+static battleship_ai_stats_t Battleship_AI_Stats;
+
+/**
+ * @brief
+ * Seals a packet and hands it to the IPC Rx task as if it came from the
+ * other board
+ */
+static void battleship_ai_send(ipc_packet_t *packet)
+{
+    ipc_packet_seal(packet);
+    if (!ipc_rx_inject(packet))
+    {
+        printf("Battleship AI: IPC Rx queue full, packet dropped\r\n");
+    }
+}
+
+static void battleship_ai_send_control(ipc_game_control_t control)
+{
+    ipc_packet_t packet;
+
+    memset(&packet, 0, sizeof(ipc_packet_t));
+    packet.cmd = IPC_CMD_GAME_CONTROL;
+    packet.load.game_control = control;
+    battleship_ai_send(&packet);
+}
+
+/**
+ * @brief
+ * Ends the current game and swaps who fires first in the next one
+ */
+static void battleship_ai_end_game(bool ai_won)
+{
+    battleship_ai_peer_t *peer = &Battleship_AI_Peer;
+
+    if (!peer->in_game)
+    {
+        return;
+    }
+
+    peer->in_game = false;
+    peer->player_id = 1 - peer->player_id;
+
+    taskENTER_CRITICAL();
+    Battleship_AI_Stats.games++;
+    Battleship_AI_Stats.ai_wins += ai_won ? 1 : 0;
+    Battleship_AI_Stats.ai_shots += peer->shots;
+    taskEXIT_CRITICAL();
+
+    printf("Battleship AI: game over, AI %s after %lu shots\r\n", ai_won ? "won" : "lost", peer->shots);
+}
+
+/**
+ * @brief
+ * Picks a target, fires and passes the turn back to the player
+ */
+static void battleship_ai_take_turn(void)
+{
+    battleship_ai_peer_t *peer = &Battleship_AI_Peer;
+    ipc_packet_t packet;
+    uint32_t start;
+    uint32_t cycles;
+    uint8_t col;
+    uint8_t row;
+    bool chosen;
+
+    vTaskDelay(pdMS_TO_TICKS(BATTLESHIP_AI_THINK_MS));
+
+    if (!peer->in_game)
+    {
+        return;
+    }
+
+    start = timer_cycles_get();
+    chosen = battleship_ai_choose(&peer->ai, &col, &row);
+    cycles = timer_cycles_get() - start;
+
+    if (!chosen || battleship_game_fire(&peer->game, col, row) != BATTLESHIP_OK)
+    {
+        return;
+    }
+    peer->shots++;
+
+    taskENTER_CRITICAL();
+    if (cycles > Battleship_AI_Stats.max_update_cycles)
+    {
+        Battleship_AI_Stats.max_update_cycles = cycles;
+    }
+    taskEXIT_CRITICAL();
+
+    memset(&packet, 0, sizeof(ipc_packet_t));
+    packet.cmd = IPC_CMD_FIRE;
+    packet.load.fire.row = row;
+    packet.load.fire.col = col;
+    battleship_ai_send(&packet);
+
+    battleship_game_pass_turn(&peer->game, peer->player_id);
+    battleship_ai_send_control(IPC_GAME_CONTROL_PASS_TURN);
+}
+
+/**
+ * @brief
+ * Answers a shot from the player with the result, and END_GAME when the
+ * last ship sinks
+ */
+static void battleship_ai_handle_fire(uint8_t row, uint8_t col)
+{
+    battleship_ai_peer_t *peer = &Battleship_AI_Peer;
+    bitboard_shot_t shot = BITBOARD_SHOT_MISS;
+    battleship_status_t status = battleship_game_receive_fire(&peer->game, col, row, &shot, NULL);
+    ipc_packet_t packet;
+
+    memset(&packet, 0, sizeof(ipc_packet_t));
+
+    switch (status)
+    {
+    case BATTLESHIP_OK:
+        packet.cmd = IPC_CMD_RESULT;
+        packet.load.result = (shot == BITBOARD_SHOT_SUNK) ? IPC_RESULT_SUNK : (shot == BITBOARD_SHOT_HIT) ? IPC_RESULT_HIT
+                                                                                                           : IPC_RESULT_MISS;
+        break;
+    case BATTLESHIP_ERR_REPEAT:
+        packet.cmd = IPC_CMD_ERROR;
+        packet.load.error = IPC_ERROR_COORD_OCCUPIED;
+        break;
+    case BATTLESHIP_ERR_INVALID:
+        packet.cmd = IPC_CMD_ERROR;
+        packet.load.error = IPC_ERROR_COORD_INVALID;
+        break;
+    default:
+        packet.cmd = IPC_CMD_ERROR;
+        packet.load.error = IPC_ERROR_SYSTEM_FAILURE;
+        break;
+    }
+    battleship_ai_send(&packet);
+
+    if (status == BATTLESHIP_OK && peer->game.phase == BATTLESHIP_PHASE_OVER)
+    {
+        battleship_ai_send_control(IPC_GAME_CONTROL_END_GAME);
+        battleship_ai_end_game(false);
+    }
+}
+
+static void battleship_ai_handle_control(ipc_game_control_t control)
+{
+    battleship_ai_peer_t *peer = &Battleship_AI_Peer;
+
+    switch (control)
+    {
+    case IPC_GAME_CONTROL_NEW_GAME:
+        // The player pressed SW1 first, so the AI is Player 2
+        peer->player_id = 1;
+        peer->in_game = false;
+        battleship_ai_send_control(IPC_GAME_CONTROL_ACK);
+        break;
+    case IPC_GAME_CONTROL_PLAYER_READY:
+        // The player has placed their ships, place ours and start
+        {
+            uint32_t seed = xTaskGetTickCount() ^ timer_cycles_get();
+
+            battleship_game_init(&peer->game, peer->player_id);
+            battleship_game_place_random(&peer->game, &seed);
+            battleship_ai_reset(&peer->ai, seed);
+            peer->in_game = true;
+            peer->shots = 0;
+        }
+        battleship_ai_send_control(IPC_GAME_CONTROL_PLAYER_READY);
+        if (peer->player_id == 0)
+        {
+            battleship_ai_take_turn();
+        }
+        break;
+    case IPC_GAME_CONTROL_PASS_TURN:
+        if (peer->in_game)
+        {
+            battleship_game_pass_turn(&peer->game, 1 - peer->player_id);
+            battleship_ai_take_turn();
+        }
+        break;
+    case IPC_GAME_CONTROL_END_GAME:
+        // The player's last ship sank
+        battleship_ai_end_game(true);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief
+ * Processes the packets the player's board sends to its opponent
+ * @param param
+ * Unused parameter
+ */
+static void task_battleship_ai(void *param)
+{
+    battleship_ai_peer_t *peer = &Battleship_AI_Peer;
+    ipc_packet_t packet;
+
+    (void)param;
+
+    while (1)
+    {
+        xQueueReceive(Queue_Battleship_AI, &packet, portMAX_DELAY);
+
+        switch (packet.cmd)
+        {
+        case IPC_CMD_FIRE:
+            battleship_ai_handle_fire(packet.load.fire.row, packet.load.fire.col);
+            break;
+        case IPC_CMD_RESULT:
+        {
+            bitboard_shot_t shot = (packet.load.result == IPC_RESULT_SUNK) ? BITBOARD_SHOT_SUNK : (packet.load.result == IPC_RESULT_HIT) ? BITBOARD_SHOT_HIT
+                                                                                                                                          : BITBOARD_SHOT_MISS;
+            uint8_t col = peer->game.shot_col;
+            uint8_t row = peer->game.shot_row;
+
+            if (battleship_game_apply_result(&peer->game, shot) == BATTLESHIP_OK)
+            {
+                battleship_ai_update(&peer->ai, col, row, shot);
+            }
+            break;
+        }
+        case IPC_CMD_GAME_CONTROL:
+            battleship_ai_handle_control(packet.load.game_control);
+            break;
+        case IPC_CMD_ERROR:
+            // The shot was refused, the next one replaces it
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/**
+ * @brief
+ * IPC local peer.  Runs on the IPC Tx task, so it only queues the packet.
+ */
+static void battleship_ai_peer(const ipc_packet_t *packet)
+{
+    if (xQueueSend(Queue_Battleship_AI, packet, 0) != pdTRUE)
+    {
+        printf("Battleship AI: queue full, packet dropped\r\n");
+    }
+}
+
+void battleship_ai_enable(bool enable)
+{
+    if (enable)
+    {
+        Battleship_AI_Peer.player_id = 1;
+        Battleship_AI_Peer.in_game = false;
+    }
+
+    Battleship_AI_Stats.enabled = enable;
+    ipc_set_local_peer(enable ? battleship_ai_peer : NULL);
+}
+
+bool battleship_ai_get_stats(battleship_ai_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    *stats = Battleship_AI_Stats;
+    taskEXIT_CRITICAL();
+
+    return true;
+}
+
+bool battleship_ai_init(void)
+{
+    Queue_Battleship_AI = xQueueCreate(IPC_TX_QUEUE_LENGTH, sizeof(ipc_packet_t));
+    if (Queue_Battleship_AI == NULL)
+    {
+        return false;
+    }
+
+    if (xTaskCreate(
+            task_battleship_ai,
+            "Battleship AI",
+            TASK_BATTLESHIP_AI_STACK_SIZE,
+            NULL,
+            TASK_BATTLESHIP_AI_PRIORITY,
+            NULL) != pdPASS)
+    {
+        return false;
+    }
+
+    // Used to seed the AI and measure each density update
+    timer_cycles_init();
+
+    return true;
+}
+#endif
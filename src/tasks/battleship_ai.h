@@ -0,0 +1,59 @@
+/**
+ * @file battleship_ai.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Probability density battleship opponent that stands in for the IPC peer
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __BATTLESHIP_AI_H__
+#define __BATTLESHIP_AI_H__
+
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "drivers.h"
+#include "bitboard.h"
+#include "battleship_ai_target.h"
+#include "battleship_engine.h"
+#include "task_ipc.h"
+
+#define TASK_BATTLESHIP_AI_PRIORITY (tskIDLE_PRIORITY + 1)
+#define TASK_BATTLESHIP_AI_STACK_SIZE (configMINIMAL_STACK_SIZE * 4)
+#define BATTLESHIP_AI_THINK_MS 600 // Pause before the AI fires so its shots can be followed
+
+// Counters describing the local opponent since it was initialized
+typedef struct
+{
+    bool enabled;
+    uint32_t games;
+    uint32_t ai_wins;
+    uint32_t ai_shots;           // Shots fired by the AI in finished games
+    uint32_t max_update_cycles;  // Slowest density update
+} battleship_ai_stats_t;
+
+/**
+ * @brief
+ * Creates the local opponent task.  Must be called after task_ipc_init()
+ * and before the scheduler starts.
+ * @return true
+ * @return false
+ */
+bool battleship_ai_init(void);
+
+/**
+ * @brief
+ * Connects or disconnects the local opponent.  While enabled the packets
+ * this board sends go to the AI instead of the IPC UART, so a game can be
+ * played on a single board.  Enable it before pressing SW1 to start.
+ * @param enable
+ */
+void battleship_ai_enable(bool enable);
+
+bool battleship_ai_get_stats(battleship_ai_stats_t *stats);
+
+#endif
+#endif
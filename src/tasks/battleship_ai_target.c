@@ -0,0 +1,298 @@
+/**
+ * @file battleship_ai_target.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Probability density targeting for the battleship opponent
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "battleship_ai_target.h"
+#include <string.h>
+
+/**
+ * @brief
+ * Every placement of every ship still afloat that avoids the misses and
+ * the ships already sunk is a possible position.  Counting how many of
+ * them cover each unshot cell gives a probability density, and the AI
+ * fires at the densest cell.  While there are hits that do not
+ * belong to a sunk ship (target mode) only the placements through those
+ * hits are counted, weighted 16x for each hit they explain, so the AI
+ * follows the line of a damaged ship.  With no open hits (hunt mode) the
+ * density naturally favours the middle of the board and a parity pattern.
+ * Placements come from the bitboard mask table, so each one costs an AND
+ * to test and a few increments to count; a full update is well under a
+ * millisecond.
+ *
+ * A sunk report does not say which ship sank, so the sunk ship is chosen
+ * from the run of hits through the last shot (see
+ * battleship_ai_resolve_sunk()).  A wrong guess can leave hits that no
+ * remaining ship explains; the density is then rebuilt from the whole
+ * fleet, ignoring what was marked sunk, so the AI never stalls.
+ */
+
+/* Global Variables */
+static const uint8_t Battleship_AI_Lengths[BITBOARD_SHIPS] = {5, 4, 3, 3, 2};
+
+static uint32_t battleship_ai_random(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+/**
+ * @brief
+ * Adds weight to the density of every cell in cells
+ */
+static void battleship_ai_add(uint32_t *density, bitboard_t cells, uint32_t weight)
+{
+    while (cells.lo != 0)
+    {
+        density[__builtin_ctzll(cells.lo)] += weight;
+        cells.lo &= cells.lo - 1;
+    }
+    while (cells.hi != 0)
+    {
+        density[64 + __builtin_ctzll(cells.hi)] += weight;
+        cells.hi &= cells.hi - 1;
+    }
+}
+
+/**
+ * @brief
+ * Rebuilds ai->density
+ * @param target Only count placements through the open hits
+ * @param recover Count every ship and allow the cells of sunk ships, used
+ * once a wrongly resolved sunk report leaves no consistent placement
+ * @return uint32_t Placements counted
+ */
+static uint32_t battleship_ai_density(battleship_ai_t *ai, bool target, bool recover)
+{
+    // Misses and sunk ships.  Open hits may still hold part of a ship.
+    bitboard_t blocked = bitboard_andnot(ai->shots, recover ? bitboard_or(ai->hits, ai->sunk) : ai->hits);
+    uint32_t placements = 0;
+
+    memset(ai->density, 0, sizeof(ai->density));
+
+    for (uint8_t ship = 0; ship < BITBOARD_SHIPS; ship++)
+    {
+        uint8_t length = recover ? Battleship_AI_Lengths[ship] : ai->remaining[ship];
+
+        if (length == 0)
+        {
+            continue;
+        }
+
+        for (uint8_t horizontal = 0; horizontal < 2; horizontal++)
+        {
+            const bitboard_t *masks = bitboard_ship_masks(length, horizontal);
+
+            for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+            {
+                bitboard_t open = bitboard_andnot(masks[index], ai->shots);
+                uint8_t covered;
+
+                if (bitboard_is_empty(open) || !bitboard_is_empty(bitboard_and(masks[index], blocked)))
+                {
+                    continue;
+                }
+
+                covered = bitboard_count(bitboard_and(masks[index], ai->hits));
+                if (target && covered == 0)
+                {
+                    continue;
+                }
+
+                battleship_ai_add(ai->density, open, target ? (1UL << (4 * covered)) : 1);
+                placements++;
+            }
+        }
+    }
+
+    return placements;
+}
+
+/**
+ * @brief
+ * Marks the ship sunk by the shot at index.  The ship must lie on the run
+ * of open hits through index in one direction.  A ship afloat exactly as
+ * long as a run is preferred, then the largest ship with the sinking shot
+ * at one end (the AI works along a line, so the last hit is usually an
+ * end), then the largest ship that fits anywhere in a run.
+ */
+static void battleship_ai_resolve_sunk(battleship_ai_t *ai, uint8_t index)
+{
+    uint8_t position[2] = {index / BITBOARD_SIZE, index % BITBOARD_SIZE};
+    uint8_t run_start[2];
+    uint8_t run_length[2];
+    int8_t last = -1;
+
+    // Runs of open hits through index, [0] vertical and [1] horizontal
+    for (uint8_t horizontal = 0; horizontal < 2; horizontal++)
+    {
+        uint8_t step = horizontal ? 1 : BITBOARD_SIZE;
+        uint8_t start = position[horizontal];
+        uint8_t end = position[horizontal];
+
+        while (start > 0 && bitboard_test(ai->hits, index - (position[horizontal] - start + 1) * step))
+        {
+            start--;
+        }
+        while (end < BITBOARD_SIZE - 1 && bitboard_test(ai->hits, index + (end - position[horizontal] + 1) * step))
+        {
+            end++;
+        }
+
+        run_start[horizontal] = start;
+        run_length[horizontal] = end - start + 1;
+    }
+
+    for (uint8_t pass = 0; pass < 3; pass++)
+    {
+        for (uint8_t ship = 0; ship < BITBOARD_SHIPS; ship++)
+        {
+            uint8_t length = ai->remaining[ship];
+
+            if (length == 0)
+            {
+                continue;
+            }
+            last = ship;
+
+            for (uint8_t horizontal = 0; horizontal < 2; horizontal++)
+            {
+                uint8_t p = position[horizontal];
+                uint8_t first = run_start[horizontal];
+                uint8_t limit = run_start[horizontal] + run_length[horizontal] - length;
+
+                if (length > run_length[horizontal])
+                {
+                    continue;
+                }
+
+                // Origins along the run that keep the sinking shot on the ship
+                for (uint8_t origin = (p + 1 > first + length) ? p + 1 - length : first; origin <= p && origin <= limit; origin++)
+                {
+                    bitboard_t mask;
+
+                    if ((pass == 0 && length != run_length[horizontal]) ||
+                        (pass == 1 && origin != p && origin + length - 1 != p))
+                    {
+                        continue;
+                    }
+
+                    mask = bitboard_ship_mask(length, horizontal,
+                                              horizontal ? origin : index % BITBOARD_SIZE,
+                                              horizontal ? index / BITBOARD_SIZE : origin);
+                    ai->hits = bitboard_andnot(ai->hits, mask);
+                    ai->sunk = bitboard_or(ai->sunk, mask);
+                    ai->remaining[ship] = 0;
+                    return;
+                }
+            }
+        }
+    }
+
+    // The hits do not explain the report, retire the smallest ship afloat
+    if (last >= 0)
+    {
+        ai->remaining[last] = 0;
+        ai->hits = bitboard_andnot(ai->hits, bitboard_cell(index));
+        ai->sunk = bitboard_or(ai->sunk, bitboard_cell(index));
+    }
+}
+
+void battleship_ai_reset(battleship_ai_t *ai, uint32_t seed)
+{
+    memset(ai, 0, sizeof(battleship_ai_t));
+    memcpy(ai->remaining, Battleship_AI_Lengths, sizeof(ai->remaining));
+    ai->seed = seed;
+}
+
+bool battleship_ai_choose(battleship_ai_t *ai, uint8_t *col, uint8_t *row)
+{
+    uint8_t choice = BITBOARD_CELLS;
+    uint32_t best = 0;
+    uint32_t ties = 0;
+
+    if (bitboard_count(ai->shots) >= BITBOARD_CELLS)
+    {
+        return false;
+    }
+
+    // Target the open hits, then hunt.  Each falls back to recovery if a
+    // wrongly resolved sunk report left nothing consistent.
+    if (bitboard_is_empty(ai->hits) ||
+        (battleship_ai_density(ai, true, false) == 0 && battleship_ai_density(ai, true, true) == 0))
+    {
+        if (battleship_ai_density(ai, false, false) == 0)
+        {
+            battleship_ai_density(ai, false, true);
+        }
+    }
+
+    // Densest unshot cell, ties broken at random
+    for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+    {
+        if (bitboard_test(ai->shots, index))
+        {
+            continue;
+        }
+
+        if (choice == BITBOARD_CELLS || ai->density[index] > best)
+        {
+            choice = index;
+            best = ai->density[index];
+            ties = 1;
+        }
+        else if (ai->density[index] == best && battleship_ai_random(&ai->seed) % ++ties == 0)
+        {
+            choice = index;
+        }
+    }
+
+    *col = choice % BITBOARD_SIZE;
+    *row = choice / BITBOARD_SIZE;
+
+    return true;
+}
+
+void battleship_ai_update(battleship_ai_t *ai, uint8_t col, uint8_t row, bitboard_shot_t result)
+{
+    uint8_t index = BITBOARD_INDEX(col, row);
+
+    if (col >= BITBOARD_SIZE || row >= BITBOARD_SIZE)
+    {
+        return;
+    }
+
+    ai->shots = bitboard_or(ai->shots, bitboard_cell(index));
+
+    if (result == BITBOARD_SHOT_HIT || result == BITBOARD_SHOT_SUNK)
+    {
+        ai->hits = bitboard_or(ai->hits, bitboard_cell(index));
+    }
+
+    if (result == BITBOARD_SHOT_SUNK)
+    {
+        battleship_ai_resolve_sunk(ai, index);
+    }
+}
+
+void battleship_ai_place_fleet(bitboard_fleet_t *fleet, uint32_t *seed)
+{
+    bitboard_fleet_clear(fleet);
+
+    for (uint8_t id = 1; id <= BITBOARD_SHIPS; id++)
+    {
+        uint32_t value;
+
+        do
+        {
+            value = battleship_ai_random(seed);
+        } while (!bitboard_fleet_place(fleet, id, Battleship_AI_Lengths[id - 1], value & 1,
+                                       (value >> 1) % BITBOARD_SIZE, (value >> 5) % BITBOARD_SIZE));
+    }
+}
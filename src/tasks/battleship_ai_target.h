@@ -0,0 +1,71 @@
+/**
+ * @file battleship_ai_target.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Probability density targeting for the battleship opponent
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __BATTLESHIP_AI_TARGET_H__
+#define __BATTLESHIP_AI_TARGET_H__
+
+// Plain C with no board or RTOS includes so the host tests in test/ can build it
+#include <stdbool.h>
+#include <stdint.h>
+#include "bitboard.h"
+
+// Targeting state for one game
+typedef struct
+{
+    bitboard_t shots;                    // Every cell fired on
+    bitboard_t hits;                     // Hits not yet assigned to a sunk ship
+    bitboard_t sunk;                     // Cells of the ships sunk so far
+    uint8_t remaining[BITBOARD_SHIPS];   // Lengths of the ships still afloat, 0 once sunk
+    uint32_t density[BITBOARD_CELLS];    // Placements covering each cell, from the last update
+    uint32_t seed;
+} battleship_ai_t;
+
+/**
+ * @brief
+ * Starts a new game.  All five ships are afloat and nothing has been fired.
+ * @param ai
+ * @param seed Breaks ties between equally likely cells
+ */
+void battleship_ai_reset(battleship_ai_t *ai, uint32_t seed);
+
+/**
+ * @brief
+ * Picks the cell most likely to hold a ship.  Every placement of every
+ * ship still afloat that avoids the misses and sunk ships is counted; while
+ * there are unresolved hits only the placements through them are counted,
+ * weighted by how many hits they explain.
+ * @param ai
+ * @param col
+ * @param row
+ * @return true
+ * @return false if every cell has been fired on
+ */
+bool battleship_ai_choose(battleship_ai_t *ai, uint8_t *col, uint8_t *row);
+
+/**
+ * @brief
+ * Records the result of a shot chosen by battleship_ai_choose()
+ * @param ai
+ * @param col
+ * @param row
+ * @param result BITBOARD_SHOT_MISS, BITBOARD_SHOT_HIT or BITBOARD_SHOT_SUNK
+ */
+void battleship_ai_update(battleship_ai_t *ai, uint8_t col, uint8_t row, bitboard_shot_t result);
+
+/**
+ * @brief
+ * Places the standard five ship fleet at random
+ * @param fleet
+ * @param seed Updated as random numbers are drawn
+ */
+void battleship_ai_place_fleet(bitboard_fleet_t *fleet, uint32_t *seed);
+
+#endif
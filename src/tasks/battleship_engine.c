@@ -0,0 +1,285 @@
+/**
+ * @file battleship_engine.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Battleship rules for one player, with no RTOS, LCD or console access
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "battleship_engine.h"
+#include <string.h>
+
+/**
+ * @brief
+ * Everything one board knows about a game lives in a battleship_game_t,
+ * and every rule is a function that checks a transition and applies it:
+ * placing a ship, firing, applying the result of my shot, applying the
+ * opponent's shot and passing the turn.  The functions only read and
+ * write the struct, so the same engine runs behind the LCD and IPC tasks
+ * in hw05.c, behind the local AI opponent and in self-play.  Callers that
+ * share a game between tasks provide their own locking.
+ */
+
+/* Global Variables */
+static const uint8_t Battleship_Game_Lengths[BITBOARD_SHIPS] = {2, 3, 3, 4, 5};
+
+static uint32_t battleship_game_random(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+void battleship_game_init(battleship_game_t *game, uint8_t player_id)
+{
+    memset(game, 0, sizeof(battleship_game_t));
+    game->phase = BATTLESHIP_PHASE_PLACEMENT;
+    game->player_id = player_id;
+    game->opponent_ships_remaining = BITBOARD_SHIPS;
+}
+
+uint8_t battleship_game_ship_length(uint8_t ship_id)
+{
+    if (ship_id == 0 || ship_id > BITBOARD_SHIPS)
+    {
+        return 0;
+    }
+
+    return Battleship_Game_Lengths[ship_id - 1];
+}
+
+battleship_status_t battleship_game_place(battleship_game_t *game, uint8_t ship_id, uint8_t col, uint8_t row, bool horizontal)
+{
+    uint8_t length = battleship_game_ship_length(ship_id);
+    bool placed_before;
+
+    if (game->phase != BATTLESHIP_PHASE_PLACEMENT)
+    {
+        return BATTLESHIP_ERR_PHASE;
+    }
+
+    if (length == 0 || bitboard_is_empty(bitboard_ship_mask(length, horizontal, col, row)))
+    {
+        return BATTLESHIP_ERR_INVALID;
+    }
+
+    placed_before = !bitboard_is_empty(game->fleet.ships[ship_id - 1]);
+    if (!bitboard_fleet_place(&game->fleet, ship_id, length, horizontal, col, row))
+    {
+        return BATTLESHIP_ERR_OVERLAP;
+    }
+
+    if (!placed_before && ++game->ships_placed == BITBOARD_SHIPS)
+    {
+        game->phase = BATTLESHIP_PHASE_PLAYING;
+    }
+
+    return BATTLESHIP_OK;
+}
+
+void battleship_game_place_random(battleship_game_t *game, uint32_t *seed)
+{
+    for (uint8_t ship_id = 1; ship_id <= BITBOARD_SHIPS; ship_id++)
+    {
+        uint32_t value;
+
+        if (!bitboard_is_empty(game->fleet.ships[ship_id - 1]))
+        {
+            continue;
+        }
+
+        do
+        {
+            value = battleship_game_random(seed);
+        } while (battleship_game_place(game, ship_id, (value >> 1) % BITBOARD_SIZE, (value >> 5) % BITBOARD_SIZE, value & 1) != BATTLESHIP_OK);
+    }
+}
+
+battleship_status_t battleship_game_fire(battleship_game_t *game, uint8_t col, uint8_t row)
+{
+    if (game->phase != BATTLESHIP_PHASE_PLAYING)
+    {
+        return BATTLESHIP_ERR_PHASE;
+    }
+
+    if (game->current_turn != game->player_id)
+    {
+        return BATTLESHIP_ERR_TURN;
+    }
+
+    if (col >= BITBOARD_SIZE || row >= BITBOARD_SIZE)
+    {
+        return BATTLESHIP_ERR_INVALID;
+    }
+
+    if (battleship_game_target_at(game, col, row) != BATTLESHIP_TARGET_UNKNOWN)
+    {
+        return BATTLESHIP_ERR_REPEAT;
+    }
+
+    // A shot the opponent refused never gets a result, so a new shot
+    // replaces it
+    game->shot_pending = true;
+    game->shot_col = col;
+    game->shot_row = row;
+
+    return BATTLESHIP_OK;
+}
+
+battleship_status_t battleship_game_apply_result(battleship_game_t *game, bitboard_shot_t result)
+{
+    bitboard_t cell;
+
+    if (!game->shot_pending)
+    {
+        return BATTLESHIP_ERR_NO_SHOT;
+    }
+
+    if (result != BITBOARD_SHOT_MISS && result != BITBOARD_SHOT_HIT && result != BITBOARD_SHOT_SUNK)
+    {
+        return BATTLESHIP_ERR_INVALID;
+    }
+
+    game->shot_pending = false;
+    cell = bitboard_cell(BITBOARD_INDEX(game->shot_col, game->shot_row));
+
+    if (result == BITBOARD_SHOT_MISS)
+    {
+        game->target_misses = bitboard_or(game->target_misses, cell);
+        game->my_misses++;
+        return BATTLESHIP_OK;
+    }
+
+    game->target_hits = bitboard_or(game->target_hits, cell);
+    game->my_hits++;
+
+    if (result == BITBOARD_SHOT_SUNK && game->opponent_ships_remaining > 0 && --game->opponent_ships_remaining == 0)
+    {
+        game->phase = BATTLESHIP_PHASE_OVER;
+        game->i_won = true;
+    }
+
+    return BATTLESHIP_OK;
+}
+
+battleship_status_t battleship_game_receive_fire(
+    battleship_game_t *game,
+    uint8_t col,
+    uint8_t row,
+    bitboard_shot_t *shot,
+    uint8_t *ship_id)
+{
+    bitboard_shot_t result;
+    uint8_t id;
+
+    if (game->phase != BATTLESHIP_PHASE_PLAYING)
+    {
+        return BATTLESHIP_ERR_PHASE;
+    }
+
+    result = bitboard_fleet_fire(&game->fleet, col, row, &id);
+    if (result == BITBOARD_SHOT_INVALID)
+    {
+        return BATTLESHIP_ERR_INVALID;
+    }
+    if (result == BITBOARD_SHOT_REPEAT)
+    {
+        return BATTLESHIP_ERR_REPEAT;
+    }
+
+    if (id != 0)
+    {
+        game->ship_hit_count[id - 1]++;
+        game->opponent_hits++;
+    }
+    else
+    {
+        game->opponent_misses++;
+    }
+
+    if (bitboard_fleet_all_sunk(&game->fleet))
+    {
+        game->phase = BATTLESHIP_PHASE_OVER;
+        game->i_won = false;
+    }
+
+    if (shot != NULL)
+    {
+        *shot = result;
+    }
+    if (ship_id != NULL)
+    {
+        *ship_id = id;
+    }
+
+    return BATTLESHIP_OK;
+}
+
+battleship_status_t battleship_game_pass_turn(battleship_game_t *game, uint8_t from_player)
+{
+    if (game->phase != BATTLESHIP_PHASE_PLAYING)
+    {
+        return BATTLESHIP_ERR_PHASE;
+    }
+
+    if (from_player >= BATTLESHIP_GAME_PLAYERS)
+    {
+        return BATTLESHIP_ERR_INVALID;
+    }
+
+    game->current_turn = 1 - from_player;
+    return BATTLESHIP_OK;
+}
+
+void battleship_game_end(battleship_game_t *game, bool i_won)
+{
+    if (game->phase == BATTLESHIP_PHASE_OVER)
+    {
+        return;
+    }
+
+    game->phase = BATTLESHIP_PHASE_OVER;
+    game->i_won = i_won;
+}
+
+uint32_t battleship_game_play_random(battleship_game_t game[BATTLESHIP_GAME_PLAYERS], uint32_t *seed)
+{
+    uint32_t transitions = 0;
+
+    for (uint8_t player = 0; player < BATTLESHIP_GAME_PLAYERS; player++)
+    {
+        battleship_game_init(&game[player], player);
+        battleship_game_place_random(&game[player], seed);
+        transitions += BITBOARD_SHIPS;
+    }
+
+    while (game[0].phase == BATTLESHIP_PHASE_PLAYING && game[1].phase == BATTLESHIP_PHASE_PLAYING)
+    {
+        battleship_game_t *shooter = &game[game[0].current_turn];
+        battleship_game_t *target = &game[1 - game[0].current_turn];
+        uint8_t index = battleship_game_random(seed) % BITBOARD_CELLS;
+        bitboard_shot_t shot;
+
+        // Next unshot cell from a random start
+        while (battleship_game_target_at(shooter, index % BITBOARD_SIZE, index / BITBOARD_SIZE) != BATTLESHIP_TARGET_UNKNOWN)
+        {
+            index = (index + 1) % BITBOARD_CELLS;
+        }
+
+        battleship_game_fire(shooter, index % BITBOARD_SIZE, index / BITBOARD_SIZE);
+        battleship_game_receive_fire(target, index % BITBOARD_SIZE, index / BITBOARD_SIZE, &shot, NULL);
+        battleship_game_apply_result(shooter, shot);
+        transitions += 3;
+
+        if (shooter->phase == BATTLESHIP_PHASE_PLAYING)
+        {
+            battleship_game_pass_turn(&game[0], shooter->player_id);
+            battleship_game_pass_turn(&game[1], shooter->player_id);
+            transitions += 2;
+        }
+    }
+
+    return transitions;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file battleship_engine.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Battleship rules for one player, with no RTOS, LCD or console access
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __BATTLESHIP_ENGINE_H__
+#define __BATTLESHIP_ENGINE_H__
+
+// Plain C with no board or RTOS includes so the host tests in test/ can build it
+#include <stdbool.h>
+#include <stdint.h>
+#include "bitboard.h"
+
+#define BATTLESHIP_GAME_PLAYERS 2
+
+typedef enum
+{
+    BATTLESHIP_PHASE_PLACEMENT, // Placing ships, the opponent may not fire yet
+    BATTLESHIP_PHASE_PLAYING,   // Entered once the whole fleet is placed
+    BATTLESHIP_PHASE_OVER
+} battleship_phase_t;
+
+typedef enum
+{
+    BATTLESHIP_OK,
+    BATTLESHIP_ERR_PHASE,   // Not allowed in the current phase
+    BATTLESHIP_ERR_TURN,    // Not this player's turn
+    BATTLESHIP_ERR_INVALID, // Off the board, or an unknown ship or result
+    BATTLESHIP_ERR_OVERLAP, // Ship would touch one already placed
+    BATTLESHIP_ERR_REPEAT,  // Cell was already fired on
+    BATTLESHIP_ERR_NO_SHOT  // Result with no shot waiting for one
+} battleship_status_t;
+
+// What a player knows about a cell of the opponent's board.  The values
+// are the ones saved by game_state.c.
+typedef enum
+{
+    BATTLESHIP_TARGET_UNKNOWN = 0,
+    BATTLESHIP_TARGET_HIT = 1,
+    BATTLESHIP_TARGET_MISS = 2
+} battleship_target_t;
+
+// One player's view of a game
+typedef struct
+{
+    battleship_phase_t phase;
+    uint8_t player_id;                        // 0 fires first
+    uint8_t current_turn;                     // Player whose turn it is
+    bool i_won;
+
+    // My board
+    bitboard_fleet_t fleet;                   // My ships and the opponent's shots at them
+    uint8_t ships_placed;
+    uint8_t ship_hit_count[BITBOARD_SHIPS];   // Index is ship id - 1
+
+    // The opponent's board, as learned from the results of my shots
+    bitboard_t target_hits;
+    bitboard_t target_misses;
+    uint8_t opponent_ships_remaining;
+    bool shot_pending;                        // Fired, waiting for the result
+    uint8_t shot_col;
+    uint8_t shot_row;
+
+    // Counters shown on the LCD and saved to the EEPROM
+    uint16_t my_hits;
+    uint16_t my_misses;
+    uint16_t opponent_hits;
+    uint16_t opponent_misses;
+} battleship_game_t;
+
+/**
+ * @brief
+ * Starts a new game in the placement phase
+ * @param game
+ * @param player_id 0 fires first
+ */
+void battleship_game_init(battleship_game_t *game, uint8_t player_id);
+
+/**
+ * @brief
+ * Returns the length of ship id, in the order the ships are placed:
+ * destroyer, submarine, cruiser, battleship, carrier
+ * @param ship_id 1 to BITBOARD_SHIPS
+ * @return uint8_t 0 if ship_id is invalid
+ */
+uint8_t battleship_game_ship_length(uint8_t ship_id);
+
+/**
+ * @brief
+ * Places (or moves) one of my ships.  The game enters the playing phase
+ * once all BITBOARD_SHIPS ships are placed.
+ * @param game
+ * @param ship_id 1 to BITBOARD_SHIPS
+ * @param col
+ * @param row
+ * @param horizontal
+ * @return battleship_status_t
+ */
+battleship_status_t battleship_game_place(battleship_game_t *game, uint8_t ship_id, uint8_t col, uint8_t row, bool horizontal);
+
+/**
+ * @brief
+ * Places every ship not yet placed at random
+ * @param game
+ * @param seed Updated as random numbers are drawn
+ */
+void battleship_game_place_random(battleship_game_t *game, uint32_t *seed);
+
+/**
+ * @brief
+ * Records my shot at the opponent.  It must be my turn and the cell must
+ * not have been fired on.  The result is applied with
+ * battleship_game_apply_result().
+ * @param game
+ * @param col
+ * @param row
+ * @return battleship_status_t
+ */
+battleship_status_t battleship_game_fire(battleship_game_t *game, uint8_t col, uint8_t row);
+
+/**
+ * @brief
+ * Applies the opponent's answer to my last shot.  Sinking the last ship
+ * ends the game with a win.
+ * @param game
+ * @param result BITBOARD_SHOT_MISS, BITBOARD_SHOT_HIT or BITBOARD_SHOT_SUNK
+ * @return battleship_status_t
+ */
+battleship_status_t battleship_game_apply_result(battleship_game_t *game, bitboard_shot_t result);
+
+/**
+ * @brief
+ * Applies the opponent's shot at my fleet.  Losing the last ship ends the
+ * game with a loss.
+ * @param game
+ * @param col
+ * @param row
+ * @param shot Returns the result to send back.  May be NULL.
+ * @param ship_id Returns the ship hit, 0 on a miss.  May be NULL.
+ * @return battleship_status_t
+ */
+battleship_status_t battleship_game_receive_fire(
+    battleship_game_t *game,
+    uint8_t col,
+    uint8_t row,
+    bitboard_shot_t *shot,
+    uint8_t *ship_id);
+
+/**
+ * @brief
+ * Ends from_player's turn
+ * @param game
+ * @param from_player
+ * @return battleship_status_t
+ */
+battleship_status_t battleship_game_pass_turn(battleship_game_t *game, uint8_t from_player);
+
+/**
+ * @brief
+ * Ends the game, used when the opponent reports the result
+ * @param game
+ * @param i_won
+ */
+void battleship_game_end(battleship_game_t *game, bool i_won);
+
+/**
+ * @brief
+ * Plays a complete game between two players that fire at random unshot
+ * cells, applying every transition to both sides
+ * @param game Two games, both are initialized here
+ * @param seed Updated as random numbers are drawn
+ * @return uint32_t Number of transitions applied
+ */
+uint32_t battleship_game_play_random(battleship_game_t game[BATTLESHIP_GAME_PLAYERS], uint32_t *seed);
+
+static inline bool battleship_game_is_my_turn(const battleship_game_t *game)
+{
+    return game->phase != BATTLESHIP_PHASE_OVER && game->current_turn == game->player_id;
+}
+
+/**
+ * @brief
+ * Returns the id of my ship at (col, row), 0 if the cell is empty or off
+ * the board
+ */
+static inline uint8_t battleship_game_ship_at(const battleship_game_t *game, uint8_t col, uint8_t row)
+{
+    return bitboard_fleet_ship_at(&game->fleet, col, row);
+}
+
+/**
+ * @brief
+ * Returns true if the opponent has fired on my cell (col, row)
+ */
+static inline bool battleship_game_shot_at(const battleship_game_t *game, uint8_t col, uint8_t row)
+{
+    return col < BITBOARD_SIZE && row < BITBOARD_SIZE && bitboard_test(game->fleet.shots, BITBOARD_INDEX(col, row));
+}
+
+static inline battleship_target_t battleship_game_target_at(const battleship_game_t *game, uint8_t col, uint8_t row)
+{
+    if (col >= BITBOARD_SIZE || row >= BITBOARD_SIZE)
+    {
+        return BATTLESHIP_TARGET_UNKNOWN;
+    }
+    if (bitboard_test(game->target_hits, BITBOARD_INDEX(col, row)))
+    {
+        return BATTLESHIP_TARGET_HIT;
+    }
+    return bitboard_test(game->target_misses, BITBOARD_INDEX(col, row)) ? BATTLESHIP_TARGET_MISS : BATTLESHIP_TARGET_UNKNOWN;
+}
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * @file bitboard.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * 100 cell battleship boards stored as bit masks
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "bitboard.h"
+#include <string.h>
+
+/**
+ * @brief
+ * Each layer of a board (a ship, all ships, the shots fired) is one bit
+ * per cell in a pair of 64 bit words.  The cells a ship covers are looked
+ * up in a table built once for every length, orientation and origin, so
+ * placing a ship, checking it for overlap, testing a shot and checking
+ * whether a ship or the whole fleet is sunk are each a few AND/OR
+ * operations instead of a loop over the cells.  An origin that would put
+ * part of the ship off the board has an empty mask.
+ *
+ * test/bitboard_bench compares these against the byte array board they
+ * replaced.
+ */
+
+#define BITBOARD_LENGTHS (BITBOARD_MAX_SHIP - BITBOARD_MIN_SHIP + 1)
+
+/* Global Variables */
+static bitboard_t Bitboard_Ship_Masks[BITBOARD_LENGTHS][2][BITBOARD_CELLS];
+
+void bitboard_init(void)
+{
+    for (uint8_t length = BITBOARD_MIN_SHIP; length <= BITBOARD_MAX_SHIP; length++)
+    {
+        for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+        {
+            uint8_t col = index % BITBOARD_SIZE;
+            uint8_t row = index / BITBOARD_SIZE;
+            bitboard_t vertical = {0, 0};
+            bitboard_t horizontal = {0, 0};
+
+            for (uint8_t i = 0; i < length; i++)
+            {
+                if (col + length <= BITBOARD_SIZE)
+                {
+                    horizontal = bitboard_or(horizontal, bitboard_cell(index + i));
+                }
+                if (row + length <= BITBOARD_SIZE)
+                {
+                    vertical = bitboard_or(vertical, bitboard_cell(index + i * BITBOARD_SIZE));
+                }
+            }
+
+            Bitboard_Ship_Masks[length - BITBOARD_MIN_SHIP][0][index] = vertical;
+            Bitboard_Ship_Masks[length - BITBOARD_MIN_SHIP][1][index] = horizontal;
+        }
+    }
+}
+
+bitboard_t bitboard_ship_mask(uint8_t length, bool horizontal, uint8_t col, uint8_t row)
+{
+    if (length < BITBOARD_MIN_SHIP || length > BITBOARD_MAX_SHIP || col >= BITBOARD_SIZE || row >= BITBOARD_SIZE)
+    {
+        return (bitboard_t){0, 0};
+    }
+
+    return Bitboard_Ship_Masks[length - BITBOARD_MIN_SHIP][horizontal ? 1 : 0][BITBOARD_INDEX(col, row)];
+}
+
+const bitboard_t *bitboard_ship_masks(uint8_t length, bool horizontal)
+{
+    if (length < BITBOARD_MIN_SHIP || length > BITBOARD_MAX_SHIP)
+    {
+        return NULL;
+    }
+
+    return Bitboard_Ship_Masks[length - BITBOARD_MIN_SHIP][horizontal ? 1 : 0];
+}
+
+void bitboard_fleet_clear(bitboard_fleet_t *fleet)
+{
+    memset(fleet, 0, sizeof(bitboard_fleet_t));
+}
+
+bool bitboard_fleet_can_place(const bitboard_fleet_t *fleet, uint8_t length, bool horizontal, uint8_t col, uint8_t row)
+{
+    bitboard_t mask = bitboard_ship_mask(length, horizontal, col, row);
+
+    return !bitboard_is_empty(mask) && bitboard_is_empty(bitboard_and(mask, fleet->occupied));
+}
+
+bool bitboard_fleet_place(bitboard_fleet_t *fleet, uint8_t id, uint8_t length, bool horizontal, uint8_t col, uint8_t row)
+{
+    bitboard_t mask = bitboard_ship_mask(length, horizontal, col, row);
+    bitboard_t others;
+
+    if (id == 0 || id > BITBOARD_SHIPS || bitboard_is_empty(mask))
+    {
+        return false;
+    }
+
+    // A ship placed before is replaced, so it may overlap its old position
+    others = bitboard_andnot(fleet->occupied, fleet->ships[id - 1]);
+    if (!bitboard_is_empty(bitboard_and(mask, others)))
+    {
+        return false;
+    }
+
+    fleet->ships[id - 1] = mask;
+    fleet->occupied = bitboard_or(others, mask);
+    return true;
+}
+
+uint8_t bitboard_fleet_ship_at(const bitboard_fleet_t *fleet, uint8_t col, uint8_t row)
+{
+    uint8_t index = BITBOARD_INDEX(col, row);
+
+    if (col >= BITBOARD_SIZE || row >= BITBOARD_SIZE || !bitboard_test(fleet->occupied, index))
+    {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < BITBOARD_SHIPS; i++)
+    {
+        if (bitboard_test(fleet->ships[i], index))
+        {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+bool bitboard_fleet_is_sunk(const bitboard_fleet_t *fleet, uint8_t id)
+{
+    if (id == 0 || id > BITBOARD_SHIPS || bitboard_is_empty(fleet->ships[id - 1]))
+    {
+        return false;
+    }
+
+    return bitboard_is_empty(bitboard_andnot(fleet->ships[id - 1], fleet->shots));
+}
+
+bool bitboard_fleet_all_sunk(const bitboard_fleet_t *fleet)
+{
+    return !bitboard_is_empty(fleet->occupied) && bitboard_is_empty(bitboard_andnot(fleet->occupied, fleet->shots));
+}
+
+bitboard_shot_t bitboard_fleet_fire(bitboard_fleet_t *fleet, uint8_t col, uint8_t row, uint8_t *id)
+{
+    uint8_t ship;
+
+    if (id != NULL)
+    {
+        *id = 0;
+    }
+
+    if (col >= BITBOARD_SIZE || row >= BITBOARD_SIZE)
+    {
+        return BITBOARD_SHOT_INVALID;
+    }
+
+    if (bitboard_test(fleet->shots, BITBOARD_INDEX(col, row)))
+    {
+        return BITBOARD_SHOT_REPEAT;
+    }
+
+    fleet->shots = bitboard_or(fleet->shots, bitboard_cell(BITBOARD_INDEX(col, row)));
+
+    ship = bitboard_fleet_ship_at(fleet, col, row);
+    if (id != NULL)
+    {
+        *id = ship;
+    }
+
+    if (ship == 0)
+    {
+        return BITBOARD_SHOT_MISS;
+    }
+
+    return bitboard_fleet_is_sunk(fleet, ship) ? BITBOARD_SHOT_SUNK : BITBOARD_SHOT_HIT;
+}
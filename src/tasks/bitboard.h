@@ -0,0 +1,159 @@
+/**
+ * @file bitboard.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * 100 cell battleship boards stored as bit masks
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __BITBOARD_H__
+#define __BITBOARD_H__
+
+// Plain C with no board or RTOS includes so the host tests in test/ can build it
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BITBOARD_SIZE 10
+#define BITBOARD_CELLS (BITBOARD_SIZE * BITBOARD_SIZE)
+#define BITBOARD_SHIPS 5
+#define BITBOARD_MIN_SHIP 2
+#define BITBOARD_MAX_SHIP 5
+#define BITBOARD_INDEX(col, row) ((uint8_t)((row) * BITBOARD_SIZE + (col)))
+
+// One layer of the board, bit row * 10 + col.  Cells 0-63 are in lo.
+typedef struct
+{
+    uint64_t lo;
+    uint64_t hi;
+} bitboard_t;
+
+// A player's ships and the shots fired at them
+typedef struct
+{
+    bitboard_t ships[BITBOARD_SHIPS]; // Cells of each ship, index is ship id - 1
+    bitboard_t occupied;              // Every ship cell
+    bitboard_t shots;                 // Every cell fired on
+} bitboard_fleet_t;
+
+typedef enum
+{
+    BITBOARD_SHOT_MISS,
+    BITBOARD_SHOT_HIT,
+    BITBOARD_SHOT_SUNK,
+    BITBOARD_SHOT_REPEAT, // Cell was already fired on
+    BITBOARD_SHOT_INVALID
+} bitboard_shot_t;
+
+static inline bitboard_t bitboard_and(bitboard_t a, bitboard_t b)
+{
+    return (bitboard_t){a.lo & b.lo, a.hi & b.hi};
+}
+
+static inline bitboard_t bitboard_or(bitboard_t a, bitboard_t b)
+{
+    return (bitboard_t){a.lo | b.lo, a.hi | b.hi};
+}
+
+static inline bitboard_t bitboard_andnot(bitboard_t a, bitboard_t b)
+{
+    return (bitboard_t){a.lo & ~b.lo, a.hi & ~b.hi};
+}
+
+static inline bool bitboard_is_empty(bitboard_t a)
+{
+    return (a.lo | a.hi) == 0;
+}
+
+static inline uint8_t bitboard_count(bitboard_t a)
+{
+    return (uint8_t)(__builtin_popcountll(a.lo) + __builtin_popcountll(a.hi));
+}
+
+static inline bitboard_t bitboard_cell(uint8_t index)
+{
+    return (index < 64) ? (bitboard_t){1ULL << index, 0} : (bitboard_t){0, 1ULL << (index - 64)};
+}
+
+static inline bool bitboard_test(bitboard_t a, uint8_t index)
+{
+    return (index < 64) ? ((a.lo >> index) & 1) : ((a.hi >> (index - 64)) & 1);
+}
+
+/**
+ * @brief
+ * Builds the table of ship masks.  Must be called before any other
+ * function in this file.
+ */
+void bitboard_init(void);
+
+/**
+ * @brief
+ * Returns the cells a ship of length covers with its bow at (col, row).
+ * The masks are precomputed for every length, orientation and origin.
+ * @param length BITBOARD_MIN_SHIP to BITBOARD_MAX_SHIP
+ * @param horizontal
+ * @param col
+ * @param row
+ * @return bitboard_t Empty if the ship would leave the board
+ */
+bitboard_t bitboard_ship_mask(uint8_t length, bool horizontal, uint8_t col, uint8_t row);
+
+/**
+ * @brief
+ * Returns the precomputed masks of a ship of length for every origin,
+ * indexed by BITBOARD_INDEX(col, row).  Origins that would put the ship
+ * off the board have an empty mask.
+ * @param length BITBOARD_MIN_SHIP to BITBOARD_MAX_SHIP
+ * @param horizontal
+ * @return const bitboard_t* BITBOARD_CELLS masks, NULL if length is invalid
+ */
+const bitboard_t *bitboard_ship_masks(uint8_t length, bool horizontal);
+
+void bitboard_fleet_clear(bitboard_fleet_t *fleet);
+
+/**
+ * @brief
+ * Returns true if the ship fits on the board without touching another
+ * ship
+ */
+bool bitboard_fleet_can_place(const bitboard_fleet_t *fleet, uint8_t length, bool horizontal, uint8_t col, uint8_t row);
+
+/**
+ * @brief
+ * Places ship id (1 to BITBOARD_SHIPS) if it fits
+ * @return true
+ * @return false if it leaves the board or overlaps another ship
+ */
+bool bitboard_fleet_place(bitboard_fleet_t *fleet, uint8_t id, uint8_t length, bool horizontal, uint8_t col, uint8_t row);
+
+/**
+ * @brief
+ * Records a shot at (col, row)
+ * @param fleet
+ * @param col
+ * @param row
+ * @param id Returns the id of the ship hit, 0 on a miss.  May be NULL.
+ * @return bitboard_shot_t
+ */
+bitboard_shot_t bitboard_fleet_fire(bitboard_fleet_t *fleet, uint8_t col, uint8_t row, uint8_t *id);
+
+/**
+ * @brief
+ * Returns the id (1 to BITBOARD_SHIPS) of the ship at (col, row), 0 if
+ * the cell is empty
+ */
+uint8_t bitboard_fleet_ship_at(const bitboard_fleet_t *fleet, uint8_t col, uint8_t row);
+
+bool bitboard_fleet_is_sunk(const bitboard_fleet_t *fleet, uint8_t id);
+
+/**
+ * @brief
+ * Returns true once every ship cell has been hit.  A fleet with no ships
+ * is not sunk.
+ */
+bool bitboard_fleet_all_sunk(const bitboard_fleet_t *fleet);
+
+#endif
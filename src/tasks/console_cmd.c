@@ -0,0 +1,393 @@
+/**
+ * @file console_cmd.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Registry and dispatcher for console commands
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "console_cmd.h"
+#include "task_console.h"
+#include <ctype.h>
+#include <string.h>
+
+/**
+ * @brief
+ * Commands are registered once at startup into an open-addressed hash
+ * table (FNV-1a over the lower case name, linear probing), so looking up
+ * a command costs one hash and usually a single string compare no matter
+ * how many commands exist.  Names match without regard to case, which
+ * replaces the separate "EEPROM"/"eeprom" compares.
+ *
+ * "batch <cmd>; <cmd>; ..." runs several commands from one line.  Replies
+ * from each command are collected and sent back as a single line with the
+ * per-command results separated by "; ".
+ *
+ * All functions in this file are called from the Console Rx task only.
+ */
+
+/* Global Variables */
+static const console_cmd_t *console_cmd_table[CONSOLE_CMD_TABLE_SIZE];
+
+// Reply collection for batch mode
+static bool batch_active = false;
+static char batch_response[CONSOLE_CMD_BATCH_SIZE];
+static uint16_t batch_length;
+static uint16_t batch_cmd_start; // Offset of the current command's replies
+
+/**
+ * @brief
+ * Computes the FNV-1a hash of a command name, ignoring case
+ * @param name
+ * @return uint32_t
+ */
+static uint32_t console_cmd_hash(const char *name)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*name != '\0')
+    {
+        hash ^= (uint8_t)tolower((unsigned char)*name++);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief
+ * Compares two command names without regard to case
+ * @param a
+ * @param b
+ * @return true
+ * @return false
+ */
+static bool console_cmd_name_equal(const char *a, const char *b)
+{
+    while (*a != '\0' && tolower((unsigned char)*a) == tolower((unsigned char)*b))
+    {
+        a++;
+        b++;
+    }
+
+    return (*a == '\0' && *b == '\0');
+}
+
+/**
+ * @brief
+ * Returns the command registered under name, or NULL
+ * @param name
+ * @return const console_cmd_t*
+ */
+static const console_cmd_t *console_cmd_find(const char *name)
+{
+    uint32_t slot = console_cmd_hash(name);
+
+    for (uint32_t i = 0; i < CONSOLE_CMD_TABLE_SIZE; i++)
+    {
+        const console_cmd_t *cmd = console_cmd_table[(slot + i) & (CONSOLE_CMD_TABLE_SIZE - 1)];
+
+        if (cmd == NULL)
+        {
+            return NULL; // Reached an empty slot, name is not registered
+        }
+        if (console_cmd_name_equal(cmd->name, name))
+        {
+            return cmd;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief
+ * Appends str to the batch response, truncating if the response is full
+ * @param str
+ */
+static void console_cmd_batch_append(const char *str)
+{
+    // Command replies leave room at the end for the batch summary
+    uint16_t limit = batch_active ? (CONSOLE_CMD_BATCH_SIZE - CONSOLE_CMD_BATCH_RESERVE) : (CONSOLE_CMD_BATCH_SIZE - 1);
+
+    while (*str != '\0' && batch_length < limit)
+    {
+        batch_response[batch_length++] = *str++;
+    }
+    batch_response[batch_length] = '\0';
+}
+
+/**
+ * @brief
+ * Tokenizes a single command and runs its handler
+ * @param line
+ * @return true
+ * @return false
+ */
+static bool console_cmd_run(char *line)
+{
+    char *argv[CONSOLE_CMD_MAX_ARGS];
+    const console_cmd_t *cmd;
+    console_cmd_status_t status = CONSOLE_CMD_USAGE;
+    int argc = 0;
+    char *token;
+
+    token = strtok(line, " ");
+    while (token != NULL && argc < CONSOLE_CMD_MAX_ARGS)
+    {
+        argv[argc++] = token;
+        token = strtok(NULL, " ");
+    }
+
+    if (argc == 0)
+    {
+        return true; // Blank command, nothing to do
+    }
+
+    cmd = console_cmd_find(argv[0]);
+    if (cmd == NULL)
+    {
+        console_cmd_reply("Unknown command: %s\r\n", argv[0]);
+        return false;
+    }
+
+    if (token == NULL && (argc - 1) >= cmd->min_args && (argc - 1) <= cmd->max_args)
+    {
+        status = cmd->handler(argc, argv);
+    }
+
+    if (status == CONSOLE_CMD_USAGE)
+    {
+        console_cmd_reply("Usage: %s %s\r\n", cmd->name, cmd->usage);
+    }
+
+    return (status == CONSOLE_CMD_OK);
+}
+
+/**
+ * @brief
+ * Runs each ';' separated command in cmds and sends all of the replies
+ * back to the console as one response
+ * @param cmds
+ * @return true if every command succeeded
+ * @return false
+ */
+static bool console_cmd_batch(char *cmds)
+{
+    uint16_t passed = 0;
+    uint16_t failed = 0;
+    char *next;
+    char summary[CONSOLE_CMD_BATCH_RESERVE];
+
+    batch_active = true;
+    batch_length = 0;
+    batch_response[0] = '\0';
+
+    for (char *cmd = cmds; cmd != NULL; cmd = next)
+    {
+        next = strchr(cmd, ';');
+        if (next != NULL)
+        {
+            *next++ = '\0';
+        }
+
+        while (*cmd == ' ')
+        {
+            cmd++;
+        }
+        if (*cmd == '\0')
+        {
+            continue;
+        }
+
+        if (batch_length > 0)
+        {
+            console_cmd_batch_append("; ");
+        }
+        batch_cmd_start = batch_length;
+
+        if (console_cmd_run(cmd))
+        {
+            passed++;
+
+            // Every command gets an entry in the response, even a silent one
+            if (batch_length == batch_cmd_start)
+            {
+                console_cmd_batch_append("OK");
+            }
+        }
+        else
+        {
+            failed++;
+        }
+    }
+
+    batch_active = false;
+
+    snprintf(summary, sizeof(summary), " [%u ok, %u failed]\r\n", passed, failed);
+    console_cmd_batch_append(summary);
+    task_console_write(batch_response);
+
+    return (failed == 0);
+}
+
+/**
+ * @brief
+ * Handler for the "help" command.  Lists every registered command.
+ * @param argc
+ * @param argv
+ * @return console_cmd_status_t
+ */
+static console_cmd_status_t console_cmd_help(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    for (uint32_t i = 0; i < CONSOLE_CMD_TABLE_SIZE; i++)
+    {
+        const console_cmd_t *cmd = console_cmd_table[i];
+
+        if (cmd != NULL)
+        {
+            console_cmd_reply("%-8s %s\r\n", cmd->name, (cmd->help != NULL) ? cmd->help : "");
+        }
+    }
+    console_cmd_reply("%-8s %s\r\n", "batch", "Run ';' separated commands");
+
+    return CONSOLE_CMD_OK;
+}
+
+static const console_cmd_t console_cmd_help_entry = {
+    .name = "help",
+    .handler = console_cmd_help,
+    .help = "List commands",
+    .usage = "",
+    .min_args = 0,
+    .max_args = 0,
+};
+
+/**
+ * @brief
+ * Clears the registry and registers the built in "help" command
+ * @return true
+ * @return false
+ */
+bool console_cmd_init(void)
+{
+    memset(console_cmd_table, 0, sizeof(console_cmd_table));
+
+    return console_cmd_register(&console_cmd_help_entry);
+}
+
+/**
+ * @brief
+ * Adds a command to the registry.  Must be called before the scheduler
+ * starts (or from the Console Rx task).  The descriptor must remain valid
+ * for the life of the program.
+ * @param cmd
+ * @return true
+ * @return false if the name is already registered or the table is full
+ */
+bool console_cmd_register(const console_cmd_t *cmd)
+{
+    uint32_t slot;
+
+    if (cmd == NULL || cmd->name == NULL || cmd->handler == NULL || cmd->usage == NULL)
+    {
+        return false;
+    }
+
+    if (console_cmd_find(cmd->name) != NULL)
+    {
+        return false;
+    }
+
+    slot = console_cmd_hash(cmd->name);
+    for (uint32_t i = 0; i < CONSOLE_CMD_TABLE_SIZE; i++)
+    {
+        uint32_t index = (slot + i) & (CONSOLE_CMD_TABLE_SIZE - 1);
+
+        if (console_cmd_table[index] == NULL)
+        {
+            console_cmd_table[index] = cmd;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief
+ * Executes a line received from the console.  The line is modified.
+ * @param line
+ * @return true
+ * @return false
+ */
+bool console_cmd_execute(char *line)
+{
+    while (*line == ' ')
+    {
+        line++;
+    }
+
+    // Move past the echoed line before printing any results
+    printf("\r\n");
+
+    // "batch" is matched without regard to case, like the registered names
+    if (strlen(line) > 5 && line[5] == ' ')
+    {
+        char name[6];
+
+        memcpy(name, line, 5);
+        name[5] = '\0';
+        if (console_cmd_name_equal(name, "batch"))
+        {
+            return console_cmd_batch(line + 6);
+        }
+    }
+
+    return console_cmd_run(line);
+}
+
+/**
+ * @brief
+ * Prints the result of a command.  Handlers use this instead of
+ * task_console_printf so their output can be collected in batch mode.
+ * A reply is cut at CONSOLE_MAX_MESSAGE_LENGTH - 1 characters, line ending
+ * included, so a handler splits anything longer into several replies.
+ *
+ * @param str_ptr Pointer to the format string.
+ * @param ...     Additional arguments for formatting.
+ */
+void console_cmd_reply(char *str_ptr, ...)
+{
+    static char reply[CONSOLE_MAX_MESSAGE_LENGTH];
+    va_list args;
+
+    va_start(args, str_ptr);
+    vsnprintf(reply, sizeof(reply), str_ptr, args);
+    va_end(args);
+
+    if (!batch_active)
+    {
+        task_console_printf("%s", reply);
+        return;
+    }
+
+    // Strip the line ending, batch replies are joined into a single line
+    reply[strcspn(reply, "\r\n")] = '\0';
+
+    if (batch_length > batch_cmd_start)
+    {
+        console_cmd_batch_append(", ");
+    }
+    console_cmd_batch_append(reply);
+}
+#endif
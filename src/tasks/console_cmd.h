@@ -0,0 +1,54 @@
+/**
+ * @file console_cmd.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Registry and dispatcher for console commands
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef CONSOLE_CMD_H
+#define CONSOLE_CMD_H
+
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+
+#define CONSOLE_CMD_TABLE_SIZE 32    // Hash table slots, must be a power of 2
+#define CONSOLE_CMD_MAX_ARGS 8       // Max tokens (including the command name)
+#define CONSOLE_CMD_BATCH_SIZE 256   // Max length of a batch response
+#define CONSOLE_CMD_BATCH_RESERVE 32 // Space kept for the batch summary
+
+typedef enum
+{
+    CONSOLE_CMD_OK,     // Command completed
+    CONSOLE_CMD_FAILED, // Command was valid but the operation failed
+    CONSOLE_CMD_USAGE   // Arguments were invalid, print the usage string
+} console_cmd_status_t;
+
+/**
+ * @brief
+ * Command handler.  argv[0] is the command name and argc is guaranteed to
+ * be within the min_args/max_args range from the command descriptor.
+ */
+typedef console_cmd_status_t (*console_cmd_handler_t)(int argc, char *argv[]);
+
+typedef struct
+{
+    const char *name;              // Command name, matched without regard to case
+    console_cmd_handler_t handler; // Function that executes the command
+    const char *help;              // One line description used by "help"
+    const char *usage;             // Argument schema, e.g. "r <address>"
+    uint8_t min_args;              // Minimum number of arguments after the name
+    uint8_t max_args;              // Maximum number of arguments after the name
+} console_cmd_t;
+
+bool console_cmd_init(void);
+bool console_cmd_register(const console_cmd_t *cmd);
+bool console_cmd_execute(char *line);
+void console_cmd_reply(char *str_ptr, ...);
+
+#endif
+#endif /* CONSOLE_CMD_H */
@@ -0,0 +1,70 @@
+/**
+ * @file console_line.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Assembles console command lines from received bytes
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "console_line.h"
+#include <stddef.h>
+
+/**
+ * @brief
+ * The console Rx line task feeds every byte taken from the Rx ring through
+ * console_line_put() and queues the lines it returns.  Keeping the
+ * assembler free of FreeRTOS lets test/test_console_line.c push the same
+ * back-to-back input through it on the host.
+ */
+
+void console_line_init(console_line_t *assembler, char *buffer, uint16_t size)
+{
+    assembler->line = buffer;
+    assembler->size = size;
+    assembler->index = 0;
+    assembler->discard = false;
+    assembler->overflows = 0;
+}
+
+const char *console_line_put(console_line_t *assembler, char c)
+{
+    if (c == '\b' || c == 0x7F)
+    {
+        if (assembler->index > 0 && !assembler->discard)
+        {
+            assembler->index--;
+        }
+        return NULL;
+    }
+
+    if (c == '\n' || c == '\r')
+    {
+        bool complete = !assembler->discard && assembler->index != 0;
+
+        assembler->line[assembler->index] = '\0';
+        assembler->discard = false;
+        assembler->index = 0;
+        return complete ? assembler->line : NULL;
+    }
+
+    if (assembler->discard)
+    {
+        // Skip the rest of a line that was too long
+        return NULL;
+    }
+
+    if (assembler->index < assembler->size - 1)
+    {
+        assembler->line[assembler->index++] = c;
+    }
+    else
+    {
+        assembler->overflows++;
+        assembler->discard = true;
+    }
+
+    return NULL;
+}
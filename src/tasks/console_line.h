@@ -0,0 +1,51 @@
+/**
+ * @file console_line.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Assembles console command lines from received bytes
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __CONSOLE_LINE_H__
+#define __CONSOLE_LINE_H__
+
+// Plain C with no board or RTOS includes so the host tests in test/ can
+// build it
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+    char *line;
+    uint16_t size;      // Bytes in line, including the NULL
+    uint16_t index;     // Characters received for the current line
+    bool discard;       // Skipping the rest of a line that was too long
+    uint32_t overflows; // Lines dropped for being longer than size - 1
+} console_line_t;
+
+/**
+ * @brief
+ * Starts with an empty line
+ * @param assembler
+ * @param buffer Holds the line being assembled
+ * @param size Bytes in buffer, including the NULL
+ */
+void console_line_init(console_line_t *assembler, char *buffer, uint16_t size);
+
+/**
+ * @brief
+ * Adds one received character.  '\r' or '\n' ends a line, so "\r\n" gives
+ * a single line; empty lines are ignored.  Backspace and DEL remove the
+ * last character.  A line longer than size - 1 is dropped whole and
+ * counted in overflows.
+ * @param assembler
+ * @param c
+ * @return const char* The completed line, valid until the next call.  NULL
+ * if c did not complete a line.
+ */
+const char *console_line_put(console_line_t *assembler, char c);
+
+#endif
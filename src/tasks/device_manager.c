@@ -0,0 +1,241 @@
+/**
+ * @file device_manager.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Routes device requests to their gatekeeper tasks and hands out pooled
+ * response mailboxes
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "device_manager.h"
+#include <string.h>
+
+/**
+ * @brief
+ * Each gatekeeper registers its request queue here, so a requester only
+ * names the device.  Responses come back through mailboxes taken from a
+ * pool created once before the scheduler starts.  A task is given the same
+ * mailbox every time it asks, so no task needs to create (or remember to
+ * delete) a response queue of its own and the heap stays flat however many
+ * games are played.
+ *
+ * Every request that expects a response is tagged with a new id, and the
+ * gatekeeper copies the id into its response.  If a request times out, its
+ * response may still arrive later.  The next request from that task sees
+ * the old id and discards the response instead of taking it as its own.
+ * Gatekeepers never block on a full mailbox; the response is dropped and
+ * counted instead.
+ */
+
+typedef struct
+{
+    TaskHandle_t owner;
+    QueueHandle_t queue;
+} device_mailbox_t;
+
+/* Global Variables */
+static QueueHandle_t Device_Routes[DEVICE_UNKNOWN];
+static device_mailbox_t Device_Mailboxes[DEVICE_MAILBOX_COUNT];
+static uint16_t Device_Request_Id = 0;
+static device_manager_stats_t Device_Manager_Stats;
+
+/**
+ * @brief
+ * Returns a new request id.  Zero is never used so an untagged response
+ * can not match.
+ */
+static uint16_t device_request_id_next(void)
+{
+    uint16_t id;
+
+    taskENTER_CRITICAL();
+    if (++Device_Request_Id == 0)
+    {
+        Device_Request_Id = 1;
+    }
+    id = Device_Request_Id;
+    taskEXIT_CRITICAL();
+
+    return id;
+}
+
+bool device_manager_register(device_type_t device, QueueHandle_t requests)
+{
+    if (device >= DEVICE_UNKNOWN || requests == NULL)
+    {
+        return false;
+    }
+
+    Device_Routes[device] = requests;
+    return true;
+}
+
+QueueHandle_t device_mailbox(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    device_mailbox_t *free_mailbox = NULL;
+    QueueHandle_t queue = NULL;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < DEVICE_MAILBOX_COUNT; i++)
+    {
+        if (Device_Mailboxes[i].queue == NULL)
+        {
+            continue;
+        }
+
+        if (Device_Mailboxes[i].owner == self)
+        {
+            queue = Device_Mailboxes[i].queue;
+            break;
+        }
+
+        if (Device_Mailboxes[i].owner == NULL && free_mailbox == NULL)
+        {
+            free_mailbox = &Device_Mailboxes[i];
+        }
+    }
+
+    if (queue == NULL && free_mailbox != NULL)
+    {
+        free_mailbox->owner = self;
+        queue = free_mailbox->queue;
+
+        if (++Device_Manager_Stats.mailboxes_in_use > Device_Manager_Stats.mailboxes_high_water)
+        {
+            Device_Manager_Stats.mailboxes_high_water = Device_Manager_Stats.mailboxes_in_use;
+        }
+    }
+    else if (queue == NULL)
+    {
+        Device_Manager_Stats.mailbox_failures++;
+    }
+    taskEXIT_CRITICAL();
+
+    return queue;
+}
+
+void device_mailbox_release(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    for (uint8_t i = 0; i < DEVICE_MAILBOX_COUNT; i++)
+    {
+        if (Device_Mailboxes[i].owner == self)
+        {
+            // Drop any late response so the next owner starts empty
+            xQueueReset(Device_Mailboxes[i].queue);
+
+            taskENTER_CRITICAL();
+            Device_Mailboxes[i].owner = NULL;
+            Device_Manager_Stats.mailboxes_in_use--;
+            taskEXIT_CRITICAL();
+            return;
+        }
+    }
+}
+
+bool device_request(device_request_msg_t *request, device_response_msg_t *response, TickType_t timeout)
+{
+    QueueHandle_t requests;
+    TimeOut_t time_out;
+
+    if (request == NULL || request->device >= DEVICE_UNKNOWN)
+    {
+        return false;
+    }
+
+    requests = Device_Routes[request->device];
+    if (requests == NULL)
+    {
+        return false;
+    }
+
+    request->request_id = (request->response_queue != NULL) ? device_request_id_next() : 0;
+
+    if (xQueueSend(requests, request, portMAX_DELAY) != pdTRUE)
+    {
+        return false;
+    }
+    Device_Manager_Stats.requests++;
+
+    // Fire and forget
+    if (request->response_queue == NULL)
+    {
+        return true;
+    }
+
+    vTaskSetTimeOutState(&time_out);
+    while (xQueueReceive(request->response_queue, response, timeout) == pdTRUE)
+    {
+        if (response->request_id == request->request_id)
+        {
+            return true;
+        }
+
+        // Answer to an earlier request that gave up waiting
+        Device_Manager_Stats.stale_responses++;
+
+        if (xTaskCheckForTimeOut(&time_out, &timeout) == pdTRUE)
+        {
+            break;
+        }
+    }
+
+    Device_Manager_Stats.timeouts++;
+    return false;
+}
+
+void device_respond(const device_request_msg_t *request, device_response_msg_t *response)
+{
+    if (request->response_queue != NULL)
+    {
+        response->request_id = request->request_id;
+
+        // Full only with the answers to requests that timed out.  The
+        // requester then times out too, rather than every other client of
+        // this gatekeeper waiting on it.
+        if (xQueueSend(request->response_queue, response, 0) != pdTRUE)
+        {
+            Device_Manager_Stats.dropped_responses++;
+        }
+    }
+}
+
+bool device_manager_get_stats(device_manager_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    memcpy(stats, &Device_Manager_Stats, sizeof(device_manager_stats_t));
+    taskEXIT_CRITICAL();
+
+    return true;
+}
+
+bool device_manager_init(void)
+{
+    for (uint8_t i = 0; i < DEVICE_MAILBOX_COUNT; i++)
+    {
+        if (Device_Mailboxes[i].queue == NULL)
+        {
+            Device_Mailboxes[i].queue = xQueueCreate(DEVICE_MAILBOX_LENGTH, sizeof(device_response_msg_t));
+            if (Device_Mailboxes[i].queue == NULL)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file device_manager.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Routes device requests to their gatekeeper tasks and hands out pooled
+ * response mailboxes
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __DEVICE_MANAGER_H__
+#define __DEVICE_MANAGER_H__
+
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "drivers.h"
+#include "devices.h"
+
+#define DEVICE_MAILBOX_COUNT 8  // Tasks that can hold a mailbox at once
+#define DEVICE_MAILBOX_LENGTH 2 // Room for a late response plus the current one
+
+// Counters describing the device manager since it was initialized
+typedef struct
+{
+    uint32_t requests;           // Requests routed to a gatekeeper
+    uint32_t timeouts;           // Requests whose response did not arrive in time
+    uint32_t stale_responses;    // Late responses discarded by a later request
+    uint32_t dropped_responses;  // Responses not sent because the mailbox was full
+    uint32_t mailbox_failures;   // device_mailbox() calls with the pool exhausted
+    uint8_t mailboxes_in_use;
+    uint8_t mailboxes_high_water;
+} device_manager_stats_t;
+
+/**
+ * @brief
+ * Creates the mailbox pool.  Must be called before the scheduler starts.
+ * The mailboxes are never deleted, so heap use does not grow as tasks come
+ * and go.
+ * @return true
+ * @return false
+ */
+bool device_manager_init(void);
+
+/**
+ * @brief
+ * Records the request queue of the gatekeeper task for device.  Called by
+ * each gatekeeper's resources init function.
+ * @param device
+ * @param requests
+ * @return true
+ * @return false
+ */
+bool device_manager_register(device_type_t device, QueueHandle_t requests);
+
+/**
+ * @brief
+ * Returns the calling task's response mailbox, taking one from the pool on
+ * the first call.  A task keeps the same mailbox until it calls
+ * device_mailbox_release().
+ * @return QueueHandle_t, NULL if the pool is exhausted
+ */
+QueueHandle_t device_mailbox(void);
+
+/**
+ * @brief
+ * Returns the calling task's mailbox to the pool.  Only needed by tasks
+ * that are about to delete themselves.
+ */
+void device_mailbox_release(void);
+
+/**
+ * @brief
+ * Sends request to the gatekeeper for request->device.  If
+ * request->response_queue is NULL the function returns once the request
+ * is queued.  Otherwise the request is tagged with a new id and the
+ * function waits up to timeout for the response carrying that id.
+ * Responses left over from earlier requests that timed out are discarded.
+ * @param request
+ * @param response
+ * @param timeout
+ * @return true
+ * @return false if no gatekeeper is registered or the response timed out
+ */
+bool device_request(device_request_msg_t *request, device_response_msg_t *response, TickType_t timeout);
+
+/**
+ * @brief
+ * Used by the gatekeeper tasks to answer request.  Copies the request id
+ * into response and sends it if the requester supplied a queue.  Never
+ * blocks: a mailbox still full of answers nobody waited for drops the
+ * response, so a slow requester cannot stall the gatekeeper.
+ * @param request
+ * @param response
+ */
+void device_respond(const device_request_msg_t *request, device_response_msg_t *response);
+
+bool device_manager_get_stats(device_manager_stats_t *stats);
+
+#endif
+#endif
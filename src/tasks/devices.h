@@ -27,7 +27,12 @@ typedef enum
 typedef enum
 {
     DEVICE_OP_READ,
-    DEVICE_OP_WRITE
+    DEVICE_OP_WRITE,
+    DEVICE_OP_READ_BLOCK,
+    DEVICE_OP_WRITE_BLOCK,
+    DEVICE_OP_STREAM_START,
+    DEVICE_OP_STREAM_STOP,
+    DEVICE_OP_SYNC
 } device_operation_t;
 
 typedef enum
@@ -44,7 +49,10 @@ typedef struct
     device_operation_t operation;
     uint16_t address;
     uint8_t value;
+    uint8_t *buffer;  // Data buffer for block operations
+    uint16_t length;  // Number of bytes for block operations
     QueueHandle_t response_queue;
+    uint16_t request_id; // Set by device_request(), echoed in the response
 } device_request_msg_t;
 
 // Data structure for receiving data from the device gatekeeper tasks
@@ -52,6 +60,7 @@ typedef struct
 {
     device_type_t device;
     device_operation_status_t status;
+    uint16_t request_id; // Id of the request being answered
     union
     {
         float temperature;
@@ -62,21 +71,5 @@ typedef struct
     } payload;
 } device_response_msg_t;
 
-/* Legacy EX13 interface definitions */
-typedef enum
-{
-    TEMP_SENSOR_READ,
-    TEMP_SENSOR_RESPONSE
-} temp_sensor_operation_t;
-
-typedef struct
-{
-    temp_sensor_operation_t operation;
-    QueueHandle_t return_queue;
-    float value;
-} temp_sensor_packet_t;
-
-extern QueueHandle_t Queue_Temp_Sensor_Responses;
-
 #endif
 #endif /* __DEVICES_H__ */
\ No newline at end of file
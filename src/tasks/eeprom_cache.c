@@ -0,0 +1,246 @@
+/**
+ * @file eeprom_cache.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Write-back cache of EEPROM pages
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "eeprom_cache.h"
+#include <string.h>
+
+/**
+ * @brief
+ * Writes go to EEPROM_CACHE_LINES pages in RAM instead of straight to the
+ * device.  A write that does not change the cached data is dropped.
+ * Changed bytes are marked dirty and written back as one page write when
+ * the line has been dirty for flush_ticks, when the line is evicted, or
+ * when the owner flushes everything.  Reads are served from cached pages,
+ * so a read always returns the newest data.
+ *
+ * A line taken for a full page write is not read from the device first,
+ * so it holds nothing to compare against and the whole page is marked
+ * dirty.
+ */
+
+/**
+ * @brief
+ * Returns the cache line holding page, or NULL
+ * @param cache
+ * @param page
+ * @return eeprom_cache_line_t*
+ */
+static eeprom_cache_line_t *eeprom_cache_find(eeprom_cache_t *cache, uint16_t page)
+{
+    for (int i = 0; i < EEPROM_CACHE_LINES; i++)
+    {
+        if (cache->lines[i].valid && cache->lines[i].page == page)
+        {
+            cache->lines[i].last_used = cache->now();
+            return &cache->lines[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief
+ * Writes the dirty bytes of a line to the EEPROM with one page write
+ * @param cache
+ * @param line
+ */
+static void eeprom_cache_flush_line(eeprom_cache_t *cache, eeprom_cache_line_t *line)
+{
+    uint16_t length = line->dirty_end - line->dirty_start;
+
+    if (length == 0)
+    {
+        return;
+    }
+
+    cache->write(line->page * EEPROM_CACHE_PAGE_SIZE + line->dirty_start, &line->data[line->dirty_start], length);
+
+    cache->stats.flushes++;
+    cache->stats.bytes_flushed += length;
+    line->dirty_start = 0;
+    line->dirty_end = 0;
+}
+
+/**
+ * @brief
+ * Loads page into the least recently used line, flushing the line first if
+ * it is dirty.  The page is not read when the caller is about to overwrite
+ * all of it, and the line then still holds the evicted page's data.
+ * @param cache
+ * @param page
+ * @param fill
+ * @return eeprom_cache_line_t*
+ */
+static eeprom_cache_line_t *eeprom_cache_alloc(eeprom_cache_t *cache, uint16_t page, bool fill)
+{
+    eeprom_cache_line_t *line = &cache->lines[0];
+
+    for (int i = 0; i < EEPROM_CACHE_LINES; i++)
+    {
+        if (!cache->lines[i].valid)
+        {
+            line = &cache->lines[i];
+            break;
+        }
+        if ((uint32_t)(cache->lines[i].last_used - line->last_used) > (UINT32_MAX / 2))
+        {
+            line = &cache->lines[i]; // Used longer ago
+        }
+    }
+
+    if (line->valid)
+    {
+        eeprom_cache_flush_line(cache, line);
+    }
+
+    if (fill)
+    {
+        cache->read(page * EEPROM_CACHE_PAGE_SIZE, line->data, EEPROM_CACHE_PAGE_SIZE);
+    }
+
+    line->page = page;
+    line->valid = true;
+    line->dirty_start = 0;
+    line->dirty_end = 0;
+    line->last_used = cache->now();
+    return line;
+}
+
+void eeprom_cache_read(eeprom_cache_t *cache, uint16_t address, uint8_t *data, uint16_t length, bool allocate)
+{
+    while (length > 0)
+    {
+        uint16_t offset = address % EEPROM_CACHE_PAGE_SIZE;
+        uint16_t chunk = (length < EEPROM_CACHE_PAGE_SIZE - offset) ? length : EEPROM_CACHE_PAGE_SIZE - offset;
+        eeprom_cache_line_t *line = eeprom_cache_find(cache, address / EEPROM_CACHE_PAGE_SIZE);
+
+        if (line == NULL && allocate)
+        {
+            line = eeprom_cache_alloc(cache, address / EEPROM_CACHE_PAGE_SIZE, true);
+            cache->stats.read_misses++;
+        }
+        else if (line == NULL)
+        {
+            // Read the rest of the block directly up to the next cached page
+            uint16_t direct = chunk;
+
+            while (direct < length && eeprom_cache_find(cache, (address + direct) / EEPROM_CACHE_PAGE_SIZE) == NULL)
+            {
+                direct += (length - direct < EEPROM_CACHE_PAGE_SIZE) ? (length - direct) : EEPROM_CACHE_PAGE_SIZE;
+            }
+            cache->read(address, data, direct);
+            cache->stats.read_misses++;
+
+            address += direct;
+            data += direct;
+            length -= direct;
+            continue;
+        }
+        else
+        {
+            cache->stats.read_hits++;
+        }
+
+        memcpy(data, &line->data[offset], chunk);
+        address += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void eeprom_cache_write(eeprom_cache_t *cache, uint16_t address, const uint8_t *data, uint16_t length)
+{
+    cache->stats.writes++;
+
+    while (length > 0)
+    {
+        uint16_t offset = address % EEPROM_CACHE_PAGE_SIZE;
+        uint16_t chunk = (length < EEPROM_CACHE_PAGE_SIZE - offset) ? length : EEPROM_CACHE_PAGE_SIZE - offset;
+        eeprom_cache_line_t *line = eeprom_cache_find(cache, address / EEPROM_CACHE_PAGE_SIZE);
+        bool filled = true;
+
+        if (line == NULL)
+        {
+            filled = (chunk != EEPROM_CACHE_PAGE_SIZE);
+            line = eeprom_cache_alloc(cache, address / EEPROM_CACHE_PAGE_SIZE, filled);
+        }
+
+        if (filled && memcmp(&line->data[offset], data, chunk) == 0)
+        {
+            cache->stats.writes_dropped++;
+        }
+        else
+        {
+            memcpy(&line->data[offset], data, chunk);
+
+            if (line->dirty_end == 0)
+            {
+                line->dirty_start = offset;
+                line->dirty_end = offset + chunk;
+                line->dirty_since = cache->now();
+            }
+            else
+            {
+                line->dirty_start = (offset < line->dirty_start) ? offset : line->dirty_start;
+                line->dirty_end = (offset + chunk > line->dirty_end) ? offset + chunk : line->dirty_end;
+            }
+
+            if (cache->write_through)
+            {
+                eeprom_cache_flush_line(cache, line);
+            }
+        }
+
+        address += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void eeprom_cache_flush(eeprom_cache_t *cache, bool all)
+{
+    uint32_t now = cache->now();
+
+    for (int i = 0; i < EEPROM_CACHE_LINES; i++)
+    {
+        eeprom_cache_line_t *line = &cache->lines[i];
+
+        if (line->dirty_end != 0 && (all || (now - line->dirty_since) >= cache->flush_ticks))
+        {
+            eeprom_cache_flush_line(cache, line);
+        }
+    }
+}
+
+uint32_t eeprom_cache_next_flush(const eeprom_cache_t *cache)
+{
+    uint32_t now = cache->now();
+    uint32_t wait = EEPROM_CACHE_CLEAN;
+
+    for (int i = 0; i < EEPROM_CACHE_LINES; i++)
+    {
+        const eeprom_cache_line_t *line = &cache->lines[i];
+
+        if (line->dirty_end != 0)
+        {
+            uint32_t age = now - line->dirty_since;
+            uint32_t left = (age >= cache->flush_ticks) ? 0 : cache->flush_ticks - age;
+
+            if (left < wait)
+            {
+                wait = left;
+            }
+        }
+    }
+
+    return wait;
+}
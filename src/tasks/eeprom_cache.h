@@ -0,0 +1,101 @@
+/**
+ * @file eeprom_cache.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Write-back cache of EEPROM pages
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __EEPROM_CACHE_H__
+#define __EEPROM_CACHE_H__
+
+// Plain C with no board or RTOS includes so the host tests in test/ can build it
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EEPROM_CACHE_PAGE_SIZE 64             // EEPROM_PAGE_SIZE
+#define EEPROM_CACHE_LINES 8                  // Pages held in RAM
+#define EEPROM_CACHE_CLEAN UINT32_MAX         // eeprom_cache_next_flush() with no dirty line
+
+// Counters describing the EEPROM cache since startup
+typedef struct
+{
+    uint32_t read_hits;       // Reads served from RAM
+    uint32_t read_misses;     // Reads that went to the EEPROM
+    uint32_t writes;          // Write requests
+    uint32_t writes_dropped;  // Writes that matched the cached data
+    uint32_t flushes;         // Page writes (write cycles) issued
+    uint32_t bytes_flushed;
+    uint32_t brownouts;       // Low voltage events, counted by the owner
+} eeprom_cache_stats_t;
+
+// One EEPROM page held in RAM
+typedef struct
+{
+    uint16_t page;            // EEPROM address / EEPROM_CACHE_PAGE_SIZE
+    bool valid;
+    uint8_t dirty_start;      // Dirty bytes are data[dirty_start] to data[dirty_end - 1]
+    uint8_t dirty_end;        // 0 when the line is clean
+    uint32_t dirty_since;     // Tick of the first write since the last flush
+    uint32_t last_used;
+    uint8_t data[EEPROM_CACHE_PAGE_SIZE];
+} eeprom_cache_line_t;
+
+// The cache and the device behind it.  read, write, now and flush_ticks
+// must be set before the first access.  write never crosses a page.
+typedef struct
+{
+    void (*read)(uint16_t address, uint8_t *data, uint16_t length);
+    void (*write)(uint16_t address, const uint8_t *data, uint16_t length);
+    uint32_t (*now)(void);                 // Current tick
+    uint32_t flush_ticks;                  // Longest a line stays dirty
+    volatile bool write_through;           // Flush every write at once, may be set from an interrupt
+    eeprom_cache_line_t lines[EEPROM_CACHE_LINES];
+    eeprom_cache_stats_t stats;
+} eeprom_cache_t;
+
+/**
+ * @brief
+ * Reads a block, taking cached pages from RAM.  Missed pages are read
+ * from the EEPROM and, if allocate is true, kept in the cache.
+ * @param cache
+ * @param address
+ * @param data
+ * @param length
+ * @param allocate
+ */
+void eeprom_cache_read(eeprom_cache_t *cache, uint16_t address, uint8_t *data, uint16_t length, bool allocate);
+
+/**
+ * @brief
+ * Writes a block into the cache.  Bytes that already hold the new value
+ * are not marked dirty, so an unchanged write costs no write cycle.
+ * @param cache
+ * @param address
+ * @param data
+ * @param length
+ */
+void eeprom_cache_write(eeprom_cache_t *cache, uint16_t address, const uint8_t *data, uint16_t length);
+
+/**
+ * @brief
+ * Flushes every dirty line, or only the lines that have been dirty for
+ * flush_ticks when all is false
+ * @param cache
+ * @param all
+ */
+void eeprom_cache_flush(eeprom_cache_t *cache, bool all);
+
+/**
+ * @brief
+ * Returns the number of ticks until the oldest dirty line is due to be
+ * flushed
+ * @param cache
+ * @return uint32_t EEPROM_CACHE_CLEAN if every line is clean
+ */
+uint32_t eeprom_cache_next_flush(const eeprom_cache_t *cache);
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ * @file game_state.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Saves the battleship game state in the EEPROM key/value store
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "game_state.h"
+#include "kv_store.h"
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief
+ * The game state is packed into a record and split across several keys of
+ * the key/value store: the counters, then the boards in GAME_STATE_CHUNK
+ * byte pieces.  The store skips values that did not change, so a save
+ * after a shot only writes the counters and the board piece holding the
+ * cell that was fired on.  The puts usually land in the same EEPROM page,
+ * so the sync at the end costs a single write cycle.
+ */
+
+/* Global Variables */
+static SemaphoreHandle_t Semaphore_Game_State; // Serializes saves from different tasks
+static game_state_record_t game_state_record;
+
+/**
+ * @brief
+ * Saves or loads one part of the record
+ */
+static bool game_state_part(uint8_t key, void *data, uint8_t length, bool save)
+{
+    return save ? kv_store_put(key, data, length) : kv_store_get(key, data, length);
+}
+
+/**
+ * @brief
+ * Saves, or loads when save is false, every part of record
+ * @param record
+ * @param save
+ * @return true
+ * @return false
+ */
+static bool game_state_transfer(game_state_record_t *record, bool save)
+{
+    bool status = game_state_part(KV_KEY_GAME_COUNTERS, record, offsetof(game_state_record_t, occupied_board), save);
+
+    for (uint8_t i = 0; status && i < sizeof(record->occupied_board); i += GAME_STATE_CHUNK)
+    {
+        uint8_t length = (sizeof(record->occupied_board) - i < GAME_STATE_CHUNK) ? sizeof(record->occupied_board) - i : GAME_STATE_CHUNK;
+        status = game_state_part(KV_KEY_GAME_OCCUPIED + i / GAME_STATE_CHUNK, &record->occupied_board[i], length, save);
+    }
+
+    for (uint8_t i = 0; status && i < sizeof(record->opponent_board); i += GAME_STATE_CHUNK)
+    {
+        uint8_t length = (sizeof(record->opponent_board) - i < GAME_STATE_CHUNK) ? sizeof(record->opponent_board) - i : GAME_STATE_CHUNK;
+        status = game_state_part(KV_KEY_GAME_OPPONENT + i / GAME_STATE_CHUNK, &record->opponent_board[i], length, save);
+    }
+
+    return status;
+}
+
+bool game_state_init(void)
+{
+    Semaphore_Game_State = xSemaphoreCreateMutex();
+
+    return (Semaphore_Game_State != NULL);
+}
+
+bool game_state_save(const battleship_game_t *game)
+{
+    game_state_record_t *record = &game_state_record;
+    bool status;
+
+    xSemaphoreTake(Semaphore_Game_State, portMAX_DELAY);
+
+    memset(record, 0, sizeof(game_state_record_t));
+    record->player_id = game->player_id;
+    record->opponent_ships_remaining = game->opponent_ships_remaining;
+    memcpy(record->ship_hit_count, game->ship_hit_count, sizeof(record->ship_hit_count));
+    record->my_hits = game->my_hits;
+    record->my_misses = game->my_misses;
+    record->opponent_hits = game->opponent_hits;
+    record->opponent_misses = game->opponent_misses;
+
+    for (int i = 0; i < 100; i++)
+    {
+        uint8_t ship = battleship_game_ship_at(game, i % 10, i / 10) & 0x0F;
+        uint8_t shot = battleship_game_target_at(game, i % 10, i / 10) & 0x03;
+
+        record->occupied_board[i / 2] |= ship << ((i % 2) * 4);
+        record->opponent_board[i / 4] |= shot << ((i % 4) * 2);
+    }
+
+    status = game_state_transfer(record, true) && kv_store_sync();
+
+    xSemaphoreGive(Semaphore_Game_State);
+
+    return status;
+}
+
+bool game_state_load(game_state_record_t *record)
+{
+    bool status;
+
+    if (record == NULL)
+    {
+        return false;
+    }
+
+    xSemaphoreTake(Semaphore_Game_State, portMAX_DELAY);
+    status = game_state_transfer(record, false);
+    xSemaphoreGive(Semaphore_Game_State);
+
+    return status;
+}
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @file game_state.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Saves the battleship game state in the EEPROM key/value store
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __GAME_STATE_H__
+#define __GAME_STATE_H__
+
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "drivers.h"
+#include "battleship_engine.h"
+
+#define GAME_STATE_CHUNK 13 // Board bytes per key/value store entry
+
+// Game state as stored in the key/value store
+typedef struct
+{
+    // Counters, saved together under KV_KEY_GAME_COUNTERS
+    uint16_t my_hits;
+    uint16_t my_misses;
+    uint16_t opponent_hits;
+    uint16_t opponent_misses;
+    uint8_t player_id;
+    uint8_t opponent_ships_remaining;
+    uint8_t ship_hit_count[5];
+    // Boards, saved GAME_STATE_CHUNK bytes per key
+    uint8_t occupied_board[50]; // Ship id per nibble, two cells per byte
+    uint8_t opponent_board[25]; // 2 bits per cell, four cells per byte
+} game_state_record_t;
+
+bool game_state_init(void);
+
+/**
+ * @brief
+ * Writes the parts of the game state that changed since the last save.
+ * Blocks until they have been written.
+ * @param game
+ * @return true
+ * @return false
+ */
+bool game_state_save(const battleship_game_t *game);
+
+/**
+ * @brief
+ * Reads the saved record without applying it to the game
+ * @param record
+ * @return true if a valid record was found
+ * @return false
+ */
+bool game_state_load(game_state_record_t *record);
+
+#endif
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file i2c_queue.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Priority queues of pending I2C transactions
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "i2c_queue.h"
+#include <stddef.h>
+
+/**
+ * @brief
+ * The scheduling policy of the I2C engine in task_i2c.c.  Each priority
+ * has its own FIFO and a submission is refused when its FIFO is full.  The
+ * engine always takes the oldest transaction of the highest non-empty
+ * FIFO, so an urgent request waits behind at most the transfer already on
+ * the bus.  test/i2c_fake_bus_bench runs the same code on a fake bus.
+ */
+
+bool i2c_queue_valid(i2c_async_priority_t priority, const uint8_t *data, uint16_t length, bool write)
+{
+    return data != NULL && length != 0 && priority < I2C_ASYNC_PRIORITY_COUNT &&
+           !(write && length > I2C_ASYNC_MAX_WRITE);
+}
+
+bool i2c_queue_push(i2c_queue_t *queue, i2c_async_priority_t priority, void *txn)
+{
+    if (priority >= I2C_ASYNC_PRIORITY_COUNT || queue->count[priority] == I2C_ASYNC_QUEUE_LENGTH)
+    {
+        return false;
+    }
+
+    queue->txn[priority][(queue->head[priority] + queue->count[priority]) % I2C_ASYNC_QUEUE_LENGTH] = txn;
+    queue->count[priority]++;
+    return true;
+}
+
+void *i2c_queue_pop(i2c_queue_t *queue)
+{
+    for (int i = 0; i < I2C_ASYNC_PRIORITY_COUNT; i++)
+    {
+        if (queue->count[i] != 0)
+        {
+            void *txn = queue->txn[i][queue->head[i]];
+
+            queue->head[i] = (queue->head[i] + 1) % I2C_ASYNC_QUEUE_LENGTH;
+            queue->count[i]--;
+            return txn;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file i2c_queue.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Priority queues of pending I2C transactions
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __I2C_QUEUE_H__
+#define __I2C_QUEUE_H__
+
+// Plain C with no board or RTOS includes so the host tests in test/ can build it
+#include <stdbool.h>
+#include <stdint.h>
+
+#define I2C_ASYNC_QUEUE_LENGTH 8  // Pending transactions per priority level
+#define I2C_ASYNC_MAX_WRITE 16    // Max data bytes in one write transaction
+
+typedef enum
+{
+    I2C_ASYNC_PRIORITY_HIGH = 0,
+    I2C_ASYNC_PRIORITY_NORMAL,
+    I2C_ASYNC_PRIORITY_LOW,
+    I2C_ASYNC_PRIORITY_COUNT
+} i2c_async_priority_t;
+
+// One FIFO of I2C_ASYNC_QUEUE_LENGTH transactions per priority.  The
+// caller provides any locking.
+typedef struct
+{
+    void *txn[I2C_ASYNC_PRIORITY_COUNT][I2C_ASYNC_QUEUE_LENGTH];
+    uint8_t head[I2C_ASYNC_PRIORITY_COUNT];
+    uint8_t count[I2C_ASYNC_PRIORITY_COUNT];
+} i2c_queue_t;
+
+/**
+ * @brief
+ * Checks the arguments of a transaction before it is queued
+ * @param priority
+ * @param data
+ * @param length
+ * @param write
+ * @return true
+ * @return false if there is no data, the priority is unknown or a write is
+ * longer than I2C_ASYNC_MAX_WRITE
+ */
+bool i2c_queue_valid(i2c_async_priority_t priority, const uint8_t *data, uint16_t length, bool write);
+
+/**
+ * @brief
+ * Appends txn to the queue for priority
+ * @param queue
+ * @param priority
+ * @param txn
+ * @return true
+ * @return false if that queue is full
+ */
+bool i2c_queue_push(i2c_queue_t *queue, i2c_async_priority_t priority, void *txn);
+
+/**
+ * @brief
+ * Removes the oldest transaction of the highest priority queue that is not
+ * empty
+ * @param queue
+ * @return void* NULL if every queue is empty
+ */
+void *i2c_queue_pop(i2c_queue_t *queue);
+
+#endif
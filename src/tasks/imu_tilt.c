@@ -0,0 +1,241 @@
+/**
+ * @file imu_tilt.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Integer-only tilt estimation used to drive a cursor from the IMU
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "imu_tilt.h"
+
+/**
+ * @brief
+ * Each sample runs through the following stages, all in integer math:
+ *   1. IIR low-pass on the accelerometer to remove vibration noise
+ *   2. Tilt from the filtered accelerometer, atan2(a_axis, a_z)
+ *   3. Complementary filter: integrate the gyro rate for fast response,
+ *      pulled toward the accelerometer tilt to cancel gyro drift
+ *   4. Hysteresis: an axis starts moving above enter_cdeg and stops
+ *      below exit_cdeg, so noise near the threshold cannot chatter
+ *   5. Repeat: the first move is reported immediately, then repeats at
+ *      an interval that shrinks linearly as the tilt grows
+ *
+ * This file includes nothing from the board or RTOS and all timing is
+ * counted in samples, so test/imu_tilt_replay.c replays traces through it
+ * on the host with the same results as on the board.
+ */
+
+// Gyro sensitivity at +/-250 dps is 8.75 mdps/LSB = 0.875 centidegrees/s.
+// In Q8 that is 224 per LSB per second.
+#define IMU_TILT_GYRO_CDEG_Q8_PER_LSB 224
+
+/**
+ * @brief
+ * atan of a ratio in [0, 1] (Q15), in centidegrees
+ * @param r
+ * @return int32_t
+ */
+static int32_t imu_tilt_atan_unit(int32_t r)
+{
+    // atan(r) ~= 45r + 15.64r(1 - r) degrees for 0 <= r <= 1
+    int32_t linear = (4500 * r) >> 15;
+    int32_t curve = (1564 * ((r * (32768 - r)) >> 15)) >> 15;
+
+    return linear + curve;
+}
+
+int32_t imu_tilt_atan2(int32_t y, int32_t x)
+{
+    int32_t ax = (x < 0) ? -x : x;
+    int32_t ay = (y < 0) ? -y : y;
+    int32_t angle;
+
+    if (ax == 0 && ay == 0)
+    {
+        return 0;
+    }
+
+    // Reduce to the first octant so the ratio stays within [0, 1]
+    if (ay <= ax)
+    {
+        angle = imu_tilt_atan_unit((int32_t)(((int64_t)ay << 15) / ax));
+    }
+    else
+    {
+        angle = 9000 - imu_tilt_atan_unit((int32_t)(((int64_t)ax << 15) / ay));
+    }
+
+    if (x < 0)
+    {
+        angle = 18000 - angle;
+    }
+
+    return (y < 0) ? -angle : angle;
+}
+
+/**
+ * @brief
+ * Converts a repeat interval for the given tilt into a number of samples
+ * @param tilt
+ * @param magnitude
+ * @return uint32_t
+ */
+static uint32_t imu_tilt_repeat_samples(const imu_tilt_t *tilt, int32_t magnitude)
+{
+    const imu_tilt_config_t *config = &tilt->config;
+    int32_t ms = config->repeat_fast_ms;
+    uint32_t samples;
+
+    if (magnitude < config->full_cdeg && config->full_cdeg > config->enter_cdeg)
+    {
+        int32_t span = config->full_cdeg - config->enter_cdeg;
+        int32_t over = magnitude - config->enter_cdeg;
+
+        ms = config->repeat_slow_ms - ((config->repeat_slow_ms - config->repeat_fast_ms) * over) / span;
+    }
+
+    samples = ((uint32_t)ms * tilt->odr_hz) / 1000;
+    return (samples == 0) ? 1 : samples;
+}
+
+/**
+ * @brief
+ * Runs the hysteresis and repeat stages for one axis
+ * @param tilt
+ * @param axis
+ * @param raw_cdeg
+ * Unfiltered accelerometer tilt, only used to measure latency
+ * @return int8_t
+ * -1/+1 if a move is due, 0 otherwise
+ */
+static int8_t imu_tilt_axis_step(imu_tilt_t *tilt, imu_tilt_axis_t *axis, int32_t raw_cdeg)
+{
+    const imu_tilt_config_t *config = &tilt->config;
+    int32_t angle = axis->angle_q8 >> 8;
+    int32_t magnitude = (angle < 0) ? -angle : angle;
+    int8_t sign = (angle < 0) ? -1 : 1;
+    int8_t move = 0;
+
+    // Remember when the unfiltered tilt first crossed the threshold
+    if (axis->direction == 0 && !axis->crossed &&
+        ((raw_cdeg < 0) ? -raw_cdeg : raw_cdeg) >= config->enter_cdeg)
+    {
+        axis->crossed = true;
+        axis->crossed_at = tilt->sample_index;
+    }
+
+    if (axis->direction == 0)
+    {
+        if (magnitude >= config->enter_cdeg)
+        {
+            axis->direction = sign;
+            move = sign;
+
+            tilt->stats.starts++;
+            if (axis->crossed)
+            {
+                tilt->stats.latency_ms += ((tilt->sample_index - axis->crossed_at) * 1000) / tilt->odr_hz;
+            }
+        }
+    }
+    else if (magnitude < config->exit_cdeg || sign != axis->direction)
+    {
+        axis->direction = 0;
+        axis->crossed = false;
+    }
+    else if ((int32_t)(tilt->sample_index - axis->next_move) >= 0)
+    {
+        move = axis->direction;
+    }
+
+    if (move != 0)
+    {
+        uint32_t slow = ((uint32_t)config->repeat_slow_ms * tilt->odr_hz) / 1000;
+
+        tilt->stats.moves++;
+        if (axis->last_move == -move && (tilt->sample_index - axis->last_move_at) < slow)
+        {
+            tilt->stats.reversals++;
+        }
+
+        axis->last_move = move;
+        axis->last_move_at = tilt->sample_index;
+        axis->next_move = tilt->sample_index + imu_tilt_repeat_samples(tilt, magnitude);
+    }
+
+    return move;
+}
+
+void imu_tilt_init(imu_tilt_t *tilt, const imu_tilt_config_t *config, uint16_t odr_hz)
+{
+    *tilt = (imu_tilt_t){0};
+    tilt->config = *config;
+    tilt->odr_hz = (odr_hz == 0) ? 1 : odr_hz;
+}
+
+bool imu_tilt_update(imu_tilt_t *tilt, const imu_tilt_sample_t *sample, int8_t *dx, int8_t *dy)
+{
+    const int16_t raw[3] = {sample->x, sample->y, sample->z};
+    int32_t accel_cdeg[2];
+    int32_t raw_cdeg[2];
+    int32_t gyro_rate[2];
+
+    // 1. Low-pass the accelerometer
+    for (int i = 0; i < 3; i++)
+    {
+        int32_t in_q8 = (int32_t)raw[i] << 8;
+
+        if (!tilt->primed)
+        {
+            tilt->accel_q8[i] = in_q8;
+        }
+        else
+        {
+            tilt->accel_q8[i] += (in_q8 - tilt->accel_q8[i]) >> tilt->config.lpf_shift;
+        }
+    }
+
+    // 2. Accelerometer tilt.  Tilting about Y changes X, tilting about X changes Y.
+    accel_cdeg[IMU_TILT_AXIS_X] = imu_tilt_atan2(tilt->accel_q8[0], tilt->accel_q8[2]);
+    accel_cdeg[IMU_TILT_AXIS_Y] = imu_tilt_atan2(tilt->accel_q8[1], tilt->accel_q8[2]);
+    raw_cdeg[IMU_TILT_AXIS_X] = imu_tilt_atan2(sample->x, sample->z);
+    raw_cdeg[IMU_TILT_AXIS_Y] = imu_tilt_atan2(sample->y, sample->z);
+    gyro_rate[IMU_TILT_AXIS_X] = -sample->gy;
+    gyro_rate[IMU_TILT_AXIS_Y] = sample->gx;
+
+    // 3. Complementary filter
+    for (int i = 0; i < 2; i++)
+    {
+        imu_tilt_axis_t *axis = &tilt->axis[i];
+        int32_t accel_q8 = accel_cdeg[i] << 8;
+
+        if (!tilt->primed)
+        {
+            axis->angle_q8 = accel_q8;
+        }
+        else
+        {
+            int32_t gyro_q8 = axis->angle_q8 + (gyro_rate[i] * IMU_TILT_GYRO_CDEG_Q8_PER_LSB) / tilt->odr_hz;
+
+            axis->angle_q8 = (int32_t)(((int64_t)tilt->config.gyro_weight * gyro_q8 +
+                                        (int64_t)(256 - tilt->config.gyro_weight) * accel_q8) >> 8);
+        }
+    }
+    tilt->primed = true;
+
+    // 4 & 5. Hysteresis and repeat
+    *dx = imu_tilt_axis_step(tilt, &tilt->axis[IMU_TILT_AXIS_X], raw_cdeg[IMU_TILT_AXIS_X]);
+    *dy = imu_tilt_axis_step(tilt, &tilt->axis[IMU_TILT_AXIS_Y], raw_cdeg[IMU_TILT_AXIS_Y]);
+
+    tilt->sample_index++;
+
+    return (*dx != 0 || *dy != 0);
+}
+
+int16_t imu_tilt_angle(const imu_tilt_t *tilt, uint8_t axis)
+{
+    return (int16_t)(tilt->axis[axis].angle_q8 >> 8);
+}
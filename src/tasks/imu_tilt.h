@@ -0,0 +1,124 @@
+/**
+ * @file imu_tilt.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Integer-only tilt estimation used to drive a cursor from the IMU
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __IMU_TILT_H__
+#define __IMU_TILT_H__
+
+// Plain C with no board or RTOS includes so the host replay bench in test/
+// can build it
+#include <stdbool.h>
+#include <stdint.h>
+
+#define IMU_TILT_AXIS_X 0
+#define IMU_TILT_AXIS_Y 1
+
+// One accelerometer + gyroscope sample, in LSM6DSM LSBs (+/-2 g, +/-250 dps).
+// Same fields as imu_sample_t.
+typedef struct
+{
+    int16_t x; // Accelerometer
+    int16_t y;
+    int16_t z;
+    int16_t gx; // Gyroscope
+    int16_t gy;
+    int16_t gz;
+} imu_tilt_sample_t;
+
+// Tuning for the tilt pipeline.  Angles are in centidegrees.
+typedef struct
+{
+    uint8_t lpf_shift;       // Accel IIR low-pass, y += (x - y) >> lpf_shift (0 = off)
+    uint8_t gyro_weight;     // Complementary filter weight of the gyro path, out of 256
+    int16_t enter_cdeg;      // Tilt that starts cursor movement
+    int16_t exit_cdeg;       // Tilt below which movement stops (hysteresis)
+    int16_t full_cdeg;       // Tilt at which the fastest repeat rate is reached
+    uint16_t repeat_slow_ms; // Repeat interval just past enter_cdeg
+    uint16_t repeat_fast_ms; // Repeat interval at full_cdeg and beyond
+} imu_tilt_config_t;
+
+// Defaults roughly match the old 2500 LSB (about 9 degree) threshold
+#define IMU_TILT_CONFIG_DEFAULT {2, 240, 900, 600, 3000, 350, 80}
+
+// Counters used to judge how the pipeline feels
+typedef struct
+{
+    uint32_t moves;         // Moves reported
+    uint32_t reversals;     // Moves opposite the previous one within repeat_slow_ms (likely false)
+    uint32_t starts;        // Times an axis went from idle to moving
+    uint32_t latency_ms;    // Sum of raw-tilt-crossing to first-move delays over all starts
+} imu_tilt_stats_t;
+
+typedef struct
+{
+    int32_t angle_q8;       // Fused tilt, centidegrees in Q8
+    int8_t direction;       // -1, 0 or +1 while the axis is moving
+    int8_t last_move;       // Direction of the last reported move
+    uint32_t next_move;     // Sample index of the next repeat
+    uint32_t last_move_at;  // Sample index of the last reported move
+    uint32_t crossed_at;    // Sample index where the raw tilt crossed enter_cdeg
+    bool crossed;
+} imu_tilt_axis_t;
+
+typedef struct
+{
+    imu_tilt_config_t config;
+    uint16_t odr_hz;
+    bool primed;
+    int32_t accel_q8[3];    // Low-passed accelerometer, Q8
+    uint32_t sample_index;
+    imu_tilt_axis_t axis[2];
+    imu_tilt_stats_t stats;
+} imu_tilt_t;
+
+/**
+ * @brief
+ * Returns atan2(y, x) in centidegrees (-18000..18000) using only integer
+ * math.  Accurate to about 0.25 degrees.
+ * @param y
+ * @param x
+ * @return int32_t
+ */
+int32_t imu_tilt_atan2(int32_t y, int32_t x);
+
+/**
+ * @brief
+ * Resets the pipeline.  odr_hz is the rate samples will be fed at.
+ * @param tilt
+ * @param config
+ * @param odr_hz
+ */
+void imu_tilt_init(imu_tilt_t *tilt, const imu_tilt_config_t *config, uint16_t odr_hz);
+
+/**
+ * @brief
+ * Feeds one IMU sample through the pipeline.  Must be called for every
+ * sample, in order, because repeat timing counts samples.
+ * @param tilt
+ * @param sample
+ * @param dx
+ * Set to -1/+1 when a move is due on the X tilt axis, 0 otherwise
+ * @param dy
+ * Set to -1/+1 when a move is due on the Y tilt axis, 0 otherwise
+ * @return true if either axis moved
+ * @return false
+ */
+bool imu_tilt_update(imu_tilt_t *tilt, const imu_tilt_sample_t *sample, int8_t *dx, int8_t *dy);
+
+/**
+ * @brief
+ * Returns the fused tilt of an axis in centidegrees
+ * @param tilt
+ * @param axis IMU_TILT_AXIS_X or IMU_TILT_AXIS_Y
+ * @return int16_t
+ */
+int16_t imu_tilt_angle(const imu_tilt_t *tilt, uint8_t axis);
+
+#endif
@@ -0,0 +1,402 @@
+/**
+ * @file kv_log.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Log structured ring of pages behind the key/value store
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "kv_log.h"
+#include <string.h>
+
+/**
+ * @brief
+ * Values are never rewritten in place.  Each put appends a record to the
+ * head page of a ring of KV_LOG_PAGE_COUNT EEPROM pages, so writes are
+ * spread over the whole ring instead of wearing out one address.
+ *
+ * Page layout:
+ *   [0]    KV_PAGE_MAGIC
+ *   [1..2] sequence number, incremented each time a page is opened
+ *   [3]    CRC-8 of bytes 0..2
+ *   [4..]  records: key, length, value[length], CRC-8 of key/length/value
+ *
+ * Opening a page writes the header and fills the rest with 0xFF in one
+ * page write, so records left from the page's previous use are gone.  An
+ * empty slot or a record with a bad CRC (a write cut short by a reset)
+ * ends the page.
+ *
+ * Mounting reads the ring once.  The live pages are the run of consecutive
+ * sequence numbers ending at the newest page.  Replaying them oldest first
+ * leaves the newest value of every key in the RAM index, so gets never
+ * touch the bus.
+ *
+ * When fewer than KV_LOG_SPARE_PAGES pages are free, the oldest page is
+ * compacted: keys whose newest record is still in it are copied to the
+ * head, and the page is freed.
+ */
+
+#define KV_PAGE_MAGIC 0x4B
+#define KV_PAGE_HEADER_SIZE 4
+#define KV_RECORD_OVERHEAD 3          // Key, length and CRC
+#define KV_LOG_SPARE_PAGES 2          // Free pages kept for compaction
+
+static bool kv_log_append(kv_log_t *log, uint8_t key, const uint8_t *value, uint8_t length);
+
+/**
+ * @brief
+ * CRC-8, polynomial 0x07
+ * @param crc
+ * @param data
+ * @param length
+ * @return uint8_t
+ */
+static uint8_t kv_log_crc8(uint8_t crc, const uint8_t *data, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static uint8_t kv_log_pages_in_use(const kv_log_t *log)
+{
+    return (uint8_t)((log->head + KV_LOG_PAGE_COUNT - log->tail) % KV_LOG_PAGE_COUNT + 1);
+}
+
+/**
+ * @brief
+ * Writes length bytes at offset within page.  Never crosses a page, so
+ * each call costs one EEPROM write cycle.
+ */
+static bool kv_log_write(kv_log_t *log, uint8_t page, uint8_t offset, const uint8_t *data, uint8_t length)
+{
+    log->stats.page_writes[page]++;
+    log->stats.bytes_written += length;
+    return log->write(page * KV_LOG_PAGE_SIZE + offset, data, length);
+}
+
+/**
+ * @brief
+ * Writes a fresh header to page and makes it the head
+ */
+static bool kv_log_open_page(kv_log_t *log, uint8_t page, uint16_t sequence)
+{
+    memset(log->page_buffer, 0xFF, KV_LOG_PAGE_SIZE);
+    log->page_buffer[0] = KV_PAGE_MAGIC;
+    log->page_buffer[1] = (uint8_t)(sequence & 0xFF);
+    log->page_buffer[2] = (uint8_t)(sequence >> 8);
+    log->page_buffer[3] = kv_log_crc8(0, log->page_buffer, 3);
+
+    if (!kv_log_write(log, page, 0, log->page_buffer, KV_LOG_PAGE_SIZE))
+    {
+        return false;
+    }
+
+    log->head = page;
+    log->head_offset = KV_PAGE_HEADER_SIZE;
+    log->sequence = sequence;
+    return true;
+}
+
+/**
+ * @brief
+ * Copies the live records out of the tail page and frees it
+ */
+static bool kv_log_compact(kv_log_t *log)
+{
+    uint8_t page = log->tail;
+
+    for (uint8_t key = 0; key < KV_LOG_MAX_KEYS; key++)
+    {
+        kv_log_entry_t *entry = &log->index[key];
+
+        if (entry->length != 0 && entry->page == page)
+        {
+            if (!kv_log_append(log, key, entry->value, entry->length))
+            {
+                return false;
+            }
+            log->stats.relocations++;
+        }
+    }
+
+    log->tail = (page + 1) % KV_LOG_PAGE_COUNT;
+    return true;
+}
+
+/**
+ * @brief
+ * Compacts the oldest pages until KV_LOG_SPARE_PAGES are free
+ */
+static bool kv_log_reclaim(kv_log_t *log)
+{
+    bool status = true;
+
+    if (log->compacting)
+    {
+        return true;
+    }
+
+    log->compacting = true;
+    for (uint8_t i = 0; status && i < KV_LOG_PAGE_COUNT &&
+                        kv_log_pages_in_use(log) > KV_LOG_PAGE_COUNT - KV_LOG_SPARE_PAGES;
+         i++)
+    {
+        status = kv_log_compact(log);
+    }
+    log->compacting = false;
+
+    return status;
+}
+
+/**
+ * @brief
+ * Opens the next page of the ring
+ */
+static bool kv_log_advance(kv_log_t *log)
+{
+    uint8_t next = (log->head + 1) % KV_LOG_PAGE_COUNT;
+
+    if (next == log->tail)
+    {
+        return false; // Every page holds live records
+    }
+
+    if (!kv_log_open_page(log, next, log->sequence + 1))
+    {
+        return false;
+    }
+
+    return kv_log_reclaim(log);
+}
+
+/**
+ * @brief
+ * Writes a record to the head page and points the index at it
+ */
+static bool kv_log_append(kv_log_t *log, uint8_t key, const uint8_t *value, uint8_t length)
+{
+    uint8_t record[KV_LOG_MAX_VALUE + KV_RECORD_OVERHEAD];
+    uint8_t size = length + KV_RECORD_OVERHEAD;
+    kv_log_entry_t *entry = &log->index[key];
+
+    // Records never span pages.  Compaction may fill a new head, so check again.
+    while (log->head_offset + size > KV_LOG_PAGE_SIZE)
+    {
+        if (!kv_log_advance(log))
+        {
+            return false;
+        }
+    }
+
+    record[0] = key;
+    record[1] = length;
+    memcpy(&record[2], value, length);
+    record[2 + length] = kv_log_crc8(0, record, length + 2);
+
+    if (!kv_log_write(log, log->head, log->head_offset, record, size))
+    {
+        return false;
+    }
+    log->head_offset += size;
+
+    if (entry->value != value)
+    {
+        memcpy(entry->value, value, length);
+    }
+    entry->length = length;
+    entry->page = log->head;
+    return true;
+}
+
+/**
+ * @brief
+ * Adds the records in page to the index
+ * @param log
+ * @param page
+ * @param end Set to the offset after the last valid record
+ * @return true
+ * @return false
+ */
+static bool kv_log_scan_page(kv_log_t *log, uint8_t page, uint8_t *end)
+{
+    uint8_t *buffer = log->page_buffer;
+    uint8_t offset = KV_PAGE_HEADER_SIZE;
+
+    if (!log->read(page * KV_LOG_PAGE_SIZE, buffer, KV_LOG_PAGE_SIZE))
+    {
+        return false;
+    }
+
+    while (offset + KV_RECORD_OVERHEAD <= KV_LOG_PAGE_SIZE)
+    {
+        uint8_t key = buffer[offset];
+        uint8_t length = buffer[offset + 1];
+
+        if (key >= KV_LOG_MAX_KEYS || length == 0 || length > KV_LOG_MAX_VALUE ||
+            offset + length + KV_RECORD_OVERHEAD > KV_LOG_PAGE_SIZE)
+        {
+            break; // Empty slot
+        }
+        if (buffer[offset + 2 + length] != kv_log_crc8(0, &buffer[offset], length + 2))
+        {
+            break; // Torn write, the rest of the page is unused
+        }
+
+        memcpy(log->index[key].value, &buffer[offset + 2], length);
+        log->index[key].length = length;
+        log->index[key].page = page;
+        offset += length + KV_RECORD_OVERHEAD;
+    }
+
+    *end = offset;
+    return true;
+}
+
+bool kv_log_mount(kv_log_t *log)
+{
+    uint8_t header[KV_PAGE_HEADER_SIZE];
+    uint16_t sequence[KV_LOG_PAGE_COUNT];
+    bool valid[KV_LOG_PAGE_COUNT];
+    bool found = false;
+    uint8_t head = 0;
+    uint8_t tail;
+
+    memset(log->index, 0, sizeof(log->index));
+    memset(&log->stats, 0, sizeof(log->stats));
+    log->mounted = false;
+    log->compacting = false;
+
+    for (uint8_t page = 0; page < KV_LOG_PAGE_COUNT; page++)
+    {
+        if (!log->read(page * KV_LOG_PAGE_SIZE, header, KV_PAGE_HEADER_SIZE))
+        {
+            return false;
+        }
+
+        valid[page] = (header[0] == KV_PAGE_MAGIC) && (header[3] == kv_log_crc8(0, header, 3));
+        sequence[page] = (uint16_t)(header[1] | (header[2] << 8));
+
+        // Sequence numbers wrap, so compare the difference
+        if (valid[page] && (!found || (int16_t)(sequence[page] - sequence[head]) > 0))
+        {
+            head = page;
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        // Blank ring
+        log->tail = 0;
+        if (!kv_log_open_page(log, 0, 0))
+        {
+            return false;
+        }
+        log->mounted = true;
+        return true;
+    }
+
+    // Pages are opened in ring order, so the live pages lead up to the head
+    tail = head;
+    for (uint8_t i = 1; i < KV_LOG_PAGE_COUNT; i++)
+    {
+        uint8_t prev = (tail + KV_LOG_PAGE_COUNT - 1) % KV_LOG_PAGE_COUNT;
+
+        if (!valid[prev] || sequence[prev] != (uint16_t)(sequence[tail] - 1))
+        {
+            break;
+        }
+        tail = prev;
+    }
+
+    // Replay oldest first so the newest record of each key wins
+    for (uint8_t page = tail;; page = (page + 1) % KV_LOG_PAGE_COUNT)
+    {
+        uint8_t end;
+
+        if (!kv_log_scan_page(log, page, &end))
+        {
+            return false;
+        }
+        if (page == head)
+        {
+            log->head_offset = end;
+            break;
+        }
+    }
+
+    log->head = head;
+    log->tail = tail;
+    log->sequence = sequence[head];
+
+    // Pages freed before the reset still look live, release them again
+    if (!kv_log_reclaim(log))
+    {
+        return false;
+    }
+
+    log->mounted = true;
+    return true;
+}
+
+bool kv_log_put(kv_log_t *log, uint8_t key, const uint8_t *value, uint8_t length)
+{
+    kv_log_entry_t *entry;
+
+    if (key >= KV_LOG_MAX_KEYS || value == NULL || length == 0 || length > KV_LOG_MAX_VALUE)
+    {
+        return false;
+    }
+
+    entry = &log->index[key];
+    if (entry->length == length && memcmp(entry->value, value, length) == 0)
+    {
+        log->stats.skipped++;
+        return true;
+    }
+
+    log->stats.puts++;
+    log->stats.bytes_requested += length;
+    return kv_log_append(log, key, value, length);
+}
+
+bool kv_log_get(const kv_log_t *log, uint8_t key, uint8_t *value, uint8_t length)
+{
+    const kv_log_entry_t *entry;
+
+    if (key >= KV_LOG_MAX_KEYS || value == NULL)
+    {
+        return false;
+    }
+
+    entry = &log->index[key];
+    if (!log->mounted || entry->length == 0 || entry->length != length)
+    {
+        return false;
+    }
+
+    memcpy(value, entry->value, length);
+    return true;
+}
+
+void kv_log_get_stats(const kv_log_t *log, kv_log_stats_t *stats)
+{
+    *stats = log->stats;
+    stats->pages_in_use = log->mounted ? kv_log_pages_in_use(log) : 0;
+    stats->keys = 0;
+    for (uint8_t key = 0; key < KV_LOG_MAX_KEYS; key++)
+    {
+        stats->keys += (log->index[key].length != 0);
+    }
+}
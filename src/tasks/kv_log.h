@@ -0,0 +1,99 @@
+/**
+ * @file kv_log.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Log structured ring of pages behind the key/value store
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __KV_LOG_H__
+#define __KV_LOG_H__
+
+// Plain C with no board or RTOS includes so the host tests in test/ can build it
+#include <stdbool.h>
+#include <stdint.h>
+
+#define KV_LOG_PAGE_SIZE 64                        // EEPROM_PAGE_SIZE
+#define KV_LOG_PAGE_COUNT 16
+#define KV_LOG_MAX_KEYS 16                         // Keys are 0 to KV_LOG_MAX_KEYS - 1
+#define KV_LOG_MAX_VALUE 16                        // Longest value in bytes
+
+// Counters describing a log since it was mounted
+typedef struct
+{
+    uint32_t puts;                                 // Values appended to the log
+    uint32_t skipped;                              // Puts that matched the stored value
+    uint32_t bytes_requested;                      // Value bytes in appended puts
+    uint32_t bytes_written;                        // Bytes sent to the backend, including overhead
+    uint32_t relocations;                          // Records copied forward by compaction
+    uint32_t page_writes[KV_LOG_PAGE_COUNT];       // Write cycles per page
+    uint8_t pages_in_use;
+    uint8_t keys;                                  // Keys holding a value
+} kv_log_stats_t;
+
+// Newest value of one key
+typedef struct
+{
+    uint8_t length;                                // 0 when the key has no value
+    uint8_t page;                                  // Page holding the newest record
+    uint8_t value[KV_LOG_MAX_VALUE];
+} kv_log_entry_t;
+
+// One ring of pages and its index.  read and write address the ring from
+// byte 0, and a write never crosses a page.
+typedef struct
+{
+    bool (*read)(uint16_t offset, uint8_t *data, uint16_t length);
+    bool (*write)(uint16_t offset, const uint8_t *data, uint16_t length);
+    kv_log_entry_t index[KV_LOG_MAX_KEYS];
+    uint8_t page_buffer[KV_LOG_PAGE_SIZE];
+    uint8_t head;                                  // Page records are appended to
+    uint8_t tail;                                  // Oldest page that may hold live records
+    uint8_t head_offset;                           // Next free byte in the head page
+    uint16_t sequence;                             // Sequence number of the head page
+    bool mounted;
+    bool compacting;
+    kv_log_stats_t stats;
+} kv_log_t;
+
+/**
+ * @brief
+ * Reads the ring through log->read and rebuilds the index.  A blank ring
+ * is formatted.  read and write must be set first.
+ * @param log
+ * @return true
+ * @return false if the backend failed
+ */
+bool kv_log_mount(kv_log_t *log);
+
+/**
+ * @brief
+ * Appends a new value for key.  Nothing is written if the value is
+ * unchanged.
+ * @param log
+ * @param key
+ * @param value
+ * @param length 1 to KV_LOG_MAX_VALUE
+ * @return true
+ * @return false
+ */
+bool kv_log_put(kv_log_t *log, uint8_t key, const uint8_t *value, uint8_t length);
+
+/**
+ * @brief
+ * Copies the value of key into value
+ * @return true
+ * @return false if the key has no value or it is not length bytes
+ */
+bool kv_log_get(const kv_log_t *log, uint8_t key, uint8_t *value, uint8_t length);
+
+/**
+ * @brief
+ * Copies the counters, with pages_in_use and keys filled in
+ */
+void kv_log_get_stats(const kv_log_t *log, kv_log_stats_t *stats);
+
+#endif
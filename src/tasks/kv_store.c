@@ -0,0 +1,126 @@
+/**
+ * @file kv_store.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Wear leveled key/value store kept in a ring of EEPROM pages
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "kv_store.h"
+#include "task_eeprom.h"
+#include "device_manager.h"
+#include <string.h>
+
+/**
+ * @brief
+ * The page ring, its index and compaction are in kv_log.c.  This file
+ * backs the ring with the EEPROM through the EEPROM task, starting at
+ * KV_STORE_BASE_ADDR, and serializes access to it with a mutex.  Gets are
+ * served from the RAM index and never touch the bus.
+ *
+ * test/kv_store_sim runs kv_log.c against a RAM ring on the host to
+ * measure write amplification and wear.
+ */
+
+/* Global Variables */
+static SemaphoreHandle_t Semaphore_KV_Store;
+static kv_log_t KV_Store;
+
+static bool kv_store_eeprom_read(uint16_t offset, uint8_t *data, uint16_t length)
+{
+    return system_sensors_eeprom_read_block(device_mailbox(), KV_STORE_BASE_ADDR + offset, data, length);
+}
+
+static bool kv_store_eeprom_write(uint16_t offset, const uint8_t *data, uint16_t length)
+{
+    return system_sensors_eeprom_write_block(device_mailbox(), KV_STORE_BASE_ADDR + offset, (uint8_t *)data, length);
+}
+
+bool kv_store_mount(void)
+{
+    bool status;
+
+    xSemaphoreTake(Semaphore_KV_Store, portMAX_DELAY);
+    status = kv_log_mount(&KV_Store);
+    xSemaphoreGive(Semaphore_KV_Store);
+
+    return status;
+}
+
+bool kv_store_get(uint8_t key, void *value, uint8_t length)
+{
+    bool status = false;
+
+    if (key >= KV_STORE_MAX_KEYS || value == NULL)
+    {
+        return false;
+    }
+
+    xSemaphoreTake(Semaphore_KV_Store, portMAX_DELAY);
+    status = kv_log_get(&KV_Store, key, (uint8_t *)value, length);
+    xSemaphoreGive(Semaphore_KV_Store);
+
+    return status;
+}
+
+bool kv_store_put(uint8_t key, const void *value, uint8_t length)
+{
+    bool status = false;
+
+    if (key >= KV_STORE_MAX_KEYS || value == NULL || length == 0 || length > KV_STORE_MAX_VALUE)
+    {
+        return false;
+    }
+
+    xSemaphoreTake(Semaphore_KV_Store, portMAX_DELAY);
+    if (KV_Store.mounted)
+    {
+        status = kv_log_put(&KV_Store, key, (const uint8_t *)value, length);
+    }
+    xSemaphoreGive(Semaphore_KV_Store);
+
+    return status;
+}
+
+bool kv_store_sync(void)
+{
+    bool status;
+
+    xSemaphoreTake(Semaphore_KV_Store, portMAX_DELAY);
+    status = system_sensors_eeprom_sync(device_mailbox());
+    xSemaphoreGive(Semaphore_KV_Store);
+
+    return status;
+}
+
+bool kv_store_get_stats(kv_store_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return false;
+    }
+
+    xSemaphoreTake(Semaphore_KV_Store, portMAX_DELAY);
+    kv_log_get_stats(&KV_Store, stats);
+    xSemaphoreGive(Semaphore_KV_Store);
+
+    return true;
+}
+
+bool kv_store_init(void)
+{
+    Semaphore_KV_Store = xSemaphoreCreateMutex();
+
+    memset(&KV_Store, 0, sizeof(KV_Store));
+    KV_Store.read = kv_store_eeprom_read;
+    KV_Store.write = kv_store_eeprom_write;
+
+    return (Semaphore_KV_Store != NULL);
+}
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file kv_store.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Wear leveled key/value store kept in a ring of EEPROM pages
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __KV_STORE_H__
+#define __KV_STORE_H__
+
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "drivers.h"
+#include "kv_log.h"
+
+#define KV_STORE_BASE_ADDR 0x0400                  // First EEPROM page of the ring
+#define KV_STORE_PAGE_SIZE KV_LOG_PAGE_SIZE
+#define KV_STORE_PAGE_COUNT KV_LOG_PAGE_COUNT      // 1 KB of EEPROM
+#define KV_STORE_MAX_KEYS KV_LOG_MAX_KEYS          // Keys are 0 to KV_STORE_MAX_KEYS - 1
+#define KV_STORE_MAX_VALUE KV_LOG_MAX_VALUE        // Longest value in bytes
+
+#if KV_LOG_PAGE_SIZE != EEPROM_PAGE_SIZE
+#error "A kv_log page must be one EEPROM write page"
+#endif
+
+/* Keys in use.  Game state is split so a save only rewrites what changed. */
+#define KV_KEY_GAME_COUNTERS 0
+#define KV_KEY_GAME_OCCUPIED 1                     // 4 keys, 1 to 4
+#define KV_KEY_GAME_OPPONENT 5                     // 2 keys, 5 and 6
+
+// Counters describing the store since it was mounted
+typedef kv_log_stats_t kv_store_stats_t;
+
+/**
+ * @brief
+ * Creates the store's RTOS resources.  Must be called before the scheduler
+ * starts.
+ * @return true
+ * @return false
+ */
+bool kv_store_init(void);
+
+/**
+ * @brief
+ * Scans the EEPROM ring and builds the in-RAM index.  Must be called from a
+ * task once the EEPROM task is running.  A blank ring is formatted.
+ * @return true
+ * @return false
+ */
+bool kv_store_mount(void);
+
+/**
+ * @brief
+ * Copies the value of key into value.  Served from RAM, no SPI traffic.
+ * @param key
+ * @param value
+ * @param length
+ * @return true
+ * @return false if the key has no value or it is not length bytes
+ */
+bool kv_store_get(uint8_t key, void *value, uint8_t length);
+
+/**
+ * @brief
+ * Appends a new value for key.  Nothing is written if the value is
+ * unchanged.
+ * @param key
+ * @param value
+ * @param length
+ * @return true
+ * @return false
+ */
+bool kv_store_put(uint8_t key, const void *value, uint8_t length);
+
+/**
+ * @brief
+ * Returns once every put so far is on the EEPROM rather than in the
+ * EEPROM task's write-back cache
+ * @return true
+ * @return false
+ */
+bool kv_store_sync(void);
+
+bool kv_store_get_stats(kv_store_stats_t *stats);
+
+#endif
+#endif
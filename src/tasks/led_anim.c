@@ -0,0 +1,336 @@
+/**
+ * @file led_anim.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Keyframe animations on the RGB LED and the IO expander LEDs
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "led_anim.h"
+#include "task_io_expander.h"
+#include <timers.h>
+
+#define INT_PRIORITY_LED_ANIM 6
+
+/**
+ * @brief
+ * Levels are held in 16.16 fixed point so a fade is one add per tick.
+ * Each tick the interrupt steps every playing channel and writes the PWM
+ * only when the 8 bit level changes; a held frame costs a decrement.
+ * The IO expander LEDs cannot be written from an interrupt, so changes
+ * to them are handed to the timer service task, which queues one bit
+ * operation for the IO expander task.
+ */
+
+// Duty cycle in 0.01% for each 8 bit level, gamma 2.2
+static const uint16_t led_anim_gamma[256] = {
+    0, 0, 0, 1, 1, 2, 3, 4, 5, 6, 8, 10, 12, 14, 17, 20,
+    23, 26, 29, 33, 37, 41, 46, 50, 55, 60, 66, 72, 78, 84, 90, 97,
+    104, 111, 119, 127, 135, 143, 152, 161, 170, 179, 189, 199, 210, 220, 231, 242,
+    254, 265, 278, 290, 303, 316, 329, 342, 356, 370, 385, 399, 415, 430, 446, 461,
+    478, 494, 511, 528, 546, 564, 582, 600, 619, 638, 658, 677, 697, 718, 738, 759,
+    781, 802, 824, 846, 869, 892, 915, 939, 963, 987, 1011, 1036, 1062, 1087, 1113, 1139,
+    1166, 1193, 1220, 1247, 1275, 1304, 1332, 1361, 1390, 1420, 1450, 1480, 1511, 1542, 1573, 1604,
+    1636, 1669, 1701, 1734, 1768, 1801, 1835, 1870, 1905, 1940, 1975, 2011, 2047, 2084, 2120, 2158,
+    2195, 2233, 2271, 2310, 2349, 2388, 2428, 2468, 2508, 2549, 2590, 2632, 2674, 2716, 2758, 2801,
+    2845, 2888, 2932, 2977, 3021, 3066, 3112, 3158, 3204, 3250, 3297, 3345, 3392, 3440, 3489, 3537,
+    3587, 3636, 3686, 3736, 3787, 3838, 3889, 3941, 3993, 4045, 4098, 4151, 4205, 4259, 4313, 4368,
+    4423, 4479, 4535, 4591, 4647, 4704, 4762, 4820, 4878, 4936, 4995, 5054, 5114, 5174, 5234, 5295,
+    5356, 5418, 5480, 5542, 5605, 5668, 5732, 5795, 5860, 5924, 5989, 6055, 6121, 6187, 6253, 6320,
+    6388, 6456, 6524, 6592, 6661, 6730, 6800, 6870, 6941, 7012, 7083, 7155, 7227, 7299, 7372, 7445,
+    7519, 7593, 7667, 7742, 7818, 7893, 7969, 8046, 8122, 8200, 8277, 8355, 8434, 8513, 8592, 8671,
+    8751, 8832, 8913, 8994, 9075, 9158, 9240, 9323, 9406, 9490, 9574, 9658, 9743, 9828, 9914, 10000};
+
+typedef struct
+{
+    const led_anim_t *anim;       // NULL when the channel is idle
+    bool loop;
+    uint8_t frame;
+    uint16_t ticks_left;          // Ticks until the frame ends
+    int32_t level;                // 16.16 fixed point
+    int32_t step;                 // Added to level every tick
+    uint8_t output;               // Level last written to the LED
+    led_keyframe_t set_frame;     // Used by led_anim_set
+    led_anim_t set_anim;
+} led_anim_state_t;
+
+static cyhal_pwm_t led_anim_pwm[3];
+static cyhal_timer_t led_anim_timer;
+static cyhal_timer_cfg_t led_anim_timer_cfg;
+static bool led_anim_initialized = false;
+static volatile bool led_anim_running = false;
+static led_anim_state_t led_anim_state[LED_ANIM_CH_COUNT];
+static uint8_t led_anim_ioxp_on = 0;    // IO expander LEDs handed to the IO expander task
+static led_anim_stats_t led_anim_stats = {.isr_cycles_min = UINT32_MAX};
+
+/* Built in animations */
+static const led_keyframe_t led_frames_fade_in[] = {{255, 1, 500}};
+static const led_keyframe_t led_frames_fade_out[] = {{0, 1, 500}};
+static const led_keyframe_t led_frames_pulse[] = {{255, 1, 600}, {0, 1, 600}};
+static const led_keyframe_t led_frames_blink[] = {{255, 0, 250}, {0, 0, 250}};
+static const led_keyframe_t led_frames_heartbeat[] = {
+    {255, 0, 100}, {0, 0, 100}, {255, 0, 100}, {0, 0, 700}};
+static const led_keyframe_t led_frames_blink_out[] = {
+    {0, 0, 150}, {255, 0, 150}, {0, 0, 150}, {255, 0, 150}, {0, 0, 150}, {255, 0, 150}, {0, 0, 10}};
+
+const led_anim_t led_anim_fade_in = {led_frames_fade_in, 1};
+const led_anim_t led_anim_fade_out = {led_frames_fade_out, 1};
+const led_anim_t led_anim_pulse = {led_frames_pulse, 2};
+const led_anim_t led_anim_blink = {led_frames_blink, 2};
+const led_anim_t led_anim_heartbeat = {led_frames_heartbeat, 4};
+const led_anim_t led_anim_blink_out = {led_frames_blink_out, 7};
+
+/**
+ * @brief
+ * Sets up the current frame of a channel
+ */
+static void led_anim_frame_start(led_anim_state_t *state)
+{
+    const led_keyframe_t *frame = &state->anim->frames[state->frame];
+    uint32_t ticks = ((uint32_t)frame->duration_ms * LED_ANIM_TICK_HZ) / 1000;
+
+    state->ticks_left = (ticks == 0) ? 1 : ticks;
+    if (frame->ramp)
+    {
+        state->step = (((int32_t)frame->level << 16) - state->level) / state->ticks_left;
+    }
+    else
+    {
+        state->level = (int32_t)frame->level << 16;
+        state->step = 0;
+    }
+}
+
+/**
+ * @brief
+ * Runs in the timer service task.  Applies IO expander LED changes.  The
+ * bit operations only record the change and never block, the IO expander
+ * task does the I2C write.
+ * @param param
+ * Unused
+ * @param changes
+ * LEDs to turn on in bits 0-7, LEDs that changed in bits 8-15
+ */
+static void led_anim_ioxp_apply(void *param, uint32_t changes)
+{
+    uint8_t on = changes & 0xFF;
+    uint8_t changed = (changes >> 8) & 0xFF;
+    (void)param;
+
+    if (changed & ~on)
+    {
+        system_sensors_io_expander_clear_bits(changed & ~on);
+    }
+    if (changed & on)
+    {
+        system_sensors_io_expander_set_bits(changed & on);
+    }
+}
+
+/**
+ * @brief
+ * Writes a channel's level to its PWM.  IO expander LEDs are collected by
+ * the caller.
+ */
+static void led_anim_output(led_anim_channel_t channel, uint8_t level)
+{
+    if (channel < LED_ANIM_CH_IOXP0)
+    {
+        cyhal_pwm_set_duty_cycle(&led_anim_pwm[channel], led_anim_gamma[level] * 0.01f, LED_ANIM_PWM_HZ);
+        led_anim_stats.pwm_writes++;
+    }
+}
+
+/**
+ * @brief
+ * Animation tick.  Steps every playing channel and stops the timer once
+ * all of them are idle.
+ */
+static void led_anim_timer_handler(void *handler_arg, cyhal_timer_event_t event)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint32_t start = timer_cycles_get();
+    uint32_t cycles;
+    uint8_t ioxp_on = led_anim_ioxp_on;
+    bool playing = false;
+    (void)handler_arg;
+    (void)event;
+
+    for (int i = 0; i < LED_ANIM_CH_COUNT; i++)
+    {
+        led_anim_state_t *state = &led_anim_state[i];
+        uint8_t level;
+
+        if (state->anim == NULL)
+        {
+            continue;
+        }
+
+        state->level += state->step;
+        if (--state->ticks_left == 0)
+        {
+            // Land exactly on the keyframe
+            state->level = (int32_t)state->anim->frames[state->frame].level << 16;
+            if (++state->frame >= state->anim->count)
+            {
+                state->frame = 0;
+                if (!state->loop)
+                {
+                    state->anim = NULL;
+                }
+            }
+            if (state->anim != NULL)
+            {
+                led_anim_frame_start(state);
+            }
+        }
+        playing |= (state->anim != NULL);
+
+        level = state->level >> 16;
+        if (level != state->output)
+        {
+            state->output = level;
+            led_anim_output(i, level);
+        }
+        if (i >= LED_ANIM_CH_IOXP0)
+        {
+            uint8_t bit = 1 << (i - LED_ANIM_CH_IOXP0);
+            ioxp_on = (level >= 128) ? (ioxp_on | bit) : (ioxp_on & ~bit);
+        }
+    }
+
+    // Retried next tick if the timer service queue is full
+    if (ioxp_on != led_anim_ioxp_on &&
+        xTimerPendFunctionCallFromISR(led_anim_ioxp_apply, NULL, ioxp_on | ((ioxp_on ^ led_anim_ioxp_on) << 8), &xHigherPriorityTaskWoken) == pdPASS)
+    {
+        led_anim_ioxp_on = ioxp_on;
+        led_anim_stats.ioxp_writes++;
+    }
+    else if (ioxp_on != led_anim_ioxp_on)
+    {
+        playing = true;
+    }
+
+    if (!playing)
+    {
+        cyhal_timer_stop(&led_anim_timer);
+        led_anim_running = false;
+    }
+
+    cycles = timer_cycles_get() - start;
+    led_anim_stats.ticks++;
+    led_anim_stats.isr_cycles_total += cycles;
+    if (cycles < led_anim_stats.isr_cycles_min)
+    {
+        led_anim_stats.isr_cycles_min = cycles;
+    }
+    if (cycles > led_anim_stats.isr_cycles_max)
+    {
+        led_anim_stats.isr_cycles_max = cycles;
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+cy_rslt_t led_anim_init(void)
+{
+    cy_rslt_t rslt;
+
+    rslt = leds_init_pwm(&led_anim_pwm[LED_RED], &led_anim_pwm[LED_GREEN], &led_anim_pwm[LED_BLUE]);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        cyhal_pwm_set_duty_cycle(&led_anim_pwm[i], 0, LED_ANIM_PWM_HZ);
+    }
+
+    rslt = timer_init(&led_anim_timer, &led_anim_timer_cfg, 100000000 / LED_ANIM_TICK_HZ, led_anim_timer_handler);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+    cyhal_timer_stop(&led_anim_timer);
+
+    // The handler queues work for the timer service task
+    cyhal_timer_enable_event(&led_anim_timer, CYHAL_TIMER_IRQ_TERMINAL_COUNT, INT_PRIORITY_LED_ANIM, true);
+
+    timer_cycles_init();
+    led_anim_initialized = true;
+    return CY_RSLT_SUCCESS;
+}
+
+bool led_anim_play(led_anim_channel_t channel, const led_anim_t *anim, bool loop)
+{
+    led_anim_state_t *state;
+
+    if (!led_anim_initialized || channel >= LED_ANIM_CH_COUNT || anim == NULL || anim->count == 0)
+    {
+        return false;
+    }
+    state = &led_anim_state[channel];
+
+    taskENTER_CRITICAL();
+    state->anim = anim;
+    state->loop = loop;
+    state->frame = 0;
+    led_anim_frame_start(state);
+    if (!led_anim_running)
+    {
+        led_anim_running = true;
+        cyhal_timer_reset(&led_anim_timer);
+        cyhal_timer_start(&led_anim_timer);
+    }
+    taskEXIT_CRITICAL();
+
+    return true;
+}
+
+bool led_anim_set(led_anim_channel_t channel, uint8_t level)
+{
+    led_anim_state_t *state;
+
+    if (!led_anim_initialized || channel >= LED_ANIM_CH_COUNT)
+    {
+        return false;
+    }
+    state = &led_anim_state[channel];
+
+    // A one tick jump, so the interrupt stays the only writer of the LEDs
+    taskENTER_CRITICAL();
+    state->set_frame.level = level;
+    state->set_frame.ramp = 0;
+    state->set_frame.duration_ms = 0;
+    state->set_anim.frames = &state->set_frame;
+    state->set_anim.count = 1;
+    taskEXIT_CRITICAL();
+
+    return led_anim_play(channel, &state->set_anim, false);
+}
+
+bool led_anim_is_playing(led_anim_channel_t channel)
+{
+    return (channel < LED_ANIM_CH_COUNT) && (led_anim_state[channel].anim != NULL);
+}
+
+bool led_anim_get_stats(led_anim_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    *stats = led_anim_stats;
+    taskEXIT_CRITICAL();
+
+    return true;
+}
+#endif
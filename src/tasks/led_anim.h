@@ -0,0 +1,102 @@
+/**
+ * @file led_anim.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Keyframe animations on the RGB LED and the IO expander LEDs
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __LED_ANIM_H__
+#define __LED_ANIM_H__
+
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "drivers.h"
+
+#define LED_ANIM_TICK_HZ 100      // Animation frame rate
+#define LED_ANIM_PWM_HZ 2000
+#define LED_ANIM_IOXP_LEDS 5      // IO expander LEDs, output port bits 0 to 4
+
+typedef enum
+{
+    LED_ANIM_CH_RED = 0,
+    LED_ANIM_CH_GREEN,
+    LED_ANIM_CH_BLUE,
+    LED_ANIM_CH_IOXP0,            // IO expander LEDs are on at level 128 and above
+    LED_ANIM_CH_COUNT = LED_ANIM_CH_IOXP0 + LED_ANIM_IOXP_LEDS
+} led_anim_channel_t;
+
+// One step of an animation
+typedef struct
+{
+    uint8_t level;                // Brightness at the end of the frame, before gamma
+    uint8_t ramp;                 // Non-zero to fade from the previous level, else jump
+    uint16_t duration_ms;
+} led_keyframe_t;
+
+typedef struct
+{
+    const led_keyframe_t *frames;
+    uint8_t count;
+} led_anim_t;
+
+// Counters describing the animation interrupt
+typedef struct
+{
+    uint32_t ticks;
+    uint32_t pwm_writes;
+    uint32_t ioxp_writes;
+    uint32_t isr_cycles_min;
+    uint32_t isr_cycles_max;
+    uint32_t isr_cycles_total;
+} led_anim_stats_t;
+
+/* Built in animations */
+extern const led_anim_t led_anim_fade_in;
+extern const led_anim_t led_anim_fade_out;
+extern const led_anim_t led_anim_pulse;
+extern const led_anim_t led_anim_blink;
+extern const led_anim_t led_anim_heartbeat;
+extern const led_anim_t led_anim_blink_out; // Three blinks, then off
+
+/**
+ * @brief
+ * Puts the RGB LED pins under PWM control and sets up the animation
+ * timer.  Used in place of leds_init.
+ * @return cy_rslt_t
+ */
+cy_rslt_t led_anim_init(void);
+
+/**
+ * @brief
+ * Starts anim on channel from the channel's current level and returns
+ * immediately.  Frames are stepped by a timer interrupt that only runs
+ * while an animation is playing.  anim must stay valid while it plays.
+ * @param channel
+ * @param anim
+ * @param loop
+ * @return true
+ * @return false
+ */
+bool led_anim_play(led_anim_channel_t channel, const led_anim_t *anim, bool loop);
+
+/**
+ * @brief
+ * Stops any animation on channel and holds it at level
+ * @param channel
+ * @param level
+ * @return true
+ * @return false if the engine is not initialized
+ */
+bool led_anim_set(led_anim_channel_t channel, uint8_t level);
+
+bool led_anim_is_playing(led_anim_channel_t channel);
+
+bool led_anim_get_stats(led_anim_stats_t *stats);
+
+#endif
+#endif
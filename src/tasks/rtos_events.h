@@ -27,6 +27,7 @@ extern EventGroupHandle_t ECE353_RTOS_Events;
 #define ECE353_RTOS_EVENTS_SW1 (1 << 0)  // Event bit for SW1 pressed
 #define ECE353_RTOS_EVENTS_SW2 (1 << 1)  // Event bit for SW2 pressed
 #define ECE353_RTOS_EVENTS_SW3 (1 << 2)  // Event bit for SW3 pressed
+#define ECE353_RTOS_EVENTS_LIGHT (1 << 3) // Light sensor crossed LIGHT_THRESHOLD
 
 #endif // ECE353_FREERTOS
 
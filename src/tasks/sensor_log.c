@@ -0,0 +1,395 @@
+/**
+ * @file sensor_log.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Fixed memory, delta encoded history of the sensor hub readings
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "sensor_log.h"
+#include <string.h>
+
+/**
+ * @brief
+ * Each series (light, temperature and IMU magnitude) is a ring of
+ * SENSOR_LOG_BLOCKS blocks.  A block holds the absolute value and tick
+ * count of its first value, then the difference of each later value from
+ * the one before it as a zigzag varint.  Sensor readings change slowly,
+ * so most differences take one byte instead of four and a 64 byte block
+ * holds about 60 values.  When the ring is full the oldest block is
+ * dropped, so the memory used is fixed.  Values are assumed to be evenly
+ * spaced; a new block is started whenever a reading arrives off schedule
+ * or the period changes, so the time of every value can be rebuilt from
+ * the block header.
+ *
+ * Each recorded value may be the mean of several readings (decimation),
+ * which trades resolution for retention.  The min, max, mean and variance
+ * are kept over every reading, using Welford's method so they cost a
+ * handful of operations per reading.
+ */
+
+typedef struct
+{
+    TickType_t start;                        // Tick count of the first value
+    TickType_t interval;                     // Ticks between values
+    int32_t first;                           // First value, not delta encoded
+    uint16_t count;
+    uint8_t used;                            // Delta bytes used
+    uint8_t data[SENSOR_LOG_BLOCK_BYTES];
+} sensor_log_block_t;
+
+typedef struct
+{
+    sensor_log_block_t blocks[SENSOR_LOG_BLOCKS];
+    uint8_t oldest;                          // Index of the oldest block
+    uint8_t held;                            // Blocks in use, the newest is being filled
+    int32_t last;                            // Newest recorded value
+    // Readings being averaged into the next value
+    uint8_t decimation;
+    uint8_t pending;
+    int32_t pending_sum;
+    TickType_t pending_start;
+    // Statistics over every reading
+    uint32_t samples;
+    int32_t min;
+    int32_t max;
+    float mean;
+    float m2;                                // Sum of squared differences from the mean
+    uint64_t cycles;
+    uint32_t max_cycles;
+} sensor_log_series_t;
+
+/* Global Variables */
+static SemaphoreHandle_t Semaphore_Sensor_Log;
+static sensor_log_series_t Sensor_Log[SENSOR_HUB_COUNT];
+
+/**
+ * @brief
+ * Integer square root, rounded down
+ */
+static uint32_t sensor_log_isqrt(uint32_t x)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > x)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (x >= root + bit)
+        {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+/**
+ * @brief
+ * Writes delta as a zigzag varint, 7 bits per byte
+ * @return uint8_t Bytes written, at most 5
+ */
+static uint8_t sensor_log_encode(int32_t delta, uint8_t *out)
+{
+    uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    uint8_t length = 0;
+
+    while (zigzag >= 0x80)
+    {
+        out[length++] = (uint8_t)(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    out[length++] = (uint8_t)zigzag;
+
+    return length;
+}
+
+/**
+ * @brief
+ * Reads one zigzag varint from data
+ * @return uint8_t Bytes read
+ */
+static uint8_t sensor_log_decode(const uint8_t *data, int32_t *delta)
+{
+    uint32_t zigzag = 0;
+    uint8_t length = 0;
+
+    do
+    {
+        zigzag |= (uint32_t)(data[length] & 0x7F) << (7 * length);
+    } while (data[length++] & 0x80);
+
+    *delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+    return length;
+}
+
+static sensor_log_block_t *sensor_log_block(sensor_log_series_t *series, uint8_t index)
+{
+    return &series->blocks[(series->oldest + index) % SENSOR_LOG_BLOCKS];
+}
+
+/**
+ * @brief
+ * Appends a value to the ring, starting a new block if the value does not
+ * fit the newest one
+ */
+static void sensor_log_append(sensor_log_series_t *series, TickType_t tick, TickType_t interval, int32_t value)
+{
+    sensor_log_block_t *block = NULL;
+    uint8_t encoded[5];
+    uint8_t length = sensor_log_encode(value - series->last, encoded);
+
+    if (series->held > 0)
+    {
+        TickType_t expected;
+        TickType_t late;
+
+        block = sensor_log_block(series, series->held - 1);
+        expected = block->start + block->count * block->interval;
+        late = ((int32_t)(tick - expected) >= 0) ? tick - expected : expected - tick;
+
+        if (block->interval != interval || late > interval / 2 || block->used + length > SENSOR_LOG_BLOCK_BYTES)
+        {
+            block = NULL;
+        }
+    }
+
+    if (block != NULL)
+    {
+        memcpy(&block->data[block->used], encoded, length);
+        block->used += length;
+        block->count++;
+    }
+    else
+    {
+        if (series->held == SENSOR_LOG_BLOCKS)
+        {
+            series->oldest = (series->oldest + 1) % SENSOR_LOG_BLOCKS;
+            series->held--;
+        }
+
+        block = sensor_log_block(series, series->held++);
+        block->start = tick;
+        block->interval = interval;
+        block->first = value;
+        block->count = 1;
+        block->used = 0;
+    }
+
+    series->last = value;
+}
+
+/**
+ * @brief
+ * Resets a series.  The caller must hold Semaphore_Sensor_Log.
+ */
+static void sensor_log_reset(sensor_log_series_t *series, uint8_t decimation)
+{
+    memset(series, 0, sizeof(sensor_log_series_t));
+    series->decimation = decimation;
+    series->min = INT32_MAX;
+    series->max = INT32_MIN;
+}
+
+void sensor_log_record(sensor_hub_sensor_t sensor, const int32_t value[3], TickType_t period)
+{
+    uint32_t start = timer_cycles_get();
+    sensor_log_series_t *series;
+    TickType_t now = xTaskGetTickCount();
+    int32_t reading;
+    float delta;
+    uint32_t cycles;
+
+    if (sensor >= SENSOR_HUB_COUNT || value == NULL)
+    {
+        return;
+    }
+    series = &Sensor_Log[sensor];
+
+    if (sensor == SENSOR_HUB_IMU)
+    {
+        reading = (int32_t)sensor_log_isqrt(
+            (uint32_t)(value[0] * value[0]) + (uint32_t)(value[1] * value[1]) + (uint32_t)(value[2] * value[2]));
+    }
+    else
+    {
+        reading = value[0];
+    }
+
+    xSemaphoreTake(Semaphore_Sensor_Log, portMAX_DELAY);
+
+    // Welford's running mean and variance
+    series->samples++;
+    delta = (float)reading - series->mean;
+    series->mean += delta / (float)series->samples;
+    series->m2 += delta * ((float)reading - series->mean);
+    if (reading < series->min)
+    {
+        series->min = reading;
+    }
+    if (reading > series->max)
+    {
+        series->max = reading;
+    }
+
+    if (series->pending == 0)
+    {
+        series->pending_start = now;
+        series->pending_sum = 0;
+    }
+    series->pending_sum += reading;
+
+    if (++series->pending >= series->decimation)
+    {
+        int32_t half = series->pending / 2;
+        int32_t mean = (series->pending_sum + ((series->pending_sum >= 0) ? half : -half)) / series->pending;
+
+        sensor_log_append(series, series->pending_start, period * series->decimation, mean);
+        series->pending = 0;
+    }
+
+    cycles = timer_cycles_get() - start;
+    series->cycles += cycles;
+    if (cycles > series->max_cycles)
+    {
+        series->max_cycles = cycles;
+    }
+
+    xSemaphoreGive(Semaphore_Sensor_Log);
+}
+
+bool sensor_log_configure(sensor_hub_sensor_t sensor, uint8_t decimation)
+{
+    if (sensor >= SENSOR_HUB_COUNT || decimation == 0 || decimation > SENSOR_LOG_MAX_DECIMATION)
+    {
+        return false;
+    }
+
+    xSemaphoreTake(Semaphore_Sensor_Log, portMAX_DELAY);
+    sensor_log_reset(&Sensor_Log[sensor], decimation);
+    xSemaphoreGive(Semaphore_Sensor_Log);
+
+    return true;
+}
+
+void sensor_log_clear(sensor_hub_sensor_t sensor)
+{
+    if (sensor >= SENSOR_HUB_COUNT)
+    {
+        return;
+    }
+
+    xSemaphoreTake(Semaphore_Sensor_Log, portMAX_DELAY);
+    sensor_log_reset(&Sensor_Log[sensor], Sensor_Log[sensor].decimation);
+    xSemaphoreGive(Semaphore_Sensor_Log);
+}
+
+bool sensor_log_get_stats(sensor_hub_sensor_t sensor, sensor_log_stats_t *stats)
+{
+    sensor_log_series_t *series;
+    TickType_t span = 0;
+
+    if (sensor >= SENSOR_HUB_COUNT || stats == NULL)
+    {
+        return false;
+    }
+    series = &Sensor_Log[sensor];
+    memset(stats, 0, sizeof(sensor_log_stats_t));
+
+    xSemaphoreTake(Semaphore_Sensor_Log, portMAX_DELAY);
+    stats->samples = series->samples;
+    stats->min = series->min;
+    stats->max = series->max;
+    stats->mean = series->mean;
+    stats->variance = (series->samples > 1) ? series->m2 / (float)(series->samples - 1) : 0.0f;
+    stats->decimation = series->decimation;
+    stats->busy_us = (uint32_t)(series->cycles / (SystemCoreClock / 1000000));
+    stats->max_cycles = series->max_cycles;
+    for (uint8_t i = 0; i < series->held; i++)
+    {
+        sensor_log_block_t *block = sensor_log_block(series, i);
+
+        stats->recorded += block->count;
+        stats->bytes += block->used;
+        span += block->count * block->interval;
+    }
+    xSemaphoreGive(Semaphore_Sensor_Log);
+
+    stats->span_ms = span * portTICK_PERIOD_MS;
+    return true;
+}
+
+uint16_t sensor_log_read_block(
+    sensor_hub_sensor_t sensor,
+    uint8_t block,
+    TickType_t *start,
+    TickType_t *interval,
+    int32_t *values)
+{
+    sensor_log_block_t copy;
+    uint16_t offset = 0;
+
+    if (sensor >= SENSOR_HUB_COUNT || start == NULL || interval == NULL || values == NULL)
+    {
+        return 0;
+    }
+
+    // Copy the block so the hub is not held up while it is decoded
+    xSemaphoreTake(Semaphore_Sensor_Log, portMAX_DELAY);
+    if (block >= Sensor_Log[sensor].held)
+    {
+        xSemaphoreGive(Semaphore_Sensor_Log);
+        return 0;
+    }
+    copy = *sensor_log_block(&Sensor_Log[sensor], block);
+    xSemaphoreGive(Semaphore_Sensor_Log);
+
+    *start = copy.start;
+    *interval = copy.interval;
+    values[0] = copy.first;
+    for (uint16_t i = 1; i < copy.count; i++)
+    {
+        int32_t delta;
+
+        offset += sensor_log_decode(&copy.data[offset], &delta);
+        values[i] = values[i - 1] + delta;
+    }
+
+    return copy.count;
+}
+
+bool sensor_log_init(void)
+{
+    Semaphore_Sensor_Log = xSemaphoreCreateMutex();
+    if (Semaphore_Sensor_Log == NULL)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < SENSOR_HUB_COUNT; i++)
+    {
+        sensor_log_reset(&Sensor_Log[i], 1);
+    }
+
+    // Used to measure the cost of each record
+    timer_cycles_init();
+
+    return true;
+}
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file sensor_log.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Fixed memory, delta encoded history of the sensor hub readings
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __SENSOR_LOG_H__
+#define __SENSOR_LOG_H__
+
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "drivers.h"
+#include "task_sensor_hub.h"
+
+#define SENSOR_LOG_BLOCKS 16                            // Blocks per series, the oldest is dropped when full
+#define SENSOR_LOG_BLOCK_BYTES 64                       // Delta bytes per block
+#define SENSOR_LOG_BLOCK_SAMPLES (SENSOR_LOG_BLOCK_BYTES + 1) // Most values one block can hold
+#define SENSOR_LOG_MAX_DECIMATION 64
+
+// Running statistics and ring use of one series
+typedef struct
+{
+    uint32_t samples;      // Readings seen since the last clear
+    int32_t min;
+    int32_t max;
+    float mean;
+    float variance;
+    uint32_t recorded;     // Values held in the ring
+    uint32_t bytes;        // Delta bytes held in the ring
+    uint32_t span_ms;      // Time covered by the values held
+    uint8_t decimation;    // Readings averaged into each recorded value
+    uint32_t busy_us;      // Time spent recording since the last clear
+    uint32_t max_cycles;   // Longest single record
+} sensor_log_stats_t;
+
+/**
+ * @brief
+ * Creates the recorder's RTOS resources.  Must be called before the
+ * scheduler starts.
+ * @return true
+ * @return false
+ */
+bool sensor_log_init(void);
+
+/**
+ * @brief
+ * Adds a sensor hub reading to its series.  The IMU is recorded as the
+ * magnitude of the acceleration.  Called by the sensor hub task.
+ * @param sensor
+ * @param value
+ * @param period Sampling period of the sensor in ticks
+ */
+void sensor_log_record(sensor_hub_sensor_t sensor, const int32_t value[3], TickType_t period);
+
+/**
+ * @brief
+ * Sets how many readings are averaged into each recorded value.  Larger
+ * values trade resolution for retention.  Clears the series.
+ * @param sensor
+ * @param decimation 1 to SENSOR_LOG_MAX_DECIMATION
+ * @return true
+ * @return false
+ */
+bool sensor_log_configure(sensor_hub_sensor_t sensor, uint8_t decimation);
+
+/**
+ * @brief
+ * Discards the history and statistics of a series
+ * @param sensor
+ */
+void sensor_log_clear(sensor_hub_sensor_t sensor);
+
+bool sensor_log_get_stats(sensor_hub_sensor_t sensor, sensor_log_stats_t *stats);
+
+/**
+ * @brief
+ * Decodes one block of a series, oldest block first.  Value i was
+ * recorded at start + i * interval.
+ * @param sensor
+ * @param block 0 is the oldest block held
+ * @param start Tick count of the first value
+ * @param interval Ticks between values
+ * @param values Must hold SENSOR_LOG_BLOCK_SAMPLES values
+ * @return uint16_t Number of values, 0 once block is past the newest block
+ */
+uint16_t sensor_log_read_block(
+    sensor_hub_sensor_t sensor,
+    uint8_t block,
+    TickType_t *start,
+    TickType_t *interval,
+    int32_t *values);
+
+#endif
+#endif
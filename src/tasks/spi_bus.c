@@ -0,0 +1,188 @@
+/**
+ * @file spi_bus.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Arbitration, chip select and DMA transfers for the shared SPI bus
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "spi_bus.h"
+#include <string.h>
+
+/**
+ * @brief
+ * The IMU and EEPROM tasks share one SPI bus.  Ownership is still the SPI
+ * mutex, but clients take it through spi_bus_acquire() so the wait and
+ * hold times of each device are measured.  FreeRTOS queues mutex waiters
+ * by task priority, so the IMU task (higher priority) is always handed the
+ * bus ahead of a waiting EEPROM transfer, and priority inheritance keeps a
+ * lower priority holder from being preempted while it owns the bus.
+ *
+ * spi_bus_transfer() frames a transfer with the client's chip select.
+ * Data phases of SPI_BUS_DMA_MIN_LENGTH bytes or more are started with
+ * cyhal_spi_transfer_async() in DMA mode, and the calling task sleeps on
+ * its task notification until the done interrupt instead of spinning on
+ * the SCB FIFO.
+ */
+
+/* Global Variables */
+static cyhal_spi_t *SPI_Obj = NULL;
+static SemaphoreHandle_t *SPI_Semaphore = NULL;
+static spi_bus_client_t *SPI_Bus_Clients[SPI_BUS_MAX_CLIENTS];
+static uint8_t SPI_Bus_Client_Count = 0;
+static TaskHandle_t SPI_Bus_Waiter = NULL; // Task sleeping on a DMA transfer
+
+/**
+ * @brief
+ * Transfer done interrupt for DMA transfers
+ * @param callback_arg
+ * @param event
+ */
+static void spi_bus_handler(void *callback_arg, cyhal_spi_event_t event)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    (void)callback_arg;
+
+    if ((event & CYHAL_SPI_IRQ_DONE) != 0 && SPI_Bus_Waiter != NULL)
+    {
+        vTaskNotifyGiveFromISR(SPI_Bus_Waiter, &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+bool spi_bus_client_register(spi_bus_client_t *client, const char *name, cyhal_gpio_t cs_pin)
+{
+    if (client == NULL || SPI_Bus_Client_Count >= SPI_BUS_MAX_CLIENTS)
+    {
+        return false;
+    }
+
+    memset(client, 0, sizeof(spi_bus_client_t));
+    client->name = name;
+    client->cs_pin = cs_pin;
+    SPI_Bus_Clients[SPI_Bus_Client_Count++] = client;
+
+    return true;
+}
+
+void spi_bus_acquire(spi_bus_client_t *client)
+{
+    uint32_t start = timer_cycles_get();
+    uint32_t wait_us;
+
+    xSemaphoreTake(*SPI_Semaphore, portMAX_DELAY);
+
+    client->acquired_at = timer_cycles_get();
+    client->acquisitions++;
+    wait_us = timer_cycles_to_us(client->acquired_at - start);
+    if (wait_us > client->max_wait_us)
+    {
+        client->max_wait_us = wait_us;
+    }
+}
+
+void spi_bus_release(spi_bus_client_t *client)
+{
+    uint32_t hold_us = timer_cycles_to_us(timer_cycles_get() - client->acquired_at);
+
+    client->hold_us += hold_us;
+    if (hold_us > client->max_hold_us)
+    {
+        client->max_hold_us = hold_us;
+    }
+
+    xSemaphoreGive(*SPI_Semaphore);
+}
+
+cy_rslt_t spi_bus_transfer(
+    spi_bus_client_t *client,
+    const uint8_t *cmd,
+    uint16_t cmd_length,
+    const uint8_t *tx,
+    uint8_t *rx,
+    uint16_t length)
+{
+    cy_rslt_t rslt = CY_RSLT_SUCCESS;
+
+    cyhal_gpio_write(client->cs_pin, 0);
+
+    if (cmd_length > 0)
+    {
+        rslt = cyhal_spi_transfer(SPI_Obj, cmd, cmd_length, NULL, 0, 0xFF);
+    }
+
+    if (rslt == CY_RSLT_SUCCESS && length > 0)
+    {
+        if (length < SPI_BUS_DMA_MIN_LENGTH)
+        {
+            rslt = cyhal_spi_transfer(SPI_Obj, tx, (tx != NULL) ? length : 0, rx, (rx != NULL) ? length : 0, 0xFF);
+        }
+        else
+        {
+            // Clear a completion left over from a transfer that timed out
+            ulTaskNotifyTake(pdTRUE, 0);
+            SPI_Bus_Waiter = xTaskGetCurrentTaskHandle();
+
+            rslt = cyhal_spi_transfer_async(SPI_Obj, tx, (tx != NULL) ? length : 0, rx, (rx != NULL) ? length : 0);
+            if (rslt == CY_RSLT_SUCCESS)
+            {
+                client->dma_transfers++;
+                if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SPI_BUS_TIMEOUT_MS)) == 0)
+                {
+                    cyhal_spi_abort_async(SPI_Obj);
+                    rslt = CYHAL_SPI_RSLT_TRANSFER_ERROR;
+                }
+            }
+
+            SPI_Bus_Waiter = NULL;
+        }
+    }
+
+    cyhal_gpio_write(client->cs_pin, 1);
+
+    return rslt;
+}
+
+spi_bus_client_t *spi_bus_get_client(uint8_t index)
+{
+    return (index < SPI_Bus_Client_Count) ? SPI_Bus_Clients[index] : NULL;
+}
+
+/**
+ * @brief
+ * Initializes the bus manager.  This function expects that the SPI
+ * peripheral had already been initialized prior to the start of FreeRTOS.
+ * @param spi_obj
+ * @param spi_semaphore
+ * @return true
+ * @return false
+ */
+bool spi_bus_init(cyhal_spi_t *spi_obj, SemaphoreHandle_t *spi_semaphore)
+{
+    if (spi_obj == NULL || spi_semaphore == NULL)
+    {
+        return false;
+    }
+
+    SPI_Obj = spi_obj;
+    SPI_Semaphore = spi_semaphore;
+
+    timer_cycles_init();
+
+    if (cyhal_spi_set_async_mode(SPI_Obj, CYHAL_ASYNC_DMA, CYHAL_DMA_PRIORITY_DEFAULT) != CY_RSLT_SUCCESS)
+    {
+        return false;
+    }
+
+    cyhal_spi_register_callback(SPI_Obj, spi_bus_handler, NULL);
+    cyhal_spi_enable_event(SPI_Obj, CYHAL_SPI_IRQ_DONE, INT_PRIORITY_SPI, true);
+
+    return true;
+}
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file spi_bus.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Arbitration, chip select and DMA transfers for the shared SPI bus
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __SPI_BUS_H__
+#define __SPI_BUS_H__
+
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "drivers.h"
+#include "spi.h"
+
+#define INT_PRIORITY_SPI 5
+#define SPI_BUS_MAX_CLIENTS 4
+#define SPI_BUS_DMA_MIN_LENGTH 16 // Shorter data phases are not worth the DMA setup
+#define SPI_BUS_TIMEOUT_MS 10     // DMA transfer abandoned if not complete by then
+
+// One device on the bus.  Counters are updated by the bus manager.
+typedef struct
+{
+    const char *name;
+    cyhal_gpio_t cs_pin;
+    uint32_t acquisitions; // Times the bus was acquired
+    uint32_t max_wait_us;  // Longest wait to acquire the bus
+    uint32_t hold_us;      // Total time the bus was held
+    uint32_t max_hold_us;  // Longest single hold
+    uint32_t dma_transfers;
+    uint32_t acquired_at;  // Cycle count when the bus was last acquired
+} spi_bus_client_t;
+
+/**
+ * @brief
+ * Registers a device on the bus.  The client must remain valid for the
+ * life of the program.  Must be called before the scheduler starts.
+ * @param client
+ * @param name
+ * @param cs_pin
+ * @return true
+ * @return false
+ */
+bool spi_bus_client_register(spi_bus_client_t *client, const char *name, cyhal_gpio_t cs_pin);
+
+/**
+ * @brief
+ * Waits for and takes ownership of the bus.  Waiting clients are served
+ * in order of the priority of their tasks.
+ * @param client
+ */
+void spi_bus_acquire(spi_bus_client_t *client);
+
+/**
+ * @brief
+ * Gives up ownership of the bus
+ * @param client
+ */
+void spi_bus_release(spi_bus_client_t *client);
+
+/**
+ * @brief
+ * Runs one chip select framed transfer.  The command bytes are sent first,
+ * then length data bytes are written from tx and/or read into rx (either
+ * may be NULL).  Long data phases run through DMA while the calling task
+ * sleeps.  The caller must own the bus.
+ * @param client
+ * @param cmd
+ * @param cmd_length
+ * @param tx
+ * @param rx
+ * @param length
+ * @return cy_rslt_t
+ */
+cy_rslt_t spi_bus_transfer(
+    spi_bus_client_t *client,
+    const uint8_t *cmd,
+    uint16_t cmd_length,
+    const uint8_t *tx,
+    uint8_t *rx,
+    uint16_t length);
+
+/**
+ * @brief
+ * Returns the registered client at index, or NULL
+ * @param index
+ * @return spi_bus_client_t*
+ */
+spi_bus_client_t *spi_bus_get_client(uint8_t index);
+
+bool spi_bus_init(cyhal_spi_t *spi_obj, SemaphoreHandle_t *spi_semaphore);
+
+#endif
+#endif
@@ -14,128 +14,160 @@
 
 #ifdef ECE353_FREERTOS
 
+#include <timers.h>
+#include <string.h>
+
 // External reference to the global event group created in ice11.c
 extern EventGroupHandle_t ECE353_RTOS_Events;
+
+typedef struct
+{
+    cyhal_gpio_t pin;
+    EventBits_t event;
+    cyhal_gpio_callback_data_t callback;
+    TimerHandle_t timer;
+    volatile bool debouncing;           // Debounce timer running
+    volatile uint32_t first_edge_at;    // Cycle count of the first edge of the burst
+    volatile uint32_t last_edge_at;     // Cycle count of the most recent edge
+    bool pressed;                       // Last validated level
+} button_t;
+
+static button_t buttons[] = {
+    {.pin = PIN_BUTTON_SW1, .event = ECE353_RTOS_EVENTS_SW1},
+    {.pin = PIN_BUTTON_SW2, .event = ECE353_RTOS_EVENTS_SW2},
+    {.pin = PIN_BUTTON_SW3, .event = ECE353_RTOS_EVENTS_SW3},
+};
+
+static buttons_stats_t button_stats = {.latency_min_us = UINT32_MAX};
+
 /**
  * @brief
- * Task used to debounce button presses (SW1, SW2, SW3).
- * The falling edge of the button press is detected by de-bouncing
- * the button for 30mS. Each button should be sampled every 15mS.
- *
- * When a button press is detected, the corresponding event is set in
- * in the event group ECE353_RTOS_Events.
- *
+ * GPIO interrupt for both edges of a button.  The first edge of a burst
+ * starts the button's one-shot debounce timer; later bounces only record
+ * their time.  A start the timer queue refuses is counted and retried on
+ * the next edge.
  * @param arg
- * Unused parameter
+ * The button
+ * @param event
  */
-void task_buttons(void *arg)
+static void button_edge_handler(void *arg, cyhal_gpio_event_t event)
 {
-    (void)arg; // Unused parameter
-    
-    // Debounce counters for each button (need 2 consecutive samples for 30ms debounce)
-    uint32_t sw1_count = 0;
-    uint32_t sw2_count = 0;
-    uint32_t sw3_count = 0;
-
-    // Previous button states for edge detection (true = not pressed)
-    bool prev_sw1_pressed = false;
-    bool prev_sw2_pressed = false;
-    bool prev_sw3_pressed = false;
-
-    while (1)
+    button_t *button = (button_t *)arg;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint32_t now = timer_cycles_get();
+    (void)event;
+
+    button_stats.edges++;
+    button->last_edge_at = now;
+    if (!button->debouncing)
     {
-        // Current button states (0 = pressed)
-        bool sw1_pressed = ((PORT_BUTTON_SW1->IN & MASK_BUTTON_PIN_SW1) == 0);
-        bool sw2_pressed = ((PORT_BUTTON_SW2->IN & MASK_BUTTON_PIN_SW2) == 0);
-        bool sw3_pressed = ((PORT_BUTTON_SW3->IN & MASK_BUTTON_PIN_SW3) == 0);
+        button->debouncing = true;
+        button->first_edge_at = now;
 
-        // Monitor button SW1 with debouncing
-        if (sw1_pressed)
+        // The timer command queue is shared with led_anim.c.  If it is full
+        // the next edge tries again instead of the button going quiet.
+        if (xTimerStartFromISR(button->timer, &xHigherPriorityTaskWoken) != pdPASS)
         {
-            sw1_count++;
-            if (sw1_count >= 2 && !prev_sw1_pressed) // Falling edge after debounce
-            {
-                // Set the SW1_PRESSED event in the event group
-                xEventGroupSetBits(ECE353_RTOS_Events, ECE353_RTOS_EVENTS_SW1);
-                vTaskDelay(pdMS_TO_TICKS(30)); // Delay for debounce
-                prev_sw1_pressed = true;
-            }
-        }
-        else
-        {
-            sw1_count = 0;
-            prev_sw1_pressed = false;
+            button->debouncing = false;
+            button_stats.timer_failures++;
         }
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
 
-        // Monitor button SW2 with debouncing
-        if (sw2_pressed)
-        {
-            sw2_count++;
-            if (sw2_count >= 2 && !prev_sw2_pressed) // Falling edge after debounce
-            {
-                // Set the SW2_PRESSED event in the event group
-                xEventGroupSetBits(ECE353_RTOS_Events, ECE353_RTOS_EVENTS_SW2);
-
-                vTaskDelay(pdMS_TO_TICKS(30)); // Delay for debounce
-                prev_sw2_pressed = true;
-            }
-        }
-        else
-        {
-            sw2_count = 0;
-            prev_sw2_pressed = false;
-        }
+/**
+ * @brief
+ * Records the time from the first edge of a press to its event
+ * @param latency_us
+ */
+static void button_latency_record(uint32_t latency_us)
+{
+    uint32_t bin = latency_us / (BUTTON_LATENCY_BIN_MS * 1000);
 
-        // Monitor button SW3 with debouncing
-        if (sw3_pressed)
-        {
-            sw3_count++;
-            if (sw3_count >= 2 && !prev_sw3_pressed) // Falling edge after debounce
-            {
-                // Set the SW3_PRESSED event in the event group
-                xEventGroupSetBits(ECE353_RTOS_Events, ECE353_RTOS_EVENTS_SW3);
-
-                vTaskDelay(pdMS_TO_TICKS(30)); // Delay for debounce
-                prev_sw3_pressed = true;
-            }
-        }
-        else
-        {
-            sw3_count = 0;
-            prev_sw3_pressed = false;
-        }
+    button_stats.presses++;
+    button_stats.latency_sum_us += latency_us;
+    if (latency_us < button_stats.latency_min_us)
+    {
+        button_stats.latency_min_us = latency_us;
+    }
+    if (latency_us > button_stats.latency_max_us)
+    {
+        button_stats.latency_max_us = latency_us;
+    }
+    button_stats.latency_bins[(bin < BUTTON_LATENCY_BINS) ? bin : BUTTON_LATENCY_BINS - 1]++;
+}
 
-        // Sample every 15ms (2 samples = 30ms debounce time)
-        vTaskDelay(pdMS_TO_TICKS(15));
+/**
+ * @brief
+ * Debounce timer expiry, run by the timer service task.  If the pin
+ * bounced during the period the timer is started again, so the level is
+ * only sampled once it has been stable for BUTTON_DEBOUNCE_MS.  A new
+ * pressed level sets the button's event bit.
+ * @param timer
+ */
+static void button_debounce_expired(TimerHandle_t timer)
+{
+    button_t *button = (button_t *)pvTimerGetTimerID(timer);
+    uint32_t first_edge_at;
+    bool pressed;
+
+    button_stats.debounces++;
+    if (timer_cycles_to_us(timer_cycles_get() - button->last_edge_at) < BUTTON_DEBOUNCE_MS * 1000)
+    {
+        xTimerReset(timer, 0);
+        return;
     }
-} /* Button Task Initialization */
+
+    taskENTER_CRITICAL();
+    pressed = !cyhal_gpio_read(button->pin); // 0 = pressed
+    first_edge_at = button->first_edge_at;
+    button->debouncing = false;
+    taskEXIT_CRITICAL();
+
+    if (pressed && !button->pressed)
+    {
+        xEventGroupSetBits(ECE353_RTOS_Events, button->event);
+        button_latency_record(timer_cycles_to_us(timer_cycles_get() - first_edge_at));
+    }
+    button->pressed = pressed;
+}
+
+/* Button Initialization */
 bool task_button_init(void)
 {
+    timer_cycles_init();
 
-    BaseType_t result;
-    // cy_rslt_t rslt;
-
-    // // initialize the buttons
-    // rslt = buttons_init_gpio();
-    // if (rslt != CY_RSLT_SUCCESS)
-    // {
-    //     return false;
-    // }
-
-    // Create the button task
-    result = xTaskCreate(
-        task_buttons,
-        "Button Task",
-        configMINIMAL_STACK_SIZE,
-        NULL,
-        tskIDLE_PRIORITY + 1,
-        NULL);
-
-    if (result != pdPASS)
+    for (uint8_t i = 0; i < sizeof(buttons) / sizeof(buttons[0]); i++)
+    {
+        button_t *button = &buttons[i];
+
+        button->timer = xTimerCreate("Button", pdMS_TO_TICKS(BUTTON_DEBOUNCE_MS), pdFALSE, button, button_debounce_expired);
+        if (button->timer == NULL)
+        {
+            return false;
+        }
+
+        button->pressed = !cyhal_gpio_read(button->pin);
+        button->callback.callback = button_edge_handler;
+        button->callback.callback_arg = button;
+        cyhal_gpio_register_callback(button->pin, &button->callback);
+        cyhal_gpio_enable_event(button->pin, CYHAL_GPIO_IRQ_BOTH, INT_PRIORITY_BUTTONS, true);
+    }
+
+    return true;
+}
+
+bool task_button_get_stats(buttons_stats_t *stats)
+{
+    if (stats == NULL)
     {
         return false;
     }
 
+    taskENTER_CRITICAL();
+    memcpy(stats, &button_stats, sizeof(buttons_stats_t));
+    taskEXIT_CRITICAL();
+
     return true;
 }
-#endif
\ No newline at end of file
+#endif
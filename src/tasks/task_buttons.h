@@ -18,8 +18,35 @@
  #include "drivers.h"
  #include "rtos_events.h"
 
- void task_buttons(void *arg);
+ #define INT_PRIORITY_BUTTONS 7
+ #define BUTTON_DEBOUNCE_MS 20     // A level must be stable this long to count
+ #define BUTTON_POLL_MS 15         // Period of the polling loop this replaced
+ #define BUTTON_LATENCY_BINS 8
+ #define BUTTON_LATENCY_BIN_MS 5
+
+ // Counters for all three buttons
+ typedef struct
+ {
+     uint32_t edges;                                // GPIO interrupts, bounces included
+     uint32_t debounces;                            // Debounce timer expiries
+     uint32_t timer_failures;                       // Debounce timer starts lost to a full timer queue
+     uint32_t presses;                              // Validated presses
+     uint32_t latency_min_us;                       // First edge to event bit set
+     uint32_t latency_max_us;
+     uint32_t latency_sum_us;
+     uint32_t latency_bins[BUTTON_LATENCY_BINS];    // BUTTON_LATENCY_BIN_MS wide, last bin is open ended
+ } buttons_stats_t;
+
+ /**
+  * @brief
+  * Enables the button edge interrupts and debounce timers.  The GPIOs must
+  * already be initialized.  No task is created.
+  * @return true
+  * @return false
+  */
  bool task_button_init(void);
+
+ bool task_button_get_stats(buttons_stats_t *stats);
  #endif
 
 #endif // __TASK_BUTTONS_H__
@@ -16,9 +16,11 @@
  * @brief
  * This function is the event handler for the console UART.
  *
- * The ISR will receive characters from the UART and store them in a console buffer
- * until the user presses the ENTER key.  At that point, the ISR will send a task
- * notification to the console task to process the received string.
+ * The ISR drains the UART Rx FIFO into the circular_buffer_rx byte ring.  When
+ * a line terminator arrives, or the ring is half full, the ISR sends a task
+ * notification to the line assembler task, which builds complete command
+ * lines from the ring.  Bytes that arrive while the ring is full are counted
+ * in Console_Rx_Stats.ring_overflows.
  *
  * The ISR will also echo the received character back to the console.
  *
@@ -33,48 +35,36 @@ void console_event_handler(void *handler_arg, cyhal_uart_event_t event)
 
     if ((event & CYHAL_UART_IRQ_RX_NOT_EMPTY) == CYHAL_UART_IRQ_RX_NOT_EMPTY)
     {
-        // ADD CODE
-        c = PORT_SCB_CONSOLE->RX_FIFO_RD;
+        bool wake_assembler = false;
 
-        PORT_SCB_CONSOLE->TX_FIFO_WR = c; // Echo the character back to the console hardware FIFO
-
-        // if characyer is equal to a backspace or the delete key, remove the
-        // last character from array
-        if ((c == '\b' || c == 0x7F))
+        // Drain every byte in the FIFO so pasted input costs one interrupt per burst
+        while (Cy_SCB_GetNumInRxFifo(PORT_SCB_CONSOLE) > 0)
         {
-            // if the index is greater than 0, then we have something to delete
-            if (produce_console_buffer->index > 0)
+            c = PORT_SCB_CONSOLE->RX_FIFO_RD;
+
+            PORT_SCB_CONSOLE->TX_FIFO_WR = c; // Echo the character back to the console hardware FIFO
+
+            if (!circular_buffer_add(circular_buffer_rx, c))
+            {
+                Console_Rx_Stats.ring_overflows++;
+            }
+            else if (c == '\n' || c == '\r')
             {
-                // decrement the index
-                produce_console_buffer->index--;
+                wake_assembler = true;
             }
-            return;
         }
 
-        // else if the current character is a \n or \r,
-        else if (c == '\n' || c == '\r')
+        // Also wake the assembler early so a long line cannot fill the ring
+        if (circular_buffer_get_num_bytes(circular_buffer_rx) >= (CONSOLE_RX_RING_SIZE / 2))
         {
-            // if the index is greater than 0, then we have a command to process
-            if (produce_console_buffer->index != 0)
-            {
-                // NULL terminate the string
-                produce_console_buffer->data[produce_console_buffer->index] = '\0';
-                // swap the role of the produce and consume buffers
-                console_buffer_t *temp = produce_console_buffer;
-                produce_console_buffer = consume_console_buffer;
-                consume_console_buffer = temp;
-                // set index to 0 again
-                produce_console_buffer->index = 0;
-                // Send the task notification to the bottom half task
-                // printf("DEBUG ISR: Sending notification to console task\n\r");
-                vTaskNotifyGiveFromISR(TaskHandle_Console_Rx, &xHigherPriorityTaskWoken);
-                portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-            }
+            wake_assembler = true;
         }
-        // else add the character to the buffer and increment the index
-        else
+
+        if (wake_assembler)
         {
-            produce_console_buffer->data[produce_console_buffer->index++] = c;
+            // Send the task notification to the bottom half task
+            vTaskNotifyGiveFromISR(TaskHandle_Console_Rx_Line, &xHigherPriorityTaskWoken);
+            portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
         }
     }
     if ((event & CYHAL_UART_IRQ_TX_EMPTY) == CYHAL_UART_IRQ_TX_EMPTY)
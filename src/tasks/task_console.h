@@ -26,19 +26,29 @@
 #define CONSOLE_QUEUE_LENGTH 10
 #define CONSOLE_BUFFER_SIZE 64
 
-// Data structure to hold console message data when using 
-// FreeRTOS and double buffering
+#define CONSOLE_RX_RING_SIZE 256       // Bytes buffered between the Rx ISR and the line assembler
+#define CONSOLE_RX_LINE_LENGTH 128     // Longest accepted command line, including the NULL
+#define CONSOLE_RX_LINE_QUEUE_LENGTH 8 // Complete lines waiting to be executed
+
+// Data structure to hold console message data
 typedef struct {
     char *data; // Buffer to hold the input string
     uint8_t index;    // Current index in the buffer
 } console_buffer_t;
 
+// Counters used to detect lost console input
+typedef struct {
+    volatile uint32_t ring_overflows; // Bytes dropped because the Rx ring was full
+    uint32_t line_overflows;          // Lines dropped for exceeding CONSOLE_RX_LINE_LENGTH
+    uint32_t lines_received;          // Lines queued for execution
+} console_rx_stats_t;
+
 // Global variables used for receiving data
-extern console_buffer_t console_buffer1;
-extern console_buffer_t console_buffer2;
-extern console_buffer_t *produce_console_buffer;
-extern console_buffer_t *consume_console_buffer;
+extern circular_buffer_t *circular_buffer_rx;
+extern QueueHandle_t xQueue_Console_Rx;
+extern console_rx_stats_t Console_Rx_Stats;
 extern TaskHandle_t TaskHandle_Console_Rx;
+extern TaskHandle_t TaskHandle_Console_Rx_Line;
 
 // Global variable for transmitting data
 extern circular_buffer_t *circular_buffer_tx;
@@ -52,6 +62,7 @@ bool task_console_resources_init_rx(void);
 bool task_console_resources_init_tx(void);
 bool task_console_init(void);
 void task_console_printf(char *str_ptr, ...);
+void task_console_write(const char *str);
 
 
 #endif
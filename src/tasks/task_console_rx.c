@@ -14,261 +14,1295 @@
 #include "drivers.h"
 #include "task_console.h"
 #include "devices.h"
+#include "device_manager.h"
+#include "bitboard.h"
+#include "battleship_ai.h"
+#include "battleship_engine.h"
 #include "task_eeprom.h"
 #include "task_imu.h"
 #include "task_light_sensor.h"
+#include "task_io_expander.h"
+#include "task_i2c.h"
+#include "spi_bus.h"
+#include "task_sensor_hub.h"
+#include "task_temp_sensor.h"
+#include "sensor_log.h"
+#include "kv_store.h"
+#include "task_joystick.h"
+#include "task_buttons.h"
+#include "led_anim.h"
+#include "console_cmd.h"
+#include "console_line.h"
 #include "cyhal_uart.h"
+#include <ctype.h>
+#include <string.h>
 /**
  * @brief
  * This file contains the implementation of the console receive (Rx) task.
  * The task is responsible for processing incoming console commands and
  * controlling hardware devices and LEDs.
  *
- * The task uses a double buffer to process the incoming console commands.
- * Supported commands: RED_ON, RED_OFF, EEPROM, IMU, LIGHT, IOEXP
+ * Input flows through three stages so bursts of pasted or scripted input
+ * are not lost while a slow command (e.g. an EEPROM write) is running:
+ *   1. console_event_handler() (ISR) copies bytes into circular_buffer_rx
+ *   2. task_console_rx_line() assembles complete lines from the ring and
+ *      queues them on xQueue_Console_Rx
+ *   3. task_console_rx() executes the queued lines one at a time
+ * Console_Rx_Stats counts input dropped at each stage.
+ *
+ * Commands are dispatched through the console command registry
+ * (console_cmd.c).  Supported commands: RED_ON, RED_OFF, EEPROM, IMU,
+ * LIGHT, IOEXP, I2C, SPI, CONSOLE, SENSORS, LOG, KV, CPU, JOY, BUTTONS,
+ * LED, DEVICES, AI, GAME, help and batch.  Device requests are answered through the
+ * console task's pooled mailbox (device_manager.c).
+ *
+ * EEPROM dump/load move whole regions through the EEPROM task using
+ * sequential reads and page writes.  Dump output uses the same
+ * "<addr>: <hex bytes>" format that load accepts, so a dump captured on
+ * the host can be pasted back to restore the region.  EEPROM bench
+ * compares page write/sequential read throughput against byte access.
+ */
+
+#define CONSOLE_EEPROM_BYTES_PER_LINE 8
+#define CONSOLE_CPU_MAX_TASKS 24
+#define CONSOLE_LOG_VALUES_PER_LINE 6
+
+// Command handlers run on this task's stack (argv, snprintf, etc.)
+#define TASK_CONSOLE_RX_STACK_SIZE (configMINIMAL_STACK_SIZE * 4)
+
+/* Global Variables */
+
+// Byte ring filled by the console ISR
+circular_buffer_t *circular_buffer_rx;
+
+// Complete lines waiting to be executed
+QueueHandle_t xQueue_Console_Rx;
+
+console_rx_stats_t Console_Rx_Stats;
+
+// Allocate task handles for the console Rx tasks
+TaskHandle_t TaskHandle_Console_Rx;
+TaskHandle_t TaskHandle_Console_Rx_Line;
+
+// Staging buffer used by the EEPROM dump/load commands
+static uint8_t eeprom_chunk[EEPROM_PAGE_SIZE];
+
+// State of an in-progress EEPROM load
+static bool eeprom_load_active = false;
+static uint16_t eeprom_load_address; // EEPROM address of eeprom_chunk[0]
+static uint16_t eeprom_load_count;   // Number of bytes staged in eeprom_chunk
+static uint32_t eeprom_load_total;   // Number of bytes written so far
+static TickType_t eeprom_load_ticks; // Ticks spent in EEPROM writes
+
+/**
+ * @brief
+ * Returns the bytes/s rate for a transfer of length bytes that took ticks
+ * @param length
+ * @param ticks
+ * @return uint32_t
+ */
+static uint32_t console_eeprom_rate(uint32_t length, TickType_t ticks)
+{
+    uint32_t ms = ticks * portTICK_PERIOD_MS;
+
+    if (ms == 0)
+    {
+        ms = 1; // Transfer finished inside a single tick
+    }
+
+    return (length * 1000) / ms;
+}
+
+/**
+ * @brief
+ * Reads length bytes starting at address and prints them as hex, one
+ * "<addr>: <bytes>" line per CONSOLE_EEPROM_BYTES_PER_LINE bytes.
+ * @param address
+ * @param length
+ * @return true
+ * @return false
+ */
+static bool console_eeprom_dump(uint16_t address, uint32_t length)
+{
+    char line[CONSOLE_MAX_MESSAGE_LENGTH];
+    TickType_t spi_ticks = 0;
+    uint32_t done = 0;
+
+    while (done < length)
+    {
+        uint16_t chunk = (length - done < sizeof(eeprom_chunk)) ? (length - done) : sizeof(eeprom_chunk);
+        TickType_t start = xTaskGetTickCount();
+
+        if (!system_sensors_eeprom_read_block(device_mailbox(), address + done, eeprom_chunk, chunk))
+        {
+            console_cmd_reply("EEPROM Dump Failed: Addr=0x%04X\r\n", address + done);
+            return false;
+        }
+        spi_ticks += xTaskGetTickCount() - start;
+
+        for (uint16_t i = 0; i < chunk; i += CONSOLE_EEPROM_BYTES_PER_LINE)
+        {
+            int n = snprintf(line, sizeof(line), "0x%04X:", (unsigned)(address + done + i));
+
+            for (uint16_t j = i; j < chunk && j < i + CONSOLE_EEPROM_BYTES_PER_LINE; j++)
+            {
+                n += snprintf(line + n, sizeof(line) - n, " %02X", eeprom_chunk[j]);
+            }
+
+            console_cmd_reply("%s\r\n", line);
+        }
+
+        done += chunk;
+    }
+
+    console_cmd_reply("EEPROM Dump: %lu bytes, %lu bytes/s\r\n",
+                      length, console_eeprom_rate(length, spi_ticks));
+    return true;
+}
+
+/**
+ * @brief
+ * Writes the bytes staged in eeprom_chunk to the EEPROM
+ * @return true
+ * @return false
+ */
+static bool console_eeprom_load_flush(void)
+{
+    TickType_t start;
+
+    if (eeprom_load_count == 0)
+    {
+        return true;
+    }
+
+    start = xTaskGetTickCount();
+    if (!system_sensors_eeprom_write_block(device_mailbox(), eeprom_load_address, eeprom_chunk, eeprom_load_count))
+    {
+        task_console_printf("EEPROM Load Failed: Addr=0x%04X\r\n", eeprom_load_address);
+        eeprom_load_active = false;
+        return false;
+    }
+    eeprom_load_ticks += xTaskGetTickCount() - start;
+
+    eeprom_load_total += eeprom_load_count;
+    eeprom_load_address += eeprom_load_count;
+    eeprom_load_count = 0;
+    return true;
+}
+
+/**
+ * @brief
+ * Returns the bytes/s rate for a transfer of length bytes that took us
+ * microseconds
+ * @param length
+ * @param us
+ * @return uint32_t
+ */
+static uint32_t console_eeprom_rate_us(uint32_t length, uint32_t us)
+{
+    return (uint32_t)(((uint64_t)length * 1000000) / ((us != 0) ? us : 1));
+}
+
+/**
+ * @brief
+ * Writes a test pattern to length bytes at address, first as one page
+ * write and then one byte at a time, reading it back each way.  Reports the
+ * throughput of each access style.  Write times include a sync, so they
+ * cover the EEPROM write-back cache flushing to the device.  Overwrites the
+ * bytes under test.
+ * @param address
+ * @param length
+ * @return true
+ * @return false
+ */
+static bool console_eeprom_bench(uint16_t address, uint16_t length)
+{
+    uint32_t block_write_us, block_read_us, byte_write_us, byte_read_us;
+    uint32_t start;
+    uint16_t errors = 0;
+
+    timer_cycles_init();
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        eeprom_chunk[i] = (uint8_t)(i ^ 0xA5);
+    }
+
+    start = timer_cycles_get();
+    if (!system_sensors_eeprom_write_block(device_mailbox(), address, eeprom_chunk, length))
+    {
+        console_cmd_reply("EEPROM Bench: block write failed\r\n");
+        return false;
+    }
+    system_sensors_eeprom_sync(device_mailbox());
+    block_write_us = timer_cycles_to_us(timer_cycles_get() - start);
+
+    memset(eeprom_chunk, 0, length);
+    start = timer_cycles_get();
+    if (!system_sensors_eeprom_read_block(device_mailbox(), address, eeprom_chunk, length))
+    {
+        console_cmd_reply("EEPROM Bench: block read failed\r\n");
+        return false;
+    }
+    block_read_us = timer_cycles_to_us(timer_cycles_get() - start);
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        errors += (eeprom_chunk[i] != (uint8_t)(i ^ 0xA5));
+    }
+
+    // Same bytes again, one transaction (and one write cycle) per byte
+    start = timer_cycles_get();
+    for (uint16_t i = 0; i < length; i++)
+    {
+        if (!system_sensors_eeprom_write(device_mailbox(), address + i, (uint8_t)(i ^ 0x5A)))
+        {
+            console_cmd_reply("EEPROM Bench: byte write failed\r\n");
+            return false;
+        }
+    }
+    system_sensors_eeprom_sync(device_mailbox());
+    byte_write_us = timer_cycles_to_us(timer_cycles_get() - start);
+
+    start = timer_cycles_get();
+    for (uint16_t i = 0; i < length; i++)
+    {
+        if (!system_sensors_eeprom_read(device_mailbox(), address + i, &eeprom_chunk[i]))
+        {
+            console_cmd_reply("EEPROM Bench: byte read failed\r\n");
+            return false;
+        }
+    }
+    byte_read_us = timer_cycles_to_us(timer_cycles_get() - start);
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        errors += (eeprom_chunk[i] != (uint8_t)(i ^ 0x5A));
+    }
+
+    console_cmd_reply("Block: W %lu B/s, R %lu B/s\r\n",
+                      console_eeprom_rate_us(length, block_write_us),
+                      console_eeprom_rate_us(length, block_read_us));
+    console_cmd_reply("Byte:  W %lu B/s, R %lu B/s\r\n",
+                      console_eeprom_rate_us(length, byte_write_us),
+                      console_eeprom_rate_us(length, byte_read_us));
+    console_cmd_reply("Verify: %u errors in %u bytes\r\n", errors, length * 2);
+
+    return errors == 0;
+}
+
+/**
+ * @brief
+ * Processes one line of input while an EEPROM load is active.  The line
+ * holds hex byte pairs, optionally preceded by an "<addr>:" prefix as
+ * produced by EEPROM dump.  "end" writes any staged bytes and finishes
+ * the load.
+ * @param line
+ */
+static void console_eeprom_load_line(char *line)
+{
+    char *hex = strrchr(line, ':');
+    int nibble = -1;
+
+    if (strcmp(line, "end") == 0 || strcmp(line, "END") == 0)
+    {
+        if (console_eeprom_load_flush())
+        {
+            task_console_printf("EEPROM Load: %lu bytes, %lu bytes/s\r\n",
+                                eeprom_load_total, console_eeprom_rate(eeprom_load_total, eeprom_load_ticks));
+        }
+        eeprom_load_active = false;
+        return;
+    }
+
+    // Skip the address prefix printed by EEPROM dump
+    hex = (hex != NULL) ? hex + 1 : line;
+
+    for (; *hex != '\0'; hex++)
+    {
+        int value;
+
+        if (isspace((unsigned char)*hex))
+        {
+            continue;
+        }
+        if (!isxdigit((unsigned char)*hex))
+        {
+            task_console_printf("EEPROM Load: invalid hex '%c', load aborted\r\n", *hex);
+            eeprom_load_active = false;
+            return;
+        }
+
+        value = isdigit((unsigned char)*hex) ? (*hex - '0') : (toupper((unsigned char)*hex) - 'A' + 10);
+        if (nibble < 0)
+        {
+            nibble = value;
+            continue;
+        }
+
+        eeprom_chunk[eeprom_load_count++] = (uint8_t)((nibble << 4) | value);
+        nibble = -1;
+
+        // Write as soon as the staged bytes reach the end of an EEPROM page
+        if (((eeprom_load_address + eeprom_load_count) % EEPROM_PAGE_SIZE) == 0)
+        {
+            if (!console_eeprom_load_flush())
+            {
+                return;
+            }
+        }
+    }
+
+    if (nibble >= 0)
+    {
+        task_console_printf("EEPROM Load: odd number of hex digits, load aborted\r\n");
+        eeprom_load_active = false;
+    }
+}
+
+/**
+ * @brief
+ * RED_ON: turns on the red LED
+ */
+static console_cmd_status_t console_cmd_red_on(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    if (!led_anim_set(LED_ANIM_CH_RED, 255))
+    {
+        leds_set_state(LED_RED, LED_ON);
+    }
+    console_cmd_reply("Turning on RED LED\r\n");
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * RED_OFF: turns off the red LED
+ */
+static console_cmd_status_t console_cmd_red_off(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    if (!led_anim_set(LED_ANIM_CH_RED, 0))
+    {
+        leds_set_state(LED_RED, LED_OFF);
+    }
+    console_cmd_reply("Turning off RED LED\r\n");
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * EEPROM w <address> <value> | r <address> | dump <address> <length> |
+ * load <address> | bench <address> <length> | sync | stats
+ */
+static console_cmd_status_t console_cmd_eeprom(int argc, char *argv[])
+{
+    if (strcmp(argv[1], "sync") == 0 && argc == 2)
+    {
+        if (!system_sensors_eeprom_sync(device_mailbox()))
+        {
+            console_cmd_reply("EEPROM Sync Failed\r\n");
+            return CONSOLE_CMD_FAILED;
+        }
+        console_cmd_reply("EEPROM Sync: cache written back\r\n");
+    }
+    else if (strcmp(argv[1], "stats") == 0 && argc == 2)
+    {
+        eeprom_cache_stats_t stats;
+
+        system_sensors_eeprom_get_cache_stats(&stats);
+        console_cmd_reply("Read hit=%lu miss=%lu\r\n", stats.read_hits, stats.read_misses);
+        console_cmd_reply("Writes=%lu Dropped=%lu\r\n", stats.writes, stats.writes_dropped);
+        console_cmd_reply("Flushes=%lu Bytes=%lu Brownouts=%lu\r\n", stats.flushes, stats.bytes_flushed, stats.brownouts);
+    }
+    else if (strcmp(argv[1], "w") == 0 && argc == 4)
+    {
+        uint16_t addr = (uint16_t)strtol(argv[2], NULL, 16);  // hex
+        uint8_t value = (uint8_t)strtol(argv[3], NULL, 16);   // hex
+
+        if (!system_sensors_eeprom_write(device_mailbox(), addr, value))
+        {
+            console_cmd_reply("EEPROM Write Failed: Addr=0x%04X, Value=0x%02X\r\n", addr, value);
+            return CONSOLE_CMD_FAILED;
+        }
+        console_cmd_reply("EEPROM Write: Addr=0x%04X, Value=0x%02X\r\n", addr, value);
+    }
+    else if (strcmp(argv[1], "r") == 0 && argc == 3)
+    {
+        uint16_t address = (uint16_t)strtol(argv[2], NULL, 0);
+        uint8_t data = 0;
+
+        if (!system_sensors_eeprom_read(device_mailbox(), address, &data))
+        {
+            console_cmd_reply("EEPROM Read Failed: Addr=0x%04X\r\n", address);
+            return CONSOLE_CMD_FAILED;
+        }
+        console_cmd_reply("EEPROM Read: Addr=0x%04X Value=0x%02X\r\n", address, data);
+    }
+    else if (strcmp(argv[1], "dump") == 0 && argc == 4)
+    {
+        uint32_t address = (uint32_t)strtoul(argv[2], NULL, 0);
+        uint32_t length = (uint32_t)strtoul(argv[3], NULL, 0);
+
+        if (length == 0 || address + length > 0x10000)
+        {
+            console_cmd_reply("EEPROM Dump: range outside EEPROM\r\n");
+            return CONSOLE_CMD_FAILED;
+        }
+        return console_eeprom_dump((uint16_t)address, length) ? CONSOLE_CMD_OK : CONSOLE_CMD_FAILED;
+    }
+    else if (strcmp(argv[1], "bench") == 0 && argc == 4)
+    {
+        uint32_t address = (uint32_t)strtoul(argv[2], NULL, 0);
+        uint32_t length = (uint32_t)strtoul(argv[3], NULL, 0);
+
+        // Limited to one page so the block write is a single write cycle
+        if (length == 0 || length > sizeof(eeprom_chunk) ||
+            (address % EEPROM_PAGE_SIZE) + length > EEPROM_PAGE_SIZE)
+        {
+            console_cmd_reply("EEPROM Bench: length must fit in one page\r\n");
+            return CONSOLE_CMD_FAILED;
+        }
+        return console_eeprom_bench((uint16_t)address, (uint16_t)length) ? CONSOLE_CMD_OK : CONSOLE_CMD_FAILED;
+    }
+    else if (strcmp(argv[1], "load") == 0 && argc == 3)
+    {
+        // Following lines are hex data until "end"
+        eeprom_load_address = (uint16_t)strtoul(argv[2], NULL, 0);
+        eeprom_load_count = 0;
+        eeprom_load_total = 0;
+        eeprom_load_ticks = 0;
+        eeprom_load_active = true;
+        console_cmd_reply("EEPROM Load: send hex lines, 'end' to finish\r\n");
+    }
+    else
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * IMU stream <hz> <watermark>: starts FIFO streaming at the ODR that
+ * matches hz (104, 208, 416, 833 or 1660).  watermark is 1 to
+ * IMU_SAMPLE_RING_SIZE samples.
+ */
+static console_cmd_status_t console_cmd_imu_stream(char *hz_str, char *watermark_str)
+{
+    uint16_t hz = (uint16_t)strtoul(hz_str, NULL, 0);
+    uint16_t watermark = (uint16_t)strtoul(watermark_str, NULL, 0);
+
+    // A larger drain would overwrite samples before a reader sees them
+    if (watermark == 0 || watermark > IMU_SAMPLE_RING_SIZE)
+    {
+        console_cmd_reply("IMU Stream: watermark is 1 to %u\r\n", IMU_SAMPLE_RING_SIZE);
+        return CONSOLE_CMD_FAILED;
+    }
+
+    for (uint8_t odr = ODR_104HZ; odr <= ODR_1660HZ; odr += 0x10)
+    {
+        if (imu_odr_to_hz(odr) == hz)
+        {
+            if (!system_sensors_imu_stream_start(device_mailbox(), odr, watermark))
+            {
+                console_cmd_reply("IMU Stream Failed\r\n");
+                return CONSOLE_CMD_FAILED;
+            }
+            console_cmd_reply("IMU Stream: %u Hz, watermark %u\r\n", hz, watermark);
+            return CONSOLE_CMD_OK;
+        }
+    }
+
+    return CONSOLE_CMD_USAGE;
+}
+
+/**
+ * @brief
+ * IMU stats: reports the sustained sample rate and SPI bus occupancy of
+ * the IMU stream
+ */
+static console_cmd_status_t console_cmd_imu_stats(void)
+{
+    imu_stream_stats_t stats;
+    uint32_t elapsed_ms;
+
+    if (!imu_stream_get_stats(&stats))
+    {
+        console_cmd_reply("IMU Stream: not running\r\n");
+        return CONSOLE_CMD_FAILED;
+    }
+
+    elapsed_ms = (xTaskGetTickCount() - stats.start) * portTICK_PERIOD_MS;
+    if (elapsed_ms == 0)
+    {
+        elapsed_ms = 1;
+    }
+
+    // bus_us / elapsed_ms is the occupancy in tenths of a percent
+    console_cmd_reply("IMU: %lu samples/s, bus %lu.%lu%%\r\n",
+                      (stats.samples * 1000) / elapsed_ms,
+                      (stats.bus_us / elapsed_ms) / 10,
+                      (stats.bus_us / elapsed_ms) % 10);
+    console_cmd_reply("IMU: %lu bursts, %lu overruns\r\n", stats.bursts, stats.overruns);
+    console_cmd_reply("IMU: jitter max %luus avg %luus\r\n",
+                      stats.jitter_max_us,
+                      (stats.drains > 1) ? stats.jitter_sum_us / (stats.drains - 1) : 0);
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * IMU [r] | stream <hz> <watermark> | stop | stats
+ */
+static console_cmd_status_t console_cmd_imu(int argc, char *argv[])
+{
+    uint16_t imu_data[3]; // X, Y, Z accelerometer data
+
+    if (argc == 4 && strcmp(argv[1], "stream") == 0)
+    {
+        return console_cmd_imu_stream(argv[2], argv[3]);
+    }
+    if (argc == 2 && strcmp(argv[1], "stop") == 0)
+    {
+        return system_sensors_imu_stream_stop(device_mailbox()) ? CONSOLE_CMD_OK : CONSOLE_CMD_FAILED;
+    }
+    if (argc == 2 && strcmp(argv[1], "stats") == 0)
+    {
+        return console_cmd_imu_stats();
+    }
+    if (argc > 2 || (argc == 2 && strcmp(argv[1], "r") != 0))
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    if (!system_sensors_imu_read(device_mailbox(), imu_data))
+    {
+        console_cmd_reply("IMU Read Failed\r\n");
+        return CONSOLE_CMD_FAILED;
+    }
+
+    // Convert uint16_t to signed int16_t for proper negative value display
+    console_cmd_reply("IMU Data: X=%d, Y=%d, Z=%d\r\n",
+                      (int16_t)imu_data[0], (int16_t)imu_data[1], (int16_t)imu_data[2]);
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * LIGHT [r]: reads the ambient light sensor
+ */
+static console_cmd_status_t console_cmd_light(int argc, char *argv[])
+{
+    uint16_t ambient_light = 0;
+
+    if (argc == 2 && strcmp(argv[1], "r") != 0)
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    if (!system_sensors_get_light(device_mailbox(), &ambient_light))
+    {
+        console_cmd_reply("Light Sensor Read Failed\r\n");
+        return CONSOLE_CMD_FAILED;
+    }
+
+    console_cmd_reply("Light Sensor: %d\r\n", ambient_light);
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * IOEXP w <address> <value> | r <address> | set|clr|tog <mask> | stats
+ * set, clr and tog change output port bits through the shadow register
+ */
+static console_cmd_status_t console_cmd_ioexp(int argc, char *argv[])
+{
+    if (strcmp(argv[1], "stats") == 0 && argc == 2)
+    {
+        io_expander_stats_t stats;
+
+        system_sensors_io_expander_get_stats(&stats);
+        console_cmd_reply("I2C txns=%lu\r\n", stats.transactions);
+        console_cmd_reply("Saved: wr=%lu rd=%lu merged=%lu\r\n",
+                          stats.writes_skipped, stats.reads_skipped, stats.bit_ops_coalesced);
+        console_cmd_reply("Bit ops=%lu\r\n", stats.bit_ops);
+    }
+    else if ((strcmp(argv[1], "set") == 0 || strcmp(argv[1], "clr") == 0 || strcmp(argv[1], "tog") == 0) && argc == 3)
+    {
+        uint8_t mask = (uint8_t)strtol(argv[2], NULL, 16);
+        bool status;
+
+        if (argv[1][0] == 's')
+        {
+            status = system_sensors_io_expander_set_bits(mask);
+        }
+        else if (argv[1][0] == 'c')
+        {
+            status = system_sensors_io_expander_clear_bits(mask);
+        }
+        else
+        {
+            status = system_sensors_io_expander_toggle_bits(mask);
+        }
+
+        if (!status)
+        {
+            console_cmd_reply("IO Expander %s Failed: Mask=0x%02X\r\n", argv[1], mask);
+            return CONSOLE_CMD_FAILED;
+        }
+        console_cmd_reply("IO Expander %s: Mask=0x%02X\r\n", argv[1], mask);
+    }
+    else if (strcmp(argv[1], "w") == 0 && argc == 4)
+    {
+        uint8_t address = (uint8_t)strtol(argv[2], NULL, 16);
+        uint8_t value = (uint8_t)strtol(argv[3], NULL, 16);
+
+        if (!system_sensors_io_expander_write(device_mailbox(), address, value))
+        {
+            console_cmd_reply("IO Expander Write Failed: Addr=0x%02X, Value=0x%02X\r\n", address, value);
+            return CONSOLE_CMD_FAILED;
+        }
+        console_cmd_reply("IO Expander Write: Addr=0x%02X, Value=0x%02X\r\n", address, value);
+    }
+    else if (strcmp(argv[1], "r") == 0 && argc == 3)
+    {
+        uint8_t address = (uint8_t)strtol(argv[2], NULL, 0);
+        uint8_t data = 0;
+
+        if (!system_sensors_io_expander_read(device_mailbox(), address, &data))
+        {
+            console_cmd_reply("IO Expander Read Failed: Addr=0x%02X\r\n", address);
+            return CONSOLE_CMD_FAILED;
+        }
+        console_cmd_reply("IO Expander Read: Addr=0x%02X Value=0x%02X\r\n", address, data);
+    }
+    else
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * CONSOLE stats: prints the console Rx counters
+ */
+static console_cmd_status_t console_cmd_console(int argc, char *argv[])
+{
+    (void)argc;
+
+    if (strcmp(argv[1], "stats") != 0)
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    console_cmd_reply("Lines=%lu RingOvf=%lu LongOvf=%lu\r\n",
+                      Console_Rx_Stats.lines_received,
+                      Console_Rx_Stats.ring_overflows,
+                      Console_Rx_Stats.line_overflows);
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * I2C stats
+ * Prints the I2C engine counters.  Wait times are the longest delay from
+ * submission to the start of the transfer for each priority.
+ */
+static console_cmd_status_t console_cmd_i2c(int argc, char *argv[])
+{
+    i2c_async_stats_t stats;
+
+    (void)argc;
+
+    if (strcmp(argv[1], "stats") != 0 || !i2c_async_get_stats(&stats))
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    console_cmd_reply("Txn H/N/L=%lu/%lu/%lu\r\n",
+                      stats.transactions[I2C_ASYNC_PRIORITY_HIGH],
+                      stats.transactions[I2C_ASYNC_PRIORITY_NORMAL],
+                      stats.transactions[I2C_ASYNC_PRIORITY_LOW]);
+    console_cmd_reply("MaxWait H/N/L=%lu/%lu/%lums\r\n",
+                      (unsigned long)(stats.max_wait[I2C_ASYNC_PRIORITY_HIGH] * portTICK_PERIOD_MS),
+                      (unsigned long)(stats.max_wait[I2C_ASYNC_PRIORITY_NORMAL] * portTICK_PERIOD_MS),
+                      (unsigned long)(stats.max_wait[I2C_ASYNC_PRIORITY_LOW] * portTICK_PERIOD_MS));
+    console_cmd_reply("Fail=%lu TO=%lu Rej=%lu\r\n",
+                      stats.failures,
+                      stats.timeouts,
+                      stats.rejected);
+    console_cmd_reply("Bus=%luus\r\n", stats.bus_us);
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * SPI stats
+ * Prints the bus manager counters for each SPI device
+ */
+static console_cmd_status_t console_cmd_spi(int argc, char *argv[])
+{
+    spi_bus_client_t *client;
+
+    (void)argc;
+
+    if (strcmp(argv[1], "stats") != 0)
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    for (uint8_t i = 0; (client = spi_bus_get_client(i)) != NULL; i++)
+    {
+        console_cmd_reply("%s: %lu acq, %lu DMA\r\n", client->name, client->acquisitions, client->dma_transfers);
+        console_cmd_reply("%s: wait max %luus\r\n", client->name, client->max_wait_us);
+        console_cmd_reply("%s: hold %luus max %luus\r\n", client->name, client->hold_us, client->max_hold_us);
+    }
+
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * SENSORS
+ * Prints the sensor hub cache without touching the sensors
  */
+static console_cmd_status_t console_cmd_sensors(int argc, char *argv[])
+{
+    static const char *names[SENSOR_HUB_COUNT] = {"Light", "Temp", "IMU"};
+    sensor_hub_reading_t reading;
+    temp_sensor_stats_t temp_stats;
 
-/* Global Variables */
-console_buffer_t console_buffer1;
-console_buffer_t console_buffer2;
+    (void)argc;
+    (void)argv;
 
-QueueHandle_t xQueue_Console_Rx;
+    for (int i = 0; i < SENSOR_HUB_COUNT; i++)
+    {
+        if (!sensor_hub_get((sensor_hub_sensor_t)i, &reading))
+        {
+            console_cmd_reply("%s: no data\r\n", names[i]);
+            continue;
+        }
 
-// External reference to the system control response queue
-extern QueueHandle_t Queue_Sensor_Responses;
+        console_cmd_reply("%s: %ld %ld %ld\r\n",
+                          names[i],
+                          (long)reading.value[0],
+                          (long)reading.value[1],
+                          (long)reading.value[2]);
+        console_cmd_reply("  #%lu %lums ago\r\n",
+                          (unsigned long)reading.sequence,
+                          (unsigned long)((xTaskGetTickCount() - reading.timestamp) * portTICK_PERIOD_MS));
+    }
 
-// Pointers to the produce and consume buffers
-console_buffer_t *produce_console_buffer;
-console_buffer_t *consume_console_buffer;
+    if (temp_sensor_get_stats(&temp_stats))
+    {
+        console_cmd_reply("LM75: reads=%lu errors=%lu\r\n", temp_stats.i2c_reads, temp_stats.read_errors);
+        console_cmd_reply("LM75: published=%lu requests=%lu\r\n", temp_stats.published, temp_stats.requests);
+        console_cmd_reply("LM75: notifications=%lu\r\n", temp_stats.notifications);
+    }
 
-// Allocate task handle for the console Rx task
-TaskHandle_t TaskHandle_Console_Rx;
+    return CONSOLE_CMD_OK;
+}
 
 /**
  * @brief
- * This function is the bottom half task for receiving console input.
- *
- * It waits for a task notification from the ISR indicating that a new
- * command has been received. The task then processes the command and
- * controls the state of the LEDs accordingly.
- *
- * @param param Unused parameter
+ * Returns the sensor named by name (light, temp or imu), or
+ * SENSOR_HUB_COUNT
  */
-void task_console_rx(void *param)
+static sensor_hub_sensor_t console_cmd_log_sensor(const char *name)
 {
-    (void)param; // Unused parameter
-    // printf("DEBUG: Console RX task started and waiting for notifications\n\r");
+    static const char *names[SENSOR_HUB_COUNT] = {"light", "temp", "imu"};
 
-    while (1)
+    for (int i = 0; i < SENSOR_HUB_COUNT; i++)
     {
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-
-        // Process the data pointed to by the console buffer pointer
-        // if "RED_ON" turn on red LED
-        if (strcmp(consume_console_buffer->data, "RED_ON") == 0)
+        if (strcmp(name, names[i]) == 0)
         {
-            printf("Turning on RED LED\r\n");
-            leds_set_state(LED_RED, LED_ON);
+            return (sensor_hub_sensor_t)i;
         }
-        // if "RED_OFF" turn off the LED
-        else if (strcmp(consume_console_buffer->data, "RED_OFF") == 0)
+    }
+
+    return SENSOR_HUB_COUNT;
+}
+
+/**
+ * @brief
+ * LOG stats | dump <sensor> | rate <sensor> <n> | clear <sensor>
+ * stats prints the running statistics of each series, how much history is
+ * held and what recording has cost (1% CPU is 10000 ppm).  dump prints a
+ * series oldest value first, CONSOLE_LOG_VALUES_PER_LINE values per
+ * "<ms>: <values>" line, for offline analysis.  rate averages n readings
+ * into each recorded value.
+ */
+static console_cmd_status_t console_cmd_log(int argc, char *argv[])
+{
+    static const char *names[SENSOR_HUB_COUNT] = {"Light", "Temp", "IMU"};
+    static int32_t values[SENSOR_LOG_BLOCK_SAMPLES];
+    sensor_hub_sensor_t sensor = (argc > 2) ? console_cmd_log_sensor(argv[2]) : SENSOR_HUB_COUNT;
+
+    if (strcmp(argv[1], "stats") == 0 && argc == 2)
+    {
+        uint32_t uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+        for (int i = 0; i < SENSOR_HUB_COUNT; i++)
         {
-            printf("Turning off RED LED\r\n");
-            leds_set_state(LED_RED, LED_OFF);
+            sensor_log_stats_t stats;
+
+            sensor_log_get_stats((sensor_hub_sensor_t)i, &stats);
+            if (stats.samples == 0)
+            {
+                console_cmd_reply("%s: no data\r\n", names[i]);
+                continue;
+            }
+
+            console_cmd_reply("%s: n=%lu min=%ld max=%ld\r\n", names[i], stats.samples, (long)stats.min, (long)stats.max);
+            console_cmd_reply("  mean=%ld var=%lu\r\n", (long)stats.mean, (unsigned long)stats.variance);
+            console_cmd_reply("  %lu values in %luB, %lus, /%u\r\n",
+                              stats.recorded, stats.bytes, stats.span_ms / 1000, stats.decimation);
+            console_cmd_reply("  cost %luus max %lucyc (%lu ppm)\r\n",
+                              stats.busy_us, stats.max_cycles,
+                              (uptime_ms > 0) ? (uint32_t)((uint64_t)stats.busy_us * 1000 / uptime_ms) : 0);
         }
-        // Handle EEPROM and IMU commands
-        else
-        {
-            // Parse the command using strtok or sscanf
-            char *token = strtok(consume_console_buffer->data, " ");
+    }
+    else if (strcmp(argv[1], "dump") == 0 && argc == 3 && sensor != SENSOR_HUB_COUNT)
+    {
+        TickType_t start;
+        TickType_t interval;
+        uint16_t count;
 
-            if (token != NULL && (strcmp(token, "EEPROM") == 0 || strcmp(token, "eeprom") == 0))
+        for (uint8_t block = 0; (count = sensor_log_read_block(sensor, block, &start, &interval, values)) != 0; block++)
+        {
+            for (uint16_t i = 0; i < count; i += CONSOLE_LOG_VALUES_PER_LINE)
             {
-                // Parse EEPROM commands: "EEPROM w <address> <value>" or "EEPROM r <address>"
-                char *operation = strtok(NULL, " ");
-                if (operation != NULL && strcmp(operation, "w") == 0)
-                {
-                    // Write command: EEPROM w <address> <value>
-                    char *addr_str = strtok(NULL, " ");
-                    char *value_str = strtok(NULL, " ");
-
-                    if (addr_str != NULL && value_str != NULL)
-                    {
-                        uint8_t addr = (uint8_t)strtol(addr_str, NULL, 16);   // hex
-                        uint8_t value = (uint8_t)strtol(value_str, NULL, 16); // hex
-
-                        // Call EEPROM write function
-                        if (system_sensors_eeprom_write(Queue_Sensor_Responses, addr, value))
-                        {
-                            printf("\r\n");
-                            task_console_printf("EEPROM Write: Addr=0x%04X, Value=0x%02X", addr, value);
-                        }
-                        else
-                        {
-                            printf("\r\n");
-                            task_console_printf("EEPROM Write Failed: Addr=0x%04X, Value=0x%02X\r\n", addr, value);
-                        }
-                    }
-                    else
-                    {
-                        printf("\r\n");
-                        task_console_printf("Usage: EEPROM w <address> <value>\r\n");
-                    }
-                }
-                else if (operation != NULL && strcmp(operation, "r") == 0)
-                {
-                    // Read command: EEPROM r <address>
-                    char *addr_str = strtok(NULL, " ");
-
-                    if (addr_str != NULL)
-                    {
-                        uint16_t address = (uint16_t)strtol(addr_str, NULL, 0);
-                        uint8_t data = 0;
-
-                        // Call EEPROM read function
-                        if (system_sensors_eeprom_read(Queue_Sensor_Responses, address, &data))
-                        {
-                            printf("\r\n");
-                            task_console_printf("EEPROM Read: Addr=0x%04X Value=0x%02X\r\n", address, data);
-                        }
-                        else
-                        {
-                            printf("\r\n");
-                            task_console_printf("EEPROM Read Failed: Addr=0x%04X\r\n", address);
-                        }
-                    }
-                    else
-                    {
-                        printf("\r\n");
-                        task_console_printf("Usage: EEPROM r <address>\r\n");
-                    }
-                }
-                else
+                char line[CONSOLE_MAX_MESSAGE_LENGTH];
+                int length = snprintf(line, sizeof(line), "%lu:",
+                                      (unsigned long)((start + i * interval) * portTICK_PERIOD_MS));
+
+                // Room for one more " %ld" and the "\r\n" console_cmd_reply() adds
+                for (uint16_t j = i; j < count && j < i + CONSOLE_LOG_VALUES_PER_LINE && length < (int)sizeof(line) - 14; j++)
                 {
-                    printf("\r\n");
-                    task_console_printf("Usage: EEPROM [w|r] <address> [value]\r\n");
+                    length += snprintf(&line[length], sizeof(line) - length, " %ld", (long)values[j]);
                 }
+                console_cmd_reply("%s\r\n", line);
             }
-            else if (token != NULL && (strcmp(token, "IMU") == 0 || strcmp(token, "imu") == 0))
+        }
+    }
+    else if (strcmp(argv[1], "rate") == 0 && argc == 4 && sensor != SENSOR_HUB_COUNT)
+    {
+        if (!sensor_log_configure(sensor, (uint8_t)strtoul(argv[3], NULL, 0)))
+        {
+            return CONSOLE_CMD_USAGE;
+        }
+    }
+    else if (strcmp(argv[1], "clear") == 0 && argc == 3 && sensor != SENSOR_HUB_COUNT)
+    {
+        sensor_log_clear(sensor);
+    }
+    else
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * KV stats
+ * Prints the key/value store counters.  Write amplification and wear over
+ * long runs are measured on the host by test/kv_store_sim.
+ */
+static console_cmd_status_t console_cmd_kv(int argc, char *argv[])
+{
+    if (strcmp(argv[1], "stats") == 0 && argc == 2)
+    {
+        kv_store_stats_t stats;
+        uint32_t max_page_writes = 0;
+
+        kv_store_get_stats(&stats);
+        for (int i = 0; i < KV_STORE_PAGE_COUNT; i++)
+        {
+            if (stats.page_writes[i] > max_page_writes)
             {
-                // Parse IMU commands: "IMU r" or just "IMU" (read accelerometer data)
-                char *operation = strtok(NULL, " ");
-                if (operation == NULL || strcmp(operation, "r") == 0)
-                {
-                    // Read command: IMU r or just IMU
-                    uint16_t imu_data[3]; // X, Y, Z accelerometer data
-
-                    // Call IMU read function
-                    if (system_sensors_imu_read(Queue_Sensor_Responses, imu_data))
-                    {
-                        // Convert uint16_t to signed int16_t for proper negative value display
-                        int16_t x = (int16_t)imu_data[0];
-                        int16_t y = (int16_t)imu_data[1];
-                        int16_t z = (int16_t)imu_data[2];
-                        printf("\r\n");
-                        task_console_printf("IMU Data: X=%d, Y=%d, Z=%d\r\n", x, y, z);
-                    }
-                    else
-                    {
-                        printf("\r\n");
-                        task_console_printf("IMU Read Failed\r\n");
-                    }
-                }
-                else
-                {
-                    printf("\r\n");
-                    task_console_printf("Usage: IMU [r]\r\n");
-                }
+                max_page_writes = stats.page_writes[i];
             }
-            else if (token != NULL && (strcmp(token, "LIGHT") == 0 || strcmp(token, "light") == 0))
+        }
+
+        console_cmd_reply("Puts=%lu Skip=%lu Reloc=%lu\r\n", stats.puts, stats.skipped, stats.relocations);
+        console_cmd_reply("Req=%luB Wr=%luB MaxPageWr=%lu\r\n", stats.bytes_requested, stats.bytes_written, max_page_writes);
+        console_cmd_reply("Pages=%u/%u Keys=%u\r\n", stats.pages_in_use, KV_STORE_PAGE_COUNT, stats.keys);
+    }
+    else
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * CPU [ms]: prints the share of CPU time each task used over a window of
+ * ms milliseconds (default 1000), from the FreeRTOS run time stats
+ */
+static console_cmd_status_t console_cmd_cpu(int argc, char *argv[])
+{
+    static TaskStatus_t before[CONSOLE_CPU_MAX_TASKS];
+    static TaskStatus_t after[CONSOLE_CPU_MAX_TASKS];
+    uint32_t window_ms = (argc == 2) ? (uint32_t)strtoul(argv[1], NULL, 0) : 1000;
+    uint32_t total_before, total_after, total;
+    UBaseType_t count_before, count_after;
+
+    if (window_ms == 0)
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    count_before = uxTaskGetSystemState(before, CONSOLE_CPU_MAX_TASKS, &total_before);
+    vTaskDelay(pdMS_TO_TICKS(window_ms));
+    count_after = uxTaskGetSystemState(after, CONSOLE_CPU_MAX_TASKS, &total_after);
+
+    total = (total_after - total_before) / 1000; // Run time units per 0.1%
+    if (count_after == 0 || total == 0)
+    {
+        console_cmd_reply("CPU: run time stats unavailable\r\n");
+        return CONSOLE_CMD_FAILED;
+    }
+
+    for (UBaseType_t i = 0; i < count_after; i++)
+    {
+        uint32_t run_time = after[i].ulRunTimeCounter;
+        uint32_t permille;
+
+        // Tasks created during the window are charged from zero
+        for (UBaseType_t j = 0; j < count_before; j++)
+        {
+            if (before[j].xTaskNumber == after[i].xTaskNumber)
             {
-                // Parse LIGHT commands: "LIGHT r" or just "LIGHT" (read ambient light)
-                char *operation = strtok(NULL, " ");
-                if (operation == NULL || strcmp(operation, "r") == 0)
-                {
-                    // Read command: LIGHT r or just LIGHT
-                    uint16_t ambient_light = 0;
-
-                    // Call light sensor read function
-                    if (system_sensors_get_light(Queue_Sensor_Responses, &ambient_light))
-                    {
-                        printf("\r\n");
-                        task_console_printf("Light Sensor: %d\r\n", ambient_light);
-                    }
-                    else
-                    {
-                        printf("\r\n");
-                        task_console_printf("Light Sensor Read Failed\r\n");
-                    }
-                }
-                else
-                {
-                    printf("Usage: LIGHT [r]\r\n");
-                }
+                run_time -= before[j].ulRunTimeCounter;
+                break;
             }
-            // do an else if for IO EXPANDER
-            else if (token != NULL && (strcmp(token, "IOEXP") == 0 || strcmp(token, "ioexp") == 0))
+        }
+
+        permille = run_time / total;
+        console_cmd_reply("%-16s %3lu.%lu%%\r\n", after[i].pcTaskName, permille / 10, permille % 10);
+    }
+
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * JOY stats | repeat <delay ms> <period ms> <min ms> <accel %>
+ */
+static console_cmd_status_t console_cmd_joy(int argc, char *argv[])
+{
+    if (argc == 2 && strcmp(argv[1], "stats") == 0)
+    {
+        console_cmd_reply("Dropped events=%lu\r\n", task_joystick_get_dropped());
+    }
+    else if (argc == 6 && strcmp(argv[1], "repeat") == 0)
+    {
+        joystick_repeat_config_t config = {
+            .delay_ms = (uint16_t)strtoul(argv[2], NULL, 0),
+            .period_ms = (uint16_t)strtoul(argv[3], NULL, 0),
+            .min_period_ms = (uint16_t)strtoul(argv[4], NULL, 0),
+            .accel_percent = (uint8_t)strtoul(argv[5], NULL, 0)};
+
+        if (!task_joystick_set_repeat(&config))
+        {
+            return CONSOLE_CMD_USAGE;
+        }
+    }
+    else
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * BUTTONS stats: press to event latency, and the wake ups used compared to
+ * polling every BUTTON_POLL_MS
+ */
+static console_cmd_status_t console_cmd_buttons(int argc, char *argv[])
+{
+    buttons_stats_t stats;
+    uint32_t polls = (uint32_t)(xTaskGetTickCount() / pdMS_TO_TICKS(BUTTON_POLL_MS));
+
+    if (strcmp(argv[1], "stats") != 0)
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    task_button_get_stats(&stats);
+    console_cmd_reply("Presses=%lu Edges=%lu Debounces=%lu\r\n", stats.presses, stats.edges, stats.debounces);
+    console_cmd_reply("Timer start failures=%lu\r\n", stats.timer_failures);
+    if (stats.presses != 0)
+    {
+        console_cmd_reply("Latency us min=%lu avg=%lu max=%lu\r\n",
+                          stats.latency_min_us, stats.latency_sum_us / stats.presses, stats.latency_max_us);
+        for (int i = 0; i < BUTTON_LATENCY_BINS; i++)
+        {
+            console_cmd_reply("  %2d-%2d ms: %lu\r\n", i * BUTTON_LATENCY_BIN_MS,
+                              (i == BUTTON_LATENCY_BINS - 1) ? 99 : (i + 1) * BUTTON_LATENCY_BIN_MS, stats.latency_bins[i]);
+        }
+    }
+    console_cmd_reply("Task wake ups=%lu, polling would have used %lu\r\n", stats.debounces, polls);
+
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * DEVICES stats
+ * Prints the device manager counters and mailbox pool use
+ */
+static console_cmd_status_t console_cmd_devices(int argc, char *argv[])
+{
+    device_manager_stats_t stats;
+
+    (void)argc;
+
+    if (strcmp(argv[1], "stats") != 0 || !device_manager_get_stats(&stats))
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    console_cmd_reply("Requests=%lu TO=%lu\r\n", stats.requests, stats.timeouts);
+    console_cmd_reply("Responses stale=%lu dropped=%lu\r\n", stats.stale_responses, stats.dropped_responses);
+    console_cmd_reply("Mailboxes %u/%u in use, high water %u, failures %lu\r\n",
+                      stats.mailboxes_in_use, DEVICE_MAILBOX_COUNT, stats.mailboxes_high_water, stats.mailbox_failures);
+    return CONSOLE_CMD_OK;
+}
+
+/**
+ * @brief
+ * LED stats | set <channel> <level> | play <channel> <animation> [loop]
+ * Channels 0-2 are red, green and blue, 3-7 the IO expander LEDs.
+ */
+static console_cmd_status_t console_cmd_led(int argc, char *argv[])
+{
+    static const struct
+    {
+        const char *name;
+        const led_anim_t *anim;
+    } animations[] = {
+        {"fadein", &led_anim_fade_in},
+        {"fadeout", &led_anim_fade_out},
+        {"pulse", &led_anim_pulse},
+        {"blink", &led_anim_blink},
+        {"heartbeat", &led_anim_heartbeat},
+    };
+    led_anim_channel_t channel = (argc >= 3) ? (led_anim_channel_t)strtoul(argv[2], NULL, 0) : LED_ANIM_CH_COUNT;
+
+    if (argc == 2 && strcmp(argv[1], "stats") == 0)
+    {
+        led_anim_stats_t stats;
+
+        led_anim_get_stats(&stats);
+        console_cmd_reply("Ticks=%lu PWM writes=%lu IOXP writes=%lu\r\n", stats.ticks, stats.pwm_writes, stats.ioxp_writes);
+        if (stats.ticks != 0)
+        {
+            console_cmd_reply("ISR us/tick min=%lu avg=%lu max=%lu\r\n",
+                              timer_cycles_to_us(stats.isr_cycles_min),
+                              timer_cycles_to_us(stats.isr_cycles_total / stats.ticks),
+                              timer_cycles_to_us(stats.isr_cycles_max));
+        }
+        return CONSOLE_CMD_OK;
+    }
+
+    if (channel >= LED_ANIM_CH_COUNT)
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    if (argc == 4 && strcmp(argv[1], "set") == 0)
+    {
+        return led_anim_set(channel, (uint8_t)strtoul(argv[3], NULL, 0)) ? CONSOLE_CMD_OK : CONSOLE_CMD_FAILED;
+    }
+
+    if (argc >= 4 && strcmp(argv[1], "play") == 0)
+    {
+        for (uint32_t i = 0; i < sizeof(animations) / sizeof(animations[0]); i++)
+        {
+            if (strcmp(argv[3], animations[i].name) == 0)
             {
-                // Parse IOEXP commands: "IOEXP r <address>" or "IOEXP w <address> <value>"
-                char *operation = strtok(NULL, " ");
-                if (operation != NULL && strcmp(operation, "w") == 0)
-                {
-                    // Write command: IOEXP w <address> <value>
-                    char *addr_str = strtok(NULL, " ");
-                    char *value_str = strtok(NULL, " ");
-
-                    if (addr_str != NULL && value_str != NULL)
-                    {
-                        uint8_t address = (uint8_t)strtol(addr_str, NULL, 16);
-                        uint8_t value = (uint8_t)strtol(value_str, NULL, 16);
-
-                        // Call IO Expander write function
-                        if (system_sensors_io_expander_write(Queue_Sensor_Responses, address, value))
-                        {
-                            printf("\r\n");
-                            task_console_printf("IO Expander Write: Addr=0x%02X, Value=0x%02X", address, value);
-                        }
-                        else
-                        {
-                            printf("\r\n");
-                            task_console_printf("IO Expander Write Failed: Addr=0x%02X, Value=0x%02X\r\n", address, value);
-                        }
-                    }
-                    else
-                    {
-                        printf("\r\n");
-                        task_console_printf("Usage: IOEXP w <address> <value>\r\n");
-                    }
-                }
-                else if (operation != NULL && strcmp(operation, "r") == 0)
-                {
-                    // Read command: IOEXP r <address>
-                    char *addr_str = strtok(NULL, " ");
-
-                    if (addr_str != NULL)
-                    {
-                        uint8_t address = (uint8_t)strtol(addr_str, NULL, 0);
-                        uint8_t data = 0;
-
-                        // Call IO Expander read function
-                        if (system_sensors_io_expander_read(Queue_Sensor_Responses, address, &data))
-                        {
-                            printf("\r\n");
-                            task_console_printf("IO Expander Read: Addr=0x%02X Value=0x%02X\r\n", address, data);
-                        }
-                        else
-                        {
-                            printf("\r\n");
-                            task_console_printf("IO Expander Read Failed: Addr=0x%02X\r\n", address);
-                        }
-                    }
-                }
+                bool loop = (argc == 5 && strcmp(argv[4], "loop") == 0);
+                return led_anim_play(channel, animations[i].anim, loop) ? CONSOLE_CMD_OK : CONSOLE_CMD_FAILED;
             }
-            else
+        }
+    }
+
+    return CONSOLE_CMD_USAGE;
+}
+
+/**
+ * @brief
+ * AI on | off | stats
+ * on/off connect the local opponent in place of the IPC UART.  The shots
+ * the targeting needs are measured on the host by test/battleship_ai_sim.
+ */
+static console_cmd_status_t console_cmd_ai(int argc, char *argv[])
+{
+    if (argc == 2 && (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0))
+    {
+        battleship_ai_enable(strcmp(argv[1], "on") == 0);
+        return CONSOLE_CMD_OK;
+    }
+
+    if (argc == 2 && strcmp(argv[1], "stats") == 0)
+    {
+        battleship_ai_stats_t stats;
+
+        battleship_ai_get_stats(&stats);
+        console_cmd_reply("AI %s, games=%lu AI wins=%lu\r\n", stats.enabled ? "on" : "off", stats.games, stats.ai_wins);
+        console_cmd_reply("Shots/game=%lu Max update=%luus\r\n",
+                          (stats.games > 0) ? stats.ai_shots / stats.games : 0,
+                          timer_cycles_to_us(stats.max_update_cycles));
+        return CONSOLE_CMD_OK;
+    }
+
+    return CONSOLE_CMD_USAGE;
+}
+
+/**
+ * @brief
+ * GAME bench <games>
+ * Plays random self-play games through the battleship engine and reports
+ * how many rule transitions it applies per second.  Strategies are played
+ * against each other on the host by test/battleship_sim.
+ */
+static console_cmd_status_t console_cmd_game(int argc, char *argv[])
+{
+    // Too large for the console task's stack
+    static battleship_game_t game[BATTLESHIP_GAME_PLAYERS];
+    uint32_t games = strtoul(argv[2], NULL, 0);
+    uint32_t seed = xTaskGetTickCount();
+    uint64_t transitions = 0;
+    uint32_t wins = 0;
+    TickType_t start;
+    uint32_t elapsed_ms;
+
+    if (argc != 3 || strcmp(argv[1], "bench") != 0 || games == 0)
+    {
+        return CONSOLE_CMD_USAGE;
+    }
+
+    start = xTaskGetTickCount();
+    for (uint32_t i = 0; i < games; i++)
+    {
+        transitions += battleship_game_play_random(game, &seed);
+        wins += game[0].i_won ? 1 : 0;
+
+        // Let tasks of the same priority run between games
+        taskYIELD();
+    }
+    elapsed_ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+
+    console_cmd_reply("Games=%lu P1 wins=%lu transitions=%lu\r\n", games, wins, (uint32_t)transitions);
+    console_cmd_reply("%lums, %lu transitions/s\r\n", elapsed_ms,
+                      (uint32_t)((transitions * 1000) / (elapsed_ms > 0 ? elapsed_ms : 1)));
+    return CONSOLE_CMD_OK;
+}
+
+// Commands handled by the console Rx task
+static const console_cmd_t console_rx_commands[] = {
+    {"RED_ON", console_cmd_red_on, "Turn on the red LED", "", 0, 0},
+    {"RED_OFF", console_cmd_red_off, "Turn off the red LED", "", 0, 0},
+    {"EEPROM", console_cmd_eeprom, "EEPROM access", "w|r|dump|load|bench <addr> [value|len] | sync | stats", 1, 3},
+    {"IMU", console_cmd_imu, "Accelerometer access", "[r] | stream <hz> <wm> | stop | stats", 0, 3},
+    {"LIGHT", console_cmd_light, "Read the light sensor", "[r]", 0, 1},
+    {"IOEXP", console_cmd_ioexp, "IO expander access", "w|r <address> [value] | set|clr|tog <mask> | stats", 1, 3},
+    {"SPI", console_cmd_spi, "SPI bus counters", "stats", 1, 1},
+    {"I2C", console_cmd_i2c, "I2C engine counters", "stats", 1, 1},
+    {"CONSOLE", console_cmd_console, "Console Rx counters", "stats", 1, 1},
+    {"SENSORS", console_cmd_sensors, "Sensor hub cache", "", 0, 0},
+    {"LOG", console_cmd_log, "Sensor history", "stats | dump <light|temp|imu> | rate <sensor> <n> | clear <sensor>", 1, 3},
+    {"CPU", console_cmd_cpu, "Per task CPU load", "[ms]", 0, 1},
+    {"BUTTONS", console_cmd_buttons, "Button counters", "stats", 1, 1},
+    {"DEVICES", console_cmd_devices, "Device manager counters", "stats", 1, 1},
+    {"AI", console_cmd_ai, "Local battleship opponent", "on | off | stats", 1, 1},
+    {"GAME", console_cmd_game, "Battleship engine benchmark", "bench <games>", 2, 2},
+    {"LED", console_cmd_led, "LED animations", "stats | set <ch> <level> | play <ch> <anim> [loop]", 1, 4},
+    {"JOY", console_cmd_joy, "Joystick events", "stats | repeat <delay> <period> <min> <accel>", 1, 5},
+    {"KV", console_cmd_kv, "Key/value store", "stats", 1, 1},
+};
+
+/**
+ * @brief
+ * This function is the bottom half task for receiving console input.
+ *
+ * It waits for a task notification from the ISR, then removes every byte
+ * in circular_buffer_rx and assembles them into lines (console_line.c).
+ * Each complete line is copied onto xQueue_Console_Rx.  A line longer than
+ * CONSOLE_RX_LINE_LENGTH is discarded up to its terminator and counted as
+ * a line overflow.
+ *
+ * @param param Unused parameter
+ */
+static void task_console_rx_line(void *param)
+{
+    (void)param; // Unused parameter
+    static char line[CONSOLE_RX_LINE_LENGTH];
+    console_line_t assembler;
+    const char *complete;
+    char c;
+
+    console_line_init(&assembler, line, sizeof(line));
+
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (circular_buffer_remove(circular_buffer_rx, &c))
+        {
+            complete = console_line_put(&assembler, c);
+            if (complete != NULL)
             {
-                task_console_printf("Unknown command: %s\r\n", consume_console_buffer->data);
+                // Blocks when the queue is full, leaving the ring to absorb new input
+                xQueueSend(xQueue_Console_Rx, complete, portMAX_DELAY);
+                Console_Rx_Stats.lines_received++;
             }
         }
+        Console_Rx_Stats.line_overflows = assembler.overflows;
+    }
+}
+
+/**
+ * @brief
+ * This function is the task that executes console commands.
+ *
+ * It waits for complete lines from task_console_rx_line() and runs each one
+ * through the console command registry.
+ *
+ * @param param Unused parameter
+ */
+void task_console_rx(void *param)
+{
+    (void)param; // Unused parameter
+    static char line[CONSOLE_RX_LINE_LENGTH];
+
+    while (1)
+    {
+        xQueueReceive(xQueue_Console_Rx, line, portMAX_DELAY);
+
+        // While an EEPROM load is active every line is data for the EEPROM
+        if (eeprom_load_active)
+        {
+            console_eeprom_load_line(line);
+            continue;
+        }
+
+        console_cmd_execute(line);
     }
 }
 
@@ -282,35 +1316,48 @@ bool task_console_resources_init_rx(void)
 {
     BaseType_t rslt;
 
-    // Create the Sensor Response Queue for hardware task communication
-    Queue_Sensor_Responses = xQueueCreate(10, sizeof(device_response_msg_t));
-    if (Queue_Sensor_Responses == NULL)
+    // Build the command table before any input can arrive
+    if (!console_cmd_init())
     {
         return false;
     }
+    for (uint32_t i = 0; i < sizeof(console_rx_commands) / sizeof(console_rx_commands[0]); i++)
+    {
+        if (!console_cmd_register(&console_rx_commands[i]))
+        {
+            return false;
+        }
+    }
 
-    // allocate an array from heap for the two console buffers
-    console_buffer1.data = (char *)pvPortMalloc(CONSOLE_MAX_MESSAGE_LENGTH);
-    console_buffer2.data = (char *)pvPortMalloc(CONSOLE_MAX_MESSAGE_LENGTH);
-
-    produce_console_buffer = &console_buffer1;
-    consume_console_buffer = &console_buffer2;
+    // Create the byte ring written by the ISR and the queue of complete lines
+    circular_buffer_rx = circular_buffer_init(CONSOLE_RX_RING_SIZE);
+    xQueue_Console_Rx = xQueueCreate(CONSOLE_RX_LINE_QUEUE_LENGTH, CONSOLE_RX_LINE_LENGTH);
+    if (circular_buffer_rx == NULL || xQueue_Console_Rx == NULL)
+    {
+        return false; // Memory allocation failed
+    }
 
-    // set initial lengths to zero
-    produce_console_buffer->index = 0;
-    consume_console_buffer->index = 0;
+    // Create the line assembler.  It runs above the command task so input is
+    // pulled out of the ring even while a long command is executing.
+    rslt = xTaskCreate(
+        task_console_rx_line,
+        "Console Rx Line",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        INT_PRIORITY_CONSOLE,
+        &TaskHandle_Console_Rx_Line);
 
-    // Check if memory allocation was successful
-    if (console_buffer1.data == NULL || console_buffer2.data == NULL)
+    if (rslt != pdPASS)
     {
-        return false; // Memory allocation failed
+        printf("ERROR: Console RX line task creation failed!\n\r");
+        return false; // Task creation failed
     }
 
     // Create the console Rx task
     rslt = xTaskCreate(
         task_console_rx,
         "Console Rx",
-        configMINIMAL_STACK_SIZE,
+        TASK_CONSOLE_RX_STACK_SIZE,
         NULL,
         tskIDLE_PRIORITY + 1,
         &TaskHandle_Console_Rx);
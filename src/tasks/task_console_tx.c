@@ -183,4 +183,43 @@ void task_console_printf(char *str_ptr, ...)
         CY_ASSERT(0); // Halt the processor
     }
 }
+
+/**
+ * @brief
+ * This function sends a string of any length to task_console_tx as a single
+ * message.  Unlike task_console_printf, the string is not prefixed with the
+ * task name and is not limited to CONSOLE_MAX_MESSAGE_LENGTH.
+ *
+ * @param str Pointer to the NULL terminated string.
+ */
+void task_console_write(const char *str)
+{
+    console_buffer_t *console_buffer;
+    char *message_buffer;
+    size_t length = strlen(str) + 1;
+
+    /* Wait for the Tx task to free memory if the heap is exhausted */
+    do {
+        message_buffer = pvPortMalloc(length);
+        if (message_buffer == NULL)
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    } while (message_buffer == NULL);
+
+    console_buffer = pvPortMalloc(sizeof(console_buffer_t));
+    if (console_buffer == NULL)
+    {
+        vPortFree(message_buffer);
+        CY_ASSERT(0); // Halt the processor
+        return;
+    }
+
+    memcpy(message_buffer, str, length);
+    console_buffer->data = message_buffer;
+    console_buffer->index = 0;
+
+    /* The receiver task is responsible to free the memory from here on */
+    xQueueSendToBack(xQueue_Console_Tx, &console_buffer, portMAX_DELAY);
+}
 #endif
\ No newline at end of file
@@ -13,15 +13,107 @@
 #if defined(ECE353_FREERTOS)
 #include "task_console.h"
 #include "task_eeprom.h"
+#include "spi_bus.h"
+#include "device_manager.h"
+#include <string.h>
 
 #define TASK_EEPROM_STACK_SIZE (configMINIMAL_STACK_SIZE * 10)
 #define TASK_EEPROM_PRIORITY (tskIDLE_PRIORITY + 1)
+#define INT_PRIORITY_LVD 5
+
+/**
+ * @brief
+ * Requests are served from the write-back cache in eeprom_cache.c.  The
+ * task flushes lines that have been dirty for EEPROM_CACHE_FLUSH_MS and
+ * flushes every line on a DEVICE_OP_SYNC request.
+ *
+ * Durability: a write acknowledged by the EEPROM task may sit in RAM for
+ * up to EEPROM_CACHE_FLUSH_MS.  Callers that need data on the device before
+ * they continue call system_sensors_eeprom_sync().  With
+ * EEPROM_CACHE_BROWNOUT_FLUSH the low voltage detector requests a sync and
+ * switches the cache to write-through when VDDD falls below
+ * EEPROM_CACHE_BROWNOUT_THRESHOLD.
+ */
 
 /* Global Variables */
 QueueHandle_t Queue_EEPROM_Requests;
 static SemaphoreHandle_t *SPI_Semaphore = NULL;
 static cyhal_spi_t *eeprom_spi_obj = NULL;
 static cyhal_gpio_t eeprom_cs_pin = NC;
+static spi_bus_client_t eeprom_spi_client;
+static eeprom_cache_t eeprom_cache;
+static volatile bool eeprom_cache_sync_pending = false; // Set by the power fail hook
+
+/**
+ * @brief
+ * Waits for the EEPROM's internal write cycle to finish.  The SPI bus is
+ * only held for each status read, so the IMU can use the bus for the
+ * several milliseconds a page write takes.
+ */
+static void eeprom_task_wait_ready(void)
+{
+    bool busy;
+
+    do
+    {
+        vTaskDelay(pdMS_TO_TICKS(1));
+
+        spi_bus_acquire(&eeprom_spi_client);
+        busy = eeprom_write_in_progress(eeprom_spi_obj, eeprom_cs_pin);
+        spi_bus_release(&eeprom_spi_client);
+    } while (busy);
+}
+
+/**
+ * @brief
+ * Writes a block one page at a time so no write wraps around inside a
+ * page.  Page data is sent through the SPI bus manager, which uses DMA for
+ * long pages.
+ * @param address
+ * @param data
+ * @param length
+ */
+static void eeprom_task_write(uint16_t address, const uint8_t *data, uint16_t length)
+{
+    while (length > 0)
+    {
+        uint16_t page_space = EEPROM_PAGE_SIZE - (address % EEPROM_PAGE_SIZE);
+        uint16_t chunk = (length < page_space) ? length : page_space;
+        uint8_t cmd[3] = {EEPROM_CMD_WRITE, (address >> 8) & 0xFF, address & 0xFF};
+
+        spi_bus_acquire(&eeprom_spi_client);
+        eeprom_write_enable(eeprom_spi_obj, eeprom_cs_pin);
+        spi_bus_transfer(&eeprom_spi_client, cmd, sizeof(cmd), data, NULL, chunk);
+        spi_bus_release(&eeprom_spi_client);
+
+        eeprom_task_wait_ready();
+
+        address += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+/**
+ * @brief
+ * Reads a block with a single sequential read
+ * @param address
+ * @param data
+ * @param length
+ */
+static void eeprom_task_read(uint16_t address, uint8_t *data, uint16_t length)
+{
+    uint8_t cmd[3] = {EEPROM_CMD_READ, (address >> 8) & 0xFF, address & 0xFF};
+
+    spi_bus_acquire(&eeprom_spi_client);
+    spi_bus_transfer(&eeprom_spi_client, cmd, sizeof(cmd), NULL, data, length);
+    spi_bus_release(&eeprom_spi_client);
+}
+
+static TickType_t eeprom_task_ticks(void)
+{
+    return xTaskGetTickCount();
+}
 
 /**
  * @brief
@@ -52,26 +144,13 @@ bool system_sensors_eeprom_write(QueueHandle_t return_queue, uint16_t address, u
     request_packet.value = data;
     request_packet.response_queue = return_queue;
 
-    // Send the request to the EEPROM task
-    if (xQueueSend(Queue_EEPROM_Requests, &request_packet, portMAX_DELAY) == pdTRUE)
+    // Send the request to the EEPROM task and wait for the response
+    if (device_request(&request_packet, &response_packet, pdMS_TO_TICKS(100)))
     {
-        // If return queue provided, wait for response
         if (return_queue != NULL)
         {
-            // Wait for the response from the EEPROM task
-            if (xQueueReceive(return_queue, &response_packet, pdMS_TO_TICKS(100)) == pdTRUE)
-            {
-                // Check the status of the response packet
-                if (response_packet.status == DEVICE_OPERATION_STATUS_WRITE_SUCCESS)
-                {
-                    status = true;
-                }
-
-                else if (response_packet.status == DEVICE_OPERATION_STATUS_WRITE_FAILURE)
-                {
-                    status = false;
-                }
-            }
+            // Check the status of the response packet
+            status = (response_packet.status == DEVICE_OPERATION_STATUS_WRITE_SUCCESS);
         }
         else
         {
@@ -108,27 +187,17 @@ bool system_sensors_eeprom_read(QueueHandle_t return_queue, uint16_t address, ui
     request_packet.operation = DEVICE_OP_READ;
     request_packet.address = address;
     request_packet.response_queue = return_queue;
-    // Send the request to the EEPROM task
-    if (xQueueSend(Queue_EEPROM_Requests, &request_packet, portMAX_DELAY) == pdTRUE)
+    // Send the request to the EEPROM task and wait for the response
+    if (device_request(&request_packet, &response_packet, pdMS_TO_TICKS(100)))
     {
-        // If return queue provided, wait for response
         if (return_queue != NULL)
         {
-            // Wait for the response from the EEPROM task
-            if (xQueueReceive(return_queue, &response_packet, pdMS_TO_TICKS(100)) == pdTRUE)
+            // Check the status of the response packet
+            if (response_packet.status == DEVICE_OPERATION_STATUS_READ_SUCCESS)
             {
-                // Check the status of the response packet
-                if (response_packet.status == DEVICE_OPERATION_STATUS_READ_SUCCESS)
-                {
-                    // Return the read value via the data pointer
-                    *data = response_packet.payload.eeprom;
-                    status = true;
-                }
-
-                else if (response_packet.status == DEVICE_OPERATION_STATUS_READ_FAILURE)
-                {
-                    status = false;
-                }
+                // Return the read value via the data pointer
+                *data = response_packet.payload.eeprom;
+                status = true;
             }
         }
         else
@@ -141,6 +210,200 @@ bool system_sensors_eeprom_read(QueueHandle_t return_queue, uint16_t address, ui
     return status;
 }
 
+/**
+ * @brief
+ * This function is the published interface to write a block of data to the
+ * EEPROM.  The EEPROM task splits the block on page boundaries so each page
+ * costs a single write cycle instead of one write cycle per byte.
+ *
+ * A return queue is required because the EEPROM task reads directly from
+ * the caller's buffer.
+ *
+ * @param return_queue
+ * @param address
+ * @param data
+ * @param length
+ * @return true
+ * @return false
+ */
+bool system_sensors_eeprom_write_block(QueueHandle_t return_queue, uint16_t address, uint8_t *data, uint16_t length)
+{
+    bool status = false;
+    device_request_msg_t request_packet;
+    device_response_msg_t response_packet;
+
+    if (return_queue == NULL || data == NULL || length == 0)
+    {
+        return false;
+    }
+
+    // Setup the request packet
+    request_packet.device = DEVICE_EEPROM;
+    request_packet.operation = DEVICE_OP_WRITE_BLOCK;
+    request_packet.address = address;
+    request_packet.buffer = data;
+    request_packet.length = length;
+    request_packet.response_queue = return_queue;
+
+    // Each page takes a write cycle, so wait until the whole block is done
+    if (device_request(&request_packet, &response_packet, portMAX_DELAY))
+    {
+        status = (response_packet.status == DEVICE_OPERATION_STATUS_WRITE_SUCCESS);
+    }
+
+    return status;
+}
+
+/**
+ * @brief
+ * This function is the published interface to read a block of data from the
+ * EEPROM using a single sequential read transaction.
+ *
+ * A return queue is required because the EEPROM task writes directly into
+ * the caller's buffer.  The call waits for the response with no timeout, so
+ * the buffer is still in scope when the task fills it, however many page
+ * writes or cache flushes are queued ahead of the read.
+ *
+ * @param return_queue
+ * @param address
+ * @param data
+ * @param length
+ * @return true
+ * @return false
+ */
+bool system_sensors_eeprom_read_block(QueueHandle_t return_queue, uint16_t address, uint8_t *data, uint16_t length)
+{
+    bool status = false;
+    device_request_msg_t request_packet;
+    device_response_msg_t response_packet;
+
+    if (return_queue == NULL || data == NULL || length == 0)
+    {
+        return false;
+    }
+
+    // Setup the request packet
+    request_packet.device = DEVICE_EEPROM;
+    request_packet.operation = DEVICE_OP_READ_BLOCK;
+    request_packet.address = address;
+    request_packet.buffer = data;
+    request_packet.length = length;
+    request_packet.response_queue = return_queue;
+
+    // The EEPROM task writes into data, so never return before it answers
+    if (device_request(&request_packet, &response_packet, portMAX_DELAY))
+    {
+        status = (response_packet.status == DEVICE_OPERATION_STATUS_READ_SUCCESS);
+    }
+
+    return status;
+}
+
+/**
+ * @brief
+ * This function is the published interface to write every dirty cache
+ * line to the EEPROM.  A return queue is required; the function returns
+ * once the data is on the device.
+ * @param return_queue
+ * @return true
+ * @return false
+ */
+bool system_sensors_eeprom_sync(QueueHandle_t return_queue)
+{
+    bool status = false;
+    device_request_msg_t request_packet;
+    device_response_msg_t response_packet;
+
+    if (return_queue == NULL)
+    {
+        return false;
+    }
+
+    request_packet.device = DEVICE_EEPROM;
+    request_packet.operation = DEVICE_OP_SYNC;
+    request_packet.response_queue = return_queue;
+
+    // Every dirty line costs a write cycle
+    if (device_request(&request_packet, &response_packet, portMAX_DELAY))
+    {
+        status = (response_packet.status == DEVICE_OPERATION_STATUS_WRITE_SUCCESS);
+    }
+
+    return status;
+}
+
+/**
+ * @brief
+ * Power fail hook.  May be called from an interrupt.  Switches the cache to
+ * write-through and has the EEPROM task flush every dirty line.  If the
+ * request queue is full the flag alone is seen when the queued request is
+ * taken.
+ */
+void system_sensors_eeprom_sync_from_isr(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    device_request_msg_t request_packet;
+
+    eeprom_cache.write_through = true;
+    eeprom_cache_sync_pending = true;
+
+    request_packet.device = DEVICE_EEPROM;
+    request_packet.operation = DEVICE_OP_SYNC;
+    request_packet.response_queue = NULL;
+    xQueueSendToFrontFromISR(Queue_EEPROM_Requests, &request_packet, &xHigherPriorityTaskWoken);
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+bool system_sensors_eeprom_get_cache_stats(eeprom_cache_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return false;
+    }
+
+    *stats = eeprom_cache.stats;
+    return true;
+}
+
+#if EEPROM_CACHE_BROWNOUT_FLUSH
+/**
+ * @brief
+ * Low voltage detector interrupt
+ */
+static void eeprom_lvd_handler(void)
+{
+    Cy_LVD_ClearInterrupt();
+    Cy_LVD_ClearInterruptMask(); // One event is enough, the cache stays write-through
+
+    eeprom_cache.stats.brownouts++;
+    system_sensors_eeprom_sync_from_isr();
+}
+
+/**
+ * @brief
+ * Enables the low voltage detector interrupt on a falling VDDD
+ */
+static void eeprom_lvd_init(void)
+{
+    static const cy_stc_sysint_t lvd_int_cfg = {
+        .intrSrc = srss_interrupt_IRQn,
+        .intrPriority = INT_PRIORITY_LVD,
+    };
+
+    Cy_LVD_ClearInterruptMask();
+    Cy_LVD_SetThreshold(EEPROM_CACHE_BROWNOUT_THRESHOLD);
+    Cy_LVD_SetInterruptConfig(CY_LVD_INTR_FALLING);
+    Cy_LVD_Enable();
+    Cy_SysLib_DelayUs(20); // Let the comparator settle before unmasking
+    Cy_LVD_ClearInterrupt();
+    Cy_LVD_SetInterruptMask();
+
+    Cy_SysInt_Init(&lvd_int_cfg, eeprom_lvd_handler);
+    NVIC_EnableIRQ(srss_interrupt_IRQn);
+}
+#endif
+
 /**
  * @brief
  *  Task used to monitor the reception of command packets sent the EEPROM
@@ -156,41 +419,40 @@ void task_eeprom(void *arg)
 
     while (1)
     {
-        // Wait for a request from the EEPROM queue
-        xQueueReceive(Queue_EEPROM_Requests, &request_packet, portMAX_DELAY);
+        // Write back lines that have been dirty too long, or all of them
+        // after a power fail
+        bool flush_all = eeprom_cache_sync_pending;
+        eeprom_cache_sync_pending = false;
+        eeprom_cache_flush(&eeprom_cache, flush_all);
+
+        // Wait for a request, or until the next line is due to be flushed.
+        // EEPROM_CACHE_CLEAN is portMAX_DELAY.
+        if (xQueueReceive(Queue_EEPROM_Requests, &request_packet, eeprom_cache_next_flush(&eeprom_cache)) != pdTRUE)
+        {
+            continue;
+        }
 
         // Process the request based on operation type
         if (request_packet.operation == DEVICE_OP_WRITE)
         {
-            // Claim the SPI Bus semaphore
-            xSemaphoreTake(*SPI_Semaphore, portMAX_DELAY);
+            uint8_t value = request_packet.value;
 
             // Perform the EEPROM write operation
-            eeprom_write_byte(eeprom_spi_obj, eeprom_cs_pin, request_packet.address, request_packet.value);
-
-            // Release the semaphore for the SPI bus
-            xSemaphoreGive(*SPI_Semaphore);
+            eeprom_cache_write(&eeprom_cache, request_packet.address, &value, 1);
 
             // Prepare the response packet (assume success for now)
             response_packet.device = DEVICE_EEPROM;
             response_packet.status = DEVICE_OPERATION_STATUS_WRITE_SUCCESS;
 
             // Send the response back if a return queue is provided
-            if (request_packet.response_queue != NULL)
-            {
-                xQueueSend(request_packet.response_queue, &response_packet, portMAX_DELAY);
-            }
+            device_respond(&request_packet, &response_packet);
         }
         else if (request_packet.operation == DEVICE_OP_READ)
         {
-            // Claim the SPI Bus semaphore
-            xSemaphoreTake(*SPI_Semaphore, portMAX_DELAY);
+            uint8_t read_value = 0;
 
             // Perform the EEPROM read operation
-            uint8_t read_value = eeprom_read_byte(eeprom_spi_obj, eeprom_cs_pin, request_packet.address);
-
-            // Release the semaphore for the SPI bus
-            xSemaphoreGive(*SPI_Semaphore);
+            eeprom_cache_read(&eeprom_cache, request_packet.address, &read_value, 1, true);
 
             // Prepare the response packet (assume success for now)
             response_packet.device = DEVICE_EEPROM;
@@ -198,10 +460,35 @@ void task_eeprom(void *arg)
             response_packet.payload.eeprom = read_value;
 
             // Send the response back if a return queue is provided
-            if (request_packet.response_queue != NULL)
-            {
-                xQueueSend(request_packet.response_queue, &response_packet, portMAX_DELAY);
-            }
+            device_respond(&request_packet, &response_packet);
+        }
+        else if (request_packet.operation == DEVICE_OP_WRITE_BLOCK)
+        {
+            eeprom_cache_write(&eeprom_cache, request_packet.address, request_packet.buffer, request_packet.length);
+
+            response_packet.device = DEVICE_EEPROM;
+            response_packet.status = DEVICE_OPERATION_STATUS_WRITE_SUCCESS;
+
+            device_respond(&request_packet, &response_packet);
+        }
+        else if (request_packet.operation == DEVICE_OP_READ_BLOCK)
+        {
+            // Uncached pages are read with sequential reads and not kept
+            eeprom_cache_read(&eeprom_cache, request_packet.address, request_packet.buffer, request_packet.length, false);
+
+            response_packet.device = DEVICE_EEPROM;
+            response_packet.status = DEVICE_OPERATION_STATUS_READ_SUCCESS;
+
+            device_respond(&request_packet, &response_packet);
+        }
+        else if (request_packet.operation == DEVICE_OP_SYNC)
+        {
+            eeprom_cache_flush(&eeprom_cache, true);
+
+            response_packet.device = DEVICE_EEPROM;
+            response_packet.status = DEVICE_OPERATION_STATUS_WRITE_SUCCESS;
+
+            device_respond(&request_packet, &response_packet);
         }
     }
 }
@@ -227,8 +514,27 @@ bool task_eeprom_resources_init(cyhal_spi_t *spi_obj, SemaphoreHandle_t *spi_sem
     eeprom_spi_obj = spi_obj;
     eeprom_cs_pin = cs_pin;
 
+    eeprom_cache.read = eeprom_task_read;
+    eeprom_cache.write = eeprom_task_write;
+    eeprom_cache.now = eeprom_task_ticks;
+    eeprom_cache.flush_ticks = pdMS_TO_TICKS(EEPROM_CACHE_FLUSH_MS);
+    eeprom_cache.write_through = (EEPROM_CACHE_FLUSH_MS == 0);
+
+    if (!spi_bus_client_register(&eeprom_spi_client, "EEPROM", cs_pin))
+    {
+        return false;
+    }
+
     /*Create the EEPROM Requests Queue */
     Queue_EEPROM_Requests = xQueueCreate(1, sizeof(device_request_msg_t));
+    if (!device_manager_register(DEVICE_EEPROM, Queue_EEPROM_Requests))
+    {
+        return false;
+    }
+
+#if EEPROM_CACHE_BROWNOUT_FLUSH
+    eeprom_lvd_init();
+#endif
 
     /* Create the FreeRTOS task for the EEPROM */
     if (xTaskCreate(
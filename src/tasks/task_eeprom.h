@@ -17,12 +17,27 @@
 #include "drivers.h"
 #include "devices.h"
 #include "rtos_events.h"
+#include "eeprom_cache.h"
+
+/* Write-back cache in front of the EEPROM, see eeprom_cache.h */
+#define EEPROM_CACHE_FLUSH_MS 500             // Longest a write stays only in RAM, 0 = write-through
+#define EEPROM_CACHE_BROWNOUT_FLUSH 1         // Flush and go write-through when VDDD drops
+#define EEPROM_CACHE_BROWNOUT_THRESHOLD CY_LVD_THRESHOLD_3_0_V
+
+#if EEPROM_CACHE_PAGE_SIZE != EEPROM_PAGE_SIZE
+#error "An EEPROM cache line must be one EEPROM write page"
+#endif
 
 extern QueueHandle_t Queue_EEPROM_Requests;
 
 /* Functions used to interact with the EEPROM */
 bool system_sensors_eeprom_write(QueueHandle_t return_queue, uint16_t address, uint8_t data);
 bool system_sensors_eeprom_read(QueueHandle_t return_queue, uint16_t address, uint8_t *data);
+bool system_sensors_eeprom_write_block(QueueHandle_t return_queue, uint16_t address, uint8_t *data, uint16_t length);
+bool system_sensors_eeprom_read_block(QueueHandle_t return_queue, uint16_t address, uint8_t *data, uint16_t length);
+bool system_sensors_eeprom_sync(QueueHandle_t return_queue);
+void system_sensors_eeprom_sync_from_isr(void);
+bool system_sensors_eeprom_get_cache_stats(eeprom_cache_stats_t *stats);
 
 /* Function used to initialize resources for the EEPROM task */
 bool task_eeprom_resources_init(cyhal_spi_t *spi_obj, SemaphoreHandle_t *spi_semaphore, cyhal_gpio_t cs_pin);
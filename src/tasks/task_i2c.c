@@ -0,0 +1,291 @@
+/**
+ * @file task_i2c.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Interrupt driven I2C transaction engine
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "task_i2c.h"
+#include <string.h>
+
+/**
+ * @brief
+ * Sensor tasks submit I2C transactions to this task instead of calling the
+ * blocking cyhal functions themselves.  Pending transactions wait in the
+ * priority queues of i2c_queue.c, read and written inside a critical
+ * section, and a counting semaphore wakes the task for each one.
+ *
+ * Transfers are started with cyhal_i2c_master_transfer_async().  The I2C
+ * task then blocks on its task notification until the completion
+ * interrupt arrives, leaving the CPU free for other tasks while the bus
+ * shifts bits.  The I2C semaphore is still held for each transfer so code
+ * that uses the blocking i2c.c functions can share the bus safely.
+ *
+ * A read writes the register address and then reads with a repeated
+ * start.  A write sends the register address followed by the data.
+ */
+
+#define I2C_ASYNC_RSLT_ERR_BUS    ((cy_rslt_t)0x1u)
+#define I2C_ASYNC_RSLT_ERR_TIMEOUT ((cy_rslt_t)0x2u)
+
+/* Global Variables */
+static cyhal_i2c_t *I2C_Obj;
+static SemaphoreHandle_t *I2C_Semaphore = NULL;
+static TaskHandle_t TaskHandle_I2C = NULL;
+
+static i2c_queue_t I2C_Queue;
+static SemaphoreHandle_t Semaphore_I2C_Pending; // Counts queued transactions
+
+static volatile cyhal_i2c_event_t I2C_Async_Event;
+static uint8_t I2C_Async_Tx[I2C_ASYNC_MAX_WRITE + 1];
+static i2c_async_stats_t I2C_Async_Stats;
+
+/**
+ * @brief
+ * Completion interrupt for asynchronous transfers
+ * @param callback_arg
+ * @param event
+ */
+static void i2c_async_handler(void *callback_arg, cyhal_i2c_event_t event)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    (void)callback_arg;
+
+    I2C_Async_Event |= event;
+    vTaskNotifyGiveFromISR(TaskHandle_I2C, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief
+ * Runs one transaction on the bus and waits for its completion interrupt
+ * @param txn
+ * @return cy_rslt_t
+ */
+static cy_rslt_t i2c_async_run(i2c_txn_t *txn)
+{
+    cy_rslt_t rslt;
+    cyhal_i2c_event_t done;
+    TickType_t deadline;
+    uint32_t start;
+
+    xSemaphoreTake(*I2C_Semaphore, portMAX_DELAY);
+    start = timer_cycles_get();
+
+    // Clear a completion left over from a transfer that timed out
+    ulTaskNotifyTake(pdTRUE, 0);
+    I2C_Async_Event = (cyhal_i2c_event_t)0;
+
+    I2C_Async_Tx[0] = txn->reg;
+    if (txn->write)
+    {
+        memcpy(&I2C_Async_Tx[1], txn->data, txn->length);
+        rslt = cyhal_i2c_master_transfer_async(I2C_Obj, txn->subordinate_address, I2C_Async_Tx, txn->length + 1, NULL, 0);
+    }
+    else
+    {
+        rslt = cyhal_i2c_master_transfer_async(I2C_Obj, txn->subordinate_address, I2C_Async_Tx, 1, txn->data, txn->length);
+    }
+
+    // A read raises a write complete event for the register address first,
+    // so keep waiting until the event that ends this transfer arrives
+    done = (cyhal_i2c_event_t)((txn->write ? CYHAL_I2C_MASTER_WR_CMPLT_EVENT : CYHAL_I2C_MASTER_RD_CMPLT_EVENT) |
+                               CYHAL_I2C_MASTER_ERR_EVENT);
+    deadline = xTaskGetTickCount() + pdMS_TO_TICKS(I2C_ASYNC_TIMEOUT_MS);
+
+    while (rslt == CY_RSLT_SUCCESS && (I2C_Async_Event & done) == 0)
+    {
+        TickType_t remaining = deadline - xTaskGetTickCount();
+
+        if ((int32_t)remaining <= 0 || ulTaskNotifyTake(pdTRUE, remaining) == 0)
+        {
+            cyhal_i2c_abort_async(I2C_Obj);
+            I2C_Async_Stats.timeouts++;
+            rslt = I2C_ASYNC_RSLT_ERR_TIMEOUT;
+        }
+    }
+
+    if (rslt == CY_RSLT_SUCCESS && (I2C_Async_Event & CYHAL_I2C_MASTER_ERR_EVENT) != 0)
+    {
+        rslt = I2C_ASYNC_RSLT_ERR_BUS;
+    }
+
+    I2C_Async_Stats.bus_us += timer_cycles_to_us(timer_cycles_get() - start);
+    xSemaphoreGive(*I2C_Semaphore);
+
+    return rslt;
+}
+
+/**
+ * @brief
+ * Serves queued transactions, highest priority first
+ * @param param
+ * Unused
+ */
+static void task_i2c(void *param)
+{
+    (void)param;
+    i2c_txn_t *txn;
+
+    while (1)
+    {
+        xSemaphoreTake(Semaphore_I2C_Pending, portMAX_DELAY);
+
+        taskENTER_CRITICAL();
+        txn = i2c_queue_pop(&I2C_Queue);
+        taskEXIT_CRITICAL();
+
+        if (txn == NULL)
+        {
+            continue;
+        }
+
+        TickType_t wait = xTaskGetTickCount() - txn->queued;
+        if (wait > I2C_Async_Stats.max_wait[txn->priority])
+        {
+            I2C_Async_Stats.max_wait[txn->priority] = wait;
+        }
+
+        txn->result = i2c_async_run(txn);
+        I2C_Async_Stats.transactions[txn->priority]++;
+        if (txn->result != CY_RSLT_SUCCESS)
+        {
+            I2C_Async_Stats.failures++;
+        }
+
+        // The submitter may reuse txn as soon as done is given, so the
+        // callback runs first and the semaphore is read before signaling
+        SemaphoreHandle_t done = txn->done;
+        if (txn->callback != NULL)
+        {
+            txn->callback(txn);
+        }
+        if (done != NULL)
+        {
+            xSemaphoreGive(done);
+        }
+    }
+}
+
+bool i2c_async_submit(i2c_txn_t *txn)
+{
+    bool queued;
+
+    if (txn == NULL || !i2c_queue_valid(txn->priority, txn->data, txn->length, txn->write))
+    {
+        I2C_Async_Stats.rejected++;
+        return false;
+    }
+
+    txn->queued = xTaskGetTickCount();
+    txn->result = I2C_ASYNC_RSLT_ERR_BUS;
+
+    taskENTER_CRITICAL();
+    queued = i2c_queue_push(&I2C_Queue, txn->priority, txn);
+    taskEXIT_CRITICAL();
+
+    if (!queued)
+    {
+        I2C_Async_Stats.rejected++;
+        return false;
+    }
+
+    xSemaphoreGive(Semaphore_I2C_Pending);
+    return true;
+}
+
+cy_rslt_t i2c_async_transfer(i2c_txn_t *txn)
+{
+    // Lives on the caller's stack, which outlasts the wait below.  A task
+    // notification would be consumed by, or consume, any other notifier of
+    // the calling task.
+    StaticSemaphore_t done_buffer;
+
+    if (txn == NULL)
+    {
+        return I2C_ASYNC_RSLT_ERR_BUS;
+    }
+
+    txn->callback = NULL;
+    txn->done = xSemaphoreCreateBinaryStatic(&done_buffer);
+
+    if (!i2c_async_submit(txn))
+    {
+        vSemaphoreDelete(txn->done);
+        return I2C_ASYNC_RSLT_ERR_BUS;
+    }
+
+    // The engine always completes a transaction, it times out on its own
+    xSemaphoreTake(txn->done, portMAX_DELAY);
+    vSemaphoreDelete(txn->done);
+    txn->done = NULL;
+
+    return txn->result;
+}
+
+bool i2c_async_get_stats(i2c_async_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return false;
+    }
+
+    *stats = I2C_Async_Stats;
+    return true;
+}
+
+/**
+ * @brief
+ * Initializes the resources used by the I2C engine.  This function expects
+ * that the I2C bus had already been initialized prior to the start of
+ * FreeRTOS.
+ * @param i2c_obj
+ * @param i2c_semaphore
+ * @return true
+ * @return false
+ */
+bool task_i2c_resources_init(cyhal_i2c_t *i2c_obj, SemaphoreHandle_t *i2c_semaphore)
+{
+    I2C_Obj = i2c_obj;
+    I2C_Semaphore = i2c_semaphore;
+    if (I2C_Obj == NULL || I2C_Semaphore == NULL)
+    {
+        return false;
+    }
+
+    Semaphore_I2C_Pending = xSemaphoreCreateCounting(I2C_ASYNC_QUEUE_LENGTH * I2C_ASYNC_PRIORITY_COUNT, 0);
+    if (Semaphore_I2C_Pending == NULL)
+    {
+        return false;
+    }
+
+    timer_cycles_init();
+
+    if (xTaskCreate(
+            task_i2c,
+            "I2C",
+            TASK_I2C_STACK_SIZE,
+            NULL,
+            TASK_I2C_PRIORITY,
+            &TaskHandle_I2C) != pdPASS)
+    {
+        return false;
+    }
+
+    cyhal_i2c_register_callback(I2C_Obj, i2c_async_handler, NULL);
+    cyhal_i2c_enable_event(
+        I2C_Obj,
+        (cyhal_i2c_event_t)(CYHAL_I2C_MASTER_WR_CMPLT_EVENT | CYHAL_I2C_MASTER_RD_CMPLT_EVENT | CYHAL_I2C_MASTER_ERR_EVENT),
+        INT_PRIORITY_I2C,
+        true);
+
+    return true;
+}
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file task_i2c.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Interrupt driven I2C transaction engine
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __TASK_I2C_H__
+#define __TASK_I2C_H__
+
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "drivers.h"
+#include "i2c_queue.h"
+
+#define TASK_I2C_PRIORITY (tskIDLE_PRIORITY + 3)
+#define TASK_I2C_STACK_SIZE (configMINIMAL_STACK_SIZE * 2)
+#define INT_PRIORITY_I2C 5
+
+// I2C_ASYNC_QUEUE_LENGTH, I2C_ASYNC_MAX_WRITE and the priorities are in i2c_queue.h
+#define I2C_ASYNC_TIMEOUT_MS 20   // Transfer abandoned if not complete by then
+
+typedef struct i2c_txn i2c_txn_t;
+
+/* Called from the I2C task when a transaction finishes */
+typedef void (*i2c_async_callback_t)(i2c_txn_t *txn);
+
+struct i2c_txn
+{
+    uint8_t subordinate_address;
+    uint8_t reg;                   // First register, the device auto-increments from here
+    uint8_t *data;
+    uint16_t length;
+    bool write;
+    i2c_async_priority_t priority;
+    i2c_async_callback_t callback; // May be NULL
+    SemaphoreHandle_t done;        // Given on completion, may be NULL
+    void *arg;                     // For use by the callback
+    TickType_t queued;             // Set by the engine
+    volatile cy_rslt_t result;     // Set by the engine before completion is signaled
+};
+
+// Counters describing the I2C engine since startup
+typedef struct
+{
+    uint32_t transactions[I2C_ASYNC_PRIORITY_COUNT]; // Completed, per priority
+    TickType_t max_wait[I2C_ASYNC_PRIORITY_COUNT];   // Longest queue-to-start delay, per priority
+    uint32_t failures;                               // Transfers that returned an error
+    uint32_t timeouts;                               // Transfers aborted after I2C_ASYNC_TIMEOUT_MS
+    uint32_t rejected;                               // Submissions refused, queue full or bad arguments
+    uint32_t bus_us;                                 // Time the engine held the bus, in microseconds
+} i2c_async_stats_t;
+
+/**
+ * @brief
+ * Queues a transaction and returns immediately.  txn must stay valid until
+ * completion is signaled through its callback or done semaphore.
+ * @param txn
+ * @return true
+ * @return false if the queue for its priority is full
+ */
+bool i2c_async_submit(i2c_txn_t *txn);
+
+/**
+ * @brief
+ * Queues a transaction and blocks the calling task until it completes.
+ * Waits on a semaphore of its own, so the calling task's notification
+ * stays free for other uses.
+ * @param txn
+ * @return cy_rslt_t
+ */
+cy_rslt_t i2c_async_transfer(i2c_txn_t *txn);
+
+bool i2c_async_get_stats(i2c_async_stats_t *stats);
+
+bool task_i2c_resources_init(cyhal_i2c_t *i2c_obj, SemaphoreHandle_t *i2c_semaphore);
+
+#endif
+#endif
@@ -15,15 +15,35 @@
 #include "imu.h"
 #include "task_console.h"
 #include "devices.h"
+#include "spi_bus.h"
+#include "device_manager.h"
+#include <string.h>
 
 #define TASK_IMU_STACK_SIZE (configMINIMAL_STACK_SIZE * 5)
-#define TASK_IMU_PRIORITY (tskIDLE_PRIORITY + 1)
 
 // Global Variables
 QueueHandle_t Queue_IMU_Requests;
 static SemaphoreHandle_t *SPI_Semaphore = NULL;
 static cyhal_spi_t *imu_spi_obj = NULL;
 static cyhal_gpio_t imu_cs_pin = NC;
+static spi_bus_client_t imu_spi_client;
+
+/*
+ * IMU stream state.  Only the IMU task modifies these.
+ *
+ * Streamed samples are published into imu_sample_ring.  The IMU task is
+ * the only writer.  imu_sample_head counts every sample ever published, so
+ * a reader can tell from it whether the slot it just copied was
+ * overwritten during the copy and needs no lock to read the ring.
+ */
+static bool imu_stream_active = false;
+static TickType_t imu_stream_period;
+static TickType_t imu_stream_next_drain;
+static uint32_t imu_stream_last_drain; // Cycle count of the previous drain
+static imu_stream_stats_t imu_stream_stats;
+static imu_sample_t imu_sample_ring[IMU_SAMPLE_RING_SIZE];
+static volatile uint32_t imu_sample_head = 0;
+static int16_t imu_fifo_buffer[IMU_STREAM_BURST_SAMPLES * FIFO_WORDS_PER_SAMPLE];
 
 /**
  * @brief
@@ -41,9 +61,17 @@ bool task_imu_resources_init(cyhal_spi_t *spi_obj, void *spi_semaphore, cyhal_gp
   imu_spi_obj = spi_obj;
   imu_cs_pin = cs_pin;
 
+  // used to measure how long the IMU holds the SPI bus
+  timer_cycles_init();
+
+  if (!spi_bus_client_register(&imu_spi_client, "IMU", cs_pin))
+  {
+    return false;
+  }
+
   // create the IMU Requests Queue
   Queue_IMU_Requests = xQueueCreate(1, sizeof(device_request_msg_t));
-  if (!Queue_IMU_Requests)
+  if (!device_manager_register(DEVICE_IMU, Queue_IMU_Requests))
   {
     return false;
   }
@@ -63,6 +91,120 @@ bool task_imu_resources_init(cyhal_spi_t *spi_obj, void *spi_semaphore, cyhal_gp
   return true;
 }
 
+/**
+ * @brief
+ * Adds one sample (FIFO_WORDS_PER_SAMPLE FIFO words) to the sample ring
+ * @param words
+ */
+static void imu_stream_publish(const int16_t *words)
+{
+  imu_sample_t *slot = &imu_sample_ring[imu_sample_head & (IMU_SAMPLE_RING_SIZE - 1)];
+
+  // the FIFO stores the gyroscope words ahead of the accelerometer words
+  slot->gx = words[0];
+  slot->gy = words[1];
+  slot->gz = words[2];
+  slot->x = words[3];
+  slot->y = words[4];
+  slot->z = words[5];
+
+  // the sample must be complete before readers can see it
+  __DMB();
+  imu_sample_head++;
+  imu_stream_stats.samples++;
+}
+
+/**
+ * @brief
+ * Reads FIFO words through the SPI bus manager so long bursts use DMA
+ * @param buffer
+ * @param words
+ */
+static void imu_stream_fifo_read(int16_t *buffer, uint16_t words)
+{
+  uint8_t reg = IMU_REG_FIFO_DATA_OUT_L | 0x80; // Set MSB for read operation
+
+  spi_bus_transfer(&imu_spi_client, &reg, 1, NULL, (uint8_t *)buffer, words * 2);
+}
+
+/**
+ * @brief
+ * Records how far the time since the previous drain was from the drain
+ * period.  Called with the bus held, so waiting on another SPI device
+ * shows up as jitter.
+ */
+static void imu_stream_record_jitter(void)
+{
+  uint32_t now = timer_cycles_get();
+  uint32_t period_us = imu_stream_period * portTICK_PERIOD_MS * 1000;
+
+  if (imu_stream_stats.drains > 0)
+  {
+    uint32_t interval_us = timer_cycles_to_us(now - imu_stream_last_drain);
+    uint32_t jitter_us = (interval_us > period_us) ? (interval_us - period_us) : (period_us - interval_us);
+
+    imu_stream_stats.jitter_sum_us += jitter_us;
+    if (jitter_us > imu_stream_stats.jitter_max_us)
+    {
+      imu_stream_stats.jitter_max_us = jitter_us;
+    }
+  }
+
+  imu_stream_last_drain = now;
+  imu_stream_stats.drains++;
+}
+
+/**
+ * @brief
+ * Drains every complete sample from the IMU FIFO, IMU_STREAM_BURST_SAMPLES
+ * per SPI burst, and publishes them to the sample ring.
+ */
+static void imu_stream_drain(void)
+{
+  uint16_t words;
+  uint16_t pattern;
+  uint16_t samples;
+  uint32_t start_cycles;
+
+  // take the SPI bus before reading from the IMU
+  spi_bus_acquire(&imu_spi_client);
+  start_cycles = timer_cycles_get();
+  imu_stream_record_jitter();
+
+  if (imu_fifo_status(imu_spi_obj, imu_cs_pin, &words, &pattern) & FIFO_STATUS2_OVER_RUN)
+  {
+    imu_stream_stats.overruns++;
+  }
+
+  // discard a partial sample so the next word read is the start of a sample
+  if (pattern != 0 && words >= (FIFO_WORDS_PER_SAMPLE - pattern))
+  {
+    imu_stream_fifo_read(imu_fifo_buffer, FIFO_WORDS_PER_SAMPLE - pattern);
+    words -= FIFO_WORDS_PER_SAMPLE - pattern;
+  }
+
+  samples = words / FIFO_WORDS_PER_SAMPLE;
+  while (samples > 0)
+  {
+    uint16_t burst = (samples < IMU_STREAM_BURST_SAMPLES) ? samples : IMU_STREAM_BURST_SAMPLES;
+
+    imu_stream_fifo_read(imu_fifo_buffer, burst * FIFO_WORDS_PER_SAMPLE);
+    imu_stream_stats.bursts++;
+
+    for (uint16_t i = 0; i < burst; i++)
+    {
+      imu_stream_publish(&imu_fifo_buffer[i * FIFO_WORDS_PER_SAMPLE]);
+    }
+
+    samples -= burst;
+  }
+
+  imu_stream_stats.bus_us += timer_cycles_to_us(timer_cycles_get() - start_cycles);
+
+  // give the SPI bus after reading from the IMU
+  spi_bus_release(&imu_spi_client);
+}
+
 void task_imu(void *arg)
 {
   (void)arg;
@@ -73,8 +215,8 @@ void task_imu(void *arg)
 
   task_console_printf("Starting IMU Task\r\n");
 
-  // take the SPI semaphore before initializing the IMU
-  xSemaphoreTake(*SPI_Semaphore, portMAX_DELAY);
+  // take the SPI bus before initializing the IMU
+  spi_bus_acquire(&imu_spi_client);
 
   // initialize the IMU
   if (!imu_init(imu_spi_obj, imu_cs_pin))
@@ -85,23 +227,101 @@ void task_imu(void *arg)
   {
     }
 
-  // give the SPI semaphore after initializing the IMU
-  xSemaphoreGive(*SPI_Semaphore);
+  // give the SPI bus after initializing the IMU
+  spi_bus_release(&imu_spi_client);
 
   while (1)
   {
+    TickType_t wait = portMAX_DELAY;
+
+    // while streaming, drain the FIFO once per watermark period
+    if (imu_stream_active)
+    {
+      TickType_t now = xTaskGetTickCount();
+
+      if ((int32_t)(now - imu_stream_next_drain) >= 0)
+      {
+        imu_stream_drain();
+        imu_stream_next_drain = now + imu_stream_period;
+      }
+      wait = imu_stream_next_drain - now;
+    }
+
     // wait for a request from IMU queue
-    xQueueReceive(Queue_IMU_Requests, &request_packet, portMAX_DELAY);
-    if (request_packet.operation == DEVICE_OP_READ)
+    if (xQueueReceive(Queue_IMU_Requests, &request_packet, wait) != pdTRUE)
     {
-      // take the SPI semaphore before reading from the IMU
-      xSemaphoreTake(*SPI_Semaphore, portMAX_DELAY);
+      continue;
+    }
+
+    if (request_packet.operation == DEVICE_OP_READ && imu_stream_active)
+    {
+      imu_sample_t sample = {0};
+
+      // answer from the stream instead of adding another SPI transaction
+      imu_stream_latest(&sample);
+
+      response_packet.device = DEVICE_IMU;
+      response_packet.status = DEVICE_OPERATION_STATUS_READ_SUCCESS;
+      response_packet.payload.imu[0] = sample.x;
+      response_packet.payload.imu[1] = sample.y;
+      response_packet.payload.imu[2] = sample.z;
+
+      device_respond(&request_packet, &response_packet);
+    }
+    else if (request_packet.operation == DEVICE_OP_STREAM_START)
+    {
+      uint16_t hz = imu_odr_to_hz(request_packet.value);
+      bool started;
+
+      spi_bus_acquire(&imu_spi_client);
+      started = imu_fifo_enable(imu_spi_obj, imu_cs_pin, request_packet.value, request_packet.length);
+      spi_bus_release(&imu_spi_client);
+
+      if (started)
+      {
+        memset(&imu_stream_stats, 0, sizeof(imu_stream_stats));
+        imu_stream_stats.start = xTaskGetTickCount();
+
+        // drain when the watermark should have been reached
+        imu_stream_period = pdMS_TO_TICKS(((uint32_t)request_packet.length * 1000) / hz);
+        if (imu_stream_period == 0)
+        {
+          imu_stream_period = 1;
+        }
+        imu_stream_next_drain = imu_stream_stats.start + imu_stream_period;
+        imu_stream_active = true;
+      }
+
+      response_packet.device = DEVICE_IMU;
+      response_packet.status = started ? DEVICE_OPERATION_STATUS_WRITE_SUCCESS : DEVICE_OPERATION_STATUS_WRITE_FAILURE;
+
+      device_respond(&request_packet, &response_packet);
+    }
+    else if (request_packet.operation == DEVICE_OP_STREAM_STOP)
+    {
+      if (imu_stream_active)
+      {
+        spi_bus_acquire(&imu_spi_client);
+        imu_fifo_disable(imu_spi_obj, imu_cs_pin);
+        spi_bus_release(&imu_spi_client);
+        imu_stream_active = false;
+      }
+
+      response_packet.device = DEVICE_IMU;
+      response_packet.status = DEVICE_OPERATION_STATUS_WRITE_SUCCESS;
+
+      device_respond(&request_packet, &response_packet);
+    }
+    else if (request_packet.operation == DEVICE_OP_READ)
+    {
+      // take the SPI bus before reading from the IMU
+      spi_bus_acquire(&imu_spi_client);
 
       // read the acceleration data from the IMU
       imu_read_registers(imu_spi_obj, imu_cs_pin, IMU_REG_OUTX_L_XL, (uint8_t *)accel_data, 6);
 
-      // give the SPI semaphore after reading from the IMU
-      xSemaphoreGive(*SPI_Semaphore);
+      // give the SPI bus after reading from the IMU
+      spi_bus_release(&imu_spi_client);
 
       // prepare the response packet
       response_packet.device = DEVICE_IMU;
@@ -111,31 +331,25 @@ void task_imu(void *arg)
       response_packet.payload.imu[2] = accel_data[2];
 
       // send the response back if a return queue is provided
-      if (request_packet.response_queue != NULL)
-      {
-        xQueueSend(request_packet.response_queue, &response_packet, portMAX_DELAY);
-      }
+      device_respond(&request_packet, &response_packet);
     }
     else if (request_packet.operation == DEVICE_OP_WRITE)
     {
-      // take the SPI semaphore before writing to the IMU
-      xSemaphoreTake(*SPI_Semaphore, portMAX_DELAY);
+      // take the SPI bus before writing to the IMU
+      spi_bus_acquire(&imu_spi_client);
 
       // write to the IMU register
       imu_write_reg(imu_spi_obj, imu_cs_pin, request_packet.address, request_packet.value);
 
-      // give the SPI semaphore after writing to the IMU
-      xSemaphoreGive(*SPI_Semaphore);
+      // give the SPI bus after writing to the IMU
+      spi_bus_release(&imu_spi_client);
 
       // prepare the response packet
       response_packet.device = DEVICE_IMU;
       response_packet.status = DEVICE_OPERATION_STATUS_WRITE_SUCCESS;
 
       // send the response back if a return queue is provided
-      if (request_packet.response_queue != NULL)
-      {
-        xQueueSend(request_packet.response_queue, &response_packet, portMAX_DELAY);
-      }
+      device_respond(&request_packet, &response_packet);
     }
   }
 }
@@ -167,23 +381,19 @@ bool system_sensors_imu_read(QueueHandle_t return_queue, uint16_t *imu_data)
   request_packet.value = 0;   // Not used for IMU
   request_packet.response_queue = return_queue;
 
-  // Send the request to the IMU task
-  if (xQueueSend(Queue_IMU_Requests, &request_packet, portMAX_DELAY) == pdTRUE)
+  // Send the request to the IMU task and wait for the response
+  if (device_request(&request_packet, &response_packet, pdMS_TO_TICKS(100)))
   {
-    // If return queue provided, wait for response
+    // If return queue provided, check the response
     if (return_queue != NULL && imu_data != NULL)
     {
-      // Wait for the response from the IMU task
-      if (xQueueReceive(return_queue, &response_packet, pdMS_TO_TICKS(100)) == pdTRUE)
+      // Check the status of the response packet
+      if (response_packet.status == DEVICE_OPERATION_STATUS_READ_SUCCESS)
       {
-        // Check the status of the response packet
-        if (response_packet.status == DEVICE_OPERATION_STATUS_READ_SUCCESS)
-        {
-          imu_data[0] = response_packet.payload.imu[0];
-          imu_data[1] = response_packet.payload.imu[1];
-          imu_data[2] = response_packet.payload.imu[2];
-          status = true;
-        }
+        imu_data[0] = response_packet.payload.imu[0];
+        imu_data[1] = response_packet.payload.imu[1];
+        imu_data[2] = response_packet.payload.imu[2];
+        status = true;
       }
     }
     else
@@ -224,20 +434,16 @@ bool system_sensors_imu_write(QueueHandle_t return_queue, uint16_t address, uint
   request_packet.value = value;
   request_packet.response_queue = return_queue;
 
-  // Send the request to the IMU task
-  if (xQueueSend(Queue_IMU_Requests, &request_packet, portMAX_DELAY) == pdTRUE)
+  // Send the request to the IMU task and wait for the response
+  if (device_request(&request_packet, &response_packet, pdMS_TO_TICKS(100)))
   {
-    // If return queue provided, wait for response
+    // If return queue provided, check the response
     if (return_queue != NULL)
     {
-      // Wait for the response from the IMU task
-      if (xQueueReceive(return_queue, &response_packet, pdMS_TO_TICKS(100)) == pdTRUE)
+      // Check the status of the response packet
+      if (response_packet.status == DEVICE_OPERATION_STATUS_WRITE_SUCCESS)
       {
-        // Check the status of the response packet
-        if (response_packet.status == DEVICE_OPERATION_STATUS_WRITE_SUCCESS)
-        {
-          status = true;
-        }
+        status = true;
       }
     }
     else
@@ -249,4 +455,187 @@ bool system_sensors_imu_write(QueueHandle_t return_queue, uint16_t address, uint
 
   return status;
 }
+
+/**
+ * @brief
+ * This function starts streaming accelerometer and gyroscope samples
+ * through the IMU FIFO.  The IMU task drains the FIFO in bursts each time the watermark
+ * is reached and publishes the samples for imu_stream_latest() and
+ * imu_stream_read().  While streaming, system_sensors_imu_read() returns
+ * the newest streamed sample instead of reading the IMU.
+ *
+ * @param return_queue Queue to receive the response (can be NULL)
+ * @param odr Output data rate, ODR_104HZ or faster
+ * @param watermark Number of samples drained per watermark period, 1 to
+ * IMU_SAMPLE_RING_SIZE so one drain never overwrites samples a reader has
+ * not seen yet
+ * @return true if operation was successful, false otherwise
+ */
+bool system_sensors_imu_stream_start(QueueHandle_t return_queue, uint8_t odr, uint16_t watermark)
+{
+  bool status = false;
+  device_request_msg_t request_packet;
+  device_response_msg_t response_packet;
+
+  if (watermark == 0 || watermark > IMU_SAMPLE_RING_SIZE)
+  {
+    return false;
+  }
+
+  // Setup the request packet
+  request_packet.device = DEVICE_IMU;
+  request_packet.operation = DEVICE_OP_STREAM_START;
+  request_packet.address = 0; // Not used for IMU
+  request_packet.value = odr;
+  request_packet.length = watermark;
+  request_packet.response_queue = return_queue;
+
+  // Send the request to the IMU task and wait for the response
+  if (device_request(&request_packet, &response_packet, pdMS_TO_TICKS(100)))
+  {
+    // If return queue provided, check the response
+    if (return_queue != NULL)
+    {
+      if (response_packet.status == DEVICE_OPERATION_STATUS_WRITE_SUCCESS)
+      {
+        status = true;
+      }
+    }
+    else
+    {
+      // No return queue provided, assume success
+      status = true;
+    }
+  }
+
+  return status;
+}
+
+/**
+ * @brief
+ * This function stops the IMU stream and returns the FIFO to bypass mode.
+ *
+ * @param return_queue Queue to receive the response (can be NULL)
+ * @return true if operation was successful, false otherwise
+ */
+bool system_sensors_imu_stream_stop(QueueHandle_t return_queue)
+{
+  bool status = false;
+  device_request_msg_t request_packet;
+  device_response_msg_t response_packet;
+
+  // Setup the request packet
+  request_packet.device = DEVICE_IMU;
+  request_packet.operation = DEVICE_OP_STREAM_STOP;
+  request_packet.address = 0; // Not used for IMU
+  request_packet.value = 0;   // Not used for IMU
+  request_packet.response_queue = return_queue;
+
+  // Send the request to the IMU task and wait for the response
+  if (device_request(&request_packet, &response_packet, pdMS_TO_TICKS(100)))
+  {
+    // If return queue provided, check the response
+    if (return_queue != NULL)
+    {
+      if (response_packet.status == DEVICE_OPERATION_STATUS_WRITE_SUCCESS)
+      {
+        status = true;
+      }
+    }
+    else
+    {
+      // No return queue provided, assume success
+      status = true;
+    }
+  }
+
+  return status;
+}
+
+/**
+ * @brief
+ * Copies the newest streamed sample.  Never blocks.
+ * @param sample
+ * @return uint32_t
+ * Sequence number of the sample (increments by one per sample), or 0 if
+ * no sample has been streamed yet
+ */
+uint32_t imu_stream_latest(imu_sample_t *sample)
+{
+  uint32_t head;
+
+  do
+  {
+    head = imu_sample_head;
+    if (head == 0)
+    {
+      return 0;
+    }
+
+    *sample = imu_sample_ring[(head - 1) & (IMU_SAMPLE_RING_SIZE - 1)];
+    __DMB();
+
+    // retry if the IMU task reused the slot while it was being copied
+  } while ((imu_sample_head - (head - 1)) >= IMU_SAMPLE_RING_SIZE);
+
+  return head;
+}
+
+/**
+ * @brief
+ * Copies up to max_samples streamed samples that are newer than *cursor
+ * and advances *cursor past them.  Each reader keeps its own cursor
+ * (start it at 0).  If the reader falls more than IMU_SAMPLE_RING_SIZE
+ * samples behind, the oldest samples are skipped.  Never blocks.
+ * @param cursor
+ * @param samples
+ * @param max_samples
+ * @return uint16_t
+ * Number of samples copied
+ */
+uint16_t imu_stream_read(uint32_t *cursor, imu_sample_t *samples, uint16_t max_samples)
+{
+  uint16_t count = 0;
+
+  while (count < max_samples)
+  {
+    uint32_t head = imu_sample_head;
+
+    // skip samples that have already been overwritten
+    if ((head - *cursor) >= IMU_SAMPLE_RING_SIZE)
+    {
+      *cursor = head - IMU_SAMPLE_RING_SIZE + 1;
+    }
+
+    if (*cursor == head)
+    {
+      break;
+    }
+
+    samples[count] = imu_sample_ring[*cursor & (IMU_SAMPLE_RING_SIZE - 1)];
+    __DMB();
+
+    // only keep the copy if the slot was not reused while it was copied
+    if ((imu_sample_head - *cursor) < IMU_SAMPLE_RING_SIZE)
+    {
+      (*cursor)++;
+      count++;
+    }
+  }
+
+  return count;
+}
+
+/**
+ * @brief
+ * Copies the IMU stream counters
+ * @param stats
+ * @return true if the stream is running
+ * @return false
+ */
+bool imu_stream_get_stats(imu_stream_stats_t *stats)
+{
+  *stats = imu_stream_stats;
+  return imu_stream_active;
+}
 #endif /* ECE353_FREERTOS */
\ No newline at end of file
@@ -23,10 +23,33 @@ extern QueueHandle_t Queue_IMU_Requests;
 #define TASK_IMU_PRIORITY (tskIDLE_PRIORITY + 2)
 #define TASK_IMU_STACK_SIZE (1024)
 
+#define IMU_SAMPLE_RING_SIZE 64       // Streamed samples kept for readers, power of 2
+#define IMU_STREAM_BURST_SAMPLES 32   // Max samples drained per SPI transaction
+
+// Counters describing the IMU stream since it was started
+typedef struct
+{
+  uint32_t samples;     // Samples published to the ring
+  uint32_t bursts;      // SPI bursts used to drain the FIFO
+  uint32_t overruns;    // Times the FIFO overran before it was drained
+  uint32_t bus_us;      // Time the IMU held the SPI bus, in microseconds
+  uint32_t drains;      // FIFO drains
+  uint32_t jitter_max_us; // Largest deviation of a drain from the drain period
+  uint32_t jitter_sum_us; // Sum of deviations, divide by drains - 1 for the mean
+  TickType_t start;     // Tick count when streaming started
+} imu_stream_stats_t;
+
 bool task_imu_resources_init(cyhal_spi_t *spi_obj, void *spi_semaphore, cyhal_gpio_t cs_pin);
 void task_imu(void *arg);
 bool system_sensors_imu_read(QueueHandle_t return_queue, uint16_t *imu_data);
 bool system_sensors_imu_write(QueueHandle_t return_queue, uint16_t address, uint8_t value);
+bool system_sensors_imu_stream_start(QueueHandle_t return_queue, uint8_t odr, uint16_t watermark);
+bool system_sensors_imu_stream_stop(QueueHandle_t return_queue);
+
+/* Lock-free readers for the IMU stream, safe to call from any task */
+uint32_t imu_stream_latest(imu_sample_t *sample);
+uint16_t imu_stream_read(uint32_t *cursor, imu_sample_t *samples, uint16_t max_samples);
+bool imu_stream_get_stats(imu_stream_stats_t *stats);
 #endif /* ECE353_FREERTOS */
 
 #endif /* __TASK_IMU_H__ */
\ No newline at end of file
@@ -15,6 +15,8 @@
 #include "task_console.h"
 #include "rtos_events.h"
 #include "devices.h"
+#include "device_manager.h"
+#include "task_i2c.h"
 
 #define TASK_IO_EXPANDER_STACK_SIZE (configMINIMAL_STACK_SIZE)
 #define TASK_IO_EXPANDER_PRIORITY (tskIDLE_PRIORITY + 1)
@@ -31,6 +33,25 @@ static void handler_io_expander_button(void *arg, cyhal_gpio_event_t event);
 static cyhal_i2c_t *I2C_Obj;
 static SemaphoreHandle_t *I2C_Semaphore = NULL;
 
+/* Shadow copies of the output and configuration registers.  A shadow is only
+ * trusted once it has been written or read since reset. */
+static SemaphoreHandle_t Semaphore_IO_Expander_Shadow;
+static uint8_t ioxp_shadow_output;
+static uint8_t ioxp_shadow_config;
+static bool ioxp_shadow_output_valid = false;
+static bool ioxp_shadow_config_valid = false;
+static uint32_t ioxp_output_generation = 0; // Counts output port writes started
+
+/* Bit operations waiting for the IO expander task, applied to the output
+ * port as (output & ioxp_pending_keep) ^ ioxp_pending_flip.  Bit operations
+ * come from timer callbacks, so these are guarded by a critical section
+ * rather than the shadow mutex. */
+static uint8_t ioxp_pending_keep = 0xFF;
+static uint8_t ioxp_pending_flip = 0x00;
+static volatile bool ioxp_pending = false;
+
+static io_expander_stats_t IO_Expander_Stats;
+
 /* Queue used to send commands used to io expander */
 QueueHandle_t Queue_IO_Expander_Requests;
 
@@ -38,38 +59,258 @@ QueueHandle_t Queue_IO_Expander_Requests;
 /* Static Function Definitions                                                */
 /******************************************************************************/
 
+/**
+ * @brief
+ * Returns the shadow of a register, or NULL if the register is not shadowed
+ */
+static uint8_t *io_expander_shadow(uint8_t address, bool **valid)
+{
+	if (address == IOXP_ADDR_OUTPUT_PORT)
+	{
+		*valid = &ioxp_shadow_output_valid;
+		return &ioxp_shadow_output;
+	}
+	if (address == IOXP_ADDR_CONFIG)
+	{
+		*valid = &ioxp_shadow_config_valid;
+		return &ioxp_shadow_config;
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ * Runs one register access through the I2C task.  The calling task sleeps
+ * until the transfer completes.
+ */
+static bool io_expander_transfer(uint8_t address, uint8_t *value, bool write)
+{
+	i2c_txn_t txn = {
+		.subordinate_address = TCA9534_SUBORDINATE_ADDR,
+		.reg = address,
+		.data = value,
+		.length = 1,
+		.write = write,
+		.priority = I2C_ASYNC_PRIORITY_HIGH, // LEDs are user visible
+	};
+
+	IO_Expander_Stats.transactions++;
+	return (i2c_async_transfer(&txn) == CY_RSLT_SUCCESS);
+}
+
+/**
+ * @brief
+ * Records a bit operation and, if none is waiting, asks the IO expander
+ * task to apply the pending operations on the next tick.  Never blocks, so
+ * it is safe from timer callbacks.
+ */
+static bool io_expander_bit_op(uint8_t keep, uint8_t flip_clear, uint8_t flip_set)
+{
+	device_request_msg_t request_packet = {
+		.device = DEVICE_IO_EXP,
+		.operation = DEVICE_OP_SYNC,
+		.response_queue = NULL,
+	};
+	bool schedule;
+
+	taskENTER_CRITICAL();
+	ioxp_pending_keep &= keep;
+	ioxp_pending_flip = (ioxp_pending_flip & ~flip_clear) ^ flip_set;
+	schedule = !ioxp_pending;
+	ioxp_pending = true;
+	IO_Expander_Stats.bit_ops++;
+	if (!schedule)
+	{
+		IO_Expander_Stats.bit_ops_coalesced++;
+	}
+	taskEXIT_CRITICAL();
+
+	// If the queue holds another request, the task flushes after serving it
+	if (schedule)
+	{
+		xQueueSend(Queue_IO_Expander_Requests, &request_packet, 0);
+	}
+
+	return true;
+}
+
+/**
+ * @brief
+ * Applies the pending bit operations to the output port with one write.
+ * The shadow mutex is not held during the I2C transfers, so a write from
+ * another task may start in between.  When that happens the newer shadow
+ * is written again so the port ends up with the last value either side
+ * chose.
+ */
+static void io_expander_flush_bits(void)
+{
+	uint8_t current;
+	uint8_t value;
+	uint8_t keep;
+	uint8_t flip;
+	uint32_t generation;
+	bool collided;
+	bool status;
+
+	xSemaphoreTake(Semaphore_IO_Expander_Shadow, portMAX_DELAY);
+	current = ioxp_shadow_output;
+	status = ioxp_shadow_output_valid;
+	xSemaphoreGive(Semaphore_IO_Expander_Shadow);
+
+	if (!status && !io_expander_transfer(IOXP_ADDR_OUTPUT_PORT, &current, false))
+	{
+		// Keep the operations, the next bit operation schedules another try
+		taskENTER_CRITICAL();
+		ioxp_pending = false;
+		taskEXIT_CRITICAL();
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	keep = ioxp_pending_keep;
+	flip = ioxp_pending_flip;
+	ioxp_pending_keep = 0xFF;
+	ioxp_pending_flip = 0x00;
+	ioxp_pending = false;
+	taskEXIT_CRITICAL();
+
+	xSemaphoreTake(Semaphore_IO_Expander_Shadow, portMAX_DELAY);
+	if (ioxp_shadow_output_valid)
+	{
+		current = ioxp_shadow_output; // Newer than the value read above
+	}
+	value = (current & keep) ^ flip;
+	if (value == current)
+	{
+		ioxp_shadow_output = current;
+		ioxp_shadow_output_valid = true;
+		IO_Expander_Stats.writes_skipped++;
+		xSemaphoreGive(Semaphore_IO_Expander_Shadow);
+		return;
+	}
+
+	do
+	{
+		// Claim the shadow before the write so later bit operations build on it
+		ioxp_shadow_output = value;
+		ioxp_shadow_output_valid = true;
+		generation = ++ioxp_output_generation;
+		xSemaphoreGive(Semaphore_IO_Expander_Shadow);
+
+		status = io_expander_transfer(IOXP_ADDR_OUTPUT_PORT, &value, true);
+
+		xSemaphoreTake(Semaphore_IO_Expander_Shadow, portMAX_DELAY);
+		collided = (ioxp_output_generation != generation);
+		if (!collided && !status)
+		{
+			ioxp_shadow_output_valid = false;
+		}
+		value = ioxp_shadow_output;
+	} while (collided && ioxp_shadow_output_valid);
+
+	xSemaphoreGive(Semaphore_IO_Expander_Shadow);
+}
+
 /******************************************************************************/
 /* Public Function Definitions                                                */
 /******************************************************************************/
 
+/**
+ * @brief
+ * Writes an IO expander register through the I2C task.  The calling task
+ * sleeps until the transfer completes.  Writes to the output and
+ * configuration registers are skipped when the shadow already holds value.
+ */
 bool system_sensors_io_expander_write(QueueHandle_t return_queue, uint8_t address, uint8_t value)
 {
-	cy_rslt_t rslt;
-	bool status = true;
+	bool *valid;
+	uint8_t *shadow = io_expander_shadow(address, &valid);
+	bool status;
+
+	if (shadow == NULL)
+	{
+		return io_expander_transfer(address, &value, true);
+	}
 
-	rslt = i2c_write_u8(I2C_Obj, TCA9534_SUBORDINATE_ADDR, address, value);
-	if (rslt != CY_RSLT_SUCCESS)
+	xSemaphoreTake(Semaphore_IO_Expander_Shadow, portMAX_DELAY);
+	if (*valid && *shadow == value)
+	{
+		IO_Expander_Stats.writes_skipped++;
+		status = true;
+	}
+	else
 	{
-		status = false;
+		if (address == IOXP_ADDR_OUTPUT_PORT)
+		{
+			ioxp_output_generation++;
+		}
+		status = io_expander_transfer(address, &value, true);
+		*shadow = value;
+		*valid = status;
 	}
+	xSemaphoreGive(Semaphore_IO_Expander_Shadow);
 
 	return status;
 }
 
+/**
+ * @brief
+ * Reads an IO expander register through the I2C task.  The output and
+ * configuration registers are returned from their shadows once known.
+ */
 bool system_sensors_io_expander_read(QueueHandle_t return_queue, uint8_t address, uint8_t *value)
 {
+	bool *valid;
+	uint8_t *shadow = io_expander_shadow(address, &valid);
 	bool status = true;
-	cy_rslt_t rslt;
 
-	rslt = i2c_read_u8(I2C_Obj, TCA9534_SUBORDINATE_ADDR, address, value);
-	if (rslt != CY_RSLT_SUCCESS)
+	if (shadow == NULL)
+	{
+		return io_expander_transfer(address, value, false);
+	}
+
+	xSemaphoreTake(Semaphore_IO_Expander_Shadow, portMAX_DELAY);
+	if (*valid)
+	{
+		IO_Expander_Stats.reads_skipped++;
+	}
+	else
 	{
-		status = false;
+		status = io_expander_transfer(address, shadow, false);
+		*valid = status;
 	}
+	*value = *shadow;
+	xSemaphoreGive(Semaphore_IO_Expander_Shadow);
 
 	return status;
 }
 
+bool system_sensors_io_expander_set_bits(uint8_t mask)
+{
+	return io_expander_bit_op((uint8_t)~mask, mask, mask);
+}
+
+bool system_sensors_io_expander_clear_bits(uint8_t mask)
+{
+	return io_expander_bit_op((uint8_t)~mask, mask, 0x00);
+}
+
+bool system_sensors_io_expander_toggle_bits(uint8_t mask)
+{
+	return io_expander_bit_op(0xFF, 0x00, mask);
+}
+
+bool system_sensors_io_expander_get_stats(io_expander_stats_t *stats)
+{
+	if (stats == NULL)
+	{
+		return false;
+	}
+
+	*stats = IO_Expander_Stats;
+	return true;
+}
+
 /**
  * @brief
  * Task used to monitor the reception of command packets sent the io expander
@@ -90,10 +331,14 @@ void task_io_expander(void *param)
 		// wait for a request packet
 		if (xQueueReceive(Queue_IO_Expander_Requests, &request_packet, portMAX_DELAY) == pdTRUE)
 		{
-			// grab the semaphore to access the bus
-			xSemaphoreTake(*I2C_Semaphore, portMAX_DELAY);
-
-			if (request_packet.operation == DEVICE_OP_WRITE)
+			// The I2C task serializes access to the bus
+			if (request_packet.operation == DEVICE_OP_SYNC)
+			{
+				// Let bit operations made during this tick join the write
+				vTaskDelay(1);
+				io_expander_flush_bits();
+			}
+			else if (request_packet.operation == DEVICE_OP_WRITE)
 			{
 				system_sensors_io_expander_write(request_packet.response_queue, request_packet.address, request_packet.value);
 			}
@@ -107,14 +352,14 @@ void task_io_expander(void *param)
 				response_packet.payload.io_expander = (uint8_t)read_value;
 
 				// send the response back if a return queue is provided
-				if (request_packet.response_queue != NULL)
-				{
-					xQueueSend(request_packet.response_queue, &response_packet, portMAX_DELAY);
-				}
+				device_respond(&request_packet, &response_packet);
 			}
 
-			// release the semaphore for the I2C bus
-			xSemaphoreGive(*I2C_Semaphore);
+			// A bit operation that found the queue full did not queue a sync
+			if (ioxp_pending && request_packet.operation != DEVICE_OP_SYNC)
+			{
+				io_expander_flush_bits();
+			}
 		}
 	}
 }
@@ -135,9 +380,15 @@ bool task_io_expander_resources_init(cyhal_i2c_t *i2c_obj, SemaphoreHandle_t *i2
 		return false;
 	}
 
+	Semaphore_IO_Expander_Shadow = xSemaphoreCreateMutex();
+	if (Semaphore_IO_Expander_Shadow == NULL)
+	{
+		return false;
+	}
+
 	/* Create the Queue used to send commands to the IO Expander*/
 	Queue_IO_Expander_Requests = xQueueCreate(1, sizeof(device_request_msg_t));
-	if (Queue_IO_Expander_Requests == NULL)
+	if (!device_manager_register(DEVICE_IO_EXP, Queue_IO_Expander_Requests))
 	{
 		return false;
 	}
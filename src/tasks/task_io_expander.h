@@ -20,6 +20,15 @@
 #define IOXP_ADDR_CONFIG                0x03
 #define IOXP_ADDR_INVALID               0xFF
 
+/* Counters describing the IO expander shadow registers since startup */
+typedef struct
+{
+	uint32_t transactions;      /* I2C transactions issued */
+	uint32_t writes_skipped;    /* Writes that matched the shadow register */
+	uint32_t reads_skipped;     /* Reads served from a shadow register */
+	uint32_t bit_ops;           /* set/clear/toggle calls */
+	uint32_t bit_ops_coalesced; /* Bit operations merged into another write */
+} io_expander_stats_t;
 
 extern QueueHandle_t Queue_IO_Expander_Requests;
 
@@ -27,6 +36,14 @@ extern QueueHandle_t Queue_IO_Expander_Requests;
 bool system_sensors_io_expander_write(QueueHandle_t return_queue, uint8_t address, uint8_t value);
 bool system_sensors_io_expander_read(QueueHandle_t return_queue, uint8_t address, uint8_t *value);
 
+/* Bit operations on the output port.  Changes made in the same tick are
+ * written with a single I2C transaction by the IO expander task. */
+bool system_sensors_io_expander_set_bits(uint8_t mask);
+bool system_sensors_io_expander_clear_bits(uint8_t mask);
+bool system_sensors_io_expander_toggle_bits(uint8_t mask);
+
+bool system_sensors_io_expander_get_stats(io_expander_stats_t *stats);
+
 /* Function used to initialize resources for the IO Expander task */
 bool task_io_expander_resources_init(cyhal_i2c_t *i2c_obj, SemaphoreHandle_t *i2c_semaphore);
 
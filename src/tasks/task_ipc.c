@@ -81,6 +81,17 @@ bool validate_packet(volatile ipc_packet_t *packet)
     return true; // Packet is valid
 }
 
+/**
+ * @brief
+ * Sets the start byte and checksum of a packet built by a local peer
+ * @param packet
+ */
+void ipc_packet_seal(ipc_packet_t *packet)
+{
+    packet->start_byte = IPC_PACKET_START;
+    packet->checksum = calculate_checksum(packet);
+}
+
 /**
  * @brief
  * This function is used to send a "fire" command to the opponent
@@ -28,6 +28,11 @@
 
 #define IPC_TX_CIRCULAR_BUFFER_SIZE 128
 #define IPC_TX_QUEUE_LENGTH 10
+#define IPC_RX_LOCAL_QUEUE_LENGTH 10
+
+// Notification bit set by ipc_rx_inject().  The UART ISR increments the
+// low bits of the notification value.
+#define IPC_RX_NOTIFY_LOCAL 0x80000000UL
 
 #define INT_PRIORITY_IPC 5 // Priority for IPC tasks and events
 
@@ -87,6 +92,9 @@ typedef struct
     uint8_t checksum;
 } ipc_packet_t;
 
+// Receives the packets this board sends when the opponent is local
+typedef void (*ipc_local_peer_t)(const ipc_packet_t *packet);
+
 /* IPC UART Globals*/
 extern cyhal_uart_t IPC_Uart_Obj;
 extern cyhal_uart_cfg_t IPC_Uart_Config;
@@ -118,6 +126,33 @@ bool ipc_send_result(ipc_result_t result);
 bool ipc_send_game_control(ipc_game_control_t control);
 bool ipc_send_error(ipc_error_t error);
 
+/**
+ * @brief
+ * Sets the start byte and checksum of a packet built by a local peer
+ * @param packet
+ */
+void ipc_packet_seal(ipc_packet_t *packet);
+
+/**
+ * @brief
+ * Replaces the UART peer with a function on this board.  Packets queued
+ * by ipc_send_*() are passed to peer instead of being transmitted, and
+ * the peer answers through ipc_rx_inject().  NULL restores the UART.
+ * @param peer
+ */
+void ipc_set_local_peer(ipc_local_peer_t peer);
+
+/**
+ * @brief
+ * Hands a packet from a local peer to the IPC Rx task, which processes it
+ * exactly as if it had arrived on the UART.  Packets are processed in the
+ * order they are injected.
+ * @param packet
+ * @return true
+ * @return false if the Rx task's local queue is full
+ */
+bool ipc_rx_inject(const ipc_packet_t *packet);
+
 #endif /* ECE353_FREERTOS */
 
 #endif /* __TASK_IPC_H__ */
\ No newline at end of file
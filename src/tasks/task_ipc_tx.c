@@ -17,6 +17,20 @@
 /* Global Variables */
 TaskHandle_t TaskHandle_IPC_Tx = NULL;
 
+/* Set when the opponent runs on this board instead of across the UART */
+static volatile ipc_local_peer_t IPC_Local_Peer = NULL;
+
+/**
+ * @brief
+ * Replaces the UART peer with a function on this board.  NULL restores
+ * the UART.
+ * @param peer
+ */
+void ipc_set_local_peer(ipc_local_peer_t peer)
+{
+    IPC_Local_Peer = peer;
+}
+
 /**
  * @brief
  * This task is used to process outgoing IPC packets.
@@ -46,6 +60,15 @@ void task_ipc_tx(void *param)
                 printf("╚═══════════════════════════════════════════════════════════╝\r\n");
             }
             
+            /* Hand the packet to the local opponent instead of the UART */
+            ipc_local_peer_t peer = IPC_Local_Peer;
+            if (peer != NULL)
+            {
+                printf("IPC TX Task: Passing packet to local peer - CMD: %s (%d)\r\n", cmd_name, packet.cmd);
+                peer(&packet);
+                continue;
+            }
+
             printf("IPC TX Task: Transmitting packet - CMD: %s (%d), checksum: 0x%02X\r\n", 
                    cmd_name, packet.cmd, packet.checksum);
             
@@ -14,6 +14,7 @@
 #ifdef ECE353_FREERTOS
 #include "drivers.h"
 #include "task_joystick.h"
+#include "task_console.h"
 
 QueueHandle_t Queue_Joystick = NULL;
 QueueHandle_t Queue_position = NULL;
@@ -30,79 +31,221 @@ const char *const joystick_pos_names[] = {
     "Lower Left",
     "Lower Right"};
 
+/* Direction seen by the most recent scan, written by the ADC interrupt */
+static volatile int8_t joystick_scan_dx = 0;
+static volatile int8_t joystick_scan_dy = 0;
+static volatile TickType_t joystick_scan_changed_at = 0;
+static TaskHandle_t TaskHandle_Joystick = NULL;
+
+static joystick_repeat_config_t joystick_repeat = {
+    .delay_ms = JOYSTICK_REPEAT_DELAY_MS,
+    .period_ms = JOYSTICK_REPEAT_PERIOD_MS,
+    .min_period_ms = JOYSTICK_REPEAT_MIN_MS,
+    .accel_percent = JOYSTICK_REPEAT_ACCEL_PERCENT};
+static uint32_t joystick_events_dropped = 0;
+
+/**
+ * @brief
+ * Classifies one axis with hysteresis.  An axis enters a direction at its
+ * threshold and only leaves it once the value is JOYSTICK_HYSTERESIS back
+ * toward center, so noise near a threshold does not chatter.
+ * @param state
+ * Current direction, 1 when above high, -1 when below low
+ * @param value
+ * @param high
+ * @param low
+ * @return int8_t
+ */
+static int8_t joystick_axis_state(int8_t state, uint16_t value, uint16_t high, uint16_t low)
+{
+    if (state > 0 && value > high - JOYSTICK_HYSTERESIS)
+    {
+        return 1;
+    }
+    if (state < 0 && value < low + JOYSTICK_HYSTERESIS)
+    {
+        return -1;
+    }
+    if (value > high)
+    {
+        return 1;
+    }
+    if (value < low)
+    {
+        return -1;
+    }
+    return 0;
+}
+
 /**
  * @brief
- *  Task used to monitor the joystick
+ * Converts a direction to a position
+ * @param dx
+ * @param dy
+ * @return joystick_position_t
+ */
+static joystick_position_t joystick_pos_from_dir(int8_t dx, int8_t dy)
+{
+    static const joystick_position_t positions[3][3] = {
+        {JOYSTICK_POS_UPPER_LEFT, JOYSTICK_POS_UP, JOYSTICK_POS_UPPER_RIGHT},
+        {JOYSTICK_POS_LEFT, JOYSTICK_POS_CENTER, JOYSTICK_POS_RIGHT},
+        {JOYSTICK_POS_LOWER_LEFT, JOYSTICK_POS_DOWN, JOYSTICK_POS_LOWER_RIGHT}};
+
+    return positions[dy + 1][dx + 1];
+}
+
+/**
+ * @brief
+ * Called from the ADC interrupt after each timer paced scan.  The task is
+ * only woken when the direction changes.
+ * @param x
+ * @param y
+ */
+static void joystick_scan_handler(uint16_t x, uint16_t y)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    // A high X reading is left and a high Y reading is up
+    int8_t dx = -joystick_axis_state(-joystick_scan_dx, x, JOYSTICK_THRESH_X_LEFT, JOYSTICK_THRESH_X_RIGHT);
+    int8_t dy = -joystick_axis_state(-joystick_scan_dy, y, JOYSTICK_THRESH_Y_UP, JOYSTICK_THRESH_Y_DOWN);
+
+    if (dx != joystick_scan_dx || dy != joystick_scan_dy)
+    {
+        joystick_scan_dx = dx;
+        joystick_scan_dy = dy;
+        joystick_scan_changed_at = xTaskGetTickCountFromISR();
+        vTaskNotifyGiveFromISR(TaskHandle_Joystick, &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief
+ * Adds an event to Queue_Joystick without blocking
+ */
+static void joystick_event_send(joystick_event_type_t type, int8_t dx, int8_t dy, uint16_t repeat, TickType_t timestamp)
+{
+    joystick_event_t event = {
+        .type = type,
+        .position = joystick_pos_from_dir(dx, dy),
+        .dx = dx,
+        .dy = dy,
+        .repeat = repeat,
+        .timestamp = timestamp};
+
+    if (xQueueSend(Queue_Joystick, &event, 0) != pdPASS)
+    {
+        joystick_events_dropped++;
+    }
+}
+
+/**
+ * @brief
+ *  Task used to monitor the joystick.  The ADC is scanned by a hardware
+ *  timer at JOYSTICK_SCAN_HZ, so the task sleeps until the direction
+ *  changes or the next auto-repeat is due.  Repeats speed up the longer the
+ *  stick is held, but each one is still a single step.
  * @param arg
  */
 void task_joystick(void *arg)
 {
-    uint16_t x_value, y_value;
-    joystick_position_t current_position;
-    static joystick_position_t previous_position = JOYSTICK_POS_CENTER;
+    joystick_repeat_config_t config = joystick_repeat;
+    joystick_position_t position;
+    int8_t dx, dy;
+    int8_t previous_dx = 0;
+    int8_t previous_dy = 0;
+    TickType_t changed_at;
+    TickType_t next_repeat = 0;
+    TickType_t period = 0;
+    uint16_t repeat = 0;
     (void)arg; // Unused parameter
-    while (1)
-    {
-        vTaskDelay(pdMS_TO_TICKS(10)); // Poll every 10ms for faster response
-        x_value = joystick_read_x();
-        y_value = joystick_read_y();
-
-        float x_volatage = (x_value / 65535.0) * 3.3;
-        float y_volatage = (y_value / 65535.0) * 3.3;
 
-        // printf("X: %f, Y: %f\r\n", x_volatage, y_volatage);
+    TaskHandle_Joystick = xTaskGetCurrentTaskHandle();
+    if (joystick_scan_start(JOYSTICK_SCAN_HZ, INT_PRIORITY_JOYSTICK, joystick_scan_handler) != CY_RSLT_SUCCESS)
+    {
+        task_console_printf("Joystick scan failed to start\r\n");
+        vTaskSuspend(NULL);
+    }
 
-        // Get the current joystick position
-        current_position = joystick_get_pos();
+    while (1)
+    {
+        bool held = (previous_dx != 0 || previous_dy != 0);
+        TickType_t wait = portMAX_DELAY;
+        TickType_t now;
 
-        // Add series of if/else if statements to detect joystick direction
-        if (current_position == JOYSTICK_POS_CENTER)
+        if (held)
         {
-            // printf("Joystick Position: %s\r\n", joystick_pos_names[JOYSTICK_POS_CENTER]);
+            now = xTaskGetTickCount();
+            wait = ((int32_t)(next_repeat - now) > 0) ? next_repeat - now : 0;
         }
-        else if (current_position == JOYSTICK_POS_LEFT)
-        {
-            // printf("Joystick Position: %s\r\n", joystick_pos_names[JOYSTICK_POS_LEFT]);
-        }
-        else if (current_position == JOYSTICK_POS_RIGHT)
-        {
-            // printf("Joystick Position: %s\r\n", joystick_pos_names[JOYSTICK_POS_RIGHT]);
-        }
-        else if (current_position == JOYSTICK_POS_UP)
-        {
-            printf("Joystick Position: %s\r\n", joystick_pos_names[JOYSTICK_POS_UP]);
-        }
-        else if (current_position == JOYSTICK_POS_DOWN)
-        {
-            // printf("Joystick Position: %s\r\n", joystick_pos_names[JOYSTICK_POS_DOWN]);
-        }
-        else if (current_position == JOYSTICK_POS_UPPER_LEFT)
-        {
-            // printf("Joystick Position: %s\r\n", joystick_pos_names[JOYSTICK_POS_UPPER_LEFT]);
-        }
-        else if (current_position == JOYSTICK_POS_UPPER_RIGHT)
-        {
-            // printf("Joystick Position: %s\r\n", joystick_pos_names[JOYSTICK_POS_UPPER_RIGHT]);
-        }
-        else if (current_position == JOYSTICK_POS_LOWER_LEFT)
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        taskENTER_CRITICAL();
+        dx = joystick_scan_dx;
+        dy = joystick_scan_dy;
+        changed_at = joystick_scan_changed_at;
+        taskEXIT_CRITICAL();
+        now = xTaskGetTickCount();
+
+        // Several changes may have happened since the last wake up
+        if (dx != previous_dx || dy != previous_dy)
         {
-            // printf("Joystick Position: %s\r\n", joystick_pos_names[JOYSTICK_POS_LOWER_LEFT]);
+            if (held)
+            {
+                joystick_event_send(JOYSTICK_EVENT_RELEASE, previous_dx, previous_dy, repeat, changed_at);
+            }
+            if (dx != 0 || dy != 0)
+            {
+                taskENTER_CRITICAL();
+                config = joystick_repeat;
+                taskEXIT_CRITICAL();
+
+                joystick_event_send(JOYSTICK_EVENT_PRESS, dx, dy, 0, changed_at);
+                repeat = 0;
+                period = pdMS_TO_TICKS(config.period_ms);
+                next_repeat = changed_at + pdMS_TO_TICKS(config.delay_ms);
+            }
+            previous_dx = dx;
+            previous_dy = dy;
+
+            // Send position to queue for other tasks to use
+            position = joystick_pos_from_dir(dx, dy);
+            xQueueOverwrite(Queue_position, &position);
         }
-        else if (current_position == JOYSTICK_POS_LOWER_RIGHT)
+        else if (held && (int32_t)(now - next_repeat) >= 0)
         {
-            // printf("Joystick Position: %s\r\n", joystick_pos_names[JOYSTICK_POS_LOWER_RIGHT]);
-        }
+            joystick_event_send(JOYSTICK_EVENT_REPEAT, dx, dy, ++repeat, now);
 
-        // If the current position is not equal to the previous position, add the new position to the joystick queue
-        if (current_position != previous_position)
-        {
-            previous_position = current_position;
-            // Send position to queue for other tasks to use
-            xQueueOverwrite(Queue_position, &current_position);
+            // Schedule from now so a late wake up does not cause a burst
+            next_repeat = now + period;
+            period -= (period * config.accel_percent) / 100;
+            if (period < pdMS_TO_TICKS(config.min_period_ms))
+            {
+                period = pdMS_TO_TICKS(config.min_period_ms);
+            }
         }
     }
 }
 
+bool task_joystick_set_repeat(const joystick_repeat_config_t *config)
+{
+    if (config == NULL || config->min_period_ms == 0 || config->min_period_ms > config->period_ms || config->accel_percent > 90)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    joystick_repeat = *config;
+    taskEXIT_CRITICAL();
+
+    return true;
+}
+
+uint32_t task_joystick_get_dropped(void)
+{
+    return joystick_events_dropped;
+}
+
 bool task_joystick_init(void)
 {
     /* Create the Queue used to send Joystick Positions*/
@@ -112,6 +255,13 @@ bool task_joystick_init(void)
         return false;
     }
 
+    /* Create the Queue used to send joystick events */
+    Queue_Joystick = xQueueCreate(JOYSTICK_EVENT_QUEUE_LENGTH, sizeof(joystick_event_t));
+    if (Queue_Joystick == NULL)
+    {
+        return false;
+    }
+
     /* Create the joystick task */
     xTaskCreate(task_joystick, "Joystick Task", 5 * configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
     return true;
@@ -16,10 +16,63 @@
 #include <complex.h>
 
 #ifdef ECE353_FREERTOS
+#define JOYSTICK_SCAN_HZ 100       // Rate both ADC channels are sampled at
+#define INT_PRIORITY_JOYSTICK 6
+
+#define JOYSTICK_HYSTERESIS 0x1000        // An axis releases this far inside its threshold
+#define JOYSTICK_EVENT_QUEUE_LENGTH 16
+#define JOYSTICK_REPEAT_DELAY_MS 400      // Hold time before the first repeat
+#define JOYSTICK_REPEAT_PERIOD_MS 150     // Time between the first repeats
+#define JOYSTICK_REPEAT_MIN_MS 50         // Fastest repeat reached by a long hold
+#define JOYSTICK_REPEAT_ACCEL_PERCENT 15  // Repeat period shrinks by this much per repeat
+
+typedef enum
+{
+    JOYSTICK_EVENT_PRESS,   // Stick moved into position
+    JOYSTICK_EVENT_REPEAT,  // Stick still held in position
+    JOYSTICK_EVENT_RELEASE  // Stick left position
+} joystick_event_type_t;
+
+// Sent on Queue_Joystick.  Each press or repeat is a single step of dx, dy.
+typedef struct
+{
+    joystick_event_type_t type;
+    joystick_position_t position;
+    int8_t dx;            // -1 left, 1 right
+    int8_t dy;            // -1 up, 1 down
+    uint16_t repeat;      // Repeats since the press
+    TickType_t timestamp; // Tick count when the event happened
+} joystick_event_t;
+
+// Auto-repeat settings
+typedef struct
+{
+    uint16_t delay_ms;
+    uint16_t period_ms;
+    uint16_t min_period_ms;
+    uint8_t accel_percent;
+} joystick_repeat_config_t;
+
 extern QueueHandle_t Queue_Joystick;
 
 void task_joystick(void *arg);
 
+/**
+ * @brief
+ * Changes the auto-repeat settings.  Takes effect on the next press.
+ * @param config
+ * @return true
+ * @return false if the settings are out of range
+ */
+bool task_joystick_set_repeat(const joystick_repeat_config_t *config);
+
+/**
+ * @brief
+ * Returns the number of events dropped because Queue_Joystick was full
+ * @return uint32_t
+ */
+uint32_t task_joystick_get_dropped(void);
+
 bool task_joystick_init(void);
 
 #endif
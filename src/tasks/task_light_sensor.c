@@ -13,8 +13,10 @@
 #if defined(ECE353_FREERTOS)
 #include "drivers.h"
 #include "task_light_sensor.h"
+#include "task_i2c.h"
 #include "task_console.h"
 #include "devices.h"
+#include "device_manager.h"
 
 #define TASK_LIGHT_SENSOR_STACK_SIZE (configMINIMAL_STACK_SIZE)
 #define TASK_LIGHT_SENSOR_PRIORITY (tskIDLE_PRIORITY + 1)
@@ -40,21 +42,6 @@ QueueHandle_t Queue_Light_Sensor_Requests;
 /******************************************************************************/
 /* Static Function Definitions                                                */
 /******************************************************************************/
-/**
- * @brief
- * Set ALS MODE to Active and initiate a software reset
- */
-static void ltr_light_sensor_start(void)
-{
-    cy_rslt_t rslt;
-
-    rslt = i2c_write_u8(I2C_Obj, LTR_SUBORDINATE_ADDR, LTR_REG_CONTR, LTR_REG_CONTR_ALS_MODE); // 1,2,3 byte in order
-    if (rslt != CY_RSLT_SUCCESS)
-    {
-        task_console_printf("LTR329ALS-01: Failed to write to CONTR register\r\n");
-    }
-}
-
 static uint8_t ltr_light_get_contr(void)
 {
     uint8_t value = 0;
@@ -105,85 +92,73 @@ static uint8_t ltr_light_sensor_part_id(void)
     return value;
 }
 
-static uint8_t ltr_light_sensor_manufac_id(void)
-{
-    uint8_t value = 0;
-    cy_rslt_t rslt;
-
-    rslt = i2c_read_u8(I2C_Obj, LTR_SUBORDINATE_ADDR, LTR_REG_MANUFAC_ID, (uint16_t *)&value);
-    if (rslt != CY_RSLT_SUCCESS)
-    {
-        task_console_printf("LTR329ALS-01: Failed to read MANUFAC ID register\r\n");
-        return value;
-    }
-
-    return value;
-}
-
-static uint16_t ltr_light_sensor_get_ch0(void)
+/**
+ * @brief
+ * Reads both ALS channels and the status register in a single burst.
+ * CH1_0 through ALS_STATUS are consecutive, and the datasheet requires
+ * CH1 to be read before CH0 so both channels come from the same
+ * measurement.  One address phase replaces the four separate register
+ * reads used before.
+ * @param ch1
+ * @param ch0
+ * @return true
+ * @return false
+ */
+static bool ltr_light_sensor_get_readings(uint16_t *ch1, uint16_t *ch0)
 {
-    uint8_t msbyte;
-    uint8_t lsbyte;
-    uint16_t value = 0;
+    uint8_t data[5]; // CH1_0, CH1_1, CH0_0, CH0_1, STATUS
+    i2c_txn_t txn = {
+        .subordinate_address = LTR_SUBORDINATE_ADDR,
+        .reg = LTR_REG_ALS_DATA_CH1_0,
+        .data = data,
+        .length = sizeof(data),
+        .write = false,
+        .priority = I2C_ASYNC_PRIORITY_LOW, // Background sampling
+    };
     cy_rslt_t rslt;
 
-    rslt = i2c_read_u8(I2C_Obj, LTR_SUBORDINATE_ADDR, LTR_REG_ALS_DATA_CH0_0, &lsbyte);
+    // The I2C task holds the bus, this task sleeps until the burst completes
+    rslt = i2c_async_transfer(&txn);
     if (rslt != CY_RSLT_SUCCESS)
     {
-        task_console_printf("LTR329ALS-01: Failed to read CH0 LSByte register\r\n");
-        return value;
-    }
-    rslt = i2c_read_u8(I2C_Obj, LTR_SUBORDINATE_ADDR, LTR_REG_ALS_DATA_CH0_1, &msbyte);
-    if (rslt != CY_RSLT_SUCCESS)
-    {
-        task_console_printf("LTR329ALS-01: Failed to read CH0 MSByte register\r\n");
-        return value;
+        task_console_printf("LTR329ALS-01: Failed to read ALS data\r\n");
+        return false;
     }
 
-    value = (msbyte << 8) | lsbyte;
+    *ch1 = (data[1] << 8) | data[0];
+    *ch0 = (data[3] << 8) | data[2];
 
-    return value;
+    return true;
 }
 
-static uint16_t ltr_light_sensor_get_ch1(void)
+/**
+ * @brief
+ * Sets ALS MODE to Active and reads the manufacturer ID, back to back
+ * under a single hold of the I2C semaphore
+ * @return uint8_t
+ * The manufacturer ID, 0 if the bus transfer failed
+ */
+static uint8_t ltr_light_sensor_init(void)
 {
-    uint8_t msbyte;
-    uint8_t lsbyte;
-    uint16_t value = 0;
+    uint8_t contr = LTR_REG_CONTR_ALS_MODE;
+    uint8_t ids[2] = {0}; // PART_ID, MANUFAC_ID
+    const i2c_burst_t list[] = {
+        {LTR_SUBORDINATE_ADDR, LTR_REG_CONTR, &contr, 1, true},
+        {LTR_SUBORDINATE_ADDR, LTR_REG_PART_ID, ids, 2, false},
+    };
     cy_rslt_t rslt;
 
-    rslt = i2c_read_u8(I2C_Obj, LTR_SUBORDINATE_ADDR, LTR_REG_ALS_DATA_CH1_0, &lsbyte);
-    if (rslt != CY_RSLT_SUCCESS)
-    {
-        task_console_printf("LTR329ALS-01: Failed to read CH1 LSByte register\r\n");
-        return value;
-    }
+    xSemaphoreTake(*I2C_Semaphore, portMAX_DELAY);
+    rslt = i2c_burst_list(I2C_Obj, list, sizeof(list) / sizeof(list[0]));
+    xSemaphoreGive(*I2C_Semaphore);
 
-    rslt = i2c_read_u8(I2C_Obj, LTR_SUBORDINATE_ADDR, LTR_REG_ALS_DATA_CH1_1, &msbyte);
     if (rslt != CY_RSLT_SUCCESS)
     {
-        task_console_printf("LTR329ALS-01: Failed to read CH1 MSByte register\r\n");
-        return value;
+        task_console_printf("LTR329ALS-01: Failed to start sensor\r\n");
+        return 0;
     }
 
-    value = (msbyte << 8) | lsbyte;
-
-    return value;
-}
-
-static void ltr_light_sensor_get_readings(uint16_t *ch1, uint16_t *ch0)
-{
-    uint8_t status = 0;
-
-    status = ltr_light_sensor_status();
-    while ((status & LTR_REG_STATUS_NEW_DATA) != LTR_REG_STATUS_NEW_DATA)
-    {
-        // Wait
-        status = ltr_light_sensor_status();
-    }
-
-    *ch1 = ltr_light_sensor_get_ch1();
-    *ch0 = ltr_light_sensor_get_ch0();
+    return ids[1];
 }
 
 /******************************************************************************/
@@ -210,10 +185,11 @@ bool system_sensors_get_light(QueueHandle_t return_queue, uint16_t *ambient_ligh
     request_packet.operation = DEVICE_OP_READ;
     request_packet.response_queue = return_queue;
 
-    // send the request to the light sensor task
-    xQueueSend(Queue_Light_Sensor_Requests, &request_packet, portMAX_DELAY);
-
-    xQueueReceive(return_queue, &response_packet, pdMS_TO_TICKS(100));
+    // send the request to the light sensor task and wait for the response
+    if (!device_request(&request_packet, &response_packet, pdMS_TO_TICKS(100)))
+    {
+        return false;
+    }
 
     // return the ambient light value via the data pointer
     *ambient_light = response_packet.payload.light_sensor;
@@ -243,7 +219,7 @@ void task_light_sensor(void *param)
 
     task_console_printf("Starting Light Sensor Task\r\n");
 
-    uint8_t manufac_id = ltr_light_sensor_manufac_id();
+    uint8_t manufac_id = ltr_light_sensor_init();
     if (manufac_id != 0x05)
     {
         task_console_printf("Light Sensor Manufacturer ID Invalid: 0x%02X\r\n", manufac_id);
@@ -254,12 +230,6 @@ void task_light_sensor(void *param)
         task_console_printf("Light Sensor Manufacturer ID Valid: 0x%02X\r\n", manufac_id);
     }
 
-    // grab the semaphore to access the bus
-    xSemaphoreTake(*I2C_Semaphore, portMAX_DELAY);
-    ltr_light_sensor_start();
-    // release the semaphore after accessing the bus
-    xSemaphoreGive(*I2C_Semaphore);
-
     while (1)
     {
         device_request_msg_t request_packet;
@@ -269,21 +239,18 @@ void task_light_sensor(void *param)
         {
             if (request_packet.operation == DEVICE_OP_READ)
             {
-                // grab the semaphore for the I2C bus
-                xSemaphoreTake(*I2C_Semaphore, portMAX_DELAY);
+                uint16_t ch1 = 0;
+                uint16_t ch0 = 0;
+                bool read_ok;
+
+                read_ok = ltr_light_sensor_get_readings(&ch1, &ch0);
 
                 // prepare the response packet
                 response_packet.device = DEVICE_LIGHT;
-                response_packet.status = DEVICE_OPERATION_STATUS_READ_SUCCESS;
-                response_packet.payload.light_sensor = ltr_light_sensor_get_ch0(); // Return channel 0 as ambient light
-
-                // release the semaphore for the I2C bus
-                xSemaphoreGive(*I2C_Semaphore);
+                response_packet.status = read_ok ? DEVICE_OPERATION_STATUS_READ_SUCCESS : DEVICE_OPERATION_STATUS_READ_FAILURE;
+                response_packet.payload.light_sensor = ch0; // Return channel 0 as ambient light
                 // send the response back if a return queue is provided
-                if (request_packet.response_queue != NULL)
-                {
-                    xQueueSend(request_packet.response_queue, &response_packet, portMAX_DELAY);
-                }
+                device_respond(&request_packet, &response_packet);
             }
         }
     }
@@ -309,7 +276,7 @@ bool task_light_sensor_resources_init(cyhal_i2c_t *i2c_obj, SemaphoreHandle_t *i
 
     /* Create the Queue used to receive requests from other tasks */
     Queue_Light_Sensor_Requests = xQueueCreate(1, sizeof(device_request_msg_t));
-    if (Queue_Light_Sensor_Requests == NULL)
+    if (!device_manager_register(DEVICE_LIGHT, Queue_Light_Sensor_Requests))
     {
         return false;
     }
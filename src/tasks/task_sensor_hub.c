@@ -0,0 +1,336 @@
+/**
+ * @file task_sensor_hub.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Periodic sampling of the board sensors into a lock-free cache
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "task_sensor_hub.h"
+#include "task_light_sensor.h"
+#include "task_temp_sensor.h"
+#include "task_imu.h"
+#include "device_manager.h"
+#include "sensor_log.h"
+
+/**
+ * @brief
+ * The sensor hub is the only task that issues periodic sensor requests.
+ * Each sensor is sampled at its configured period and the result is
+ * published to a cache that any task can read without blocking, so
+ * game code never waits on the I2C/SPI gatekeeper tasks.
+ *
+ * Each cache entry holds two slots and a sequence number.  The hub writes
+ * the slot that is not currently published and then increments the
+ * sequence, which publishes it.  A reader copies the published slot and
+ * retries only if the sequence changed during the copy.  A reader that
+ * preempts the hub mid-write reads the other slot, so it never waits on
+ * the hub.
+ *
+ * Subscriptions compare each new sample against a threshold and set event
+ * bits only when the value crosses it.  Every sample is also added to the
+ * sensor's history in sensor_log.c.
+ */
+
+typedef struct
+{
+    volatile uint32_t sequence;
+    sensor_hub_reading_t slot[2];
+} sensor_hub_entry_t;
+
+typedef struct
+{
+    sensor_hub_sensor_t sensor;
+    uint8_t channel;
+    int32_t threshold;
+    int32_t hysteresis;
+    EventGroupHandle_t events;
+    EventBits_t bits;
+    volatile bool above;
+} sensor_hub_subscription_t;
+
+/* Global Variables */
+static sensor_hub_config_t Sensor_Hub_Config;
+static sensor_hub_entry_t Sensor_Hub_Cache[SENSOR_HUB_COUNT];
+static sensor_hub_subscription_t Sensor_Hub_Subs[SENSOR_HUB_MAX_SUBSCRIPTIONS];
+static uint8_t Sensor_Hub_Sub_Count = 0;
+
+/**
+ * @brief
+ * Publishes a new reading to the cache.  Only called by the hub task.
+ * @param sensor
+ * @param value
+ */
+static void sensor_hub_publish(sensor_hub_sensor_t sensor, const int32_t value[3])
+{
+    sensor_hub_entry_t *entry = &Sensor_Hub_Cache[sensor];
+    uint32_t sequence = entry->sequence + 1;
+    sensor_hub_reading_t *slot = &entry->slot[sequence & 1];
+
+    slot->value[0] = value[0];
+    slot->value[1] = value[1];
+    slot->value[2] = value[2];
+    slot->timestamp = xTaskGetTickCount();
+    slot->sequence = sequence;
+
+    // The slot must be complete before the new sequence makes it visible
+    __DMB();
+    entry->sequence = sequence;
+}
+
+/**
+ * @brief
+ * Checks the subscriptions of a sensor against its newest value
+ * @param sensor
+ * @param value
+ */
+static void sensor_hub_notify(sensor_hub_sensor_t sensor, const int32_t value[3])
+{
+    for (uint8_t i = 0; i < Sensor_Hub_Sub_Count; i++)
+    {
+        sensor_hub_subscription_t *sub = &Sensor_Hub_Subs[i];
+        bool above = sub->above;
+
+        if (sub->sensor != sensor)
+        {
+            continue;
+        }
+
+        if (!above && value[sub->channel] > sub->threshold)
+        {
+            above = true;
+        }
+        else if (above && value[sub->channel] < sub->threshold - sub->hysteresis)
+        {
+            above = false;
+        }
+
+        if (above != sub->above)
+        {
+            sub->above = above;
+            if (sub->events != NULL)
+            {
+                xEventGroupSetBits(sub->events, sub->bits);
+            }
+        }
+    }
+}
+
+/**
+ * @brief
+ * Reads one sensor through its gatekeeper task
+ * @param sensor
+ * @param value
+ * @return true
+ * @return false
+ */
+static bool sensor_hub_sample(sensor_hub_sensor_t sensor, int32_t value[3])
+{
+    uint16_t light = 0;
+    uint16_t imu[3] = {0};
+    imu_sample_t sample;
+
+    switch (sensor)
+    {
+    case SENSOR_HUB_LIGHT:
+        if (!system_sensors_get_light(device_mailbox(), &light))
+        {
+            return false;
+        }
+        value[0] = light;
+        return true;
+
+    case SENSOR_HUB_TEMP:
+        // The temp sensor task samples on its own schedule, read its cache
+        return temp_sensor_get_cached(&value[0]);
+
+    case SENSOR_HUB_IMU:
+        // Use the FIFO stream when it is running so the bus is not touched
+        if (imu_stream_latest(&sample) != 0)
+        {
+            value[0] = sample.x;
+            value[1] = sample.y;
+            value[2] = sample.z;
+            return true;
+        }
+        if (!system_sensors_imu_read(device_mailbox(), imu))
+        {
+            return false;
+        }
+        value[0] = (int16_t)imu[0];
+        value[1] = (int16_t)imu[1];
+        value[2] = (int16_t)imu[2];
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief
+ * Samples every enabled sensor when its period expires
+ * @param param
+ * Unused
+ */
+static void task_sensor_hub(void *param)
+{
+    (void)param;
+    TickType_t next_sample[SENSOR_HUB_COUNT];
+    TickType_t now = xTaskGetTickCount();
+    int32_t value[3];
+
+    for (int i = 0; i < SENSOR_HUB_COUNT; i++)
+    {
+        next_sample[i] = now;
+    }
+
+    while (1)
+    {
+        TickType_t delay = portMAX_DELAY;
+
+        now = xTaskGetTickCount();
+        for (int i = 0; i < SENSOR_HUB_COUNT; i++)
+        {
+            TickType_t period = pdMS_TO_TICKS(Sensor_Hub_Config.period_ms[i]);
+            TickType_t wait;
+
+            if (period == 0)
+            {
+                continue;
+            }
+
+            if ((int32_t)(now - next_sample[i]) >= 0)
+            {
+                value[0] = value[1] = value[2] = 0;
+                if (sensor_hub_sample((sensor_hub_sensor_t)i, value))
+                {
+                    sensor_hub_publish((sensor_hub_sensor_t)i, value);
+                    sensor_hub_notify((sensor_hub_sensor_t)i, value);
+                    sensor_log_record((sensor_hub_sensor_t)i, value, period);
+                }
+
+                // Skip missed periods rather than sampling back to back
+                next_sample[i] += period;
+                now = xTaskGetTickCount();
+                if ((int32_t)(now - next_sample[i]) >= 0)
+                {
+                    next_sample[i] = now + period;
+                }
+            }
+
+            wait = next_sample[i] - now;
+            if (wait < delay)
+            {
+                delay = wait;
+            }
+        }
+
+        vTaskDelay((delay == 0) ? 1 : delay);
+    }
+}
+
+bool sensor_hub_get(sensor_hub_sensor_t sensor, sensor_hub_reading_t *reading)
+{
+    sensor_hub_entry_t *entry;
+    uint32_t sequence;
+
+    if (sensor >= SENSOR_HUB_COUNT || reading == NULL)
+    {
+        return false;
+    }
+
+    entry = &Sensor_Hub_Cache[sensor];
+    do
+    {
+        sequence = entry->sequence;
+        __DMB();
+        *reading = entry->slot[sequence & 1];
+        __DMB();
+    } while (sequence != entry->sequence);
+
+    return (sequence != 0);
+}
+
+bool sensor_hub_subscribe(
+    sensor_hub_sensor_t sensor,
+    uint8_t channel,
+    int32_t threshold,
+    int32_t hysteresis,
+    EventGroupHandle_t events,
+    EventBits_t bits,
+    uint8_t *id)
+{
+    sensor_hub_subscription_t *sub;
+
+    if (sensor >= SENSOR_HUB_COUNT || channel >= 3 || hysteresis < 0 || id == NULL ||
+        Sensor_Hub_Sub_Count >= SENSOR_HUB_MAX_SUBSCRIPTIONS)
+    {
+        return false;
+    }
+
+    sub = &Sensor_Hub_Subs[Sensor_Hub_Sub_Count];
+    sub->sensor = sensor;
+    sub->channel = channel;
+    sub->threshold = threshold;
+    sub->hysteresis = hysteresis;
+    sub->events = events;
+    sub->bits = bits;
+    sub->above = false;
+
+    *id = Sensor_Hub_Sub_Count++;
+    return true;
+}
+
+bool sensor_hub_is_above(uint8_t id)
+{
+    if (id >= Sensor_Hub_Sub_Count)
+    {
+        return false;
+    }
+
+    return Sensor_Hub_Subs[id].above;
+}
+
+/**
+ * @brief
+ * Initializes the resources used by the sensor hub.  The gatekeeper tasks
+ * of every enabled sensor must also be initialized.
+ * @param config
+ * @return true
+ * @return false
+ */
+bool task_sensor_hub_resources_init(const sensor_hub_config_t *config)
+{
+    if (config == NULL)
+    {
+        return false;
+    }
+
+    Sensor_Hub_Config = *config;
+
+    if (!sensor_log_init())
+    {
+        return false;
+    }
+
+    if (xTaskCreate(
+            task_sensor_hub,
+            "Sensor Hub",
+            TASK_SENSOR_HUB_STACK_SIZE,
+            NULL,
+            TASK_SENSOR_HUB_PRIORITY,
+            NULL) != pdPASS)
+    {
+        return false;
+    }
+
+    return true;
+}
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file task_sensor_hub.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Periodic sampling of the board sensors into a lock-free cache
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __TASK_SENSOR_HUB_H__
+#define __TASK_SENSOR_HUB_H__
+
+#include "main.h"
+
+#ifdef ECE353_FREERTOS
+#include "devices.h"
+
+#define TASK_SENSOR_HUB_PRIORITY (tskIDLE_PRIORITY + 1)
+#define TASK_SENSOR_HUB_STACK_SIZE (configMINIMAL_STACK_SIZE * 2)
+
+#define SENSOR_HUB_MAX_SUBSCRIPTIONS 8
+
+typedef enum
+{
+    SENSOR_HUB_LIGHT = 0, // value[0] = ALS channel 0 counts
+    SENSOR_HUB_TEMP,      // value[0] = temperature in hundredths of a degree C
+    SENSOR_HUB_IMU,       // value[0..2] = accelerometer X, Y, Z
+    SENSOR_HUB_COUNT
+} sensor_hub_sensor_t;
+
+// Sampling period of each sensor in ms, 0 disables the sensor
+typedef struct
+{
+    uint16_t period_ms[SENSOR_HUB_COUNT];
+} sensor_hub_config_t;
+
+typedef struct
+{
+    int32_t value[3];
+    TickType_t timestamp; // Tick count when the sample was taken
+    uint32_t sequence;    // Incremented on every publish, 0 = never sampled
+} sensor_hub_reading_t;
+
+/**
+ * @brief
+ * Returns the newest reading of a sensor without blocking.  Safe to call
+ * from any task.
+ * @param sensor
+ * @param reading
+ * @return true
+ * @return false if the sensor has not been sampled yet
+ */
+bool sensor_hub_get(sensor_hub_sensor_t sensor, sensor_hub_reading_t *reading);
+
+/**
+ * @brief
+ * Registers a threshold on one value of a sensor.  The subscription is
+ * above once the value exceeds threshold and below once it drops under
+ * threshold - hysteresis.  bits are set in events on every crossing.
+ * Must be called before the scheduler starts.
+ * @param sensor
+ * @param channel Index into sensor_hub_reading_t.value
+ * @param threshold
+ * @param hysteresis
+ * @param events Event group to notify, may be NULL
+ * @param bits
+ * @param id Returns the subscription id
+ * @return true
+ * @return false if the arguments are invalid or the table is full
+ */
+bool sensor_hub_subscribe(
+    sensor_hub_sensor_t sensor,
+    uint8_t channel,
+    int32_t threshold,
+    int32_t hysteresis,
+    EventGroupHandle_t events,
+    EventBits_t bits,
+    uint8_t *id);
+
+/**
+ * @brief
+ * Returns true if the subscribed value is currently above its threshold
+ * @param id
+ * @return true
+ * @return false
+ */
+bool sensor_hub_is_above(uint8_t id);
+
+bool task_sensor_hub_resources_init(const sensor_hub_config_t *config);
+
+#endif
+#endif
@@ -15,13 +15,30 @@
 #include "drivers.h"
 #include "task_temp_sensor.h"
 #include "task_console.h"
+#include "task_i2c.h"
+#include "device_manager.h"
 
 #define TASK_TEMP_SENSOR_STACK_SIZE (configMINIMAL_STACK_SIZE)
 #define TASK_TEMP_SENSOR_PRIORITY (tskIDLE_PRIORITY + 1)
 
-/******************************************************************************/
-/* Function Declarations                                                      */
-/******************************************************************************/
+/**
+ * @brief
+ * The task reads the LM75 every sample_ms and sums the raw register
+ * values, 1/256 degree C per count.  After oversample reads the sum is
+ * decimated to hundredths of a degree in integer math and published to a
+ * cache.  Requests are answered from the cache, so I2C traffic follows the
+ * sampling schedule no matter how many readers there are.  Averaging
+ * reads of the 0.5 degree part also smooths the value between steps.
+ */
+
+typedef struct
+{
+	int32_t delta;
+	EventGroupHandle_t events;
+	EventBits_t bits;
+	int32_t reported;
+	bool valid;
+} temp_sensor_subscriber_t;
 
 /******************************************************************************/
 /* Global Variables                                                           */
@@ -35,55 +52,101 @@ static SemaphoreHandle_t *I2C_Semaphore = NULL;
 /* Queue used to send commands used to temp sensor */
 QueueHandle_t Queue_Temp_Sensor_Requests;
 
+static volatile uint16_t Temp_Sensor_Sample_Ms = TEMP_SENSOR_SAMPLE_MS;
+static volatile uint8_t Temp_Sensor_Oversample = TEMP_SENSOR_OVERSAMPLE;
+
+/* Newest published temperature, hundredths of a degree C */
+static volatile int32_t Temp_Sensor_Value;
+static volatile bool Temp_Sensor_Valid = false;
+
+static temp_sensor_subscriber_t Temp_Sensor_Subscribers[TEMP_SENSOR_MAX_SUBSCRIBERS];
+static uint8_t Temp_Sensor_Subscriber_Count = 0;
+static temp_sensor_stats_t Temp_Sensor_Stats;
+
 /******************************************************************************/
 /* Static Function Definitions                                                */
 /******************************************************************************/
 
-/** Read the value of the input port
+/** Reads the raw temperature register
  *
- * @param reg The reg address to read
+ * @param raw Signed temperature, 1/256 degree C per count
  *
  */
-static float LM75_get_temp(void)
+static bool LM75_get_raw(int16_t *raw)
 {
-	float temp = 0.0f;
-	uint16_t raw_value = 0;
-	cy_rslt_t rslt;
-
-	// read two bytes from the temperature register
-	rslt = i2c_read_u16(I2C_Obj, LM75_SUBORDINATE_ADDR, LM75_TEMP_REG, (uint16_t *)&raw_value);
-	if (rslt != CY_RSLT_SUCCESS)
+	uint8_t data[2];
+	i2c_txn_t txn = {
+		.subordinate_address = LM75_SUBORDINATE_ADDR,
+		.reg = LM75_TEMP_REG,
+		.data = data,
+		.length = 2,
+		.write = false,
+		.priority = I2C_ASYNC_PRIORITY_LOW,
+	};
+
+	Temp_Sensor_Stats.i2c_reads++;
+	if (i2c_async_transfer(&txn) != CY_RSLT_SUCCESS)
 	{
-		printf("LM75: Failed to read temperature register\r\n");
-		return temp;
+		Temp_Sensor_Stats.read_errors++;
+		return false;
 	}
-	// need to format the raw value into a temperature
-	// the temperature is a 9-bit two's complement value
-	temp = (float)(raw_value >> 7); // shift off the unused bits
-
-	// convert raw value to celsius
-	// each bit is 0.5 degrees celsius
-	temp *= 0.5f;
 
-	return temp;
+	// The temperature is left justified two's complement, unused bits read 0
+	*raw = (int16_t)(((uint16_t)data[0] << 8) | data[1]);
+	return true;
 }
 
 static uint8_t LM75_get_product_id(void)
 {
 	uint8_t prod_id = 0;
+	i2c_txn_t txn = {
+		.subordinate_address = LM75_SUBORDINATE_ADDR,
+		.reg = LM75_PRODUCT_ID,
+		.data = &prod_id,
+		.length = 1,
+		.write = false,
+		.priority = I2C_ASYNC_PRIORITY_LOW,
+	};
 	cy_rslt_t rslt;
 	// read the product ID register
-	rslt = i2c_read_u8(I2C_Obj, LM75_SUBORDINATE_ADDR, LM75_PRODUCT_ID, &prod_id);
+	rslt = i2c_async_transfer(&txn);
 
 	if (rslt != CY_RSLT_SUCCESS)
 	{
-		printf("LM75: Failed to read product ID register\r\n");
+		task_console_printf("LM75: Failed to read product ID register\r\n");
 		return 0;
 	}
 
 	return prod_id;
 }
 
+/**
+ * @brief
+ * Publishes a decimated value and notifies the subscribers it moved more
+ * than their delta away from
+ * @param value
+ */
+static void temp_sensor_publish(int32_t value)
+{
+	Temp_Sensor_Value = value;
+	Temp_Sensor_Valid = true;
+	Temp_Sensor_Stats.published++;
+
+	for (uint8_t i = 0; i < Temp_Sensor_Subscriber_Count; i++)
+	{
+		temp_sensor_subscriber_t *sub = &Temp_Sensor_Subscribers[i];
+		int32_t moved = value - sub->reported;
+
+		if (!sub->valid || moved > sub->delta || moved < -sub->delta)
+		{
+			sub->reported = value;
+			sub->valid = true;
+			xEventGroupSetBits(sub->events, sub->bits);
+			Temp_Sensor_Stats.notifications++;
+		}
+	}
+}
+
 /******************************************************************************/
 /* Public Function Definitions                                                */
 /******************************************************************************/
@@ -108,28 +171,76 @@ bool system_sensors_get_temp(QueueHandle_t return_queue, float *temperature)
 	request_packet.operation = DEVICE_OP_READ;
 	request_packet.response_queue = return_queue;
 
-	// send the request to the temp sensor task
-	xQueueSend(Queue_Temp_Sensor_Requests, &request_packet, portMAX_DELAY);
-
-	// wait for the response from the temp sensor task
-	xQueueReceive(return_queue, &response_packet, pdMS_TO_TICKS(100));
+	// send the request to the temp sensor task and wait for the response
+	if (!device_request(&request_packet, &response_packet, pdMS_TO_TICKS(100)))
+	{
+		return false;
+	}
 
 	// return the temperature value via the data pointer
 	*temperature = response_packet.payload.temperature;
 
-	if (response_packet.status == DEVICE_OPERATION_STATUS_READ_SUCCESS)
+	return (response_packet.status == DEVICE_OPERATION_STATUS_READ_SUCCESS);
+}
+
+bool temp_sensor_get_cached(int32_t *centi_celsius)
+{
+	if (centi_celsius == NULL || !Temp_Sensor_Valid)
 	{
-		return true;
+		return false;
 	}
-	else
+
+	*centi_celsius = Temp_Sensor_Value;
+	return true;
+}
+
+bool temp_sensor_configure(uint16_t sample_ms, uint8_t oversample)
+{
+	if (sample_ms == 0 || oversample == 0 || oversample > TEMP_SENSOR_OVERSAMPLE_MAX)
 	{
 		return false;
 	}
+
+	taskENTER_CRITICAL();
+	Temp_Sensor_Sample_Ms = sample_ms;
+	Temp_Sensor_Oversample = oversample;
+	taskEXIT_CRITICAL();
+
+	return true;
+}
+
+bool temp_sensor_subscribe(int32_t delta_centi, EventGroupHandle_t events, EventBits_t bits)
+{
+	temp_sensor_subscriber_t *sub;
+
+	if (events == NULL || delta_centi < 0 || Temp_Sensor_Subscriber_Count >= TEMP_SENSOR_MAX_SUBSCRIBERS)
+	{
+		return false;
+	}
+
+	sub = &Temp_Sensor_Subscribers[Temp_Sensor_Subscriber_Count++];
+	sub->delta = delta_centi;
+	sub->events = events;
+	sub->bits = bits;
+	sub->valid = false;
+
+	return true;
+}
+
+bool temp_sensor_get_stats(temp_sensor_stats_t *stats)
+{
+	if (stats == NULL)
+	{
+		return false;
+	}
+
+	*stats = Temp_Sensor_Stats;
+	return true;
 }
 
 /**
  * @brief
- * Task used to monitor the reception of command packets sent the temp sensor
+ * Task used to sample the temp sensor and answer requests from the cache
  * @param param
  * Unused
  */
@@ -137,43 +248,63 @@ void task_temp_sensor(void *param)
 {
 	device_request_msg_t request_packet;
 	device_response_msg_t response_packet;
+	TickType_t next_sample;
+	int32_t sum = 0;
+	uint8_t count = 0;
+	int16_t raw;
 
-	printf("Starting Temp Sensor Task\r\n");
-
-	// Take the I2C semaphore to configure the temp sensor
-	xSemaphoreTake(*I2C_Semaphore, portMAX_DELAY);
+	task_console_printf("Starting Temp Sensor Task\r\n");
 
 	// Verify that the temp sensor is connected by reading the product ID
 	uint8_t prod_id = LM75_get_product_id();
-	// give the semaphore back
-	xSemaphoreGive(*I2C_Semaphore);
+	if (prod_id != LM75_PRODUCT_ID)
+	{
+		task_console_printf("LM75 Product ID Invalid: 0x%02X\r\n", prod_id);
+	}
 
+	next_sample = xTaskGetTickCount();
 	while (1)
 	{
-		// Wait for a request from EX13
-		temp_sensor_packet_t legacy_request;
-		if (xQueueReceive(Queue_Temp_Sensor_Requests, &legacy_request, portMAX_DELAY) == pdTRUE)
+		TickType_t now = xTaskGetTickCount();
+		TickType_t wait = ((int32_t)(next_sample - now) > 0) ? next_sample - now : 0;
+
+		if (xQueueReceive(Queue_Temp_Sensor_Requests, &request_packet, wait) == pdTRUE)
 		{
-			if (legacy_request.operation == TEMP_SENSOR_READ)
+			if (request_packet.operation == DEVICE_OP_READ && request_packet.response_queue != NULL)
 			{
-				// grab the semaphore for the I2C bus
-				xSemaphoreTake(*I2C_Semaphore, portMAX_DELAY);
-
-				// Read temperature from sensor
-				float temperature = LM75_get_temp();
-
-				// release the semaphore for the I2C bus
-				xSemaphoreGive(*I2C_Semaphore);
-
-				// Send response back to EX13
-				legacy_request.operation = TEMP_SENSOR_RESPONSE;
-				legacy_request.value = temperature;
-				
-				if (legacy_request.return_queue != NULL)
-				{
-					xQueueSend(legacy_request.return_queue, &legacy_request, portMAX_DELAY);
-				}
+				bool valid = Temp_Sensor_Valid;
+
+				Temp_Sensor_Stats.requests++;
+				response_packet.device = DEVICE_TEMPERATURE;
+				response_packet.status = valid ? DEVICE_OPERATION_STATUS_READ_SUCCESS : DEVICE_OPERATION_STATUS_READ_FAILURE;
+				response_packet.payload.temperature = valid ? Temp_Sensor_Value / 100.0f : 0.0f;
+				device_respond(&request_packet, &response_packet);
 			}
+			continue;
+		}
+
+		// Skip missed periods rather than sampling back to back
+		next_sample += pdMS_TO_TICKS(Temp_Sensor_Sample_Ms);
+		if ((int32_t)(xTaskGetTickCount() - next_sample) >= 0)
+		{
+			next_sample = xTaskGetTickCount() + pdMS_TO_TICKS(Temp_Sensor_Sample_Ms);
+		}
+
+		if (!LM75_get_raw(&raw))
+		{
+			continue;
+		}
+
+		sum += raw;
+		if (++count >= Temp_Sensor_Oversample)
+		{
+			// sum / count / 256 degrees, rounded to hundredths
+			int32_t scaled = sum * 100;
+			int32_t divisor = (int32_t)count * 256;
+
+			temp_sensor_publish((scaled + ((scaled >= 0) ? divisor / 2 : -divisor / 2)) / divisor);
+			sum = 0;
+			count = 0;
 		}
 	}
 }
@@ -196,13 +327,13 @@ bool task_temp_sensor_resources_init(cyhal_i2c_t *i2c_obj, SemaphoreHandle_t *i2
 	}
 
 	/* Create the Queue used to receive requests  */
-	Queue_Temp_Sensor_Requests = xQueueCreate(1, sizeof(temp_sensor_packet_t));
-	if (Queue_Temp_Sensor_Requests == NULL)
+	Queue_Temp_Sensor_Requests = xQueueCreate(TEMP_SENSOR_QUEUE_LENGTH, sizeof(device_request_msg_t));
+	if (!device_manager_register(DEVICE_TEMPERATURE, Queue_Temp_Sensor_Requests))
 	{
 		return false;
 	}
 
-	/* Create the task that will control the status LED */
+	/* Create the task that samples the temp sensor */
 	if (xTaskCreate(
 			task_temp_sensor,
 			"Temp Sensor",
@@ -218,4 +349,4 @@ bool task_temp_sensor_resources_init(cyhal_i2c_t *i2c_obj, SemaphoreHandle_t *i2
 		return true;
 	}
 }
-#endif
\ No newline at end of file
+#endif
@@ -22,11 +22,64 @@
 
 #define LM75_PRODUCT_ID                      0xA1
 
+#define TEMP_SENSOR_SAMPLE_MS                 125  /* Default time between LM75 reads */
+#define TEMP_SENSOR_OVERSAMPLE                8    /* Default reads averaged per published value */
+#define TEMP_SENSOR_OVERSAMPLE_MAX            64
+#define TEMP_SENSOR_MAX_SUBSCRIBERS           4
+#define TEMP_SENSOR_QUEUE_LENGTH              4
+
+/* Counters describing the temp sensor task since startup */
+typedef struct
+{
+	uint32_t i2c_reads;      /* LM75 reads, on the sampling schedule */
+	uint32_t read_errors;
+	uint32_t published;      /* Decimated values published */
+	uint32_t requests;       /* Reads answered from the cache */
+	uint32_t notifications;  /* Subscriber notifications sent */
+} temp_sensor_stats_t;
+
 extern QueueHandle_t Queue_Temp_Sensor_Requests;
 
-/* Functions used to interact with the Temp Sensor */
+/* Functions used to interact with the Temp Sensor.  Reads are answered
+ * from the newest published value and never touch the I2C bus. */
 bool system_sensors_get_temp(QueueHandle_t return_queue, float *temperature);
 
+/**
+ * @brief
+ * Returns the newest published temperature without blocking
+ * @param centi_celsius
+ * Temperature in hundredths of a degree C
+ * @return true
+ * @return false if no value has been published yet
+ */
+bool temp_sensor_get_cached(int32_t *centi_celsius);
+
+/**
+ * @brief
+ * Changes the sampling schedule.  A value is published every
+ * sample_ms * oversample ms.
+ * @param sample_ms
+ * @param oversample
+ * @return true
+ * @return false if the settings are out of range
+ */
+bool temp_sensor_configure(uint16_t sample_ms, uint8_t oversample);
+
+/**
+ * @brief
+ * Sets bits in events whenever the published temperature moves more than
+ * delta_centi away from the value last reported to this subscriber.  Must
+ * be called before the scheduler starts.
+ * @param delta_centi
+ * @param events
+ * @param bits
+ * @return true
+ * @return false if the table is full
+ */
+bool temp_sensor_subscribe(int32_t delta_centi, EventGroupHandle_t events, EventBits_t bits);
+
+bool temp_sensor_get_stats(temp_sensor_stats_t *stats);
+
 /* Function used to initialize resources for the Temp Sensor task */
 bool task_temp_sensor_resources_init(cyhal_i2c_t *i2c_obj, SemaphoreHandle_t *i2c_semaphore);
 
@@ -0,0 +1,85 @@
+/**
+ * @file battleship_ai_sim.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Shots the density targeting needs to sink a random fleet
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "host_test.h"
+#include "battleship_ai_target.h"
+#include <stdlib.h>
+
+/**
+ * @brief
+ * Plays battleship_ai_target.c against random fleets with no opponent
+ * firing back, the way the AI sees a game: it chooses a cell, the fleet
+ * reports miss, hit or sunk, and the result goes back through
+ * battleship_ai_update().  Reports the average, fewest and most shots to
+ * sink the fleet, how they are spread, and the time per choice.
+ *
+ *   battleship_ai_sim [games]    default 100000
+ */
+
+#define SIM_BUCKET 10 // Shots per histogram bucket
+
+int main(int argc, char *argv[])
+{
+    uint32_t games = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 100000;
+    uint32_t histogram[BITBOARD_CELLS / SIM_BUCKET + 1] = {0};
+    battleship_ai_t ai;
+    bitboard_fleet_t fleet;
+    uint32_t seed = 353;
+    uint64_t shots = 0;
+    uint8_t min_shots = BITBOARD_CELLS;
+    uint8_t max_shots = 0;
+    uint32_t unfinished = 0;
+    double start;
+    double elapsed;
+
+    bitboard_init();
+
+    start = host_test_seconds();
+    for (uint32_t game = 0; game < games; game++)
+    {
+        uint8_t game_shots = 0;
+        uint8_t col;
+        uint8_t row;
+
+        battleship_ai_place_fleet(&fleet, &seed);
+        battleship_ai_reset(&ai, seed);
+
+        while (!bitboard_fleet_all_sunk(&fleet) && battleship_ai_choose(&ai, &col, &row))
+        {
+            battleship_ai_update(&ai, col, row, bitboard_fleet_fire(&fleet, col, row, NULL));
+            game_shots++;
+        }
+
+        unfinished += !bitboard_fleet_all_sunk(&fleet);
+        shots += game_shots;
+        histogram[game_shots / SIM_BUCKET]++;
+        min_shots = (game_shots < min_shots) ? game_shots : min_shots;
+        max_shots = (game_shots > max_shots) ? game_shots : max_shots;
+    }
+    elapsed = host_test_seconds() - start;
+
+    printf("%u games: shots avg %.2f min %u max %u\n", games, (double)shots / games, min_shots, max_shots);
+    for (uint8_t i = 0; i <= BITBOARD_CELLS / SIM_BUCKET; i++)
+    {
+        if (histogram[i] != 0)
+        {
+            printf("  %3u-%3u: %6.2f%%\n", i * SIM_BUCKET, i * SIM_BUCKET + SIM_BUCKET - 1, 100.0 * histogram[i] / games);
+        }
+    }
+    printf("  %.0f games/s, %.2f us per choice\n", games / elapsed, elapsed * 1e6 / shots);
+
+    CHECK(unfinished == 0);
+    CHECK(min_shots >= 17); // Every ship cell has to be hit
+    // Firing at random needs about 95 shots on average
+    CHECK((double)shots / games < 50.0);
+
+    return host_test_result("battleship_ai_sim");
+}
@@ -0,0 +1,420 @@
+/**
+ * @file battleship_sim.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Self-play between battleship targeting strategies
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "host_test.h"
+#include "battleship_engine.h"
+#include "battleship_ai_target.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief
+ * Each side of a simulated game is a battleship_game_t driven by a
+ * strategy from Battleship_Strategies[].  A turn is the same sequence of
+ * engine transitions the two boards apply over IPC: fire, receive_fire on
+ * the other side, apply_result, then pass_turn on both sides.  Placement,
+ * overlap, repeat and sunk checks are the engine's, so the simulator plays
+ * by the rules hw05 plays by.
+ *
+ * A strategy is a name and three functions, so a new one only needs an
+ * entry in the table.  The random and parity strategies work from the
+ * hits and misses already in the game; density wraps battleship_ai_target.c.
+ *
+ * The games are split over one worker thread per CPU.  Every worker has
+ * its own players and seeds and fills its own result, and the results are
+ * merged once all the workers have finished.  The first worker's share is
+ * then replayed on the main thread and must give the same result.
+ *
+ *   battleship_sim [a] [b] [games] [threads]    default density parity 20000, one thread per CPU
+ */
+
+#define SIM_BUCKET 10 // Shots per histogram bucket
+#define SIM_BUCKETS (BITBOARD_CELLS / SIM_BUCKET + 1)
+#define SIM_MAX_THREADS 64
+#define SIM_SEED 353
+
+typedef enum
+{
+    BATTLESHIP_STRATEGY_RANDOM,  // Any unshot cell
+    BATTLESHIP_STRATEGY_PARITY,  // Checkerboard hunt, then the neighbours of hits
+    BATTLESHIP_STRATEGY_DENSITY, // battleship_ai_target.c
+    BATTLESHIP_STRATEGY_COUNT
+} battleship_strategy_id_t;
+
+// One side of a simulated game
+typedef struct
+{
+    battleship_game_t game;
+    battleship_ai_t ai; // Only used by the density strategy
+    uint32_t seed;
+} battleship_sim_player_t;
+
+// A targeting strategy.  The player's game holds every shot and result,
+// so a strategy only needs its own state for what the game does not track.
+typedef struct
+{
+    const char *name;
+    void (*reset)(battleship_sim_player_t *player);
+    bool (*choose)(battleship_sim_player_t *player, uint8_t *col, uint8_t *row);
+    void (*update)(battleship_sim_player_t *player, uint8_t col, uint8_t row, bitboard_shot_t result);
+} battleship_strategy_t;
+
+// Games played by one worker, or all of them once merged.  Index 0 is
+// strategy a, 1 is strategy b.
+typedef struct
+{
+    uint32_t games;
+    uint32_t wins[2];
+    uint32_t forfeits;                   // Games ended by a strategy with no legal shot
+    uint64_t win_shots[2];               // Shots fired in the games won
+    uint32_t histogram[2][SIM_BUCKETS];  // Games won, by shots fired / SIM_BUCKET
+    uint64_t transitions;                // Engine transitions applied
+} battleship_sim_result_t;
+
+// One worker thread and its share of the games
+typedef struct
+{
+    pthread_t thread;
+    battleship_strategy_id_t strategy[2];
+    uint32_t games;
+    uint32_t seed;
+    battleship_sim_result_t result;
+} battleship_sim_worker_t;
+
+/* Global Variables */
+static const int8_t Battleship_Sim_Directions[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+
+static uint32_t battleship_sim_random(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+/**
+ * @brief
+ * Picks one of count cells at random
+ */
+static void battleship_sim_pick(battleship_sim_player_t *player, const uint8_t *cells, uint8_t count, uint8_t *col, uint8_t *row)
+{
+    uint8_t index = cells[battleship_sim_random(&player->seed) % count];
+
+    *col = index % BITBOARD_SIZE;
+    *row = index / BITBOARD_SIZE;
+}
+
+static void battleship_sim_reset_none(battleship_sim_player_t *player)
+{
+    (void)player;
+}
+
+static void battleship_sim_update_none(battleship_sim_player_t *player, uint8_t col, uint8_t row, bitboard_shot_t result)
+{
+    (void)player;
+    (void)col;
+    (void)row;
+    (void)result;
+}
+
+static bool battleship_sim_random_choose(battleship_sim_player_t *player, uint8_t *col, uint8_t *row)
+{
+    uint8_t cells[BITBOARD_CELLS];
+    uint8_t count = 0;
+
+    for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+    {
+        if (battleship_game_target_at(&player->game, index % BITBOARD_SIZE, index / BITBOARD_SIZE) == BATTLESHIP_TARGET_UNKNOWN)
+        {
+            cells[count++] = index;
+        }
+    }
+
+    if (count == 0)
+    {
+        return false;
+    }
+
+    battleship_sim_pick(player, cells, count, col, row);
+    return true;
+}
+
+/**
+ * @brief
+ * Fires at the unshot neighbours of any hit.  With none, hunts on the
+ * black squares of a checkerboard (every ship covers at least one), then
+ * on whatever is left.
+ */
+static bool battleship_sim_parity_choose(battleship_sim_player_t *player, uint8_t *col, uint8_t *row)
+{
+    uint8_t cells[BITBOARD_CELLS];
+    uint8_t count = 0;
+
+    for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+    {
+        uint8_t c = index % BITBOARD_SIZE;
+        uint8_t r = index / BITBOARD_SIZE;
+
+        if (battleship_game_target_at(&player->game, c, r) != BATTLESHIP_TARGET_UNKNOWN)
+        {
+            continue;
+        }
+
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            // Off the board wraps past BITBOARD_SIZE and reads as unknown
+            uint8_t nc = (uint8_t)(c + Battleship_Sim_Directions[i][0]);
+            uint8_t nr = (uint8_t)(r + Battleship_Sim_Directions[i][1]);
+
+            if (battleship_game_target_at(&player->game, nc, nr) == BATTLESHIP_TARGET_HIT)
+            {
+                cells[count++] = index;
+                break;
+            }
+        }
+    }
+
+    for (uint8_t pass = 0; pass < 2 && count == 0; pass++)
+    {
+        for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+        {
+            uint8_t c = index % BITBOARD_SIZE;
+            uint8_t r = index / BITBOARD_SIZE;
+
+            if ((pass == 1 || (c + r) % 2 == 0) &&
+                battleship_game_target_at(&player->game, c, r) == BATTLESHIP_TARGET_UNKNOWN)
+            {
+                cells[count++] = index;
+            }
+        }
+    }
+
+    if (count == 0)
+    {
+        return false;
+    }
+
+    battleship_sim_pick(player, cells, count, col, row);
+    return true;
+}
+
+static void battleship_sim_density_reset(battleship_sim_player_t *player)
+{
+    battleship_ai_reset(&player->ai, battleship_sim_random(&player->seed));
+}
+
+static bool battleship_sim_density_choose(battleship_sim_player_t *player, uint8_t *col, uint8_t *row)
+{
+    return battleship_ai_choose(&player->ai, col, row);
+}
+
+static void battleship_sim_density_update(battleship_sim_player_t *player, uint8_t col, uint8_t row, bitboard_shot_t result)
+{
+    battleship_ai_update(&player->ai, col, row, result);
+}
+
+static const battleship_strategy_t Battleship_Strategies[BATTLESHIP_STRATEGY_COUNT] = {
+    [BATTLESHIP_STRATEGY_RANDOM] = {"random", battleship_sim_reset_none, battleship_sim_random_choose, battleship_sim_update_none},
+    [BATTLESHIP_STRATEGY_PARITY] = {"parity", battleship_sim_reset_none, battleship_sim_parity_choose, battleship_sim_update_none},
+    [BATTLESHIP_STRATEGY_DENSITY] = {"density", battleship_sim_density_reset, battleship_sim_density_choose, battleship_sim_density_update},
+};
+
+static battleship_strategy_id_t battleship_sim_strategy_find(const char *name)
+{
+    for (uint8_t id = 0; id < BATTLESHIP_STRATEGY_COUNT; id++)
+    {
+        if (strcmp(name, Battleship_Strategies[id].name) == 0)
+        {
+            return (battleship_strategy_id_t)id;
+        }
+    }
+
+    return BATTLESHIP_STRATEGY_COUNT;
+}
+
+/**
+ * @brief
+ * Plays one game
+ * @param player
+ * @param strategy
+ * @param first Side that fires first
+ * @param result Counts the transitions and any forfeit
+ * @return uint8_t The winning side
+ */
+static uint8_t battleship_sim_play(
+    battleship_sim_player_t player[2],
+    const battleship_strategy_t *strategy[2],
+    uint8_t first,
+    battleship_sim_result_t *result)
+{
+    uint8_t shooter = first;
+
+    for (uint8_t side = 0; side < 2; side++)
+    {
+        battleship_game_init(&player[side].game, (side == first) ? 0 : 1);
+        battleship_game_place_random(&player[side].game, &player[side].seed);
+        strategy[side]->reset(&player[side]);
+        result->transitions += BITBOARD_SHIPS;
+    }
+
+    while (player[shooter].game.phase == BATTLESHIP_PHASE_PLAYING)
+    {
+        battleship_sim_player_t *attacker = &player[shooter];
+        battleship_sim_player_t *defender = &player[1 - shooter];
+        bitboard_shot_t shot;
+        uint8_t col;
+        uint8_t row;
+
+        if (!strategy[shooter]->choose(attacker, &col, &row) ||
+            battleship_game_fire(&attacker->game, col, row) != BATTLESHIP_OK ||
+            battleship_game_receive_fire(&defender->game, col, row, &shot, NULL) != BATTLESHIP_OK)
+        {
+            // A strategy that can not make a legal shot forfeits
+            battleship_game_end(&attacker->game, false);
+            battleship_game_end(&defender->game, true);
+            result->transitions += 2;
+            result->forfeits++;
+            break;
+        }
+
+        battleship_game_apply_result(&attacker->game, shot);
+        strategy[shooter]->update(attacker, col, row, shot);
+        result->transitions += 3;
+
+        if (attacker->game.phase == BATTLESHIP_PHASE_PLAYING)
+        {
+            battleship_game_pass_turn(&attacker->game, attacker->game.player_id);
+            battleship_game_pass_turn(&defender->game, attacker->game.player_id);
+            result->transitions += 2;
+            shooter = 1 - shooter;
+        }
+    }
+
+    return player[0].game.i_won ? 0 : 1;
+}
+
+/**
+ * @brief
+ * Plays worker->games games from worker->seed into worker->result.  The
+ * first shot alternates between a and b.
+ */
+static void *battleship_sim_worker(void *arg)
+{
+    battleship_sim_worker_t *worker = arg;
+    const battleship_strategy_t *strategy[2] = {&Battleship_Strategies[worker->strategy[0]], &Battleship_Strategies[worker->strategy[1]]};
+    battleship_sim_player_t player[2];
+    battleship_sim_result_t *result = &worker->result;
+
+    memset(result, 0, sizeof(battleship_sim_result_t));
+    player[0].seed = worker->seed;
+    player[1].seed = battleship_sim_random(&player[0].seed);
+
+    for (uint32_t game = 0; game < worker->games; game++)
+    {
+        uint8_t winner = battleship_sim_play(player, strategy, game % 2, result);
+        uint16_t shots = player[winner].game.my_hits + player[winner].game.my_misses;
+
+        result->games++;
+        result->wins[winner]++;
+        result->win_shots[winner] += shots;
+        result->histogram[winner][shots / SIM_BUCKET]++;
+    }
+
+    return NULL;
+}
+
+static void battleship_sim_merge(battleship_sim_result_t *total, const battleship_sim_result_t *part)
+{
+    total->games += part->games;
+    total->forfeits += part->forfeits;
+    total->transitions += part->transitions;
+    for (uint8_t side = 0; side < 2; side++)
+    {
+        total->wins[side] += part->wins[side];
+        total->win_shots[side] += part->win_shots[side];
+        for (uint8_t bucket = 0; bucket < SIM_BUCKETS; bucket++)
+        {
+            total->histogram[side][bucket] += part->histogram[side][bucket];
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static battleship_sim_worker_t workers[SIM_MAX_THREADS];
+    battleship_strategy_id_t id[2] = {
+        battleship_sim_strategy_find((argc > 1) ? argv[1] : "density"),
+        battleship_sim_strategy_find((argc > 2) ? argv[2] : "parity")};
+    uint32_t games = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 0) : 20000;
+    long threads = (argc > 4) ? strtol(argv[4], NULL, 0) : sysconf(_SC_NPROCESSORS_ONLN);
+    battleship_sim_result_t total = {0};
+    battleship_sim_worker_t replay;
+    double start;
+    double elapsed;
+
+    if (id[0] == BATTLESHIP_STRATEGY_COUNT || id[1] == BATTLESHIP_STRATEGY_COUNT || games == 0)
+    {
+        printf("usage: battleship_sim [random|parity|density] [random|parity|density] [games] [threads]\n");
+        return 2;
+    }
+    threads = (threads < 1) ? 1 : (threads > SIM_MAX_THREADS) ? SIM_MAX_THREADS : threads;
+    threads = ((uint32_t)threads > games) ? (long)games : threads;
+
+    bitboard_init();
+
+    start = host_test_seconds();
+    for (long i = 0; i < threads; i++)
+    {
+        workers[i].strategy[0] = id[0];
+        workers[i].strategy[1] = id[1];
+        workers[i].games = games / threads + ((uint32_t)i < games % threads ? 1 : 0);
+        workers[i].seed = SIM_SEED + (uint32_t)i * 7919;
+        CHECK(pthread_create(&workers[i].thread, NULL, battleship_sim_worker, &workers[i]) == 0);
+    }
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        battleship_sim_merge(&total, &workers[i].result);
+    }
+    elapsed = host_test_seconds() - start;
+
+    printf("%s vs %s: %u games on %ld threads, %.0f games/s, %.2f M transitions/s\n",
+           Battleship_Strategies[id[0]].name, Battleship_Strategies[id[1]].name, games, threads,
+           games / elapsed, total.transitions / elapsed / 1e6);
+    for (uint8_t side = 0; side < 2; side++)
+    {
+        printf("  %c %-7s wins %6.2f%%, %.2f shots per win\n",
+               'A' + side, Battleship_Strategies[id[side]].name, 100.0 * total.wins[side] / total.games,
+               total.wins[side] ? (double)total.win_shots[side] / total.wins[side] : 0.0);
+    }
+    for (uint8_t bucket = 0; bucket < SIM_BUCKETS; bucket++)
+    {
+        if (total.histogram[0][bucket] != 0 || total.histogram[1][bucket] != 0)
+        {
+            printf("  %3u-%3u: A %6.2f%%  B %6.2f%%\n",
+                   bucket * SIM_BUCKET, bucket * SIM_BUCKET + SIM_BUCKET - 1,
+                   100.0 * total.histogram[0][bucket] / total.games, 100.0 * total.histogram[1][bucket] / total.games);
+        }
+    }
+
+    // A worker only touches its own players, so its games replay exactly
+    replay = workers[0];
+    battleship_sim_worker(&replay);
+    CHECK(memcmp(&replay.result, &workers[0].result, sizeof(battleship_sim_result_t)) == 0);
+
+    CHECK(total.games == games);
+    CHECK(total.wins[0] + total.wins[1] == games);
+    CHECK(total.forfeits == 0);
+    // Every ship cell has to be hit to win
+    CHECK(total.histogram[0][0] == 0 && total.histogram[1][0] == 0);
+
+    return host_test_result("battleship_sim");
+}
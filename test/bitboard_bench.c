@@ -0,0 +1,237 @@
+/**
+ * @file bitboard_bench.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Bitboard checks against the byte array board they replaced
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "host_test.h"
+#include "bitboard.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief
+ * Places the same pseudo random fleet on a byte array board, as
+ * battleship.c and hw05 kept it before the bitboards, and on a
+ * bitboard_fleet_t, then fires on half the cells.  Every origin of every
+ * ship length and orientation is checked for overlap both ways, and the
+ * all-sunk scan is timed against bitboard_fleet_all_sunk().  The answers
+ * must agree.
+ *
+ *   bitboard_bench [rounds]    default 20000
+ */
+
+static const uint8_t Lengths[BITBOARD_SHIPS] = {2, 3, 3, 4, 5};
+
+/* Global Variables */
+static uint8_t Board[BITBOARD_SIZE][BITBOARD_SIZE];
+static uint8_t Hits[BITBOARD_SIZE][BITBOARD_SIZE];
+static bitboard_fleet_t Fleet;
+
+/**
+ * @brief
+ * The overlap check battleship.c used before the bitboards
+ */
+static bool array_overlap(uint8_t board[BITBOARD_SIZE][BITBOARD_SIZE], uint8_t col, uint8_t row, uint8_t length, bool horizontal)
+{
+    for (uint8_t i = 0; i < length; i++)
+    {
+        uint8_t check_col = horizontal ? col + i : col;
+        uint8_t check_row = horizontal ? row : row + i;
+
+        if (check_row >= BITBOARD_SIZE || check_col >= BITBOARD_SIZE || board[check_row][check_col] != 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief
+ * The all-sunk scan hw05 used before the bitboards
+ */
+static bool array_all_sunk(uint8_t board[BITBOARD_SIZE][BITBOARD_SIZE], uint8_t hits[BITBOARD_SIZE][BITBOARD_SIZE])
+{
+    uint8_t remaining = 0;
+
+    for (uint8_t r = 0; r < BITBOARD_SIZE; r++)
+    {
+        for (uint8_t c = 0; c < BITBOARD_SIZE; c++)
+        {
+            remaining += (board[r][c] != 0 && hits[r][c] == 0);
+        }
+    }
+
+    return remaining == 0;
+}
+
+static void bench_place_fleet(uint32_t seed)
+{
+    memset(Board, 0, sizeof(Board));
+    memset(Hits, 0, sizeof(Hits));
+    bitboard_fleet_clear(&Fleet);
+
+    for (uint8_t id = 1; id <= BITBOARD_SHIPS; id++)
+    {
+        uint8_t col;
+        uint8_t row;
+        bool horizontal;
+
+        do
+        {
+            seed = seed * 1103515245 + 12345;
+            col = (seed >> 16) % BITBOARD_SIZE;
+            row = (seed >> 20) % BITBOARD_SIZE;
+            horizontal = (seed >> 30) & 1;
+        } while (!bitboard_fleet_place(&Fleet, id, Lengths[id - 1], horizontal, col, row));
+
+        for (uint8_t i = 0; i < Lengths[id - 1]; i++)
+        {
+            Board[horizontal ? row : row + i][horizontal ? col + i : col] = id;
+        }
+    }
+}
+
+static void bench_fire(uint8_t col, uint8_t row)
+{
+    Hits[row][col] = 1;
+    bitboard_fleet_fire(&Fleet, col, row, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t rounds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 20000;
+    // Read through volatile pointers so the loops can not be hoisted
+    uint8_t(*volatile board_ptr)[BITBOARD_SIZE] = Board;
+    uint8_t(*volatile hits_ptr)[BITBOARD_SIZE] = Hits;
+    const bitboard_fleet_t *volatile fleet_ptr = &Fleet;
+    volatile uint32_t answers = 0;
+    uint32_t checks = 0;
+    uint32_t mismatches = 0;
+    double start;
+    double array_s;
+    double bitboard_s;
+
+    bitboard_init();
+
+    // Every length fits in (SIZE - length + 1) origins per line, both ways
+    for (uint8_t length = BITBOARD_MIN_SHIP; length <= BITBOARD_MAX_SHIP; length++)
+    {
+        for (uint8_t horizontal = 0; horizontal < 2; horizontal++)
+        {
+            const bitboard_t *masks = bitboard_ship_masks(length, horizontal);
+            uint32_t origins = 0;
+            bool sizes_ok = true;
+
+            for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+            {
+                if (!bitboard_is_empty(masks[index]))
+                {
+                    origins++;
+                    sizes_ok &= (bitboard_count(masks[index]) == length);
+                }
+            }
+            CHECK(origins == (uint32_t)BITBOARD_SIZE * (BITBOARD_SIZE - length + 1));
+            CHECK(sizes_ok);
+        }
+    }
+
+    // Overlap agrees on many fleets
+    for (uint32_t fleet = 0; fleet < 1000; fleet++)
+    {
+        bench_place_fleet(fleet);
+        for (uint8_t length = BITBOARD_MIN_SHIP; length <= BITBOARD_MAX_SHIP; length++)
+        {
+            for (uint8_t horizontal = 0; horizontal < 2; horizontal++)
+            {
+                for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+                {
+                    uint8_t col = index % BITBOARD_SIZE;
+                    uint8_t row = index / BITBOARD_SIZE;
+
+                    mismatches += (array_overlap(Board, col, row, length, horizontal) !=
+                                   !bitboard_fleet_can_place(&Fleet, length, horizontal, col, row));
+                    checks++;
+                }
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+
+    // All sunk agrees while a fleet is shot down cell by cell
+    bench_place_fleet(7);
+    for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+    {
+        bench_fire(index % BITBOARD_SIZE, index / BITBOARD_SIZE);
+        if (array_all_sunk(Board, Hits) != bitboard_fleet_all_sunk(&Fleet))
+        {
+            mismatches++;
+        }
+    }
+    CHECK(mismatches == 0);
+    CHECK(bitboard_fleet_all_sunk(&Fleet));
+
+    // Timing, on one fleet with half the cells fired on
+    bench_place_fleet(353);
+    for (uint8_t index = 0; index < BITBOARD_CELLS; index += 2)
+    {
+        bench_fire(index % BITBOARD_SIZE, index / BITBOARD_SIZE);
+    }
+
+    start = host_test_seconds();
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        for (uint8_t length = BITBOARD_MIN_SHIP; length <= BITBOARD_MAX_SHIP; length++)
+        {
+            for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+            {
+                answers += array_overlap(board_ptr, index % BITBOARD_SIZE, index / BITBOARD_SIZE, length, round & 1);
+            }
+        }
+    }
+    array_s = host_test_seconds() - start;
+
+    start = host_test_seconds();
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        for (uint8_t length = BITBOARD_MIN_SHIP; length <= BITBOARD_MAX_SHIP; length++)
+        {
+            for (uint8_t index = 0; index < BITBOARD_CELLS; index++)
+            {
+                answers += bitboard_fleet_can_place(fleet_ptr, length, round & 1, index % BITBOARD_SIZE, index / BITBOARD_SIZE);
+            }
+        }
+    }
+    bitboard_s = host_test_seconds() - start;
+
+    uint32_t overlap_ops = rounds * (BITBOARD_MAX_SHIP - BITBOARD_MIN_SHIP + 1) * BITBOARD_CELLS;
+    printf("overlap:  array %.1f ns, bitboard %.1f ns (%.1fx), %u checks agree\n",
+           array_s * 1e9 / overlap_ops, bitboard_s * 1e9 / overlap_ops, array_s / bitboard_s, checks);
+
+    start = host_test_seconds();
+    for (uint32_t round = 0; round < rounds * 100; round++)
+    {
+        answers += array_all_sunk(board_ptr, hits_ptr);
+    }
+    array_s = host_test_seconds() - start;
+
+    start = host_test_seconds();
+    for (uint32_t round = 0; round < rounds * 100; round++)
+    {
+        answers += bitboard_fleet_all_sunk(fleet_ptr);
+    }
+    bitboard_s = host_test_seconds() - start;
+
+    printf("all sunk: array %.1f ns, bitboard %.1f ns (%.1fx)\n",
+           array_s * 1e9 / (rounds * 100.0), bitboard_s * 1e9 / (rounds * 100.0), array_s / bitboard_s);
+
+    (void)answers;
+    return host_test_result("bitboard_bench");
+}
@@ -0,0 +1,50 @@
+/**
+ * @file host_test.h
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Checks shared by the host tests
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+static int host_test_checks;
+static int host_test_failures;
+
+// Records a failed check and keeps going so one run reports every failure
+#define CHECK(cond)                                                          \
+    do                                                                       \
+    {                                                                        \
+        host_test_checks++;                                                  \
+        if (!(cond))                                                         \
+        {                                                                    \
+            host_test_failures++;                                            \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        }                                                                    \
+    } while (0)
+
+// Exit status for main()
+static inline int host_test_result(const char *name)
+{
+    printf("%s: %d checks, %d failed\n", name, host_test_checks, host_test_failures);
+    return (host_test_failures == 0) ? 0 : 1;
+}
+
+// Wall clock seconds, for the throughput benchmarks
+static inline double host_test_seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+#endif
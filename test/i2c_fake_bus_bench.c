@@ -0,0 +1,390 @@
+/**
+ * @file i2c_fake_bus_bench.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Throughput and tail latency of the I2C engine's scheduling on a fake bus
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "host_test.h"
+#include "i2c_queue.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief
+ * The engine in src/tasks/task_i2c.c checks and queues every submission
+ * with i2c_queue.c and starts whatever i2c_queue_pop() returns once the
+ * bus is free.  A transfer is never preempted.  This program links the
+ * same i2c_queue.c into a discrete event simulation of a fake bus where
+ * every device has its own response latency, so the behaviour of the
+ * engine's queues under load can be measured without hardware.
+ *
+ * The board's own traffic (IO expander writes, LM75 and LTR-329 reads) runs
+ * in every scenario.  A load generator adds NORMAL priority reads at a
+ * rising rate until the bus saturates.  Each scenario reports transactions
+ * per second of simulated time, bus utilization, and p50/p99/max latency
+ * from submission to completion for each priority.  Once NORMAL traffic
+ * fills the bus the LOW readers starve, which is what strict priority
+ * does on the board as well.
+ */
+
+// Bus clock from drivers/i2c.h, which needs the board headers
+#define I2C_MASTER_FREQUENCY 100000u
+
+#define ENGINE_OVERHEAD_US 25  // Completion interrupt, task switch and next setup
+#define SIM_SECONDS 60
+#define MAX_SAMPLES (SIM_SECONDS * 20000)
+
+// A device on the fake bus
+typedef struct
+{
+    const char *name;
+    uint8_t address;
+    uint32_t latency_us; // Clock stretching and conversion time per transfer
+} fake_device_t;
+
+static const fake_device_t Fake_Devices[] = {
+    {"TCA9534", 0x20, 5},
+    {"LM75", 0x48, 40},
+    {"LTR-329", 0x29, 60},
+    {"load", 0x50, 20},
+};
+
+// Something that submits transactions.  A blocking source waits for its
+// transfer to finish before it schedules the next one, the way
+// i2c_async_transfer() does.
+typedef struct
+{
+    uint8_t device;
+    uint8_t priority;
+    uint16_t length;
+    bool write;
+    uint32_t period_us;
+    uint32_t burst;     // Transactions submitted at each period
+    bool blocking;
+    uint64_t next_us;
+    uint32_t outstanding;
+} fake_source_t;
+
+// What the engine queues.  A priority's queue is a FIFO of
+// I2C_ASYNC_QUEUE_LENGTH, so its slots are reused in turn.
+typedef struct
+{
+    uint8_t source;
+    uint64_t queued_us;
+} fake_txn_t;
+
+typedef struct
+{
+    i2c_queue_t queue;
+    fake_txn_t slots[I2C_ASYNC_PRIORITY_COUNT][I2C_ASYNC_QUEUE_LENGTH];
+    uint32_t next_slot[I2C_ASYNC_PRIORITY_COUNT];
+} fake_engine_t;
+
+typedef struct
+{
+    uint32_t *latency_us;
+    uint32_t count;
+} fake_latency_t;
+
+typedef struct
+{
+    uint32_t completed;
+    uint32_t rejected;
+    uint64_t busy_us;
+    fake_latency_t latency[I2C_ASYNC_PRIORITY_COUNT];
+    bool fifo_ok;
+    uint32_t max_transfer_us;
+} fake_result_t;
+
+/* Global Variables */
+static uint32_t Fake_Seed = 1;
+static uint8_t Fake_Data[I2C_ASYNC_MAX_WRITE];
+
+/**
+ * @brief
+ * Time a transfer holds the bus.  Every byte is 8 data bits plus an ACK;
+ * start, repeated start and stop add about a bit each.
+ */
+static uint32_t fake_bus_transfer_us(const fake_source_t *source)
+{
+    uint32_t bits;
+
+    if (source->write)
+    {
+        bits = 1 + 9 * (2 + source->length) + 1; // Address, register, data
+    }
+    else
+    {
+        bits = 1 + 9 * 2 + 1 + 9 * (1 + source->length) + 1; // Register phase, then read
+    }
+
+    return (bits * 1000000u) / I2C_MASTER_FREQUENCY + Fake_Devices[source->device].latency_us + ENGINE_OVERHEAD_US;
+}
+
+static uint32_t fake_random(void)
+{
+    Fake_Seed = Fake_Seed * 1103515245 + 12345;
+    return Fake_Seed >> 16;
+}
+
+// Task periods drift with tick rounding and preemption, so each one is
+// spread by +/-10% to keep the sources from locking into phase
+static uint64_t fake_source_period(const fake_source_t *source)
+{
+    uint32_t spread = source->period_us / 5;
+
+    if (spread == 0)
+    {
+        return source->period_us;
+    }
+    return source->period_us - spread / 2 + fake_random() % spread;
+}
+
+/**
+ * @brief
+ * i2c_async_submit(): checks the transaction, then queues it unless the
+ * queue for its priority is full
+ */
+static bool fake_engine_submit(fake_engine_t *engine, const fake_source_t *source, uint8_t index, uint64_t now)
+{
+    i2c_async_priority_t priority = (i2c_async_priority_t)source->priority;
+    fake_txn_t *txn;
+
+    if (!i2c_queue_valid(priority, Fake_Data, source->length, source->write))
+    {
+        return false;
+    }
+
+    txn = &engine->slots[priority][engine->next_slot[priority] % I2C_ASYNC_QUEUE_LENGTH];
+    if (!i2c_queue_push(&engine->queue, priority, txn))
+    {
+        return false;
+    }
+
+    engine->next_slot[priority]++;
+    txn->source = index;
+    txn->queued_us = now;
+    return true;
+}
+
+static void fake_source_submit(fake_source_t *sources, uint8_t index, fake_engine_t *engine, uint64_t now, fake_result_t *result)
+{
+    fake_source_t *source = &sources[index];
+
+    for (uint32_t i = 0; i < source->burst; i++)
+    {
+        if (fake_engine_submit(engine, source, index, now))
+        {
+            source->outstanding++;
+        }
+        else
+        {
+            result->rejected++;
+        }
+    }
+
+    // A blocking source that was refused tries again next period
+    if (!source->blocking || source->outstanding == 0)
+    {
+        source->next_us = now + fake_source_period(source);
+    }
+    else
+    {
+        source->next_us = UINT64_MAX;
+    }
+}
+
+/**
+ * @brief
+ * Runs the engine's queues for SIM_SECONDS of simulated time
+ */
+static void fake_bus_run(fake_source_t *sources, uint8_t source_count, fake_result_t *result)
+{
+    static fake_engine_t engine;
+    uint64_t now = 0;
+    uint64_t bus_free_us = 0;
+    uint64_t end_us = (uint64_t)SIM_SECONDS * 1000000u;
+    uint64_t last_queued[I2C_ASYNC_PRIORITY_COUNT] = {0};
+
+    memset(&engine, 0, sizeof(engine));
+    for (int p = 0; p < I2C_ASYNC_PRIORITY_COUNT; p++)
+    {
+        result->latency[p].count = 0;
+    }
+    result->completed = 0;
+    result->rejected = 0;
+    result->busy_us = 0;
+    result->fifo_ok = true;
+    result->max_transfer_us = 0;
+
+    while (now < end_us)
+    {
+        // Submissions due by now, in source order
+        for (uint8_t i = 0; i < source_count; i++)
+        {
+            if (sources[i].next_us <= now)
+            {
+                fake_source_submit(sources, i, &engine, now, result);
+            }
+        }
+
+        // The engine starts the next transaction once the bus is free
+        if (bus_free_us <= now)
+        {
+            fake_txn_t *txn = i2c_queue_pop(&engine.queue);
+
+            if (txn != NULL)
+            {
+                fake_source_t *source = &sources[txn->source];
+                uint8_t p = source->priority;
+                uint32_t transfer_us = fake_bus_transfer_us(source);
+                fake_latency_t *latency = &result->latency[p];
+
+                if (txn->queued_us < last_queued[p])
+                {
+                    result->fifo_ok = false;
+                }
+                last_queued[p] = txn->queued_us;
+
+                bus_free_us = now + transfer_us;
+                result->busy_us += transfer_us;
+                result->completed++;
+                if (transfer_us > result->max_transfer_us)
+                {
+                    result->max_transfer_us = transfer_us;
+                }
+                if (latency->count < MAX_SAMPLES)
+                {
+                    latency->latency_us[latency->count++] = (uint32_t)(bus_free_us - txn->queued_us);
+                }
+
+                // A blocking caller wakes when its transfer completes
+                source->outstanding--;
+                if (source->blocking && source->outstanding == 0)
+                {
+                    source->next_us = bus_free_us + fake_source_period(source);
+                }
+            }
+        }
+
+        // Advance to the next event: a submission or the bus coming free
+        uint64_t next = end_us;
+        for (uint8_t i = 0; i < source_count; i++)
+        {
+            if (sources[i].next_us < next)
+            {
+                next = sources[i].next_us;
+            }
+        }
+        if (bus_free_us > now && bus_free_us < next)
+        {
+            next = bus_free_us;
+        }
+        now = (next > now) ? next : now + 1;
+    }
+}
+
+static int fake_compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static uint32_t fake_percentile(const fake_latency_t *latency, uint32_t percent)
+{
+    if (latency->count == 0)
+    {
+        return 0;
+    }
+
+    uint32_t index = (uint32_t)(((uint64_t)latency->count * percent) / 100);
+    return latency->latency_us[(index < latency->count) ? index : latency->count - 1];
+}
+
+int main(void)
+{
+    // NORMAL priority load added to the board's own traffic, transactions per second
+    static const uint32_t Load_Rates[] = {0, 500, 1000, 1500, 2000};
+    fake_result_t result;
+    double start = host_test_seconds();
+    uint64_t total_completed = 0;
+
+    for (int p = 0; p < I2C_ASYNC_PRIORITY_COUNT; p++)
+    {
+        result.latency[p].latency_us = malloc(MAX_SAMPLES * sizeof(uint32_t));
+    }
+
+    printf("%6s %9s %6s %8s  %-22s %-22s %-22s\n", "load/s", "txn/s", "busy", "rejected",
+           "high p50/p99/max us", "normal p50/p99/max us", "low p50/p99/max us");
+
+    for (size_t i = 0; i < sizeof(Load_Rates) / sizeof(Load_Rates[0]); i++)
+    {
+        fake_source_t sources[] = {
+            // LED animation on the IO expander, a shadow flush every 20 ms
+            {.device = 0, .priority = I2C_ASYNC_PRIORITY_HIGH, .length = 1, .write = true, .period_us = 20000, .burst = 1, .blocking = true},
+            // LM75 temperature every TEMP_SENSOR_SAMPLE_MS
+            {.device = 1, .priority = I2C_ASYNC_PRIORITY_LOW, .length = 2, .write = false, .period_us = 125000, .burst = 1, .blocking = true},
+            // LTR-329 ALS burst read
+            {.device = 2, .priority = I2C_ASYNC_PRIORITY_LOW, .length = 5, .write = false, .period_us = 100000, .burst = 1, .blocking = true},
+            // Load generator, callback driven so it does not wait for completion
+            {.device = 3, .priority = I2C_ASYNC_PRIORITY_NORMAL, .length = 4, .write = false,
+             .period_us = Load_Rates[i] ? 1000000u / Load_Rates[i] : UINT32_MAX, .burst = 1, .blocking = false},
+        };
+        uint8_t source_count = sizeof(sources) / sizeof(sources[0]);
+
+        if (Load_Rates[i] == 0)
+        {
+            sources[3].next_us = UINT64_MAX;
+        }
+
+        fake_bus_run(sources, source_count, &result);
+        total_completed += result.completed;
+
+        char column[I2C_ASYNC_PRIORITY_COUNT][32];
+        for (int p = 0; p < I2C_ASYNC_PRIORITY_COUNT; p++)
+        {
+            qsort(result.latency[p].latency_us, result.latency[p].count, sizeof(uint32_t), fake_compare_u32);
+            snprintf(column[p], sizeof(column[p]), "%u/%u/%u",
+                     fake_percentile(&result.latency[p], 50),
+                     fake_percentile(&result.latency[p], 99),
+                     fake_percentile(&result.latency[p], 100));
+        }
+
+        printf("%6u %9.0f %5.1f%% %8u  %-22s %-22s %-22s\n",
+               Load_Rates[i],
+               (double)result.completed / SIM_SECONDS,
+               100.0 * result.busy_us / (SIM_SECONDS * 1000000.0),
+               result.rejected,
+               column[I2C_ASYNC_PRIORITY_HIGH], column[I2C_ASYNC_PRIORITY_NORMAL], column[I2C_ASYNC_PRIORITY_LOW]);
+
+        // Transfers run to completion, so a HIGH transaction waits for at
+        // most the transfer already on the bus plus its own
+        uint32_t high_bound = result.max_transfer_us + fake_bus_transfer_us(&sources[0]);
+        CHECK(fake_percentile(&result.latency[I2C_ASYNC_PRIORITY_HIGH], 100) <= high_bound);
+        CHECK(result.fifo_ok);
+        CHECK(result.latency[I2C_ASYNC_PRIORITY_HIGH].count >= SIM_SECONDS * 1000000u / (20000 + high_bound));
+
+        if (Load_Rates[i] == 0)
+        {
+            CHECK(result.rejected == 0);
+        }
+    }
+
+    double elapsed = host_test_seconds() - start;
+    printf("%.1f M simulated transactions/s on the host\n", total_completed / elapsed / 1e6);
+
+    for (int p = 0; p < I2C_ASYNC_PRIORITY_COUNT; p++)
+    {
+        free(result.latency[p].latency_us);
+    }
+
+    return host_test_result("i2c_fake_bus_bench");
+}
@@ -0,0 +1,358 @@
+/**
+ * @file imu_tilt_replay.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Host replay bench for the IMU tilt pipeline
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "host_test.h"
+#include "imu_tilt.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief
+ * With no argument the bench builds a trace from a gesture script: each
+ * step tilts the board about one axis, holds, and returns level.  Gravity
+ * is rotated by the scripted angle and the gyro reports its rate, with
+ * sensor noise, a gyro bias, hand tremor and sharp taps added.  Because
+ * the intent of every sample is known, each move the pipeline reports is
+ * scored: the first move of a gesture gives time-to-first-move, measured
+ * from the sample where the true tilt crosses enter_cdeg, and any move on
+ * the wrong axis, in the wrong direction or outside a gesture is false.
+ *
+ * With a file argument the bench replays a trace recorded on the board
+ * instead, one "x,y,z,gx,gy,gz" sample per line at 104 Hz, and reports
+ * the moves and the pipeline counters.
+ */
+
+#define ODR_HZ 104
+#define ACCEL_LSB_PER_G 16384.0 // +/-2 g
+#define GYRO_DPS_PER_LSB 0.00875 // +/-250 dps
+#define PI 3.14159265358979
+
+#define MAX_SAMPLES 20000
+#define SETTLE_MS 300 // Moves this long after a gesture returns level still count for it
+
+typedef struct
+{
+    int8_t axis;        // IMU_TILT_AXIS_X/Y, -1 for rest
+    int8_t sign;
+    double degrees;     // Peak tilt
+    uint16_t ramp_ms;   // Time to reach the peak, and to return level
+    uint16_t hold_ms;
+    bool intended;      // false for tilts below the threshold, which must not move
+} gesture_t;
+
+// Sample annotations built with the trace
+typedef struct
+{
+    int8_t axis;
+    int8_t sign;
+    bool intended;
+    int16_t gesture;    // Index into Gestures[], -1 at rest
+    bool crossed;       // True tilt is past enter_cdeg
+} truth_t;
+
+static const gesture_t Gestures[] = {
+    {-1, 0, 0, 0, 3000, false},   // Resting on the table, with taps
+    {IMU_TILT_AXIS_X, 1, 15, 250, 1500, true},
+    {-1, 0, 0, 0, 1000, false},
+    {IMU_TILT_AXIS_X, -1, 15, 250, 1500, true},
+    {-1, 0, 0, 0, 1000, false},
+    {IMU_TILT_AXIS_Y, 1, 20, 200, 1000, true},
+    {-1, 0, 0, 0, 1000, false},
+    {IMU_TILT_AXIS_Y, -1, 30, 300, 2500, true}, // Past full_cdeg, fastest repeat
+    {-1, 0, 0, 0, 1000, false},
+    {IMU_TILT_AXIS_X, 1, 12, 150, 150, true},   // Quick flick
+    {-1, 0, 0, 0, 1000, false},
+    {IMU_TILT_AXIS_X, 1, 5, 300, 2000, false},  // Small tilt, no moves
+    {-1, 0, 0, 0, 1000, false},
+    {IMU_TILT_AXIS_Y, -1, 7, 300, 2000, false}, // Just under enter_cdeg
+    {-1, 0, 0, 0, 2000, false},
+};
+#define GESTURES (sizeof(Gestures) / sizeof(Gestures[0]))
+
+static imu_tilt_sample_t Trace[MAX_SAMPLES];
+static truth_t Truth[MAX_SAMPLES];
+static uint32_t Seed = 353;
+
+static double uniform(void)
+{
+    Seed = Seed * 1103515245 + 12345;
+    return ((Seed >> 8) + 0.5) / 16777216.0;
+}
+
+static double gaussian(double sigma)
+{
+    return sigma * sqrt(-2.0 * log(uniform())) * cos(2.0 * PI * uniform());
+}
+
+static int16_t clamp16(double v)
+{
+    return (int16_t)((v > 32767) ? 32767 : (v < -32768) ? -32768 : lround(v));
+}
+
+/**
+ * @brief
+ * Builds the scripted trace.  Returns the number of samples.
+ */
+static uint32_t trace_build(int16_t enter_cdeg)
+{
+    uint32_t n = 0;
+    double angle[2] = {0, 0};
+
+    for (uint32_t g = 0; g < GESTURES; g++)
+    {
+        const gesture_t *gesture = &Gestures[g];
+        uint32_t ramp = gesture->ramp_ms * ODR_HZ / 1000;
+        uint32_t hold = gesture->hold_ms * ODR_HZ / 1000;
+        uint32_t length = (gesture->axis < 0) ? hold : 2 * ramp + hold;
+
+        for (uint32_t i = 0; i < length && n < MAX_SAMPLES; i++, n++)
+        {
+            double previous[2] = {angle[0], angle[1]};
+            double tremor = 0.3 * sin(2 * PI * 8.0 * n / ODR_HZ); // Degrees, 8 Hz hand tremor
+            double target = 0;
+            double ax, ay, az, rate[2];
+
+            if (gesture->axis >= 0)
+            {
+                double peak = gesture->sign * gesture->degrees;
+
+                // Smooth ramp up, hold, smooth ramp down
+                if (i < ramp)
+                {
+                    target = peak * (1 - cos(PI * i / ramp)) / 2;
+                }
+                else if (i < ramp + hold)
+                {
+                    target = peak;
+                }
+                else
+                {
+                    target = peak * (1 + cos(PI * (i - ramp - hold) / ramp)) / 2;
+                }
+            }
+
+            angle[0] = (gesture->axis == IMU_TILT_AXIS_X) ? target : 0;
+            angle[1] = (gesture->axis == IMU_TILT_AXIS_Y) ? target : 0;
+            angle[0] += tremor;
+            angle[1] += tremor / 2;
+
+            // Gravity seen by the accelerometer, matching imu_tilt's atan2(a_axis, a_z)
+            ax = sin(angle[0] * PI / 180);
+            ay = sin(angle[1] * PI / 180);
+            az = cos(angle[0] * PI / 180) * cos(angle[1] * PI / 180);
+            for (int k = 0; k < 2; k++)
+            {
+                rate[k] = (angle[k] - previous[k]) * ODR_HZ; // Degrees per second
+            }
+
+            Trace[n].x = clamp16(ax * ACCEL_LSB_PER_G + gaussian(120));
+            Trace[n].y = clamp16(ay * ACCEL_LSB_PER_G + gaussian(120));
+            Trace[n].z = clamp16(az * ACCEL_LSB_PER_G + gaussian(120));
+            Trace[n].gx = clamp16(rate[1] / GYRO_DPS_PER_LSB + 30 + gaussian(40));
+            Trace[n].gy = clamp16(-rate[0] / GYRO_DPS_PER_LSB - 20 + gaussian(40));
+            Trace[n].gz = clamp16(gaussian(40));
+
+            // Sharp taps while resting: a few samples of lateral jolt
+            if (gesture->axis < 0 && i % 300 == 150 && i + 3 < length)
+            {
+                Trace[n].x = clamp16(Trace[n].x + 0.4 * ACCEL_LSB_PER_G);
+                Trace[n].gy = clamp16(Trace[n].gy + 3000);
+            }
+
+            Truth[n].axis = gesture->axis;
+            Truth[n].sign = gesture->sign;
+            Truth[n].intended = gesture->intended;
+            Truth[n].gesture = (gesture->axis >= 0) ? (int16_t)g : -1;
+            Truth[n].crossed = gesture->axis >= 0 && fabs(target) * 100 >= enter_cdeg;
+        }
+    }
+
+    return n;
+}
+
+/**
+ * @brief
+ * Replays the scripted trace and scores every move
+ */
+static void bench_script(void)
+{
+    const imu_tilt_config_t config = IMU_TILT_CONFIG_DEFAULT;
+    const uint32_t settle = SETTLE_MS * ODR_HZ / 1000;
+    uint32_t samples = trace_build(config.enter_cdeg);
+    int32_t crossed_at[GESTURES];
+    int32_t first_move_at[GESTURES];
+    uint32_t false_moves = 0;
+    uint32_t moves = 0;
+    uint32_t detected = 0;
+    uint32_t intended = 0;
+    uint32_t latency_total_ms = 0;
+    uint32_t latency_max_ms = 0;
+    int16_t last_gesture = -1;
+    uint32_t last_gesture_end = 0;
+    imu_tilt_t tilt;
+    double start;
+    double elapsed;
+    const uint32_t rounds = 200;
+
+    for (uint32_t g = 0; g < GESTURES; g++)
+    {
+        crossed_at[g] = -1;
+        first_move_at[g] = -1;
+    }
+
+    imu_tilt_init(&tilt, &config, ODR_HZ);
+    for (uint32_t n = 0; n < samples; n++)
+    {
+        int8_t move[2];
+        const truth_t *truth = &Truth[n];
+
+        if (truth->gesture >= 0)
+        {
+            last_gesture = truth->gesture;
+            last_gesture_end = n;
+            if (truth->crossed && crossed_at[truth->gesture] < 0)
+            {
+                crossed_at[truth->gesture] = n;
+            }
+        }
+
+        if (!imu_tilt_update(&tilt, &Trace[n], &move[IMU_TILT_AXIS_X], &move[IMU_TILT_AXIS_Y]))
+        {
+            continue;
+        }
+
+        for (int axis = 0; axis < 2; axis++)
+        {
+            // A move belongs to the gesture in progress, or the one that just ended
+            int16_t g = (truth->gesture >= 0) ? truth->gesture : (n - last_gesture_end <= settle) ? last_gesture
+                                                                                                 : -1;
+            bool expected;
+
+            if (move[axis] == 0)
+            {
+                continue;
+            }
+            moves++;
+
+            expected = g >= 0 && Gestures[g].intended && Gestures[g].axis == axis && Gestures[g].sign == move[axis];
+            if (!expected)
+            {
+                false_moves++;
+                printf("  false move: sample %u axis %d dir %+d (gesture %d)\n", n, axis, move[axis], g);
+            }
+            else if (first_move_at[g] < 0)
+            {
+                first_move_at[g] = n;
+            }
+        }
+    }
+
+    for (uint32_t g = 0; g < GESTURES; g++)
+    {
+        if (!Gestures[g].intended)
+        {
+            continue;
+        }
+
+        intended++;
+        if (first_move_at[g] >= 0 && crossed_at[g] >= 0)
+        {
+            int32_t delay = first_move_at[g] - crossed_at[g];
+            uint32_t ms = (delay > 0) ? (uint32_t)(delay * 1000 / ODR_HZ) : 0;
+
+            detected++;
+            latency_total_ms += ms;
+            latency_max_ms = (ms > latency_max_ms) ? ms : latency_max_ms;
+        }
+    }
+
+    // Throughput of the pipeline itself
+    start = host_test_seconds();
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        imu_tilt_init(&tilt, &config, ODR_HZ);
+        for (uint32_t n = 0; n < samples; n++)
+        {
+            int8_t dx, dy;
+
+            imu_tilt_update(&tilt, &Trace[n], &dx, &dy);
+        }
+    }
+    elapsed = host_test_seconds() - start;
+
+    printf("Scripted trace: %u samples (%.1f s), %u gestures\n", samples, (double)samples / ODR_HZ, intended);
+    printf("  detected %u/%u, moves %u, false moves %u\n", detected, intended, moves, false_moves);
+    printf("  time to first move avg %u ms, max %u ms\n", detected ? latency_total_ms / detected : 0, latency_max_ms);
+    printf("  pipeline counters: starts %u reversals %u\n", tilt.stats.starts, tilt.stats.reversals);
+    printf("  %.1f M samples/s\n", rounds * samples / elapsed / 1e6);
+
+    CHECK(detected == intended);
+    CHECK(false_moves == 0);
+    CHECK(detected > 0 && latency_total_ms / detected <= 150);
+}
+
+/**
+ * @brief
+ * Replays a trace recorded on the board
+ */
+static int replay_file(const char *path)
+{
+    const imu_tilt_config_t config = IMU_TILT_CONFIG_DEFAULT;
+    FILE *file = fopen(path, "r");
+    char text[128];
+    uint32_t samples = 0;
+    uint32_t moves[2][2] = {{0, 0}, {0, 0}};
+    imu_tilt_t tilt;
+
+    if (file == NULL)
+    {
+        printf("Can't open %s\n", path);
+        return 1;
+    }
+
+    imu_tilt_init(&tilt, &config, ODR_HZ);
+    while (fgets(text, sizeof(text), file) != NULL)
+    {
+        int v[6];
+        imu_tilt_sample_t sample;
+        int8_t dx, dy;
+
+        if (sscanf(text, "%d,%d,%d,%d,%d,%d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 6)
+        {
+            continue;
+        }
+        sample = (imu_tilt_sample_t){v[0], v[1], v[2], v[3], v[4], v[5]};
+        samples++;
+
+        imu_tilt_update(&tilt, &sample, &dx, &dy);
+        moves[IMU_TILT_AXIS_X][dx > 0] += (dx != 0);
+        moves[IMU_TILT_AXIS_Y][dy > 0] += (dy != 0);
+    }
+    fclose(file);
+
+    printf("%s: %u samples (%.1f s)\n", path, samples, (double)samples / ODR_HZ);
+    printf("  X moves -%u +%u, Y moves -%u +%u\n", moves[0][0], moves[0][1], moves[1][0], moves[1][1]);
+    printf("  starts %u reversals %u, time to first move avg %u ms\n", tilt.stats.starts, tilt.stats.reversals,
+           tilt.stats.starts ? tilt.stats.latency_ms / tilt.stats.starts : 0);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        return replay_file(argv[1]);
+    }
+
+    bench_script();
+    return host_test_result("imu_tilt_replay");
+}
@@ -0,0 +1,169 @@
+/**
+ * @file kv_store_sim.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Write amplification and wear of the key/value store's page ring
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "host_test.h"
+#include "kv_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief
+ * Runs kv_log.c against a RAM copy of the ring that counts the writes to
+ * every byte.  The updates follow the game state keys: every shot changes
+ * the counters and about one board chunk, with the value sizes used by
+ * game_state.c.  The ring is remounted every KV_SIM_REMOUNT_INTERVAL
+ * updates and the index rebuilt from it must match the last value put for
+ * every key.
+ *
+ * Reports the write amplification (bytes written per value byte), the
+ * most and fewest writes to one byte of the ring, and the writes the
+ * hottest byte would take if every key had a fixed EEPROM address.
+ *
+ *   kv_store_sim [updates]    default 1000000
+ */
+
+#define KV_SIM_KEYS 7                 // Game state keys, see kv_store.h
+#define KV_SIM_REMOUNT_INTERVAL 100000
+#define KV_SIM_RING_SIZE (KV_LOG_PAGE_COUNT * KV_LOG_PAGE_SIZE)
+
+/* Global Variables */
+static uint8_t KV_Sim_Memory[KV_SIM_RING_SIZE];
+static uint32_t KV_Sim_Wear[KV_SIM_RING_SIZE];
+static uint32_t KV_Sim_Page_Crossings;
+
+static bool kv_sim_read(uint16_t offset, uint8_t *data, uint16_t length)
+{
+    memcpy(data, &KV_Sim_Memory[offset], length);
+    return true;
+}
+
+static bool kv_sim_write(uint16_t offset, const uint8_t *data, uint16_t length)
+{
+    // A write must stay inside one EEPROM page
+    if (offset / KV_LOG_PAGE_SIZE != (offset + length - 1) / KV_LOG_PAGE_SIZE)
+    {
+        KV_Sim_Page_Crossings++;
+    }
+
+    memcpy(&KV_Sim_Memory[offset], data, length);
+    for (uint16_t i = 0; i < length; i++)
+    {
+        KV_Sim_Wear[offset + i]++;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // Same value sizes as the game state keys
+    static const uint8_t lengths[KV_SIM_KEYS] = {15, 13, 13, 13, 11, 13, 12};
+    static uint8_t expected[KV_SIM_KEYS][KV_LOG_MAX_VALUE];
+    static kv_log_t log;
+    uint32_t updates = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 1000000;
+    uint32_t key_updates[KV_SIM_KEYS] = {0};
+    uint64_t bytes_requested = 0;
+    uint64_t bytes_written = 0;
+    uint32_t max_cell_writes = 0;
+    uint32_t min_cell_writes = UINT32_MAX;
+    uint32_t hot_cell_writes = 0;
+    uint32_t errors = 0;
+    uint32_t rng = 0x2545F491;
+    double start;
+    double elapsed;
+
+    memset(KV_Sim_Memory, 0xFF, sizeof(KV_Sim_Memory));
+    log.read = kv_sim_read;
+    log.write = kv_sim_write;
+    CHECK(kv_log_mount(&log));
+
+    start = host_test_seconds();
+    for (uint32_t i = 0; i < updates; i++)
+    {
+        uint8_t key;
+
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+
+        // Every shot changes the counters, and about one board chunk
+        key = (rng & 1) ? 0 : (uint8_t)(1 + ((rng >> 1) % (KV_SIM_KEYS - 1)));
+        expected[key][(rng >> 8) % lengths[key]] ^= (uint8_t)((rng >> 16) | 1);
+
+        if (!kv_log_put(&log, key, expected[key], lengths[key]))
+        {
+            printf("put %u failed\n", i);
+            CHECK(false);
+            break;
+        }
+        key_updates[key]++;
+
+        // Remount now and then to check the index rebuilt from the ring
+        if ((i + 1) % KV_SIM_REMOUNT_INTERVAL == 0 || i + 1 == updates)
+        {
+            bytes_requested += log.stats.bytes_requested;
+            bytes_written += log.stats.bytes_written;
+
+            CHECK(kv_log_mount(&log));
+            for (uint8_t k = 0; k < KV_SIM_KEYS; k++)
+            {
+                uint8_t value[KV_LOG_MAX_VALUE];
+
+                if (key_updates[k] != 0 &&
+                    (!kv_log_get(&log, k, value, lengths[k]) || memcmp(value, expected[k], lengths[k]) != 0))
+                {
+                    errors++;
+                }
+            }
+        }
+    }
+    elapsed = host_test_seconds() - start;
+
+    for (uint32_t i = 0; i < KV_SIM_RING_SIZE; i++)
+    {
+        if (KV_Sim_Wear[i] > max_cell_writes)
+        {
+            max_cell_writes = KV_Sim_Wear[i];
+        }
+        if (KV_Sim_Wear[i] < min_cell_writes)
+        {
+            min_cell_writes = KV_Sim_Wear[i];
+        }
+    }
+
+    // Storing each key at a fixed address wears its bytes once per update
+    for (uint8_t k = 0; k < KV_SIM_KEYS; k++)
+    {
+        if (key_updates[k] > hot_cell_writes)
+        {
+            hot_cell_writes = key_updates[k];
+        }
+    }
+
+    double amplification = (double)bytes_written / (bytes_requested ? bytes_requested : 1);
+
+    printf("updates %u, %.2f M updates/s\n", updates, updates / elapsed / 1e6);
+    printf("  write amplification %.2f (%llu bytes written for %llu requested)\n",
+           amplification, (unsigned long long)bytes_written, (unsigned long long)bytes_requested);
+    printf("  cell writes: max %u min %u, fixed address hot cell %u (%.1fx less wear)\n",
+           max_cell_writes, min_cell_writes, hot_cell_writes,
+           (double)hot_cell_writes / (max_cell_writes ? max_cell_writes : 1));
+    printf("  remount errors %u\n", errors);
+
+    CHECK(errors == 0);
+    CHECK(KV_Sim_Page_Crossings == 0);
+    // Record overhead, page headers and compaction.  Rewriting a whole page
+    // per put would cost about 5.
+    CHECK(amplification < 3.0);
+    // The ring spreads the hot key over every page
+    CHECK(max_cell_writes < hot_cell_writes);
+
+    return host_test_result("kv_store_sim");
+}
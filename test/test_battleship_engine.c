@@ -0,0 +1,231 @@
+/**
+ * @file test_battleship_engine.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Unit tests and a throughput benchmark for battleship_engine.c
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "host_test.h"
+#include "battleship_engine.h"
+#include <stdlib.h>
+
+/**
+ * @brief
+ * Checks every transition of the engine against a fixed fleet, ship n
+ * lying horizontally from column 0 of row n - 1, then times whole games
+ * of random shots through battleship_game_play_random().
+ *
+ *   test_battleship_engine [games]    default 200000
+ */
+
+static void place_fleet(battleship_game_t *game)
+{
+    for (uint8_t id = 1; id <= BITBOARD_SHIPS; id++)
+    {
+        CHECK(battleship_game_place(game, id, 0, id - 1, true) == BATTLESHIP_OK);
+    }
+}
+
+static void test_place(void)
+{
+    battleship_game_t game;
+
+    battleship_game_init(&game, 0);
+    CHECK(game.phase == BATTLESHIP_PHASE_PLACEMENT);
+    CHECK(battleship_game_ship_length(0) == 0);
+    CHECK(battleship_game_ship_length(5) == 5);
+
+    // Unknown ship, off the board and running off the edge
+    CHECK(battleship_game_place(&game, 0, 0, 0, true) == BATTLESHIP_ERR_INVALID);
+    CHECK(battleship_game_place(&game, 6, 0, 0, true) == BATTLESHIP_ERR_INVALID);
+    CHECK(battleship_game_place(&game, 1, BITBOARD_SIZE, 0, true) == BATTLESHIP_ERR_INVALID);
+    CHECK(battleship_game_place(&game, 5, 6, 0, true) == BATTLESHIP_ERR_INVALID);
+    CHECK(battleship_game_place(&game, 5, 0, 6, false) == BATTLESHIP_ERR_INVALID);
+
+    CHECK(battleship_game_place(&game, 1, 0, 0, true) == BATTLESHIP_OK);
+    CHECK(battleship_game_place(&game, 2, 1, 0, false) == BATTLESHIP_ERR_OVERLAP);
+
+    // Moving a placed ship does not count it twice
+    CHECK(battleship_game_place(&game, 1, 0, 0, false) == BATTLESHIP_OK);
+    CHECK(game.ships_placed == 1);
+    CHECK(battleship_game_ship_at(&game, 0, 1) == 1);
+    CHECK(battleship_game_ship_at(&game, 1, 0) == 0);
+
+    // The fifth ship starts the game
+    battleship_game_init(&game, 0);
+    for (uint8_t id = 1; id < BITBOARD_SHIPS; id++)
+    {
+        CHECK(battleship_game_place(&game, id, 0, id - 1, true) == BATTLESHIP_OK);
+        CHECK(game.phase == BATTLESHIP_PHASE_PLACEMENT);
+    }
+    CHECK(battleship_game_place(&game, BITBOARD_SHIPS, 0, BITBOARD_SHIPS - 1, true) == BATTLESHIP_OK);
+    CHECK(game.phase == BATTLESHIP_PHASE_PLAYING);
+    CHECK(battleship_game_place(&game, 1, 5, 5, true) == BATTLESHIP_ERR_PHASE);
+}
+
+static void test_fire(void)
+{
+    battleship_game_t game;
+
+    battleship_game_init(&game, 0);
+    CHECK(battleship_game_fire(&game, 0, 0) == BATTLESHIP_ERR_PHASE);
+    place_fleet(&game);
+
+    CHECK(battleship_game_is_my_turn(&game));
+    CHECK(battleship_game_apply_result(&game, BITBOARD_SHOT_MISS) == BATTLESHIP_ERR_NO_SHOT);
+    CHECK(battleship_game_fire(&game, BITBOARD_SIZE, 0) == BATTLESHIP_ERR_INVALID);
+    CHECK(battleship_game_fire(&game, 3, 3) == BATTLESHIP_OK);
+    CHECK(game.shot_pending && game.shot_col == 3 && game.shot_row == 3);
+    CHECK(battleship_game_apply_result(&game, BITBOARD_SHOT_REPEAT) == BATTLESHIP_ERR_INVALID);
+    CHECK(battleship_game_apply_result(&game, BITBOARD_SHOT_MISS) == BATTLESHIP_OK);
+    CHECK(!game.shot_pending);
+    CHECK(battleship_game_target_at(&game, 3, 3) == BATTLESHIP_TARGET_MISS);
+    CHECK(game.my_misses == 1 && game.my_hits == 0);
+    CHECK(battleship_game_fire(&game, 3, 3) == BATTLESHIP_ERR_REPEAT);
+
+    // A second shot replaces one that never got a result
+    CHECK(battleship_game_fire(&game, 4, 4) == BATTLESHIP_OK);
+    CHECK(battleship_game_fire(&game, 5, 5) == BATTLESHIP_OK);
+    CHECK(battleship_game_apply_result(&game, BITBOARD_SHOT_HIT) == BATTLESHIP_OK);
+    CHECK(battleship_game_target_at(&game, 5, 5) == BATTLESHIP_TARGET_HIT);
+    CHECK(battleship_game_target_at(&game, 4, 4) == BATTLESHIP_TARGET_UNKNOWN);
+    CHECK(game.my_hits == 1);
+
+    // Player 1 waits for player 0
+    battleship_game_init(&game, 1);
+    place_fleet(&game);
+    CHECK(!battleship_game_is_my_turn(&game));
+    CHECK(battleship_game_fire(&game, 0, 0) == BATTLESHIP_ERR_TURN);
+}
+
+static void test_pass_turn(void)
+{
+    battleship_game_t game;
+
+    battleship_game_init(&game, 1);
+    CHECK(battleship_game_pass_turn(&game, 0) == BATTLESHIP_ERR_PHASE);
+    place_fleet(&game);
+
+    CHECK(battleship_game_pass_turn(&game, BATTLESHIP_GAME_PLAYERS) == BATTLESHIP_ERR_INVALID);
+    CHECK(battleship_game_pass_turn(&game, 0) == BATTLESHIP_OK);
+    CHECK(game.current_turn == 1);
+    CHECK(battleship_game_fire(&game, 0, 0) == BATTLESHIP_OK);
+    CHECK(battleship_game_pass_turn(&game, 1) == BATTLESHIP_OK);
+    CHECK(game.current_turn == 0);
+    CHECK(battleship_game_fire(&game, 1, 0) == BATTLESHIP_ERR_TURN);
+}
+
+static void test_receive_fire(void)
+{
+    battleship_game_t game;
+    bitboard_shot_t shot;
+    uint8_t ship_id;
+
+    battleship_game_init(&game, 0);
+    CHECK(battleship_game_receive_fire(&game, 0, 0, &shot, &ship_id) == BATTLESHIP_ERR_PHASE);
+    place_fleet(&game);
+
+    CHECK(battleship_game_receive_fire(&game, 9, 9, &shot, &ship_id) == BATTLESHIP_OK);
+    CHECK(shot == BITBOARD_SHOT_MISS && ship_id == 0);
+    CHECK(game.opponent_misses == 1);
+    CHECK(battleship_game_receive_fire(&game, 9, 9, &shot, &ship_id) == BATTLESHIP_ERR_REPEAT);
+    CHECK(battleship_game_receive_fire(&game, 0, BITBOARD_SIZE, &shot, &ship_id) == BATTLESHIP_ERR_INVALID);
+
+    CHECK(battleship_game_receive_fire(&game, 0, 0, &shot, &ship_id) == BATTLESHIP_OK);
+    CHECK(shot == BITBOARD_SHOT_HIT && ship_id == 1);
+    CHECK(battleship_game_shot_at(&game, 0, 0));
+    CHECK(battleship_game_receive_fire(&game, 1, 0, &shot, &ship_id) == BATTLESHIP_OK);
+    CHECK(shot == BITBOARD_SHOT_SUNK && ship_id == 1);
+    CHECK(game.ship_hit_count[0] == 2);
+
+    // Sinking the rest of the fleet loses the game
+    for (uint8_t id = 2; id <= BITBOARD_SHIPS; id++)
+    {
+        for (uint8_t col = 0; col < battleship_game_ship_length(id); col++)
+        {
+            CHECK(battleship_game_receive_fire(&game, col, id - 1, &shot, NULL) == BATTLESHIP_OK);
+        }
+        CHECK(shot == BITBOARD_SHOT_SUNK);
+    }
+    CHECK(game.opponent_hits == 17);
+    CHECK(game.phase == BATTLESHIP_PHASE_OVER && !game.i_won);
+    CHECK(battleship_game_receive_fire(&game, 8, 8, &shot, NULL) == BATTLESHIP_ERR_PHASE);
+}
+
+static void test_win(void)
+{
+    battleship_game_t game;
+
+    battleship_game_init(&game, 0);
+    place_fleet(&game);
+
+    // Only a sunk result counts down the opponent's fleet
+    for (uint8_t id = 1; id <= BITBOARD_SHIPS; id++)
+    {
+        CHECK(game.phase == BATTLESHIP_PHASE_PLAYING);
+        CHECK(battleship_game_fire(&game, id, 9) == BATTLESHIP_OK);
+        CHECK(battleship_game_apply_result(&game, BITBOARD_SHOT_HIT) == BATTLESHIP_OK);
+        CHECK(battleship_game_fire(&game, id, 8) == BATTLESHIP_OK);
+        CHECK(battleship_game_apply_result(&game, BITBOARD_SHOT_SUNK) == BATTLESHIP_OK);
+        CHECK(game.opponent_ships_remaining == BITBOARD_SHIPS - id);
+    }
+    CHECK(game.phase == BATTLESHIP_PHASE_OVER && game.i_won);
+    CHECK(game.my_hits == 2 * BITBOARD_SHIPS);
+    CHECK(battleship_game_fire(&game, 0, 0) == BATTLESHIP_ERR_PHASE);
+
+    // Ending an ended game keeps the first outcome
+    battleship_game_end(&game, false);
+    CHECK(game.i_won);
+
+    battleship_game_init(&game, 0);
+    place_fleet(&game);
+    battleship_game_end(&game, false);
+    CHECK(game.phase == BATTLESHIP_PHASE_OVER && !game.i_won);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t games = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 200000;
+    battleship_game_t game[BATTLESHIP_GAME_PLAYERS];
+    uint32_t seed = 1;
+    uint32_t wins[BATTLESHIP_GAME_PLAYERS] = {0};
+    uint64_t transitions = 0;
+    double start;
+    double elapsed;
+
+    bitboard_init();
+
+    test_place();
+    test_fire();
+    test_pass_turn();
+    test_receive_fire();
+    test_win();
+
+    start = host_test_seconds();
+    for (uint32_t i = 0; i < games; i++)
+    {
+        transitions += battleship_game_play_random(game, &seed);
+        wins[game[0].i_won ? 0 : 1]++;
+
+        // Exactly one side wins and the loser's fleet is gone
+        if (game[0].i_won == game[1].i_won || !bitboard_fleet_all_sunk(&game[game[0].i_won ? 1 : 0].fleet))
+        {
+            CHECK(false);
+            break;
+        }
+    }
+    elapsed = host_test_seconds() - start;
+
+    printf("games %u, %.1f k games/s, %.2f M transitions/s\n",
+           games, games / elapsed / 1e3, transitions / elapsed / 1e6);
+    printf("  first player wins %.1f%%, %.1f transitions per game\n",
+           100.0 * wins[0] / (games ? games : 1), (double)transitions / (games ? games : 1));
+
+    CHECK(wins[0] + wins[1] == games);
+
+    return host_test_result("test_battleship_engine");
+}
@@ -0,0 +1,321 @@
+/**
+ * @file test_console_line.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Host test for the console line assembler
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "host_test.h"
+#include "console_line.h"
+#include <stdbool.h>
+#include <string.h>
+
+// Sizes used by the firmware (task_console.h)
+#define LINE_LENGTH 128
+#define RING_SIZE 256
+#define LINE_QUEUE_LENGTH 8
+
+// Lines sent back to back at line rate
+#define BLAST_LINES 200000
+
+static char line[LINE_LENGTH];
+static console_line_t assembler;
+
+/**
+ * @brief
+ * Feeds text and returns the number of lines completed, copying the last one
+ */
+static int feed(const char *text, char *last)
+{
+    int lines = 0;
+
+    for (; *text != '\0'; text++)
+    {
+        const char *complete = console_line_put(&assembler, *text);
+
+        if (complete != NULL)
+        {
+            strcpy(last, complete);
+            lines++;
+        }
+    }
+
+    return lines;
+}
+
+static void test_editing(void)
+{
+    char last[LINE_LENGTH] = "";
+    char long_line[LINE_LENGTH + 8];
+
+    console_line_init(&assembler, line, sizeof(line));
+
+    CHECK(feed("LED stats\r", last) == 1 && strcmp(last, "LED stats") == 0);
+    // CR LF and blank lines do not produce empty commands
+    CHECK(feed("KV stats\r\n\r\n\n", last) == 1 && strcmp(last, "KV stats") == 0);
+    CHECK(feed("AIX\b on\n", last) == 1 && strcmp(last, "AI on") == 0);
+    CHECK(feed("\x7f\x7fX\x7f\r", last) == 0);
+
+    // A line one character too long is dropped, the next one is intact
+    memset(long_line, 'A', LINE_LENGTH);
+    long_line[LINE_LENGTH] = '\0';
+    CHECK(feed(long_line, last) == 0);
+    CHECK(feed("\b\b\rCPU\r", last) == 1 && strcmp(last, "CPU") == 0);
+    CHECK(assembler.overflows == 1);
+
+    // The longest accepted line
+    long_line[LINE_LENGTH - 1] = '\0';
+    CHECK(feed(long_line, last) == 0 && feed("\n", last) == 1 && strlen(last) == LINE_LENGTH - 1);
+    CHECK(assembler.overflows == 1);
+}
+
+// One UART byte at 115200 baud, 8N1, in ns
+#define BYTE_NS (10 * 1000000000ULL / 115200)
+
+// The receive path from the UART to the command task, stepped one byte
+// time at a time
+typedef struct
+{
+    char ring[RING_SIZE];                            // circular_buffer_rx
+    uint32_t produce;
+    uint32_t consume;
+    char queue[LINE_QUEUE_LENGTH][LINE_LENGTH];      // xQueue_Console_Rx
+    uint32_t queue_head;
+    uint32_t queue_tail;
+    uint32_t queue_high_water;
+    char held[LINE_LENGTH];                          // Line the line task is blocked sending
+    bool blocked;
+    uint64_t busy_until;                             // The command task is running a command
+    uint32_t executed;
+    uint32_t ring_overflows;                         // Console_Rx_Stats.ring_overflows
+    uint32_t bytes_sent;
+    uint32_t intact;                                 // Executed lines that were sent whole, in order
+    uint32_t garbled;                                // Executed lines made of pieces of several
+    bool in_order;
+} rx_model_t;
+
+/**
+ * @brief
+ * Queues a line for the command task, or blocks the line task on it
+ */
+static void model_queue_line(rx_model_t *m, const char *complete)
+{
+    if (m->queue_tail - m->queue_head == LINE_QUEUE_LENGTH)
+    {
+        strcpy(m->held, complete);
+        m->blocked = true;
+        return;
+    }
+
+    strcpy(m->queue[m->queue_tail++ % LINE_QUEUE_LENGTH], complete);
+    if (m->queue_tail - m->queue_head > m->queue_high_water)
+    {
+        m->queue_high_water = m->queue_tail - m->queue_head;
+    }
+}
+
+/**
+ * @brief
+ * Sends lines numbered commands back to back at the UART's byte rate.
+ * The first command takes first_ns to run and every other one command_ns.
+ * The line task empties the ring whenever it is not blocked on a full
+ * line queue; a byte arriving at a full ring is lost.  ending NULL mixes
+ * "\r", "\n" and "\r\n".
+ */
+static void model_run(rx_model_t *m, uint32_t lines, const char *ending, uint64_t first_ns, uint64_t command_ns)
+{
+    char text[32];
+    int length = 0;
+    int sent_index = 0;
+    uint32_t sent = 0;
+    uint32_t next = 0;
+
+    memset(m, 0, sizeof(rx_model_t));
+    m->in_order = true;
+    console_line_init(&assembler, line, sizeof(line));
+
+    for (uint64_t now = 0;; now += BYTE_NS)
+    {
+        // The UART delivers one byte per byte time
+        if (sent < lines)
+        {
+            if (sent_index == length)
+            {
+                static const char *endings[] = {"\r", "\n", "\r\n"};
+
+                length = snprintf(text, sizeof(text), "EEPROM r 0x%04lX 16%s", (unsigned long)sent,
+                                  (ending != NULL) ? ending : endings[sent % 3]);
+                sent_index = 0;
+            }
+
+            m->bytes_sent++;
+            if (m->produce - m->consume == RING_SIZE)
+            {
+                m->ring_overflows++;
+            }
+            else
+            {
+                m->ring[m->produce++ % RING_SIZE] = text[sent_index];
+            }
+            if (++sent_index == length)
+            {
+                sent++;
+            }
+        }
+
+        // The command task takes the next line once the last one is done
+        if (now >= m->busy_until && m->queue_head != m->queue_tail)
+        {
+            const char *command = m->queue[m->queue_head++ % LINE_QUEUE_LENGTH];
+            unsigned long number;
+            int used = 0;
+
+            if (sscanf(command, "EEPROM r 0x%lX 16%n", &number, &used) == 1 && used == (int)strlen(command) &&
+                number >= next)
+            {
+                m->in_order = m->in_order && (number == next);
+                next = number + 1;
+                m->intact++;
+            }
+            else
+            {
+                m->garbled++;
+            }
+            m->busy_until = now + ((m->executed++ == 0) ? first_ns : command_ns);
+        }
+
+        // The line task wakes when the queue has room again, then empties
+        // the ring
+        if (m->blocked && m->queue_tail - m->queue_head < LINE_QUEUE_LENGTH)
+        {
+            m->blocked = false;
+            model_queue_line(m, m->held);
+        }
+        while (!m->blocked && m->consume != m->produce)
+        {
+            const char *complete = console_line_put(&assembler, m->ring[m->consume++ % RING_SIZE]);
+
+            if (complete != NULL)
+            {
+                model_queue_line(m, complete);
+            }
+        }
+
+        if (sent == lines && !m->blocked && m->consume == m->produce && m->queue_head == m->queue_tail)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief
+ * Commands that run faster than a line arrives: BLAST_LINES lines with
+ * mixed endings all arrive, once and in order, with nothing dropped
+ */
+static void test_line_rate(void)
+{
+    static rx_model_t m;
+
+    model_run(&m, BLAST_LINES, NULL, 1000000, 1000000);
+
+    CHECK(m.intact == BLAST_LINES);
+    CHECK(m.in_order);
+    CHECK(m.garbled == 0);
+    CHECK(m.ring_overflows == 0);
+    CHECK(assembler.overflows == 0);
+    CHECK(m.queue_high_water == 1);
+}
+
+/**
+ * @brief
+ * The command task stalls on its first command while a script keeps
+ * arriving.  The line queue fills, the line task blocks on it with one
+ * more line, and the ring takes the rest.  A stall the ring and queue can
+ * absorb loses nothing; past that every byte delivered to the full ring is
+ * counted as an overflow and lines are lost or run together.
+ */
+static void test_stalled_consumer(void)
+{
+    static rx_model_t m;
+    // Enough to keep the UART busy for the longest stall
+    const uint32_t lines = 1000;
+    // "EEPROM r 0x0000 16\r"
+    const uint32_t line_bytes = 19;
+    // Bytes held after the stalled line: the queue, the line the line task
+    // is blocked on and the ring
+    const uint64_t capacity_ns = ((LINE_QUEUE_LENGTH + 1) * line_bytes + RING_SIZE) * BYTE_NS;
+    const uint32_t stall_ms[] = {5, 10, 20, 30, 35, 40, 50, 100, 250, 1000};
+    uint32_t last_overflows = 0;
+
+    printf("stall ms  ring overflows  lines lost  garbled  queue high water  (capacity %.1f ms)\n", capacity_ns / 1e6);
+    for (size_t i = 0; i < sizeof(stall_ms) / sizeof(stall_ms[0]); i++)
+    {
+        uint64_t stall_ns = stall_ms[i] * 1000000ULL;
+
+        // After the stall the commands keep up again
+        model_run(&m, lines, "\r", stall_ns, 100000);
+        printf("%8u  %14u  %10u  %7u  %16u\n", stall_ms[i], m.ring_overflows, lines - m.intact, m.garbled, m.queue_high_water);
+
+        CHECK(m.in_order || m.ring_overflows != 0);
+        // Every byte the UART sent reached the ring or was counted
+        CHECK(m.produce + m.ring_overflows == m.bytes_sent);
+        CHECK(m.ring_overflows >= last_overflows);
+        last_overflows = m.ring_overflows;
+
+        if (stall_ns < capacity_ns)
+        {
+            CHECK(m.ring_overflows == 0);
+            CHECK(m.intact == lines);
+        }
+        else
+        {
+            // The ring fills capacity_ns into the stall and drops the
+            // bytes of the remaining time, one per byte time
+            uint64_t expected = (stall_ns - capacity_ns) / BYTE_NS;
+
+            CHECK(m.queue_high_water == LINE_QUEUE_LENGTH);
+            CHECK(m.ring_overflows + 2 >= expected && m.ring_overflows <= expected + 2);
+            CHECK(m.intact < lines);
+            CHECK(m.intact + m.ring_overflows / line_bytes <= lines);
+        }
+    }
+}
+
+/**
+ * @brief
+ * Commands that take longer than a line to arrive: a long script fills
+ * the queue and then the ring, and input is lost until the script ends
+ */
+static void test_slow_commands(void)
+{
+    static rx_model_t m;
+    const uint32_t lines = 2000;
+    // Twice the time a 19 byte line takes to arrive
+    const uint64_t command_ns = 2 * 19 * BYTE_NS;
+
+    model_run(&m, lines, "\r", command_ns, command_ns);
+    printf("slow commands: %u lines, %u executed (%u garbled), %u ring overflows, %u line overflows\n",
+           lines, m.executed, m.garbled, m.ring_overflows, assembler.overflows);
+
+    CHECK(m.queue_high_water == LINE_QUEUE_LENGTH);
+    CHECK(m.produce + m.ring_overflows == m.bytes_sent);
+    // The command task runs about every other line, so roughly half the
+    // input is dropped
+    CHECK(m.executed > lines * 4 / 10 && m.executed < lines * 6 / 10);
+    CHECK(m.ring_overflows > m.bytes_sent * 4 / 10);
+    CHECK(m.intact < lines);
+}
+
+int main(void)
+{
+    test_editing();
+    test_line_rate();
+    test_stalled_consumer();
+    test_slow_commands();
+    return host_test_result("test_console_line");
+}
@@ -0,0 +1,188 @@
+/**
+ * @file test_eeprom_cache.c
+ * @author Joe Krachey (jkrachey@wisc.edu)
+ * @brief
+ * Host test for the EEPROM write-back cache
+ * @version 0.1
+ * @date 2025-10-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "host_test.h"
+#include "eeprom_cache.h"
+#include <string.h>
+
+/**
+ * @brief
+ * Runs eeprom_cache.c against a RAM copy of the EEPROM and a tick counter
+ * the test advances by hand.  Checks that reads see the newest data, that
+ * unchanged writes are dropped, that dirty lines reach the device when
+ * they are due or evicted, and that a full page write into a reused line
+ * is never mistaken for an unchanged one.
+ */
+
+#define PAGES 64
+#define FLUSH_TICKS 500
+
+/* Global Variables */
+static uint8_t Memory[PAGES * EEPROM_CACHE_PAGE_SIZE];
+static uint32_t Device_Writes;
+static uint32_t Ticks;
+static eeprom_cache_t Cache;
+
+static void memory_read(uint16_t address, uint8_t *data, uint16_t length)
+{
+    memcpy(data, &Memory[address], length);
+}
+
+static void memory_write(uint16_t address, const uint8_t *data, uint16_t length)
+{
+    memcpy(&Memory[address], data, length);
+    Device_Writes++;
+}
+
+static uint32_t ticks_now(void)
+{
+    return Ticks;
+}
+
+static void cache_reset(void)
+{
+    memset(Memory, 0xFF, sizeof(Memory));
+    memset(&Cache, 0, sizeof(Cache));
+    Cache.read = memory_read;
+    Cache.write = memory_write;
+    Cache.now = ticks_now;
+    Cache.flush_ticks = FLUSH_TICKS;
+    Device_Writes = 0;
+    Ticks = 0;
+}
+
+static void test_read_write(void)
+{
+    uint8_t value[16];
+    uint8_t block[3 * EEPROM_CACHE_PAGE_SIZE];
+
+    cache_reset();
+
+    // A block across pages reads back from the cache before any flush
+    for (uint16_t i = 0; i < sizeof(block); i++)
+    {
+        block[i] = (uint8_t)i;
+    }
+    eeprom_cache_write(&Cache, 40, block, sizeof(block));
+    CHECK(Device_Writes == 0);
+    memset(block, 0, sizeof(block));
+    eeprom_cache_read(&Cache, 40, block, sizeof(block), false);
+    CHECK(block[0] == 0 && block[100] == 100 && block[sizeof(block) - 1] == (uint8_t)(sizeof(block) - 1));
+    CHECK(eeprom_cache_next_flush(&Cache) == FLUSH_TICKS);
+
+    // Rewriting the same bytes is dropped
+    eeprom_cache_write(&Cache, 40, block, 16);
+    CHECK(Cache.stats.writes_dropped == 1);
+
+    // Nothing is due until FLUSH_TICKS have passed
+    Ticks = FLUSH_TICKS - 1;
+    eeprom_cache_flush(&Cache, false);
+    CHECK(Device_Writes == 0);
+    Ticks = FLUSH_TICKS;
+    CHECK(eeprom_cache_next_flush(&Cache) == 0);
+    eeprom_cache_flush(&Cache, false);
+    CHECK(Device_Writes == 4);
+    CHECK(eeprom_cache_next_flush(&Cache) == EEPROM_CACHE_CLEAN);
+    CHECK(Memory[40] == 0 && Memory[40 + 100] == 100);
+
+    // Bytes outside the written range keep what the device held
+    eeprom_cache_read(&Cache, 32, value, sizeof(value), true);
+    CHECK(value[0] == 0xFF && value[7] == 0xFF && value[8] == 0);
+}
+
+static void test_eviction(void)
+{
+    uint8_t value[4] = {1, 2, 3, 4};
+    uint8_t check[4];
+
+    cache_reset();
+
+    // One more page than there are lines evicts the least recently used
+    for (uint16_t page = 0; page <= EEPROM_CACHE_LINES; page++)
+    {
+        Ticks++;
+        eeprom_cache_write(&Cache, page * EEPROM_CACHE_PAGE_SIZE, value, sizeof(value));
+    }
+    CHECK(Device_Writes == 1);
+    CHECK(memcmp(&Memory[0], value, sizeof(value)) == 0);
+
+    eeprom_cache_flush(&Cache, true);
+    CHECK(Device_Writes == EEPROM_CACHE_LINES + 1);
+    eeprom_cache_read(&Cache, EEPROM_CACHE_LINES * EEPROM_CACHE_PAGE_SIZE, check, sizeof(check), false);
+    CHECK(memcmp(check, value, sizeof(value)) == 0);
+}
+
+/**
+ * @brief
+ * A full page write that misses takes a line without reading the page, so
+ * the line still holds the page it evicted.  The same 64 bytes written to
+ * the new page must still be written, as kv_log_open_page() does when it
+ * formats a page.
+ */
+static void test_full_page_reuse(void)
+{
+    uint8_t page_data[EEPROM_CACHE_PAGE_SIZE];
+    uint8_t check[EEPROM_CACHE_PAGE_SIZE];
+
+    cache_reset();
+    memset(page_data, 0xA5, sizeof(page_data));
+
+    // Every line holds a copy of page_data
+    for (uint16_t page = 0; page < EEPROM_CACHE_LINES; page++)
+    {
+        Ticks++;
+        eeprom_cache_write(&Cache, page * EEPROM_CACHE_PAGE_SIZE, page_data, sizeof(page_data));
+    }
+    eeprom_cache_flush(&Cache, true);
+    CHECK(Device_Writes == EEPROM_CACHE_LINES);
+
+    // Page 0's line is reused for the next page, with the same bytes
+    Ticks++;
+    eeprom_cache_write(&Cache, EEPROM_CACHE_LINES * EEPROM_CACHE_PAGE_SIZE, page_data, sizeof(page_data));
+    CHECK(Cache.stats.writes_dropped == 0);
+    CHECK(eeprom_cache_next_flush(&Cache) == FLUSH_TICKS);
+
+    eeprom_cache_flush(&Cache, true);
+    CHECK(Device_Writes == EEPROM_CACHE_LINES + 1);
+    CHECK(memcmp(&Memory[EEPROM_CACHE_LINES * EEPROM_CACHE_PAGE_SIZE], page_data, sizeof(page_data)) == 0);
+
+    // Once the line is the page's, an identical write is dropped
+    eeprom_cache_write(&Cache, EEPROM_CACHE_LINES * EEPROM_CACHE_PAGE_SIZE, page_data, sizeof(page_data));
+    CHECK(Cache.stats.writes_dropped == 1);
+
+    // Page 0 was evicted clean and reads back from the device
+    eeprom_cache_read(&Cache, 0, check, sizeof(check), false);
+    CHECK(Cache.stats.read_misses == 1);
+    CHECK(memcmp(check, page_data, sizeof(page_data)) == 0);
+}
+
+static void test_write_through(void)
+{
+    uint8_t value = 0x42;
+
+    cache_reset();
+    Cache.write_through = true;
+
+    eeprom_cache_write(&Cache, 10, &value, 1);
+    CHECK(Device_Writes == 1 && Memory[10] == 0x42);
+    CHECK(eeprom_cache_next_flush(&Cache) == EEPROM_CACHE_CLEAN);
+    eeprom_cache_write(&Cache, 10, &value, 1);
+    CHECK(Device_Writes == 1);
+}
+
+int main(void)
+{
+    test_read_write();
+    test_eviction();
+    test_full_page_reuse();
+    test_write_through();
+    return host_test_result("test_eeprom_cache");
+}